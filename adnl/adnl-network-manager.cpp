@@ -19,12 +19,15 @@
 #include "adnl-network-manager.hpp"
 #include "adnl-peer-table.h"
 
+#include "td/utils/as.h"
+
 namespace ton {
 
 namespace adnl {
 
-td::actor::ActorOwn<AdnlNetworkManager> AdnlNetworkManager::create(td::uint16 port) {
-  return td::actor::create_actor<AdnlNetworkManagerImpl>("NetworkManager", port);
+td::actor::ActorOwn<AdnlNetworkManager> AdnlNetworkManager::create(td::uint16 port, td::uint32 receivers_per_port) {
+  CHECK(receivers_per_port > 0);
+  return td::actor::create_actor<AdnlNetworkManagerImpl>("NetworkManager", port, receivers_per_port);
 }
 
 void AdnlNetworkManagerImpl::add_listening_udp_port(td::uint16 port) {
@@ -40,30 +43,72 @@ void AdnlNetworkManagerImpl::add_listening_udp_port(td::uint16 port) {
     }
   };
 
-  auto X = td::UdpServer::create("udp server", port, std::make_unique<Callback>(actor_shared(this)));
-  X.ensure();
-  udp_servers_.emplace(port, X.move_as_ok());
-}
+  // passes packets to the peer table right away, bypassing the manager
+  class ConcurrentCallback : public td::UdpServer::Callback {
+   public:
+    ConcurrentCallback(std::shared_ptr<SharedCallback> callback) : callback_(std::move(callback)) {
+    }
 
-void AdnlNetworkManagerImpl::receive_udp_message(td::UdpMessage message) {
-  if (!callback_) {
-    LOG(ERROR) << this << ": dropping IN message [?->?]: peer table unitialized";
+   private:
+    std::shared_ptr<SharedCallback> callback_;
+    td::uint64 received_messages_ = 0;
+    void on_udp_message(td::UdpMessage udp_message) override {
+      auto callback = callback_->callback.load(std::memory_order_acquire);
+      if (check_udp_message(callback, udp_message, received_messages_)) {
+        callback->receive_packet_concurrent(udp_message.address, std::move(udp_message.data));
+      }
+    }
+  };
+
+  auto &servers = udp_servers_[port];
+  if (receivers_per_port_ == 1) {
+    auto X = td::UdpServer::create("udp server", port, std::make_unique<Callback>(actor_shared(this)));
+    X.ensure();
+    servers.push_back(X.move_as_ok());
     return;
   }
+  for (td::uint32 i = 0; i < receivers_per_port_; i++) {
+    auto X = td::UdpServer::create(PSLICE() << "udp server " << i, port,
+                                   std::make_unique<ConcurrentCallback>(shared_callback_), false, true);
+    X.ensure();
+    servers.push_back(X.move_as_ok());
+  }
+}
+
+bool AdnlNetworkManagerImpl::check_udp_message(const Callback *callback, const td::UdpMessage &message,
+                                               td::uint64 &received_messages) {
+  if (!callback) {
+    LOG(ERROR) << PrintId{} << ": dropping IN message [?->?]: peer table unitialized";
+    return false;
+  }
   if (message.error.is_error()) {
-    VLOG(ADNL_WARNING) << this << ": dropping ERROR message: " << message.error;
-    return;
+    VLOG(ADNL_WARNING) << PrintId{} << ": dropping ERROR message: " << message.error;
+    return false;
   }
   if (message.data.size() >= get_mtu()) {
-    VLOG(ADNL_NOTICE) << this << ": received huge packet of size " << message.data.size();
+    VLOG(ADNL_NOTICE) << PrintId{} << ": received huge packet of size " << message.data.size();
   }
-  received_messages_++;
-  if (received_messages_ % 64 == 0) {
-    VLOG(ADNL_DEBUG) << this << ": received " << received_messages_ << " udp messages";
+  received_messages++;
+  if (received_messages % 64 == 0) {
+    VLOG(ADNL_DEBUG) << PrintId{} << ": received " << received_messages << " udp messages";
   }
 
-  VLOG(ADNL_EXTRA_DEBUG) << this << ": received message of size " << message.data.size();
-  callback_->receive_packet(message.address, std::move(message.data));
+  VLOG(ADNL_EXTRA_DEBUG) << PrintId{} << ": received message of size " << message.data.size();
+  return true;
+}
+
+void AdnlNetworkManagerImpl::receive_udp_message(td::UdpMessage message) {
+  if (check_udp_message(callback_, message, received_messages_)) {
+    callback_->receive_packet(message.address, std::move(message.data));
+  }
+}
+
+td::actor::ActorId<td::UdpServer> AdnlNetworkManagerImpl::get_udp_server(td::uint16 port, AdnlNodeIdShort dst_id) {
+  auto it = udp_servers_.find(port);
+  CHECK(it != udp_servers_.end());
+  auto &servers = it->second;
+  // packets to one peer must go through one socket: ADNL drops packets reordered by more than 64 seqnos
+  return servers[td::as<td::uint32>(dst_id.as_slice().begin()) % servers.size()].get();
 }
 
 void AdnlNetworkManagerImpl::send_udp_packet(AdnlNodeIdShort src_id, AdnlNodeIdShort dst_id, td::IPAddress dst_addr,
@@ -84,20 +129,15 @@ void AdnlNetworkManagerImpl::send_udp_packet(AdnlNodeIdShort src_id, AdnlNodeIdS
   auto &v = dv[randseed % dv.size()];
 
   if (!v.is_proxy()) {
-    auto it = udp_servers_.find(static_cast<td::uint16>(v.addr.get_port()));
-    CHECK(it != udp_servers_.end());
-
     td::UdpMessage M;
     M.address = dst_addr;
     M.data = std::move(data);
 
     CHECK(M.data.size() <= get_mtu());
 
-    td::actor::send_closure(it->second, &td::UdpServer::send, std::move(M));
+    td::actor::send_closure(get_udp_server(static_cast<td::uint16>(v.addr.get_port()), dst_id), &td::UdpServer::send,
+                            std::move(M));
   } else {
-    auto it = udp_servers_.find(out_udp_port_);
-    CHECK(it != udp_servers_.end());
-
     auto enc = v.proxy->encrypt(
         AdnlProxy::Packet{dst_addr.get_ipv4(), static_cast<td::uint16>(dst_addr.get_port()), std::move(data)});
 
@@ -105,7 +145,7 @@ void AdnlNetworkManagerImpl::send_udp_packet(AdnlNodeIdShort src_id, AdnlNodeIdS
     M.address = v.addr;
     M.data = std::move(enc);
 
-    td::actor::send_closure(it->second, &td::UdpServer::send, std::move(M));
+    td::actor::send_closure(get_udp_server(out_udp_port_, dst_id), &td::UdpServer::send, std::move(M));
   }
 }
 
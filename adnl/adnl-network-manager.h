@@ -57,8 +57,15 @@ class AdnlNetworkManager : public td::actor::Actor {
     virtual ~Callback() = default;
     //virtual void receive_packet(td::IPAddress addr, ConnHandle conn_handle, td::BufferSlice data) = 0;
     virtual void receive_packet(td::IPAddress addr, td::BufferSlice data) = 0;
+    // used instead of receive_packet if there are several receivers per port: it is called right on the receiving
+    // threads, possibly concurrently
+    virtual void receive_packet_concurrent(td::IPAddress addr, td::BufferSlice data) {
+      receive_packet(addr, std::move(data));
+    }
   };
-  static td::actor::ActorOwn<AdnlNetworkManager> create(td::uint16 out_port);
+  // with receivers_per_port > 1 every listening port is served by that many SO_REUSEPORT sockets, each handled by its
+  // own actor, so that packets are received on several scheduler threads at once
+  static td::actor::ActorOwn<AdnlNetworkManager> create(td::uint16 out_port, td::uint32 receivers_per_port = 1);
 
   virtual ~AdnlNetworkManager() = default;
 
@@ -26,6 +26,7 @@
 #include "td/actor/PromiseFuture.h"
 #include "adnl-network-manager.h"
 
+#include <atomic>
 #include <map>
 
 namespace td {
@@ -52,11 +53,21 @@ class AdnlNetworkManagerImpl : public AdnlNetworkManager {
     }
   };
 
-  AdnlNetworkManagerImpl(td::uint16 out_udp_port) : out_udp_port_(out_udp_port) {
+  // callback of the receivers if there are several of them per port; installed callbacks are kept alive while any
+  // receiver may use them
+  struct SharedCallback {
+    std::atomic<Callback *> callback{nullptr};
+    std::vector<std::unique_ptr<Callback>> installed;
+  };
+
+  AdnlNetworkManagerImpl(td::uint16 out_udp_port, td::uint32 receivers_per_port)
+      : out_udp_port_(out_udp_port), receivers_per_port_(receivers_per_port) {
   }
 
   void install_callback(std::unique_ptr<Callback> callback) override {
-    callback_ = std::move(callback);
+    callback_ = callback.get();
+    shared_callback_->callback.store(callback_, std::memory_order_release);
+    shared_callback_->installed.push_back(std::move(callback));
   }
 
   void add_self_addr(td::IPAddress addr, td::uint32 priority) override {
@@ -89,17 +100,24 @@ class AdnlNetworkManagerImpl : public AdnlNetworkManager {
   void add_listening_udp_port(td::uint16 port);
   void receive_udp_message(td::UdpMessage message);
 
+  static bool check_udp_message(const Callback *callback, const td::UdpMessage &message,
+                                td::uint64 &received_messages);
+
  private:
-  std::unique_ptr<Callback> callback_;
+  Callback *callback_ = nullptr;
+  std::shared_ptr<SharedCallback> shared_callback_ = std::make_shared<SharedCallback>();
 
   std::map<td::uint32, std::vector<OutDesc>> out_desc_;
 
   td::uint64 received_messages_ = 0;
   td::uint64 sent_messages_ = 0;
 
-  std::map<td::uint16, td::actor::ActorOwn<td::UdpServer>> udp_servers_;
+  std::map<td::uint16, std::vector<td::actor::ActorOwn<td::UdpServer>>> udp_servers_;
 
   td::uint16 out_udp_port_;
+  td::uint32 receivers_per_port_;
+
+  td::actor::ActorId<td::UdpServer> get_udp_server(td::uint16 port, AdnlNodeIdShort dst_id);
 };
 
 }  // namespace adnl
@@ -75,6 +75,22 @@ void AdnlPeerTableImpl::receive_packet(td::IPAddress addr, td::BufferSlice data)
                    << " (len=" << (data.size() + 32) << ")";
 }
 
+void AdnlPeerTableImpl::LocalIdDecryptors::set(AdnlNodeIdShort id, std::shared_ptr<Decryptor> decryptor) {
+  auto lock = mutex_.lock_write().move_as_ok();
+  decryptors_[id] = std::move(decryptor);
+}
+
+void AdnlPeerTableImpl::LocalIdDecryptors::erase(AdnlNodeIdShort id) {
+  auto lock = mutex_.lock_write().move_as_ok();
+  decryptors_.erase(id);
+}
+
+std::shared_ptr<Decryptor> AdnlPeerTableImpl::LocalIdDecryptors::get(AdnlNodeIdShort id) {
+  auto lock = mutex_.lock_read().move_as_ok();
+  auto it = decryptors_.find(id);
+  return it == decryptors_.end() ? nullptr : it->second;
+}
+
 void AdnlPeerTableImpl::receive_decrypted_packet(AdnlNodeIdShort dst, AdnlPacket packet) {
   packet.run_basic_checks().ensure();
 
@@ -202,12 +218,28 @@ void AdnlPeerTableImpl::add_id_ex(AdnlNodeIdFull id, AdnlAddressList addr_list,
         a, std::make_pair(td::actor::create_actor<AdnlLocalId>("localid", std::move(id), std::move(addr_list), mode,
                                                                actor_id(this), keyring_, dht_node_),
                           mode));
+    td::actor::send_closure(keyring_, &keyring::Keyring::get_decryptor, a.pubkey_hash(),
+                            [SelfId = actor_id(this), a](td::Result<std::shared_ptr<Decryptor>> R) {
+                              if (R.is_error()) {
+                                VLOG(ADNL_INFO) << "adnl: no decryptor for local id " << a << ": " << R.error();
+                                return;
+                              }
+                              td::actor::send_closure(SelfId, &AdnlPeerTableImpl::got_local_id_decryptor, a,
+                                                      R.move_as_ok());
+                            });
+  }
+}
+
+void AdnlPeerTableImpl::got_local_id_decryptor(AdnlNodeIdShort id, std::shared_ptr<Decryptor> decryptor) {
+  if (local_ids_.count(id)) {
+    local_id_decryptors_->set(id, std::move(decryptor));
   }
 }
 
 void AdnlPeerTableImpl::del_id(AdnlNodeIdShort id, td::Promise<td::Unit> promise) {
   VLOG(ADNL_INFO) << "adnl: deleting local id " << id;
   local_ids_.erase(id);
+  local_id_decryptors_->erase(id);
   promise.set_value(td::Unit());
 }
 
@@ -245,14 +277,41 @@ void AdnlPeerTableImpl::register_network_manager(td::actor::ActorId<AdnlNetworkM
     void receive_packet(td::IPAddress addr, td::BufferSlice data) override {
       td::actor::send_closure(id_, &AdnlPeerTableImpl::receive_packet, addr, std::move(data));
     }
-    Cb(td::actor::ActorId<AdnlPeerTableImpl> id) : id_(id) {
+    void receive_packet_concurrent(td::IPAddress addr, td::BufferSlice data) override {
+      // packets to local ids are decrypted right here, channels and unknown destinations are left to the peer table
+      auto decryptor = data.size() >= 32 ? decryptors_->get(AdnlNodeIdShort{data.as_slice().truncate(32)}) : nullptr;
+      if (!decryptor) {
+        receive_packet(addr, std::move(data));
+        return;
+      }
+      AdnlNodeIdShort dst{data.as_slice().truncate(32)};
+      data.confirm_read(32);
+      auto R = decrypt_packet(*decryptor, data.as_slice());
+      if (R.is_error()) {
+        VLOG(ADNL_WARNING) << AdnlLocalId::PrintId{dst} << ": dropping IN message: cannot decrypt: "
+                           << R.move_as_error();
+        return;
+      }
+      auto packet = R.move_as_ok();
+      packet.set_remote_addr(addr);
+      td::actor::send_closure(id_, &AdnlPeerTableImpl::receive_decrypted_packet, dst, std::move(packet));
+    }
+    Cb(td::actor::ActorId<AdnlPeerTableImpl> id, std::shared_ptr<LocalIdDecryptors> decryptors)
+        : id_(id), decryptors_(std::move(decryptors)) {
     }
 
    private:
     td::actor::ActorId<AdnlPeerTableImpl> id_;
+    std::shared_ptr<LocalIdDecryptors> decryptors_;
+
+    static td::Result<AdnlPacket> decrypt_packet(Decryptor &decryptor, td::Slice data) {
+      TRY_RESULT(decrypted, decryptor.decrypt(data));
+      TRY_RESULT(tl_packet, fetch_tl_object<ton_api::adnl_packetContents>(std::move(decrypted), true));
+      return AdnlPacket::create(std::move(tl_packet));
+    }
   };
 
-  auto cb = std::make_unique<Cb>(actor_id(this));
+  auto cb = std::make_unique<Cb>(actor_id(this), local_id_decryptors_);
   td::actor::send_closure(network_manager_, &AdnlNetworkManager::install_callback, std::move(cb));
 }
 
@@ -32,12 +32,26 @@
 #include "adnl-ext-server.h"
 #include "adnl-address-list.h"
 
+#include "td/utils/port/RwMutex.h"
+
 namespace ton {
 
 namespace adnl {
 
 class AdnlPeerTableImpl : public AdnlPeerTable {
  public:
+  // decryptors of local ids, used to decrypt packets right on the receiving threads of the network manager
+  class LocalIdDecryptors {
+   public:
+    void set(AdnlNodeIdShort id, std::shared_ptr<Decryptor> decryptor);
+    void erase(AdnlNodeIdShort id);
+    std::shared_ptr<Decryptor> get(AdnlNodeIdShort id);
+
+   private:
+    td::RwMutex mutex_;
+    std::map<AdnlNodeIdShort, std::shared_ptr<Decryptor>> decryptors_;
+  };
+
   AdnlPeerTableImpl(std::string db_root, td::actor::ActorId<keyring::Keyring> keyring);
 
   void add_peer(AdnlNodeIdShort local_id, AdnlNodeIdFull id, AdnlAddressList addr_list) override;
@@ -66,6 +80,7 @@ class AdnlPeerTableImpl : public AdnlPeerTable {
   }
   void add_id_ex(AdnlNodeIdFull id, AdnlAddressList addr_list, td::uint32 mode) override;
   void del_id(AdnlNodeIdShort id, td::Promise<td::Unit> promise) override;
+  void got_local_id_decryptor(AdnlNodeIdShort id, std::shared_ptr<Decryptor> decryptor);
   void subscribe(AdnlNodeIdShort dst, std::string prefix, std::unique_ptr<Callback> callback) override;
   void unsubscribe(AdnlNodeIdShort dst, std::string prefix) override;
   void register_dht_node(td::actor::ActorId<dht::Dht> dht_node) override;
@@ -116,6 +131,7 @@ class AdnlPeerTableImpl : public AdnlPeerTable {
   std::map<AdnlNodeIdShort, td::actor::ActorOwn<AdnlPeer>> peers_;
   std::map<AdnlNodeIdShort, std::pair<td::actor::ActorOwn<AdnlLocalId>, td::uint32>> local_ids_;
   std::map<AdnlChannelIdShort, td::actor::ActorId<AdnlChannel>> channels_;
+  std::shared_ptr<LocalIdDecryptors> local_id_decryptors_ = std::make_shared<LocalIdDecryptors>();
 
   td::actor::ActorOwn<AdnlDb> db_;
 
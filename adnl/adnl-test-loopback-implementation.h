@@ -21,6 +21,7 @@
 #include "adnl/adnl.h"
 #include "td/utils/Random.h"
 
+#include <deque>
 #include <set>
 
 namespace ton {
@@ -48,7 +49,35 @@ class TestLoopbackNetworkManager : public ton::adnl::AdnlNetworkManager {
       return;
     }
     CHECK(callback_);
-    callback_->receive_packet(dst_addr, std::move(data));
+    if (latency_ <= 0 && bandwidth_ <= 0) {
+      callback_->receive_packet(dst_addr, std::move(data));
+      return;
+    }
+    auto now = td::Time::now();
+    auto departure = now;
+    if (bandwidth_ > 0) {
+      // packets wait in a queue of limited size for the link
+      if ((last_departure_ - now) * bandwidth_ >= max_queue_size_) {
+        return;
+      }
+      departure = std::max(now, last_departure_) + 1.0 / bandwidth_;
+      last_departure_ = departure;
+    }
+    pending_.push_back(Packet{td::Timestamp::at(departure + latency_), dst_addr, std::move(data)});
+    if (pending_.size() == 1) {
+      alarm_timestamp() = pending_.front().deliver_at;
+    }
+  }
+
+  void alarm() override {
+    while (!pending_.empty() && pending_.front().deliver_at.is_in_past()) {
+      auto packet = std::move(pending_.front());
+      pending_.pop_front();
+      callback_->receive_packet(packet.addr, std::move(packet.data));
+    }
+    if (!pending_.empty()) {
+      alarm_timestamp() = pending_.front().deliver_at;
+    }
   }
 
   void add_node_id(AdnlNodeIdShort id, bool allow_send, bool allow_receive) {
@@ -69,6 +98,19 @@ class TestLoopbackNetworkManager : public ton::adnl::AdnlNetworkManager {
     loss_probability_ = p;
   }
 
+  // one-way delay of every packet, in seconds
+  void set_latency(double latency) {
+    CHECK(latency >= 0);
+    latency_ = latency;
+  }
+
+  // emulates a link of the given rate in packets per second; packets not fitting into the queue are dropped
+  void set_bandwidth(double packets_per_second, td::uint32 max_queue_size) {
+    CHECK(packets_per_second >= 0);
+    bandwidth_ = packets_per_second;
+    max_queue_size_ = max_queue_size;
+  }
+
   TestLoopbackNetworkManager() {
   }
 
@@ -79,6 +121,18 @@ class TestLoopbackNetworkManager : public ton::adnl::AdnlNetworkManager {
   std::set<AdnlNodeIdShort> allowed_destinations_;
   std::unique_ptr<Callback> callback_;
   double loss_probability_ = 0.0;
+
+  struct Packet {
+    td::Timestamp deliver_at;
+    td::IPAddress addr;
+    td::BufferSlice data;
+  };
+  // constant latency keeps the packets ordered by delivery time
+  std::deque<Packet> pending_;
+  double latency_ = 0.0;
+  double bandwidth_ = 0.0;
+  td::uint32 max_queue_size_ = 0;
+  double last_departure_ = 0.0;
 };
 
 }  // namespace adnl
@@ -478,8 +478,12 @@ void CatChainReceiverImpl::start_up() {
   CHECK(root_block_);
 
   if (!opts_.debug_disable_db) {
+    td::RocksDbOptions db_options;
+    db_options.workload = td::RocksDbOptions::Workload::SmallWrites;
     std::shared_ptr<td::KeyValue> kv = std::make_shared<td::RocksDb>(
-        td::RocksDb::open(db_root_ + "/catchainreceiver-" + td::base64url_encode(as_slice(incarnation_))).move_as_ok());
+        td::RocksDb::open(db_root_ + "/catchainreceiver-" + td::base64url_encode(as_slice(incarnation_)),
+                          std::move(db_options))
+            .move_as_ok());
     db_ = DbType{std::move(kv)};
 
     auto P = td::PromiseCreator::lambda([SelfId = actor_id(this)](td::Result<DbType::GetResult> R) {
@@ -46,6 +46,22 @@ namespace td {
 Ed25519::PublicKey::PublicKey(SecureString octet_string) : octet_string_(std::move(octet_string)) {
 }
 
+Ed25519::PublicKey::PublicKey(PublicKey &&other) noexcept
+    : octet_string_(std::move(other.octet_string_)), imported_key_(other.imported_key_.exchange(nullptr)) {
+}
+
+Ed25519::PublicKey &Ed25519::PublicKey::operator=(PublicKey &&other) noexcept {
+  if (this != &other) {
+    octet_string_ = std::move(other.octet_string_);
+    free_imported_key(imported_key_.exchange(other.imported_key_.exchange(nullptr)));
+  }
+  return *this;
+}
+
+Ed25519::PublicKey::~PublicKey() {
+  free_imported_key(imported_key_.load(std::memory_order_relaxed));
+}
+
 SecureString Ed25519::PublicKey::as_octet_string() const {
   return octet_string_.copy();
 }
@@ -208,14 +224,32 @@ Result<SecureString> Ed25519::PrivateKey::sign(Slice data) const {
   return std::move(res);
 }
 
+void Ed25519::PublicKey::free_imported_key(void *key) {
+  EVP_PKEY_free(static_cast<EVP_PKEY *>(key));
+}
+
+void *Ed25519::PublicKey::get_imported_key() const {
+  auto pkey = imported_key_.load(std::memory_order_acquire);
+  if (pkey != nullptr) {
+    return pkey;
+  }
+  void *new_pkey = detail::X25519_key_to_PKEY(octet_string_, false);
+  if (new_pkey == nullptr) {
+    return nullptr;
+  }
+  if (!imported_key_.compare_exchange_strong(pkey, new_pkey, std::memory_order_acq_rel)) {
+    // another thread has imported the key first
+    free_imported_key(new_pkey);
+    return pkey;
+  }
+  return new_pkey;
+}
+
 Status Ed25519::PublicKey::verify_signature(Slice data, Slice signature) const {
-  auto pkey = detail::X25519_key_to_PKEY(octet_string_, false);
+  auto pkey = static_cast<EVP_PKEY *>(get_imported_key());
   if (pkey == nullptr) {
     return Status::Error("Can't import public key");
   }
-  SCOPE_EXIT {
-    EVP_PKEY_free(pkey);
-  };
 
   EVP_MD_CTX *md_ctx = EVP_MD_CTX_new();
   if (md_ctx == nullptr) {
@@ -235,6 +269,40 @@ Status Ed25519::PublicKey::verify_signature(Slice data, Slice signature) const {
   return Status::Error("Wrong signature");
 }
 
+Status Ed25519::verify_signatures_batch(Span<SignatureCheck> checks, size_t *bad_index) {
+  // one digest context is shared by the whole batch
+  EVP_MD_CTX *md_ctx = EVP_MD_CTX_new();
+  if (md_ctx == nullptr) {
+    return Status::Error("Can't create EVP_MD_CTX");
+  }
+  SCOPE_EXIT {
+    EVP_MD_CTX_free(md_ctx);
+  };
+
+  for (size_t i = 0; i < checks.size(); i++) {
+    auto &check = checks[i];
+    auto pkey = static_cast<EVP_PKEY *>(check.public_key->get_imported_key());
+    if (pkey == nullptr) {
+      if (bad_index) {
+        *bad_index = i;
+      }
+      return Status::Error("Can't import public key");
+    }
+
+    if (EVP_MD_CTX_reset(md_ctx) <= 0 || EVP_DigestVerifyInit(md_ctx, nullptr, nullptr, nullptr, pkey) <= 0) {
+      return Status::Error("Can't init DigestVerify");
+    }
+    if (EVP_DigestVerify(md_ctx, check.signature.ubegin(), check.signature.size(), check.data.ubegin(),
+                         check.data.size()) != 1) {
+      if (bad_index) {
+        *bad_index = i;
+      }
+      return Status::Error("Wrong signature");
+    }
+  }
+  return Status::OK();
+}
+
 Result<SecureString> Ed25519::compute_shared_secret(const PublicKey &public_key, const PrivateKey &private_key) {
   BigNum p = BigNum::from_hex("7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed").move_as_ok();
   auto public_y = public_key.as_octet_string();
@@ -312,6 +380,14 @@ Result<SecureString> Ed25519::compute_shared_secret(const PublicKey &public_key,
 
 #else
 
+void Ed25519::PublicKey::free_imported_key(void *key) {
+  CHECK(key == nullptr);
+}
+
+void *Ed25519::PublicKey::get_imported_key() const {
+  return nullptr;
+}
+
 Result<Ed25519::PrivateKey> Ed25519::generate_private_key() {
   crypto::Ed25519::PrivateKey private_key;
   if (!private_key.random_private_key(true)) {
@@ -371,6 +447,19 @@ Status Ed25519::PublicKey::verify_signature(Slice data, Slice signature) const {
   return Status::Error("Wrong signature");
 }
 
+Status Ed25519::verify_signatures_batch(Span<SignatureCheck> checks, size_t *bad_index) {
+  for (size_t i = 0; i < checks.size(); i++) {
+    auto status = checks[i].public_key->verify_signature(checks[i].data, checks[i].signature);
+    if (status.is_error()) {
+      if (bad_index) {
+        *bad_index = i;
+      }
+      return status;
+    }
+  }
+  return Status::OK();
+}
+
 Result<SecureString> Ed25519::compute_shared_secret(const PublicKey &public_key, const PrivateKey &private_key) {
   crypto::Ed25519::PrivateKey tmp_private_key;
   if (!tmp_private_key.import_private_key(Slice(private_key.as_octet_string()).ubegin())) {
@@ -20,8 +20,11 @@
 
 #include "td/utils/common.h"
 #include "td/utils/SharedSlice.h"
+#include "td/utils/Span.h"
 #include "td/utils/Status.h"
 
+#include <atomic>
+
 #if TD_HAVE_OPENSSL
 
 namespace td {
@@ -33,13 +36,28 @@ class Ed25519 {
     static constexpr size_t LENGTH = 32;
 
     explicit PublicKey(SecureString octet_string);
+    PublicKey(PublicKey &&other) noexcept;
+    PublicKey &operator=(PublicKey &&other) noexcept;
+    ~PublicKey();
 
     SecureString as_octet_string() const;
 
     Status verify_signature(Slice data, Slice signature) const;
 
    private:
+    friend class Ed25519;
     SecureString octet_string_;
+    // the key imported into the crypto library; created by the first verification and then shared by all threads
+    mutable std::atomic<void *> imported_key_{nullptr};
+
+    void *get_imported_key() const;
+    static void free_imported_key(void *key);
+  };
+
+  struct SignatureCheck {
+    const PublicKey *public_key;
+    Slice data;
+    Slice signature;
   };
 
   class PrivateKey {
@@ -65,6 +83,10 @@ class Ed25519 {
   static Result<PrivateKey> generate_private_key();
 
   static Result<SecureString> compute_shared_secret(const PublicKey &public_key, const PrivateKey &private_key);
+
+  // succeeds only if all signatures are valid; otherwise stops at the first wrong signature and stores its index
+  // in bad_index, if it isn't null
+  static Status verify_signatures_batch(Span<SignatureCheck> checks, size_t *bad_index = nullptr);
 };
 
 }  // namespace td
@@ -2185,6 +2185,23 @@ Ref<vm::Cell> Transaction::commit(Account& acc) {
   CHECK((const void*)&acc == (const void*)&account);
   // export all fields modified by the Transaction into original account
   // NB: this is the only method that modifies account
+  export_state(acc);
+  end_lt = 0;
+  return root;
+}
+
+// applies the transaction to a copy of the original account, leaving both the account and the transaction unchanged
+// (used by speculative execution, where the transaction may be accounted for in the block only later)
+bool Transaction::commit_copy(Account& acc) const {
+  if (root.is_null() || new_total_state.is_null() || !end_lt || (const void*)&acc == (const void*)&account ||
+      acc.addr != account.addr || acc.last_trans_end_lt_ != account.last_trans_end_lt_) {
+    return false;
+  }
+  export_state(acc);
+  return true;
+}
+
+void Transaction::export_state(Account& acc) const {
   if (orig_addr_rewrite_set && new_split_depth >= 0 && acc.status == Account::acc_nonexist &&
       acc_status == Account::acc_active) {
     LOG(DEBUG) << "setting address rewriting info for newly-activated account " << acc.addr.to_hex()
@@ -2198,27 +2215,25 @@ Ref<vm::Cell> Transaction::commit(Account& acc) {
   acc.last_trans_hash_ = root->get_hash().bits();
   acc.last_paid = last_paid;
   acc.storage_stat = new_storage_stat;
-  acc.balance = std::move(balance);
-  acc.due_payment = std::move(due_payment);
-  acc.total_state = std::move(new_total_state);
-  acc.inner_state = std::move(new_inner_state);
+  acc.balance = balance;
+  acc.due_payment = due_payment;
+  acc.total_state = new_total_state;
+  acc.inner_state = new_inner_state;
   if (was_frozen) {
     acc.state_hash = frozen_hash;
   }
-  acc.my_addr = std::move(my_addr);
-  // acc.my_addr_exact = std::move(my_addr_exact);
-  acc.code = std::move(new_code);
-  acc.data = std::move(new_data);
-  acc.library = std::move(new_library);
+  acc.my_addr = my_addr;
+  // acc.my_addr_exact = my_addr_exact;
+  acc.code = new_code;
+  acc.data = new_data;
+  acc.library = new_library;
   if (acc.status == Account::acc_active) {
     acc.tick = new_tick;
     acc.tock = new_tock;
   } else {
     acc.tick = acc.tock = false;
   }
-  end_lt = 0;
   acc.push_transaction(root, start_lt);
-  return root;
 }
 
 LtCellRef Transaction::extract_out_msg(unsigned i) {
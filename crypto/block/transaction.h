@@ -364,6 +364,7 @@ struct Transaction {
   bool update_limits(block::BlockLimitStatus& blk_lim_st) const;
 
   Ref<vm::Cell> commit(Account& _account);  // _account should point to the same account
+  bool commit_copy(Account& _copy) const;    // _copy should be a copy of the account, the transaction is kept intact
   LtCellRef extract_out_msg(unsigned i);
   NewOutMsg extract_out_msg_ext(unsigned i);
   void extract_out_msgs(std::vector<LtCellRef>& list);
@@ -384,6 +385,7 @@ struct Transaction {
   bool serialize_action_phase(vm::CellBuilder& cb);
   bool serialize_bounce_phase(vm::CellBuilder& cb);
   bool unpack_msg_state(bool lib_only = false);
+  void export_state(Account& acc) const;
 };
 
 }  // namespace block
@@ -17,6 +17,7 @@
     Copyright 2017-2019 Telegram Systems LLP
 */
 #include "crypto/Ed25519.h"
+#include "td/utils/benchmark.h"
 #include "td/utils/logging.h"
 #include "td/utils/misc.h"
 #include "td/utils/Slice.h"
@@ -27,6 +28,7 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 unsigned char fixed_privkey[32] = "abacabadabacabaeabacabadabacaba";
 unsigned char fixed_pubkey[32] = {0x6f, 0x9e, 0x5b, 0xde, 0xce, 0x87, 0x21, 0xeb, 0x57, 0x37, 0xfb,
@@ -217,3 +219,79 @@ TEST(Crypto, almost_zero) {
     }
   }
 }
+
+struct Ed25519SignedSet {
+  std::vector<td::Ed25519::PublicKey> public_keys;
+  std::vector<td::SecureString> signatures;
+  std::string message;
+
+  explicit Ed25519SignedSet(int n) : message("block id to sign") {
+    for (int i = 0; i < n; i++) {
+      auto pk = td::Ed25519::generate_private_key().move_as_ok();
+      public_keys.push_back(pk.get_public_key().move_as_ok());
+      signatures.push_back(pk.sign(message).move_as_ok());
+    }
+  }
+  std::vector<td::Ed25519::SignatureCheck> get_checks() const {
+    std::vector<td::Ed25519::SignatureCheck> checks;
+    for (size_t i = 0; i < public_keys.size(); i++) {
+      checks.push_back(td::Ed25519::SignatureCheck{&public_keys[i], message, signatures[i]});
+    }
+    return checks;
+  }
+};
+
+TEST(Crypto, ed25519_batch) {
+  Ed25519SignedSet set(20);
+  auto checks = set.get_checks();
+  td::Ed25519::verify_signatures_batch(checks).ensure();
+  td::Ed25519::verify_signatures_batch({}).ensure();
+
+  for (size_t i = 0; i < checks.size(); i++) {
+    auto bad_signature = set.signatures[i].copy();
+    bad_signature.as_mutable_slice()[5] ^= 1;
+    auto bad_checks = checks;
+    bad_checks[i].signature = bad_signature;
+    size_t bad_index = checks.size();
+    CHECK(td::Ed25519::verify_signatures_batch(bad_checks, &bad_index).is_error());
+    CHECK(bad_index == i);
+    bad_checks[i].signature = checks[(i + 1) % checks.size()].signature;
+    bad_index = checks.size();
+    CHECK(td::Ed25519::verify_signatures_batch(bad_checks, &bad_index).is_error());
+    CHECK(bad_index == i);
+  }
+}
+
+class BenchEd25519Verify : public td::Benchmark {
+ public:
+  BenchEd25519Verify(int validators, bool batch) : set_(validators), batch_(batch) {
+  }
+  std::string get_description() const override {
+    return PSTRING() << "ed25519 verify " << set_.public_keys.size() << " signatures" << (batch_ ? " (batch)" : "");
+  }
+
+  void run(int n) override {
+    auto checks = set_.get_checks();
+    for (int i = 0; i < n; i++) {
+      if (batch_) {
+        td::Ed25519::verify_signatures_batch(checks).ensure();
+      } else {
+        for (auto &check : checks) {
+          td::Ed25519::PublicKey(check.public_key->as_octet_string())
+              .verify_signature(check.data, check.signature)
+              .ensure();
+        }
+      }
+    }
+  }
+
+ private:
+  Ed25519SignedSet set_;
+  bool batch_;
+};
+
+TEST(Crypto, ed25519_batch_benchmark) {
+  // multiply by the number of signatures to get verifications per second
+  td::bench(BenchEd25519Verify(400, false));
+  td::bench(BenchEd25519Verify(400, true));
+}
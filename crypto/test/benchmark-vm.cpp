@@ -0,0 +1,199 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#include "vm/vm.h"
+#include "vm/cp0.h"
+#include "vm/dict.h"
+#include "fift/utils.h"
+
+#include "smc-envelope/MultisigWallet.h"
+#include "smc-envelope/WalletV3.h"
+
+#include "td/utils/benchmark.h"
+#include "td/utils/misc.h"
+#include "td/utils/Random.h"
+
+#include <algorithm>
+
+// arithmetic, stack and control flow instructions in a loop; one op is one loop iteration
+class BenchVmLoop : public td::Benchmark {
+ public:
+  BenchVmLoop() {
+    code_ = fift::compile_asm(R"ABCD(
+0 INT SWAP
+REPEAT:<{
+  INC DUP 3 MULCONST 5 ADDCONST
+  DUP 1 RSHIFT# XOR 255 INT AND
+  OVER ADD 2DUP LESS IF:<{ SWAP }> DROP
+}>
+)ABCD")
+                .move_as_ok();
+    steps_per_iteration_ = run_loop(1000) / 1000;
+  }
+  std::string get_description() const override {
+    return PSTRING() << "TVM loop (" << steps_per_iteration_ << " steps per op)";
+  }
+  void run(int n) override {
+    td::do_not_optimize_away(run_loop(n));
+  }
+
+ private:
+  td::Ref<vm::Cell> code_;
+  long long steps_per_iteration_{0};
+
+  long long run_loop(int n) {
+    vm::Stack stack;
+    stack.push_smallint(n);
+    long long steps = 0;
+    int res = vm::run_vm_code(vm::load_cell_slice_ref(code_), stack, 0, nullptr, {}, &steps);
+    CHECK(res == 0);
+    return steps;
+  }
+};
+
+// "seqno" and "get_public_key", the most frequent get-method calls served by liteservers
+class BenchWalletGetMethods : public td::Benchmark {
+ public:
+  BenchWalletGetMethods()
+      : wallet_(td::Ed25519::generate_private_key().move_as_ok().get_public_key().move_as_ok(), 239) {
+  }
+  std::string get_description() const override {
+    return "wallet v3 get-methods";
+  }
+  void run(int n) override {
+    for (int i = 0; i < n; i++) {
+      auto res = wallet_.run_get_method(i % 2 ? td::Slice("seqno") : td::Slice("get_public_key"));
+      CHECK(res.success);
+    }
+  }
+
+ private:
+  ton::WalletV3 wallet_;
+};
+
+// dictionary-heavy contract compiled from FunC
+class BenchMultisigGetMethods : public td::Benchmark {
+ public:
+  BenchMultisigGetMethods() {
+    std::vector<td::SecureString> public_keys;
+    for (int i = 0; i < 10; i++) {
+      public_keys.push_back(
+          td::Ed25519::generate_private_key().move_as_ok().get_public_key().move_as_ok().as_octet_string());
+    }
+    auto ms_lib = ton::MultisigWallet::create();
+    wallet_ = ton::MultisigWallet::create(ms_lib->create_init_data(239, std::move(public_keys), 7));
+  }
+  std::string get_description() const override {
+    return "multisig get-methods";
+  }
+  void run(int n) override {
+    for (int i = 0; i < n; i++) {
+      if (i % 2) {
+        CHECK(wallet_->get_public_keys().size() == 10);
+      } else {
+        CHECK(wallet_->get_n_k() == std::make_pair(10, 7));
+      }
+    }
+  }
+
+ private:
+  td::Ref<ton::MultisigWallet> wallet_;
+};
+
+// filling a dictionary of 32-byte keys with repeated set() or at once from sorted entries
+class BenchDictBuild : public td::Benchmark {
+ public:
+  BenchDictBuild(int keys, bool sorted) : sorted_(sorted) {
+    keys_.resize(keys);
+    for (auto& key : keys_) {
+      td::Random::secure_bytes(key.as_slice());
+    }
+    std::sort(keys_.begin(), keys_.end());
+    auto value = vm::load_cell_slice_ref(vm::CellBuilder().store_long(239, 64).finalize());
+    for (auto& key : keys_) {
+      entries_.emplace_back(key.cbits(), value);
+    }
+  }
+  std::string get_description() const override {
+    return PSTRING() << "dictionary of " << keys_.size() << " keys, " << (sorted_ ? "build_sorted" : "set");
+  }
+  void run(int n) override {
+    for (int i = 0; i < n; i++) {
+      vm::Dictionary dict{256};
+      if (sorted_) {
+        CHECK(dict.build_sorted(entries_));
+      } else {
+        for (auto& entry : entries_) {
+          CHECK(dict.set(entry.first, 256, entry.second));
+        }
+      }
+      td::do_not_optimize_away(dict.get_root_cell()->get_hash().as_slice()[0]);
+    }
+  }
+
+ private:
+  bool sorted_;
+  std::vector<td::Bits256> keys_;
+  std::vector<vm::DictionaryFixed::entry_t> entries_;
+};
+
+// creating short-lived cells referencing recently created ones and passing references around, as the VM does
+class BenchCellChurn : public td::Benchmark {
+ public:
+  std::string get_description() const override {
+    return "cell churn";
+  }
+  void run(int n) override {
+    std::vector<td::Ref<vm::Cell>> recent(64);
+    for (int i = 0; i < n; i++) {
+      vm::CellBuilder cb;
+      cb.store_long(i, 32);
+      for (int j = 0; j < i % 8; j++) {
+        cb.store_long(i * 239 + j, 64);
+      }
+      for (int j = 1; j <= i % 4; j++) {
+        auto& ref = recent[(i + j * 7) % recent.size()];
+        if (ref.not_null()) {
+          cb.store_ref(ref);
+        }
+      }
+      auto cell = cb.finalize();
+      for (int j = 0; j < 8; j++) {
+        td::Ref<vm::Cell> copy = cell;
+        td::do_not_optimize_away(copy.get());
+      }
+      recent[i % recent.size()] = std::move(cell);
+    }
+  }
+};
+
+int main() {
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
+  vm::init_op_cp0();
+  vm::DictionaryBase::get_empty_dictionary();
+
+  td::bench(BenchVmLoop());
+  td::bench(BenchWalletGetMethods());
+  td::bench(BenchMultisigGetMethods());
+  td::bench(BenchCellChurn());
+  for (int keys : {100000, 1000000}) {
+    td::bench(BenchDictBuild(keys, false));
+    td::bench(BenchDictBuild(keys, true));
+  }
+  return 0;
+}
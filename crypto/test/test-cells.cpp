@@ -33,10 +33,12 @@
 #include "common/util.h"
 #include "vm/cells.h"
 #include "vm/cellslice.h"
+#include "vm/cells/CellAllocator.h"
 
 #include "td/utils/tests.h"
 #include "td/utils/crypto.h"
 #include "td/utils/misc.h"
+#include "td/utils/port/thread.h"
 
 static std::stringstream create_ss() {
   std::stringstream ss;
@@ -114,6 +116,57 @@ TEST(Cells, simple) {
   REGRESSION_VERIFY(os.str());
 }
 
+std::vector<td::Ref<vm::Cell>> create_test_cells(int n) {
+  std::vector<td::Ref<vm::Cell>> cells;
+  for (int i = 0; i < n; i++) {
+    vm::CellBuilder cb;
+    unsigned bits = (i * 239) % 1024;
+    for (unsigned j = 0; j < bits; j += 64) {
+      cb.store_long(i * 17 + j, std::min(bits - j, 64u));
+    }
+    for (int j = 0; j < i % 5 && j < (int)cells.size(); j++) {
+      cb.store_ref(cells[cells.size() - 1 - j]);
+    }
+    cells.push_back(cb.finalize());
+  }
+  return cells;
+}
+
+TEST(Cells, allocator) {
+  const int n = 10000;
+  auto total_cells = vm::DataCell::get_total_data_cells();
+  auto expected = create_test_cells(n);
+  std::vector<std::vector<td::Ref<vm::Cell>>> created(4);
+  {
+    // cells of all sizes are created by some threads and destroyed by the others
+    std::vector<td::thread> threads;
+    for (auto& cells : created) {
+      threads.emplace_back([&cells] { cells = create_test_cells(n); });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    threads.clear();
+    for (auto& cells : created) {
+      for (int i = 0; i < n; i++) {
+        ASSERT_EQ(expected[i]->get_hash(), cells[i]->get_hash());
+      }
+      threads.emplace_back([&cells] { cells.clear(); });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  // caches of finished threads are moved to the depot
+  ASSERT_TRUE(vm::CellAllocator::get_depot_size() > 0);
+  auto reused = create_test_cells(n);
+  ASSERT_EQ(expected.back()->get_hash(), reused.back()->get_hash());
+
+  expected.clear();
+  reused.clear();
+  ASSERT_EQ(total_cells, vm::DataCell::get_total_data_cells());
+}
+
 void test_two_bitstrings(const td::BitSlice& bs1, const td::BitSlice& bs2) {
   using td::to_binary;
   using td::to_hex;
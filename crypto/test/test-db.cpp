@@ -762,6 +762,66 @@ TEST(TonDb, BocMultipleRoots) {
   }
 };
 
+TEST(TonDb, BocParallel) {
+  td::Random::Xorshift128plus rnd{123};
+  for (int t = 0; t < 50; t++) {
+    auto cells = gen_random_cells(rnd.fast(1, 10), rnd.fast(1000, 20000), rnd);
+    auto mode = get_random_serialization_mode(rnd);
+    auto serialized = serialize_boc(cells, mode);
+    for (int threads = 2; threads <= 4; threads++) {
+      vm::BagOfCells boc;
+      boc.deserialize(serialized, BagOfCells::default_max_roots, threads).ensure();
+      ASSERT_EQ(cells.size(), static_cast<size_t>(boc.get_root_count()));
+      for (size_t i = 0; i < cells.size(); i++) {
+        ASSERT_EQ(cells[i]->get_hash(), boc.get_root_cell(static_cast<int>(i))->get_hash());
+      }
+    }
+    // a runner may run the work on fewer threads than asked, down to the calling thread only
+    vm::BagOfCells boc_runner;
+    boc_runner
+        .deserialize(serialized, BagOfCells::default_max_roots, 4,
+                     [](int threads, const std::function<void()> &f) { f(); })
+        .ensure();
+    for (size_t i = 0; i < cells.size(); i++) {
+      ASSERT_EQ(cells[i]->get_hash(), boc_runner.get_root_cell(static_cast<int>(i))->get_hash());
+    }
+    // corrupted data must give the same result on both paths
+    auto broken = serialized;
+    broken[rnd.fast(0, static_cast<int>(broken.size()) - 1)] ^= static_cast<char>(rnd.fast(1, 255));
+    vm::BagOfCells boc, boc_parallel;
+    auto r_boc = boc.deserialize(broken, BagOfCells::default_max_roots, 1);
+    auto r_boc_parallel = boc_parallel.deserialize(broken, BagOfCells::default_max_roots, 4);
+    ASSERT_EQ(r_boc.is_error(), r_boc_parallel.is_error());
+    if (r_boc.is_ok()) {
+      ASSERT_EQ(boc.get_root_count(), boc_parallel.get_root_count());
+      for (int i = 0; i < boc.get_root_count(); i++) {
+        ASSERT_EQ(boc.get_root_cell(i)->get_hash(), boc_parallel.get_root_cell(i)->get_hash());
+      }
+    }
+  }
+}
+
+TEST(TonDb, BocSerializeToFile) {
+  td::Random::Xorshift128plus rnd{123};
+  std::string path = "boc-serialize-to-file";
+  for (int t = 0; t < 50; t++) {
+    auto cells = gen_random_cells(rnd.fast(1, 10), rnd.fast(1, 5000), rnd);
+    vm::BagOfCells boc;
+    for (auto &cell : cells) {
+      boc.add_root(cell);
+    }
+    boc.import_cells().ensure();
+    auto mode = get_random_serialization_mode(rnd);
+    auto expected = boc.serialize_to_string(mode);
+    td::unlink(path).ignore();
+    auto fd = td::FileFd::open(path, td::FileFd::Write | td::FileFd::Create | td::FileFd::Truncate).move_as_ok();
+    boc.serialize_to_file(fd, mode, rnd.fast(1, 1 << 14)).ensure();
+    fd.close();
+    ASSERT_EQ(expected, td::read_file_str(path).move_as_ok());
+  }
+  td::unlink(path).ignore();
+}
+
 TEST(TonDb, DynamicBoc) {
   td::Random::Xorshift128plus rnd{123};
   std::string old_root_hash;
@@ -804,6 +864,254 @@ TEST(TonDb, DynamicBoc) {
   ASSERT_EQ(0u, kv->count("").ok());
 };
 
+TEST(TonDb, DataCellCache) {
+  td::Random::Xorshift128plus rnd{123};
+  auto kv = std::make_shared<td::MemoryKeyValue>();
+  auto cell = gen_random_cell(1000, rnd);
+  auto serialization = serialize_boc(cell);
+  {
+    auto dboc = DynamicBagOfCellsDb::create();
+    dboc->set_loader(std::make_unique<CellLoader>(kv));
+    dboc->inc(cell);
+    dboc->prepare_commit();
+    CellStorer cell_storer(*kv);
+    dboc->commit(cell_storer);
+  }
+
+  auto load_all = [&](std::shared_ptr<vm::DataCellCache> cache) {
+    auto dboc = DynamicBagOfCellsDb::create();
+    dboc->set_loader(std::make_unique<CellLoader>(kv, cache));
+    auto root = dboc->load_cell(cell->get_hash().as_slice()).move_as_ok();
+    ASSERT_EQ(serialization, serialize_boc(root));
+  };
+
+  auto cache = std::make_shared<vm::DataCellCache>(1 << 20);
+  load_all(cache);
+  auto stats = cache->get_stats();
+  ASSERT_TRUE(stats.size > 0);
+  ASSERT_EQ(stats.size, stats.misses);
+  ASSERT_EQ(0u, stats.evictions);
+  // the second reader with a fresh snapshot gets all cells from the cache
+  load_all(cache);
+  auto stats2 = cache->get_stats();
+  ASSERT_EQ(stats.misses, stats2.misses);
+  ASSERT_EQ(stats.size, stats2.size);
+  ASSERT_TRUE(stats2.hits > stats.hits);
+
+  ASSERT_TRUE(stats.bytes > 0);
+  ASSERT_TRUE(stats.bytes <= (1 << 20));
+
+  auto small_cache = std::make_shared<vm::DataCellCache>(stats.bytes / 4, 4);
+  load_all(small_cache);
+  load_all(small_cache);
+  auto small_stats = small_cache->get_stats();
+  ASSERT_TRUE(small_stats.bytes <= stats.bytes / 4);
+  ASSERT_TRUE(small_stats.size < stats.size);
+  ASSERT_TRUE(small_stats.evictions > 0);
+  ASSERT_EQ(small_stats.misses, small_stats.size + small_stats.evictions);
+}
+
+TEST(TonDb, DataCellCacheSnapshot) {
+  td::Random::Xorshift128plus rnd{123};
+  auto cell = gen_random_cell(1000, rnd);
+  auto serialization = serialize_boc(cell);
+  auto kv = std::make_shared<td::MemoryKeyValue>();
+  auto dboc = DynamicBagOfCellsDb::create();
+  dboc->set_loader(std::make_unique<CellLoader>(kv));
+  dboc->inc(cell);
+  dboc->prepare_commit();
+  {
+    CellStorer cell_storer(*kv);
+    dboc->commit(cell_storer);
+  }
+
+  auto cache = std::make_shared<vm::DataCellCache>(1 << 20);
+  dboc->set_loader(std::make_unique<CellLoader>(kv->snapshot(), cache)).ensure();
+  auto old_reader = dboc->get_cell_db_reader();
+  // only the root and its references get into the cache before the state is garbage collected
+  auto root = old_reader->load_cell(cell->get_hash().as_slice()).move_as_ok();
+  for (unsigned i = 0; i < root->size_refs(); i++) {
+    CellSlice cs(NoVm(), root->get_ref(i));
+  }
+  root.clear();
+
+  dboc->dec(cell);
+  dboc->prepare_commit();
+  {
+    CellStorer cell_storer(*kv);
+    dboc->commit(cell_storer);
+  }
+  ASSERT_EQ(0u, kv->count("").ok());
+  dboc->set_loader(std::make_unique<CellLoader>(kv->snapshot(), cache)).ensure();
+
+  // the cached cells load their references through the old snapshot, not through the latest one
+  auto misses = cache->get_stats().misses;
+  root = old_reader->load_cell(cell->get_hash().as_slice()).move_as_ok();
+  ASSERT_EQ(serialization, serialize_boc(root));
+  auto stats = cache->get_stats();
+  ASSERT_TRUE(stats.hits > 0);
+  ASSERT_TRUE(stats.misses > misses);
+}
+
+TEST(TonDb, CellDbReader) {
+  td::Random::Xorshift128plus rnd{123};
+  auto kv = std::make_shared<td::MemoryKeyValue>();
+  auto dboc = DynamicBagOfCellsDb::create();
+  dboc->set_loader(std::make_unique<CellLoader>(kv));
+  auto cell = gen_random_cell(1000, rnd);
+  auto serialization = serialize_boc(cell);
+  dboc->inc(cell);
+  dboc->prepare_commit();
+  {
+    CellStorer cell_storer(*kv);
+    dboc->commit(cell_storer);
+  }
+  dboc->set_loader(std::make_unique<CellLoader>(kv, std::make_shared<vm::DataCellCache>(1 << 10))).ensure();
+  auto reader = dboc->get_cell_db_reader();
+  ASSERT_TRUE(reader != nullptr);
+  // the reader is independent of the bag of cells it was taken from
+  dboc->set_loader(std::make_unique<CellLoader>(kv)).ensure();
+  dboc.reset();
+
+  std::vector<td::thread> threads;
+  std::atomic<int> ok{0};
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 10; j++) {
+        auto root = reader->load_cell(cell->get_hash().as_slice()).move_as_ok();
+        if (serialize_boc(root) == serialization) {
+          ok++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(40, ok.load());
+  ASSERT_TRUE(reader->load_cell(td::Slice(std::string(32, '\0'))).is_error());
+}
+
+TEST(TonDb, CellDbReaderAfterGc) {
+  td::Random::Xorshift128plus rnd{123};
+  auto kv = std::make_shared<td::MemoryKeyValue>();
+  auto dboc = DynamicBagOfCellsDb::create();
+  dboc->set_loader(std::make_unique<CellLoader>(kv));
+  auto old_cell = gen_random_cell(1000, rnd);
+  auto old_serialization = serialize_boc(old_cell);
+  dboc->inc(old_cell);
+  dboc->prepare_commit();
+  {
+    CellStorer cell_storer(*kv);
+    dboc->commit(cell_storer);
+  }
+
+  auto cache = std::make_shared<vm::DataCellCache>(1 << 20);
+  dboc->set_loader(std::make_unique<CellLoader>(kv->snapshot(), cache)).ensure();
+  auto old_reader = dboc->get_cell_db_reader();
+
+  // the old state is garbage collected completely
+  auto new_cell = gen_random_cell(1000, rnd);
+  auto new_serialization = serialize_boc(new_cell);
+  dboc->dec(old_cell);
+  dboc->inc(new_cell);
+  dboc->prepare_commit();
+  {
+    CellStorer cell_storer(*kv);
+    dboc->commit(cell_storer);
+  }
+  dboc->set_loader(std::make_unique<CellLoader>(kv->snapshot(), cache)).ensure();
+  auto new_reader = dboc->get_cell_db_reader();
+  ASSERT_TRUE(new_reader->load_cell(old_cell->get_hash().as_slice()).is_error());
+
+  // the reader taken before the commit still sees the whole old state, also when the new state is read at once
+  std::vector<td::thread> threads;
+  std::atomic<int> ok{0};
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&, i] {
+      auto &reader = i % 2 == 0 ? old_reader : new_reader;
+      auto &cell = i % 2 == 0 ? old_cell : new_cell;
+      auto &serialization = i % 2 == 0 ? old_serialization : new_serialization;
+      for (int j = 0; j < 10; j++) {
+        auto root = reader->load_cell(cell->get_hash().as_slice()).move_as_ok();
+        if (serialize_boc(root) == serialization) {
+          ok++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(40, ok.load());
+}
+
+TEST(TonDb, CellDbReaderPrefetch) {
+  class CountingReader : public td::KeyValueReader {
+   public:
+    explicit CountingReader(std::shared_ptr<td::KeyValueReader> reader) : reader_(std::move(reader)) {
+    }
+    td::Result<GetStatus> get(td::Slice key, std::string &value) override {
+      gets++;
+      return reader_->get(key, value);
+    }
+    td::Result<std::vector<GetStatus>> get_multi(td::Span<td::Slice> keys, std::vector<std::string> &values) override {
+      batches++;
+      return reader_->get_multi(keys, values);
+    }
+    td::Result<size_t> count(td::Slice prefix) override {
+      return reader_->count(prefix);
+    }
+    std::atomic<int> gets{0};
+    std::atomic<int> batches{0};
+
+   private:
+    std::shared_ptr<td::KeyValueReader> reader_;
+  };
+
+  td::Random::Xorshift128plus rnd{123};
+  auto kv = std::make_shared<td::MemoryKeyValue>();
+  auto cell = gen_random_cell(1000, rnd);
+  auto serialization = serialize_boc(cell);
+  auto dboc = DynamicBagOfCellsDb::create();
+  dboc->set_loader(std::make_unique<CellLoader>(kv));
+  dboc->inc(cell);
+  dboc->prepare_commit();
+  {
+    CellStorer cell_storer(*kv);
+    dboc->commit(cell_storer);
+  }
+
+  auto load_all = [&](size_t prefetch_cells, bool explicit_prefetch) {
+    auto counting_reader = std::make_shared<CountingReader>(kv);
+    auto cache = std::make_shared<vm::DataCellCache>(1 << 20);
+    dboc->set_loader(std::make_unique<CellLoader>(counting_reader, cache, prefetch_cells)).ensure();
+    auto reader = dboc->get_cell_db_reader();
+    if (explicit_prefetch) {
+      reader->prefetch(cell->get_hash().as_slice(), 1 << 20).ensure();
+    }
+    auto root = reader->load_cell(cell->get_hash().as_slice()).move_as_ok();
+    ASSERT_EQ(serialization, serialize_boc(root));
+    return std::make_pair(counting_reader->gets.load(), counting_reader->batches.load());
+  };
+
+  auto single = load_all(0, false);
+  ASSERT_TRUE(single.first > 0);
+  ASSERT_EQ(0, single.second);
+  // one batch per level of the tree instead of one lookup per cell
+  auto prefetched = load_all(0, true);
+  ASSERT_EQ(0, prefetched.first);
+  ASSERT_TRUE(prefetched.second > 0);
+  ASSERT_TRUE(prefetched.second < single.first);
+  auto on_miss = load_all(1 << 20, false);
+  ASSERT_EQ(0, on_miss.first);
+  ASSERT_EQ(prefetched.second, on_miss.second);
+  // with a small prefetch limit the rest of the tree is prefetched on later misses
+  auto limited = load_all(16, false);
+  ASSERT_EQ(0, limited.first);
+  ASSERT_TRUE(limited.second > on_miss.second);
+}
+
 TEST(TonDb, DynamicBoc2) {
   int VERBOSITY_NAME(boc) = VERBOSITY_NAME(DEBUG) + 10;
   td::Random::Xorshift128plus rnd{123};
@@ -893,6 +1201,265 @@ TEST(TonDb, DynamicBoc2) {
   ASSERT_EQ(0u, kv->count("").ok());
 }
 
+struct TestCellHashInfo {
+  std::string hash;
+  int value{0};
+  td::Slice key() const {
+    return hash;
+  }
+  bool operator<(const TestCellHashInfo &other) const {
+    return hash < other.hash;
+  }
+  friend bool operator<(const TestCellHashInfo &info, td::Slice hash) {
+    return info.hash < hash;
+  }
+  friend bool operator<(td::Slice hash, const TestCellHashInfo &info) {
+    return hash < info.hash;
+  }
+};
+
+// previous std::set-based implementation of CellHashTable, kept as a baseline for benchmarks
+template <class InfoT>
+class CellHashSet {
+ public:
+  template <class F>
+  InfoT &apply(td::Slice hash, F &&f) {
+    auto it = set_.find(hash);
+    if (it != set_.end()) {
+      auto &res = const_cast<InfoT &>(*it);
+      f(res);
+      return res;
+    }
+    InfoT info;
+    f(info);
+    auto &res = const_cast<InfoT &>(*(set_.insert(std::move(info)).first));
+    return res;
+  }
+  void erase(td::Slice hash) {
+    auto it = set_.find(hash);
+    CHECK(it != set_.end());
+    set_.erase(it);
+  }
+  size_t size() const {
+    return set_.size();
+  }
+
+ private:
+  std::set<InfoT, std::less<>> set_;
+};
+
+TEST(TonDb, CellHashTable) {
+  td::Random::Xorshift128plus rnd{123};
+  CellHashTable<TestCellHashInfo> table;
+  std::map<std::string, int> baseline;
+  std::vector<TestCellHashInfo *> infos;
+  std::vector<std::string> keys;
+  for (int i = 0; i < 2000; i++) {
+    keys.push_back(td::rand_string('a', 'z', rnd.fast(1, 40)));
+  }
+  for (int t = 0; t < 100000; t++) {
+    auto &key = keys[rnd.fast(0, static_cast<int>(keys.size()) - 1)];
+    if (rnd.fast(0, 2) == 0) {
+      auto it = baseline.find(key);
+      if (it != baseline.end()) {
+        table.erase(key);
+        baseline.erase(it);
+      }
+    } else {
+      auto &info = table.apply(key, [&](TestCellHashInfo &info) {
+        if (info.hash.empty()) {
+          info.hash = key;
+        }
+        info.value++;
+      });
+      ASSERT_EQ(key, info.hash);
+      ASSERT_EQ(++baseline[key], info.value);
+      infos.push_back(&info);
+    }
+    ASSERT_EQ(baseline.size(), table.size());
+    if (t % 1000 == 0) {
+      // references must survive rehashing
+      for (auto *info : infos) {
+        auto it = baseline.find(info->hash);
+        if (it != baseline.end()) {
+          ASSERT_EQ(it->second, info->value);
+        }
+      }
+      infos.clear();
+
+      size_t cnt = 0;
+      table.for_each([&](const TestCellHashInfo &info) {
+        ASSERT_EQ(baseline[info.hash], info.value);
+        cnt++;
+      });
+      ASSERT_EQ(baseline.size(), cnt);
+    }
+  }
+  table.filter([](const TestCellHashInfo &info) { return info.value % 2 == 0; });
+  for (auto it = baseline.begin(); it != baseline.end();) {
+    if (it->second % 2 == 0) {
+      ASSERT_EQ(it->second, table.apply(it->first, [](auto &) {}).value);
+      it++;
+    } else {
+      it = baseline.erase(it);
+    }
+  }
+  ASSERT_EQ(baseline.size(), table.size());
+}
+
+template <class TableT>
+class BenchCellHashTable : public td::Benchmark {
+ public:
+  explicit BenchCellHashTable(std::string name) : name_(std::move(name)) {
+  }
+  std::string get_description() const override {
+    return PSTRING() << "CellHashTable " << name_ << " apply+erase";
+  }
+
+  void start_up_n(int n) override {
+    td::Random::Xorshift128plus rnd{123};
+    keys_.resize(n);
+    for (auto &key : keys_) {
+      key.resize(32);
+      for (auto &c : key) {
+        c = static_cast<char>(rnd());
+      }
+    }
+  }
+
+  void run(int n) override {
+    TableT table;
+    int res = 0;
+    // every key is inserted, looked up once more and erased, as during DynamicBagOfCellsDb commit
+    for (int i = 0; i < n; i++) {
+      table.apply(keys_[i], [&](TestCellHashInfo &info) {
+        if (info.hash.empty()) {
+          info.hash = keys_[i];
+        }
+      });
+    }
+    for (int i = 0; i < n; i++) {
+      res += table.apply(keys_[i], [](TestCellHashInfo &info) { info.value++; }).value;
+    }
+    for (int i = 0; i < n; i++) {
+      table.erase(keys_[i]);
+    }
+    td::do_not_optimize_away(res);
+  }
+
+  void tear_down() override {
+    keys_.clear();
+  }
+
+ private:
+  std::string name_;
+  std::vector<std::string> keys_;
+};
+
+TEST(TonDb, BenchCellHashTable) {
+  td::bench(BenchCellHashTable<CellHashSet<TestCellHashInfo>>("std::set"));
+  td::bench(BenchCellHashTable<CellHashTable<TestCellHashInfo>>("open addressing"));
+}
+
+class BenchDynamicBocCommit : public td::Benchmark {
+ public:
+  std::string get_description() const override {
+    return "DynamicBagOfCellsDb commit (cells)";
+  }
+
+  void start_up_n(int n) override {
+    // balanced binary tree of n distinct ordinary cells
+    std::vector<Ref<Cell>> cells(n);
+    for (int i = n - 1; i >= 0; i--) {
+      CellBuilder cb;
+      cb.store_long(i, 64);
+      for (int j = 2 * i + 1; j <= 2 * i + 2 && j < n; j++) {
+        cb.store_ref(std::move(cells[j]));
+      }
+      cells[i] = cb.finalize();
+    }
+    root_ = std::move(cells[0]);
+  }
+
+  void run(int n) override {
+    auto kv = std::make_shared<td::MemoryKeyValue>();
+    auto dboc = DynamicBagOfCellsDb::create();
+    dboc->set_loader(std::make_unique<CellLoader>(kv));
+    dboc->inc(root_);
+    dboc->prepare_commit();
+    {
+      CellStorer cell_storer(*kv);
+      dboc->commit(cell_storer);
+    }
+    dboc->set_loader(std::make_unique<CellLoader>(kv));
+    dboc->dec(dboc->load_cell(root_->get_hash().as_slice()).move_as_ok());
+    dboc->prepare_commit();
+    {
+      CellStorer cell_storer(*kv);
+      dboc->commit(cell_storer);
+    }
+    CHECK(kv->count("").ok() == 0);
+  }
+
+  void tear_down() override {
+    root_ = {};
+  }
+
+ private:
+  Ref<Cell> root_;
+};
+
+TEST(TonDb, BenchDynamicBocCommit) {
+  td::bench(BenchDynamicBocCommit());
+}
+
+class BenchBocDeserialize : public td::Benchmark {
+ public:
+  explicit BenchBocDeserialize(int threads) : threads_(threads) {
+  }
+  std::string get_description() const override {
+    return PSTRING() << "BagOfCells::deserialize, " << threads_ << " threads (cells)";
+  }
+
+  void start_up_n(int n) override {
+    // balanced binary tree of n distinct cells with 64 bytes of data each
+    std::vector<Ref<Cell>> cells(n);
+    for (int i = n - 1; i >= 0; i--) {
+      CellBuilder cb;
+      for (int j = 0; j < 8; j++) {
+        cb.store_long(i + j, 64);
+      }
+      for (int j = 2 * i + 1; j <= 2 * i + 2 && j < n; j++) {
+        cb.store_ref(std::move(cells[j]));
+      }
+      cells[i] = cb.finalize();
+    }
+    root_hash_ = cells[0]->get_hash();
+    serialized_ = serialize_boc(std::move(cells[0]));
+  }
+
+  void run(int n) override {
+    vm::BagOfCells boc;
+    boc.deserialize(serialized_, 1, threads_).ensure();
+    CHECK(boc.get_root_cell()->get_hash() == root_hash_);
+  }
+
+  void tear_down() override {
+    serialized_ = {};
+  }
+
+ private:
+  int threads_;
+  std::string serialized_;
+  Cell::Hash root_hash_;
+};
+
+TEST(TonDb, BenchBocDeserialize) {
+  for (int threads = 1; threads <= 8; threads *= 2) {
+    td::bench(BenchBocDeserialize(threads));
+  }
+}
+
 template <class BocDeserializerT>
 td::Status test_boc_deserializer(std::vector<Ref<Cell>> cells, int mode) {
   auto total_data_cells_before = vm::DataCell::get_total_data_cells();
@@ -1338,6 +1905,27 @@ TEST(Cell, MerkleUpdateHands) {
   CHECK(MerkleUpdate::combine(update, bad_update).is_null());
 }
 
+TEST(Cell, UsageTreeDeferLoads) {
+  auto leaf = CellBuilder{}.store_bytes("leaf").finalize();
+  auto root = CellBuilder{}.store_bytes("root").store_ref(leaf).finalize();
+  auto usage_tree = std::make_shared<CellUsageTree>();
+  auto usage_cell = UsageCell::create(root, usage_tree->root_ptr());
+
+  std::vector<CellUsageTree::NodeId> loads;
+  {
+    CellUsageTree::DeferLoads defer{*usage_tree, loads};
+    auto child = CellSlice(vm::NoVm(), usage_cell).prefetch_ref(0);
+    CellSlice(vm::NoVm(), child);
+  }
+  ASSERT_EQ(2u, loads.size());
+  ASSERT_TRUE(!usage_tree->is_loaded(usage_tree->root_id()));
+  ASSERT_TRUE(!usage_tree->is_loaded(usage_tree->get_child(usage_tree->root_id(), 0)));
+
+  usage_tree->apply_loads(loads);
+  ASSERT_TRUE(usage_tree->is_loaded(usage_tree->root_id()));
+  ASSERT_TRUE(usage_tree->is_loaded(usage_tree->get_child(usage_tree->root_id(), 0)));
+}
+
 TEST(Cell, MerkleUpdateArray) {
   // create simple array
   size_t n = 1 << 20;
@@ -1364,6 +1952,40 @@ TEST(Cell, MerkleUpdateArray) {
   check_merkle_update(root, arr.root(), update);
 }
 
+TEST(Cell, MerkleUpdateDiff) {
+  td::Random::Xorshift128plus rnd{123};
+  for (int t = 0; t < 1000; t++) {
+    auto A = gen_random_cell(rnd.fast(1, 1000), rnd, false);
+    auto B = gen_random_cell(rnd.fast(1, X), A, rnd, false);
+    check_merkle_update(A, B, MerkleUpdate::generate_diff(A, B));
+    check_merkle_update(B, A, MerkleUpdate::generate_diff(B, A));
+    check_merkle_update(A, A, MerkleUpdate::generate_diff(A, A));
+  }
+}
+
+TEST(Cell, MerkleUpdateDiffArray) {
+  size_t n = 1 << 20;
+  std::vector<td::uint64> data;
+  for (size_t i = 0; i < n; i++) {
+    data.push_back(i / 3);
+  }
+  CompactArray arr(data);
+  auto root = arr.root();
+  for (size_t i = 0; i < 100; i++) {
+    arr.set(i * 9973 % n, i);
+  }
+  auto update = MerkleUpdate::generate_diff(root, arr.root());
+  check_merkle_update(root, arr.root(), update);
+
+  // only the changed paths are stored
+  CellStorageStat stat, full_stat;
+  stat.compute_used_storage(update, false);
+  full_stat.compute_used_storage(arr.root(), false);
+  ASSERT_TRUE(stat.cells * 20 < full_stat.cells);
+  auto got = MerkleUpdate::apply(root, std_boc_deserialize(std_boc_serialize(update, 31).move_as_ok()).move_as_ok());
+  ASSERT_EQ(arr.root()->get_hash(), got->get_hash());
+}
+
 TEST(Cell, MerkleUpdateCombineArray) {
   size_t n = 1 << 10;
   std::vector<td::uint64> data;
@@ -18,15 +18,19 @@
 */
 #include "vm/vm.h"
 #include "vm/cp0.h"
+#include "vm/opctable.h"
 #include "vm/dict.h"
 #include "fift/utils.h"
 #include "common/bigint.hpp"
 
 #include "td/utils/base64.h"
+#include "td/utils/Random.h"
 #include "td/utils/tests.h"
 #include "td/utils/ScopeGuard.h"
 #include "td/utils/StringBuilder.h"
 
+#include <set>
+
 std::string run_vm(td::Ref<vm::Cell> cell) {
   vm::init_op_cp0();
   vm::DictionaryBase::get_empty_dictionary();
@@ -448,3 +452,163 @@ RETALT
 )A";
   test_run_vm(fift::compile_asm(test1).move_as_ok());
 }
+
+// counts the leaves of a subtree
+struct CountAugmentation : vm::dict::AugmentationData {
+  bool skip_extra(vm::CellSlice &cs) const override {
+    return cs.advance(32);
+  }
+  bool eval_leaf(vm::CellBuilder &cb, vm::CellSlice &val_cs) const override {
+    return cb.store_long_bool(1, 32);
+  }
+  bool eval_fork(vm::CellBuilder &cb, vm::CellSlice &left_cs, vm::CellSlice &right_cs) const override {
+    return cb.store_long_bool(left_cs.prefetch_ulong(32) + right_cs.prefetch_ulong(32), 32);
+  }
+  bool eval_empty(vm::CellBuilder &cb) const override {
+    return cb.store_long_bool(0, 32);
+  }
+};
+
+// n distinct random keys of key_bits bits in increasing order
+std::set<std::string> random_dict_keys(td::Random::Xorshift128plus &rnd, int n, int key_bits) {
+  std::set<std::string> keys;
+  while ((int)keys.size() < n) {
+    std::string key((key_bits + 7) / 8, '\0');
+    for (auto &c : key) {
+      c = static_cast<char>(rnd() % (key_bits == 267 ? 3 : 256));  // many common prefixes
+    }
+    td::bitstring::bits_memset(reinterpret_cast<unsigned char *>(&key[0]), key_bits, false,
+                               key.size() * 8 - key_bits);
+    keys.insert(std::move(key));
+  }
+  return keys;
+}
+
+td::ConstBitPtr key_bits_of(const std::string &key) {
+  return td::ConstBitPtr{reinterpret_cast<const unsigned char *>(key.data())};
+}
+
+TEST(VM, dict_build_sorted) {
+  vm::DictionaryBase::get_empty_dictionary();
+  CountAugmentation aug;
+  td::Random::Xorshift128plus rnd(123);
+  for (int n : {0, 1, 2, 3, 17, 1000}) {
+    for (int key_bits : {10, 64, 267}) {
+      auto keys = random_dict_keys(rnd, n, key_bits);
+      vm::Dictionary dict1{key_bits}, dict2{key_bits};
+      vm::AugmentedDictionary adict1{key_bits, aug}, adict2{key_bits, aug};
+      std::vector<vm::DictionaryFixed::entry_t> entries;
+      for (auto &key : keys) {
+        auto key_ptr = key_bits_of(key);
+        auto value = vm::load_cell_slice_ref(vm::CellBuilder().store_long(rnd(), 64).finalize());
+        ASSERT_TRUE(dict1.set(key_ptr, key_bits, value, vm::Dictionary::SetMode::Add));
+        ASSERT_TRUE(adict1.set(key_ptr, key_bits, value, vm::Dictionary::SetMode::Add));
+        entries.emplace_back(key_ptr, std::move(value));
+      }
+      ASSERT_TRUE(dict2.build_sorted(entries));
+      ASSERT_TRUE(adict2.build_sorted(entries));
+      ASSERT_EQ(dict1.is_empty(), dict2.is_empty());
+      if (!dict1.is_empty()) {
+        ASSERT_EQ(dict1.get_root_cell()->get_hash(), dict2.get_root_cell()->get_hash());
+        ASSERT_EQ(adict1.get_root_cell()->get_hash(), adict2.get_root_cell()->get_hash());
+        ASSERT_EQ(static_cast<int>(adict2.get_root_extra()->prefetch_ulong(32)), n);
+      }
+      ASSERT_TRUE(adict2.validate_all());
+      if (entries.size() >= 2) {
+        std::swap(entries[0], entries[1]);
+        vm::Dictionary dict3{key_bits};
+        ASSERT_TRUE(!dict3.build_sorted(entries));
+        ASSERT_TRUE(!dict2.build_sorted(entries));  // not empty
+      }
+    }
+  }
+}
+
+TEST(VM, dict_lookup_set_many) {
+  vm::DictionaryBase::get_empty_dictionary();
+  CountAugmentation aug;
+  td::Random::Xorshift128plus rnd(239);
+  for (int n : {0, 1, 5, 100, 500}) {  // 2 * n keys must fit into 10 bits
+    for (int key_bits : {10, 64, 267}) {
+      auto all_keys = random_dict_keys(rnd, 2 * n, key_bits);
+      std::vector<std::string> keys(all_keys.begin(), all_keys.end());
+      for (std::size_t i = keys.size(); i > 1; i--) {
+        std::swap(keys[i - 1], keys[rnd() % i]);
+      }
+      // the first half of keys is in the dictionary, the other half is not
+      vm::Dictionary dict{key_bits};
+      vm::AugmentedDictionary adict{key_bits, aug};
+      for (int i = 0; i < n; i++) {
+        auto value = vm::load_cell_slice_ref(vm::CellBuilder().store_long(i, 32).finalize());
+        CHECK(dict.set(key_bits_of(keys[i]), key_bits, value));
+        CHECK(adict.set(key_bits_of(keys[i]), key_bits, value));
+      }
+      std::vector<td::ConstBitPtr> lookup_keys;
+      for (auto &key : keys) {
+        lookup_keys.push_back(key_bits_of(key));
+      }
+      if (n > 0) {
+        lookup_keys.push_back(key_bits_of(keys[0]));  // duplicate keys are allowed
+      }
+      auto values = dict.lookup_many(lookup_keys);
+      auto avalues = adict.lookup_many(lookup_keys);
+      ASSERT_EQ(lookup_keys.size(), values.size());
+      for (std::size_t i = 0; i < lookup_keys.size(); i++) {
+        auto value = dict.lookup(lookup_keys[i], key_bits);
+        ASSERT_EQ(value.is_null(), values[i].is_null());
+        ASSERT_EQ(value.is_null(), avalues[i].is_null());
+        if (value.not_null()) {
+          ASSERT_TRUE(value->contents_equal(*values[i]));
+          ASSERT_TRUE(value->contents_equal(*avalues[i]));
+        }
+      }
+      // modify every other key of both halves
+      std::vector<vm::DictionaryFixed::entry_t> entries;
+      for (std::size_t i = 0; i < keys.size(); i += 2) {
+        entries.emplace_back(key_bits_of(keys[i]),
+                             vm::load_cell_slice_ref(vm::CellBuilder().store_long(1000 + i, 32).finalize()));
+      }
+      for (auto mode : {vm::Dictionary::SetMode::Set, vm::Dictionary::SetMode::Add, vm::Dictionary::SetMode::Replace}) {
+        vm::Dictionary dict1{dict.get_root_cell(), key_bits}, dict2{dict.get_root_cell(), key_bits};
+        vm::AugmentedDictionary adict1{adict.get_root(), key_bits, aug}, adict2{adict.get_root(), key_bits, aug};
+        int changes = 0;
+        for (auto &entry : entries) {
+          changes += dict1.set(entry.first, key_bits, entry.second, mode);
+          adict1.set(entry.first, key_bits, entry.second, mode);
+        }
+        ASSERT_EQ(changes, dict2.set_many(entries, mode));
+        ASSERT_EQ(changes, adict2.set_many(entries, mode));
+        ASSERT_EQ(dict1.is_empty(), dict2.is_empty());
+        if (!dict1.is_empty()) {
+          ASSERT_EQ(dict1.get_root_cell()->get_hash(), dict2.get_root_cell()->get_hash());
+          ASSERT_EQ(adict1.get_root_cell()->get_hash(), adict2.get_root_cell()->get_hash());
+        }
+      }
+      if (entries.size() >= 2) {
+        entries.push_back(entries[0]);
+        ASSERT_EQ(-1, dict.set_many(entries));
+      }
+    }
+  }
+}
+
+TEST(VM, opcode_lookup_tables) {
+  vm::init_op_cp0();
+  auto cp0 = dynamic_cast<const vm::OpcodeTable *>(vm::DispatchTable::get_table(0));
+  CHECK(cp0);
+  ASSERT_TRUE(cp0->check_lookup_tables());
+
+  // ranges split below the first byte, below the second byte and inside the third byte of the opcode
+  vm::OpcodeTable table{"test", static_cast<vm::Codepage>(-1)};
+  auto exec = [](vm::VmState *) { return 0; };
+  table.insert(vm::OpcodeInstr::mksimple(0x10, 8, "A", exec))
+      .insert(vm::OpcodeInstr::mksimple(0x2, 4, "B", exec))
+      .insert(vm::OpcodeInstr::mksimple(0x3105, 16, "C", exec))
+      .insert(vm::OpcodeInstr::mksimple(0x3106, 16, "D", exec))
+      .insert(vm::OpcodeInstr::mksimple(0x4201a, 20, "E", exec))
+      .insert(vm::OpcodeInstr::mksimple(0x4201c3, 24, "F", exec))
+      .insert(vm::OpcodeInstr::mkfixedrange(0x7f0000, 0x7f8000, 24, 15, vm::instr::dump_1c("G "), nullptr));
+  ASSERT_TRUE(!table.check_lookup_tables());
+  table.finalize();
+  ASSERT_TRUE(table.check_lookup_tables());
+}
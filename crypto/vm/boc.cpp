@@ -26,6 +26,10 @@
 #include "td/utils/Slice-decl.h"
 #include "td/utils/format.h"
 #include "td/utils/crypto.h"
+#include "td/utils/port/thread.h"
+
+#include <atomic>
+#include <mutex>
 
 namespace vm {
 using td::Ref;
@@ -474,16 +478,102 @@ std::string BagOfCells::extract_string() const {
   return std::string{serialized.data(), serialized.data() + serialized.size()};
 }
 
-void BagOfCells::store_uint(unsigned long long value, unsigned bytes) {
-  unsigned char* ptr = store_ptr += bytes;
-  store_chk();
-  while (bytes) {
-    *--ptr = value & 0xff;
-    value >>= 8;
-    --bytes;
+namespace {
+// stores the serialization into a preallocated buffer
+class BocBufferWriter {
+ public:
+  BocBufferWriter(unsigned char* begin, unsigned char* end) : begin_(begin), ptr_(begin), end_(end) {
+  }
+  void store_uint(unsigned long long value, unsigned bytes) {
+    unsigned char* ptr = ptr_ += bytes;
+    DCHECK(ptr_ <= end_);
+    while (bytes) {
+      *--ptr = value & 0xff;
+      value >>= 8;
+      --bytes;
+    }
+  }
+  unsigned char* reserve(std::size_t size) {
+    return ptr_;
+  }
+  void advance(std::size_t size) {
+    ptr_ += size;
+    DCHECK(ptr_ <= end_);
+  }
+  td::uint64 position() const {
+    return ptr_ - begin_;
+  }
+  void store_crc32c() {
+    store_uint(td::bswap32(td::crc32c(td::Slice{begin_, ptr_})), 4);
   }
-  DCHECK(!bytes);
-}
+
+ private:
+  unsigned char* begin_;
+  unsigned char* ptr_;
+  unsigned char* end_;
+};
+
+// stores the serialization into a file through a fixed size buffer, computing CRC32C of the flushed data
+class BocFileWriter {
+ public:
+  BocFileWriter(td::FileFd& fd, std::size_t buffer_size) : fd_(fd), buffer_(std::max<std::size_t>(buffer_size, 1 << 12)) {
+  }
+  void store_uint(unsigned long long value, unsigned bytes) {
+    unsigned char* ptr = reserve(bytes) + bytes;
+    advance(bytes);
+    while (bytes) {
+      *--ptr = value & 0xff;
+      value >>= 8;
+      --bytes;
+    }
+  }
+  unsigned char* reserve(std::size_t size) {
+    DCHECK(size <= buffer_.size());
+    if (buffer_.size() - used_ < size) {
+      flush();
+    }
+    return buffer_.data() + used_;
+  }
+  void advance(std::size_t size) {
+    used_ += size;
+    DCHECK(used_ <= buffer_.size());
+  }
+  td::uint64 position() const {
+    return flushed_ + used_;
+  }
+  void store_crc32c() {
+    flush();
+    store_uint(td::bswap32(crc_), 4);
+  }
+  td::Status finish() {
+    flush();
+    return std::move(status_);
+  }
+
+ private:
+  td::FileFd& fd_;
+  std::vector<unsigned char> buffer_;
+  std::size_t used_{0};
+  td::uint64 flushed_{0};
+  td::uint32 crc_{0};
+  td::Status status_;
+
+  void flush() {
+    td::Slice data{buffer_.data(), used_};
+    crc_ = td::crc32c_extend(crc_, data);
+    flushed_ += used_;
+    used_ = 0;
+    while (status_.is_ok() && !data.empty()) {
+      auto r_size = fd_.write(data);
+      if (r_size.is_error()) {
+        status_ = r_size.move_as_error();
+      } else {
+        data.remove_prefix(r_size.ok());
+      }
+    }
+  }
+};
+}  // namespace
 
 //serialized_boc#672fb0ac has_idx:(## 1) has_crc32c:(## 1)
 //  has_cache_bits:(## 1) flags:(## 2) { flags = 0 }
@@ -496,13 +586,12 @@ void BagOfCells::store_uint(unsigned long long value, unsigned bytes) {
 //  index:(cells * ##(off_bytes * 8))
 //  cell_data:(tot_cells_size * [ uint8 ])
 //  = BagOfCells;
-std::size_t BagOfCells::serialize_to(unsigned char* buffer, std::size_t buff_size, int mode) {
-  std::size_t size_est = estimate_serialized_size(mode);
-  if (!size_est || size_est > buff_size) {
-    return 0;
-  }
-  init_store(buffer, buffer + size_est);
-  store_uint(info.magic, 4);
+template <class WriterT>
+td::uint64 BagOfCells::serialize_to_impl(WriterT& writer, int mode) {
+  auto store_ref = [&](unsigned long long value) { writer.store_uint(value, info.ref_byte_size); };
+  auto store_offset = [&](unsigned long long value) { writer.store_uint(value, info.offset_byte_size); };
+
+  writer.store_uint(info.magic, 4);
 
   td::uint8 byte{0};
   if (info.has_index) {
@@ -519,9 +608,9 @@ std::size_t BagOfCells::serialize_to(unsigned char* buffer, std::size_t buff_siz
     return 0;
   }
   byte |= static_cast<td::uint8>(info.ref_byte_size);
-  store_uint(byte, 1);
+  writer.store_uint(byte, 1);
 
-  store_uint(info.offset_byte_size, 1);
+  writer.store_uint(info.offset_byte_size, 1);
   store_ref(cell_count);
   store_ref(root_count);
   store_ref(0);
@@ -531,7 +620,7 @@ std::size_t BagOfCells::serialize_to(unsigned char* buffer, std::size_t buff_siz
     DCHECK(k >= 0 && k < cell_count);
     store_ref(k);
   }
-  DCHECK(store_ptr - buffer == (long long)info.index_offset);
+  DCHECK(writer.position() == info.index_offset);
   DCHECK((unsigned)cell_count == cell_list_.size());
   if (info.has_index) {
     std::size_t offs = 0;
@@ -550,8 +639,8 @@ std::size_t BagOfCells::serialize_to(unsigned char* buffer, std::size_t buff_siz
     }
     DCHECK(offs == info.data_size);
   }
-  DCHECK(store_ptr - buffer == (long long)info.data_offset);
-  unsigned char* keep_ptr = store_ptr;
+  DCHECK(writer.position() == info.data_offset);
+  auto keep_position = writer.position();
   for (int i = 0; i < cell_count; ++i) {
     const auto& dc_info = cell_list_[cell_count - 1 - i];
     const Ref<DataCell>& dc = dc_info.dc_ref;
@@ -559,9 +648,8 @@ std::size_t BagOfCells::serialize_to(unsigned char* buffer, std::size_t buff_siz
     if (dc_info.is_root_cell && (mode & Mode::WithTopHash)) {
       with_hash = true;
     }
-    int s = dc->serialize(store_ptr, 256, with_hash);
-    store_ptr += s;
-    store_chk();
+    int s = dc->serialize(writer.reserve(256), 256, with_hash);
+    writer.advance(s);
     DCHECK(dc->size_refs() == dc_info.ref_num);
     // std::cerr << (dc_info.is_special() ? '*' : ' ') << i << '<' << (int)dc_info.wt << ">:";
     for (unsigned j = 0; j < dc_info.ref_num; ++j) {
@@ -572,16 +660,35 @@ std::size_t BagOfCells::serialize_to(unsigned char* buffer, std::size_t buff_siz
     }
     // std::cerr << std::endl;
   }
-  store_chk();
-  DCHECK(store_ptr - keep_ptr == (long long)info.data_size);
-  DCHECK(store_end - store_ptr == (info.has_crc32c ? 4 : 0));
+  DCHECK(writer.position() - keep_position == info.data_size);
   if (info.has_crc32c) {
-    // compute crc32c of buffer .. store_ptr
-    unsigned crc = td::crc32c(td::Slice{buffer, store_ptr});
-    store_uint(td::bswap32(crc), 4);
+    writer.store_crc32c();
+  }
+  DCHECK(writer.position() == info.total_size);
+  return writer.position();
+}
+
+std::size_t BagOfCells::serialize_to(unsigned char* buffer, std::size_t buff_size, int mode) {
+  std::size_t size_est = estimate_serialized_size(mode);
+  if (!size_est || size_est > buff_size) {
+    return 0;
   }
-  DCHECK(store_empty());
-  return store_ptr - buffer;
+  BocBufferWriter writer(buffer, buffer + size_est);
+  return static_cast<std::size_t>(serialize_to_impl(writer, mode));
+}
+
+td::Status BagOfCells::serialize_to_file(td::FileFd& fd, int mode, std::size_t buffer_size) {
+  std::size_t size_est = estimate_serialized_size(mode);
+  if (!size_est) {
+    return td::Status::Error("no cells to serialize to this bag of cells");
+  }
+  BocFileWriter writer(fd, buffer_size);
+  auto size = serialize_to_impl(writer, mode);
+  TRY_STATUS(writer.finish());
+  if (size != size_est) {
+    return td::Status::Error("error while serializing a bag of cells: actual serialized size differs from estimated");
+  }
+  return td::Status::OK();
 }
 
 unsigned long long BagOfCells::Info::read_int(const unsigned char* ptr, unsigned bytes) {
@@ -715,6 +822,21 @@ td::Result<td::Slice> BagOfCells::get_cell_slice(int idx, td::Slice data) {
   return data.substr(offs, td::narrow_cast<size_t>(offs_end - offs));
 }
 
+td::Result<int> BagOfCells::read_cell_ref(int idx, td::Slice cell_slice, const CellSerializationInfo& cell_info,
+                                          int k) {
+  int ref_idx = (int)info.read_ref(cell_slice.ubegin() + cell_info.refs_offset + k * info.ref_byte_size);
+  if (ref_idx <= idx) {
+    return td::Status::Error(PSLICE() << "bag-of-cells error: reference #" << k << " of cell #" << idx
+                                      << " is to cell #" << ref_idx << " with smaller index");
+  }
+  if (ref_idx >= cell_count) {
+    return td::Status::Error(PSLICE() << "bag-of-cells error: reference #" << k << " of cell #" << idx
+                                      << " is to non-existent cell #" << ref_idx << ", only " << cell_count
+                                      << " cells are defined");
+  }
+  return ref_idx;
+}
+
 td::Result<td::Ref<vm::DataCell>> BagOfCells::deserialize_cell(int idx, td::Slice cells_slice,
                                                                td::Span<td::Ref<DataCell>> cells_span,
                                                                std::vector<td::uint8>* cell_should_cache) {
@@ -729,16 +851,7 @@ td::Result<td::Ref<vm::DataCell>> BagOfCells::deserialize_cell(int idx, td::Slic
 
   auto refs = td::MutableSpan<td::Ref<Cell>>(refs_buf).substr(0, cell_info.refs_cnt);
   for (int k = 0; k < cell_info.refs_cnt; k++) {
-    int ref_idx = (int)info.read_ref(cell_slice.ubegin() + cell_info.refs_offset + k * info.ref_byte_size);
-    if (ref_idx <= idx) {
-      return td::Status::Error(PSLICE() << "bag-of-cells error: reference #" << k << " of cell #" << idx
-                                        << " is to cell #" << ref_idx << " with smaller index");
-    }
-    if (ref_idx >= cell_count) {
-      return td::Status::Error(PSLICE() << "bag-of-cells error: reference #" << k << " of cell #" << idx
-                                        << " is to non-existent cell #" << ref_idx << ", only " << cell_count
-                                        << " cells are defined");
-    }
+    TRY_RESULT(ref_idx, read_cell_ref(idx, cell_slice, cell_info, k));
     refs[k] = cells_span[cell_count - ref_idx - 1];
     if (cell_should_cache) {
       auto& cnt = (*cell_should_cache)[ref_idx];
@@ -751,7 +864,143 @@ td::Result<td::Ref<vm::DataCell>> BagOfCells::deserialize_cell(int idx, td::Slic
   return cell_info.create_data_cell(cell_slice, refs);
 }
 
-td::Result<long long> BagOfCells::deserialize(const td::Slice& data, int max_roots) {
+namespace {
+// cells are claimed by worker threads in chunks of this size; smaller levels are processed by one thread
+constexpr std::size_t parallel_chunk_size = 256;
+
+void run_on_new_threads(int threads, const std::function<void()>& f) {
+#if !TD_THREAD_UNSUPPORTED
+  std::vector<td::thread> workers;
+  for (int i = 1; i < threads; i++) {
+    workers.emplace_back(f);
+  }
+#endif
+  f();
+#if !TD_THREAD_UNSUPPORTED
+  for (auto& worker : workers) {
+    worker.join();
+  }
+#endif
+}
+}  // namespace
+
+td::Status BagOfCells::deserialize_cells_parallel(td::Slice cells_slice, std::vector<Ref<DataCell>>& cell_list,
+                                                  std::vector<td::uint8>* cell_should_cache, int threads,
+                                                  const ParallelRunner& runner) {
+  // references always point to cells with larger indices, so levels are computed in one backward pass;
+  // all references of a cell have smaller levels than the cell itself
+  std::vector<int> level(cell_count);
+  int max_level = 0;
+  for (int idx = cell_count - 1; idx >= 0; idx--) {
+    auto S = [&]() -> td::Status {
+      TRY_RESULT(cell_slice, get_cell_slice(idx, cells_slice));
+      CellSerializationInfo cell_info;
+      TRY_STATUS(cell_info.init(cell_slice, info.ref_byte_size));
+      int cell_level = 0;
+      for (int k = 0; k < cell_info.refs_cnt; k++) {
+        TRY_RESULT(ref_idx, read_cell_ref(idx, cell_slice, cell_info, k));
+        cell_level = std::max(cell_level, level[ref_idx] + 1);
+        if (cell_should_cache) {
+          auto& cnt = (*cell_should_cache)[ref_idx];
+          if (cnt < 2) {
+            cnt++;
+          }
+        }
+      }
+      level[idx] = cell_level;
+      max_level = std::max(max_level, cell_level);
+      return td::Status::OK();
+    }();
+    if (S.is_error()) {
+      return td::Status::Error(PSLICE() << "invalid bag-of-cells failed to deserialize cell #" << idx << " " << S);
+    }
+  }
+
+  std::vector<std::size_t> level_begin(max_level + 2, 0);
+  for (auto l : level) {
+    level_begin[l + 1]++;
+  }
+  for (int l = 0; l <= max_level; l++) {
+    level_begin[l + 1] += level_begin[l];
+  }
+  std::vector<int> order(cell_count);
+  {
+    auto pos = level_begin;
+    for (int idx = 0; idx < cell_count; idx++) {
+      order[pos[level[idx]]++] = idx;
+    }
+  }
+
+  // consecutive small levels are merged into one segment processed by a single thread
+  struct Segment {
+    std::size_t begin, end;
+    bool parallel;
+  };
+  std::vector<Segment> segments;
+  for (int l = 0; l <= max_level; l++) {
+    auto begin = level_begin[l], end = level_begin[l + 1];
+    bool parallel = end - begin >= parallel_chunk_size * 2;
+    if (!parallel && !segments.empty() && !segments.back().parallel) {
+      segments.back().end = end;
+    } else {
+      segments.push_back(Segment{begin, end, parallel});
+    }
+  }
+
+  cell_list.clear();
+  cell_list.resize(cell_count);
+  std::atomic<bool> failed{false};
+  std::mutex error_mutex;
+  td::Status error;
+
+  auto build_cell = [&](int idx) {
+    auto r_cell = deserialize_cell(idx, cells_slice, cell_list, nullptr);
+    if (r_cell.is_error()) {
+      std::lock_guard<std::mutex> guard(error_mutex);
+      if (!failed) {
+        error = td::Status::Error(PSLICE() << "invalid bag-of-cells failed to deserialize cell #" << idx << " "
+                                           << r_cell.error());
+        failed = true;
+      }
+      return;
+    }
+    cell_list[cell_count - idx - 1] = r_cell.move_as_ok();
+  };
+  // a level depends only on the previous ones, so every parallel segment is a separate run
+  for (auto& segment : segments) {
+    if (failed) {
+      break;
+    }
+    if (!segment.parallel) {
+      for (auto j = segment.begin; j < segment.end && !failed; j++) {
+        build_cell(order[j]);
+      }
+      continue;
+    }
+    std::atomic<std::size_t> next{segment.begin};
+    auto run = [&] {
+      while (!failed) {
+        auto begin = next.fetch_add(parallel_chunk_size, std::memory_order_relaxed);
+        if (begin >= segment.end) {
+          break;
+        }
+        auto end = std::min(begin + parallel_chunk_size, segment.end);
+        for (auto j = begin; j < end; j++) {
+          build_cell(order[j]);
+        }
+      }
+    };
+    if (runner) {
+      runner(threads, run);
+    } else {
+      run_on_new_threads(threads, run);
+    }
+  }
+  return error;
+}
+
+td::Result<long long> BagOfCells::deserialize(const td::Slice& data, int max_roots, int threads,
+                                              const ParallelRunner& runner) {
   clear();
   long long size_est = info.parse_serialized_header(data);
   //LOG(INFO) << "estimated size " << size_est << ", true size " << data.size();
@@ -834,18 +1083,26 @@ td::Result<long long> BagOfCells::deserialize(const td::Slice& data, int max_roo
   }
   auto cells_slice = data.substr(info.data_offset, info.data_size);
   std::vector<Ref<DataCell>> cell_list;
-  cell_list.reserve(cell_count);
-  std::array<td::Ref<Cell>, 4> refs_buf;
-  for (int i = 0; i < cell_count; i++) {
-    // reconstruct cell with index cell_count - 1 - i
-    int idx = cell_count - 1 - i;
-    auto r_cell = deserialize_cell(idx, cells_slice, cell_list, info.has_cache_bits ? &cell_should_cache : nullptr);
-    if (r_cell.is_error()) {
-      return td::Status::Error(PSLICE() << "invalid bag-of-cells failed to deserialize cell #" << idx << " "
-                                        << r_cell.error());
+#if TD_THREAD_UNSUPPORTED
+  threads = 1;
+#endif
+  threads = std::min(threads, cell_count / (int)parallel_chunk_size);
+  if (threads > 1) {
+    TRY_STATUS(deserialize_cells_parallel(cells_slice, cell_list, info.has_cache_bits ? &cell_should_cache : nullptr,
+                                          threads, runner));
+  } else {
+    cell_list.reserve(cell_count);
+    for (int i = 0; i < cell_count; i++) {
+      // reconstruct cell with index cell_count - 1 - i
+      int idx = cell_count - 1 - i;
+      auto r_cell = deserialize_cell(idx, cells_slice, cell_list, info.has_cache_bits ? &cell_should_cache : nullptr);
+      if (r_cell.is_error()) {
+        return td::Status::Error(PSLICE() << "invalid bag-of-cells failed to deserialize cell #" << idx << " "
+                                          << r_cell.error());
+      }
+      cell_list.push_back(r_cell.move_as_ok());
+      DCHECK(cell_list.back().not_null());
     }
-    cell_list.push_back(r_cell.move_as_ok());
-    DCHECK(cell_list.back().not_null());
   }
   if (info.has_cache_bits) {
     for (int idx = 0; idx < cell_count; idx++) {
@@ -907,12 +1164,13 @@ unsigned long long BagOfCells::get_idx_entry_raw(int index) {
  * 
  */
 
-td::Result<Ref<Cell>> std_boc_deserialize(td::Slice data, bool can_be_empty) {
+td::Result<Ref<Cell>> std_boc_deserialize(td::Slice data, bool can_be_empty, int threads,
+                                          const BagOfCells::ParallelRunner& runner) {
   if (data.empty() && can_be_empty) {
     return Ref<Cell>();
   }
   BagOfCells boc;
-  auto res = boc.deserialize(data, 1);
+  auto res = boc.deserialize(data, 1, threads, runner);
   if (res.is_error()) {
     return res.move_as_error();
   }
@@ -17,11 +17,13 @@
     Copyright 2017-2020 Telegram Systems LLP
 */
 #pragma once
+#include <functional>
 #include <set>
 #include "vm/cells.h"
 #include "td/utils/Status.h"
 #include "td/utils/buffer.h"
 #include "td/utils/HashMap.h"
+#include "td/utils/port/FileFd.h"
 
 namespace vm {
 using td::Ref;
@@ -200,8 +202,6 @@ class BagOfCells {
   int max_depth{1024};
   Info info;
   unsigned long long data_bytes{0};
-  unsigned char* store_ptr{nullptr};
-  unsigned char* store_end{nullptr};
   td::HashMap<Hash, int> cells;
   struct CellInfo {
     Ref<DataCell> dc_ref;
@@ -251,12 +251,21 @@ class BagOfCells {
   std::string serialize_to_string(int mode = 0);
   td::Result<td::BufferSlice> serialize_to_slice(int mode = 0);
   std::size_t serialize_to(unsigned char* buffer, std::size_t buff_size, int mode = 0);
+  // writes the serialization to the current position of fd, keeping at most buffer_size bytes of it in memory
+  td::Status serialize_to_file(td::FileFd& fd, int mode = 0, std::size_t buffer_size = 1 << 20);
   std::string extract_string() const;
 
-  td::Result<long long> deserialize(const td::Slice& data, int max_roots = default_max_roots);
+  // runs f on the calling thread and on up to threads - 1 other threads and returns when all the calls have
+  // finished; f may be run on fewer threads, down to the calling thread only
+  using ParallelRunner = std::function<void(int threads, const std::function<void()>& f)>;
+  // with threads > 1 cells are grouped by their level in the reference graph,
+  // and cells of one level are created and hashed in parallel by runner; without a runner new threads are started
+  td::Result<long long> deserialize(const td::Slice& data, int max_roots = default_max_roots, int threads = 1,
+                                    const ParallelRunner& runner = nullptr);
   td::Result<long long> deserialize(const unsigned char* buffer, std::size_t buff_size,
-                                    int max_roots = default_max_roots) {
-    return deserialize(td::Slice{buffer, buff_size}, max_roots);
+                                    int max_roots = default_max_roots, int threads = 1,
+                                    const ParallelRunner& runner = nullptr) {
+    return deserialize(td::Slice{buffer, buff_size}, max_roots, threads, runner);
   }
   int get_root_count() const {
     return root_count;
@@ -279,34 +288,24 @@ class BagOfCells {
     cell_list_.clear();
   }
   td::uint64 compute_sizes(int mode, int& r_size, int& o_size);
-  void init_store(unsigned char* from, unsigned char* to) {
-    store_ptr = from;
-    store_end = to;
-  }
-  void store_chk() const {
-    DCHECK(store_ptr <= store_end);
-  }
-  bool store_empty() const {
-    return store_ptr == store_end;
-  }
-  void store_uint(unsigned long long value, unsigned bytes);
-  void store_ref(unsigned long long value) {
-    store_uint(value, info.ref_byte_size);
-  }
-  void store_offset(unsigned long long value) {
-    store_uint(value, info.offset_byte_size);
-  }
+  template <class WriterT>
+  td::uint64 serialize_to_impl(WriterT& writer, int mode);
   void reorder_cells();
   int revisit(int cell_idx, int force = 0);
   unsigned long long get_idx_entry_raw(int index);
   unsigned long long get_idx_entry(int index);
   bool get_cache_entry(int index);
   td::Result<td::Slice> get_cell_slice(int index, td::Slice data);
+  td::Result<int> read_cell_ref(int index, td::Slice cell_slice, const CellSerializationInfo& cell_info, int k);
   td::Result<td::Ref<vm::DataCell>> deserialize_cell(int index, td::Slice data, td::Span<td::Ref<DataCell>> cells,
                                                      std::vector<td::uint8>* cell_should_cache);
+  td::Status deserialize_cells_parallel(td::Slice data, std::vector<Ref<DataCell>>& cell_list,
+                                        std::vector<td::uint8>* cell_should_cache, int threads,
+                                        const ParallelRunner& runner);
 };
 
-td::Result<Ref<Cell>> std_boc_deserialize(td::Slice data, bool can_be_empty = false);
+td::Result<Ref<Cell>> std_boc_deserialize(td::Slice data, bool can_be_empty = false, int threads = 1,
+                                          const BagOfCells::ParallelRunner& runner = nullptr);
 td::Result<td::BufferSlice> std_boc_serialize(Ref<Cell> root, int mode = 0);
 
 td::Result<std::vector<Ref<Cell>>> std_boc_deserialize_multi(td::Slice data,
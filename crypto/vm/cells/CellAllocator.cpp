@@ -0,0 +1,202 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#include "vm/cells/CellAllocator.h"
+
+#include "td/utils/port/thread_local.h"
+
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace vm {
+
+namespace {
+
+constexpr size_t size_classes = CellAllocator::max_pooled_size / CellAllocator::size_granularity;
+// blocks are moved between threads and the depot in batches of this size
+constexpr size_t batch_size = 64;
+constexpr size_t max_thread_blocks = 2 * batch_size;
+constexpr size_t max_depot_batches = 256;
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+size_t get_size_class(size_t size) {
+  return (size - 1) / CellAllocator::size_granularity;
+}
+
+size_t get_block_size(size_t size_class) {
+  return (size_class + 1) * CellAllocator::size_granularity;
+}
+
+void free_blocks(FreeBlock* block) {
+  while (block) {
+    auto next = block->next;
+    ::operator delete(block);
+    block = next;
+  }
+}
+
+class Depot {
+ public:
+  FreeBlock* pop_batch(size_t size_class) {
+    auto& shard = shards_[size_class];
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    if (shard.batches.empty()) {
+      return nullptr;
+    }
+    auto batch = shard.batches.back();
+    shard.batches.pop_back();
+    return batch;
+  }
+  void push_batch(size_t size_class, FreeBlock* batch) {
+    {
+      auto& shard = shards_[size_class];
+      std::lock_guard<std::mutex> guard(shard.mutex);
+      if (shard.batches.size() < max_depot_batches) {
+        shard.batches.push_back(batch);
+        return;
+      }
+    }
+    free_blocks(batch);
+  }
+  size_t size() {
+    size_t res = 0;
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> guard(shard.mutex);
+      res += shard.batches.size() * batch_size;
+    }
+    return res;
+  }
+
+ private:
+  struct Shard {
+    std::mutex mutex;
+    std::vector<FreeBlock*> batches;
+  };
+  Shard shards_[size_classes];
+};
+
+Depot& get_depot() {
+  // never destroyed: cells may be freed by other static destructors
+  static Depot* depot = new Depot();
+  return *depot;
+}
+
+struct FreeList {
+  FreeBlock* head{nullptr};
+  size_t size{0};
+
+  FreeBlock* pop_batch() {
+    auto batch = head;
+    for (size_t i = 1; i < batch_size; i++) {
+      head = head->next;
+    }
+    auto last = head;
+    head = head->next;
+    last->next = nullptr;
+    size -= batch_size;
+    return batch;
+  }
+};
+
+struct ThreadCache {
+  FreeList lists[size_classes];
+
+  ThreadCache();
+  ~ThreadCache();
+};
+
+TD_THREAD_LOCAL ThreadCache* thread_cache;
+TD_THREAD_LOCAL bool thread_cache_destroyed;
+
+ThreadCache::ThreadCache() {
+  thread_cache = this;
+}
+
+ThreadCache::~ThreadCache() {
+  thread_cache = nullptr;
+  thread_cache_destroyed = true;
+  for (size_t size_class = 0; size_class < size_classes; size_class++) {
+    auto& list = lists[size_class];
+    while (list.size >= batch_size) {
+      get_depot().push_batch(size_class, list.pop_batch());
+    }
+    free_blocks(list.head);
+  }
+}
+
+// nullptr while the thread is being destroyed
+ThreadCache* get_thread_cache() {
+  if (td::likely(thread_cache != nullptr)) {
+    return thread_cache;
+  }
+  if (thread_cache_destroyed) {
+    return nullptr;
+  }
+  static thread_local ThreadCache cache;
+  return &cache;
+}
+
+}  // namespace
+
+void* CellAllocator::allocate(size_t size) {
+  if (size > max_pooled_size) {
+    return ::operator new(size);
+  }
+  auto size_class = get_size_class(size);
+  auto cache = get_thread_cache();
+  if (cache) {
+    auto& list = cache->lists[size_class];
+    if (!list.head) {
+      list.head = get_depot().pop_batch(size_class);
+      list.size = list.head ? batch_size : 0;
+    }
+    if (list.head) {
+      auto block = list.head;
+      list.head = block->next;
+      list.size--;
+      return block;
+    }
+  }
+  return ::operator new(get_block_size(size_class));
+}
+
+void CellAllocator::deallocate(void* ptr, size_t size) {
+  auto cache = size > max_pooled_size ? nullptr : get_thread_cache();
+  if (!cache) {
+    ::operator delete(ptr);
+    return;
+  }
+  auto size_class = get_size_class(size);
+  auto& list = cache->lists[size_class];
+  auto block = static_cast<FreeBlock*>(ptr);
+  block->next = list.head;
+  list.head = block;
+  if (++list.size > max_thread_blocks) {
+    get_depot().push_batch(size_class, list.pop_batch());
+  }
+}
+
+size_t CellAllocator::get_depot_size() {
+  return get_depot().size();
+}
+
+}  // namespace vm
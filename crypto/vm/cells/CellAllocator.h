@@ -0,0 +1,40 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#pragma once
+
+#include "td/utils/common.h"
+
+namespace vm {
+
+// Pool of memory blocks for cells. Blocks are grouped into a few size classes (a cell with its storage takes at most
+// a few hundred bytes); every thread keeps its own free lists, and excess blocks are moved in batches to a global
+// depot with one mutex per size class, so that blocks freed by one thread may be reused by the others.
+class CellAllocator {
+ public:
+  static constexpr size_t size_granularity = 32;
+  static constexpr size_t max_pooled_size = 384;
+
+  static void* allocate(size_t size);
+  static void deallocate(void* ptr, size_t size);
+
+  // number of free blocks kept in the global depot
+  static size_t get_depot_size();
+};
+
+}  // namespace vm
@@ -18,7 +18,26 @@
 */
 #include "vm/cells/CellUsageTree.h"
 
+#include "td/utils/port/thread_local.h"
+
 namespace vm {
+namespace {
+TD_THREAD_LOCAL CellUsageTree::DeferLoads *deferred_loads;
+}  // namespace
+
+//
+// CellUsageTree::DeferLoads
+//
+CellUsageTree::DeferLoads::DeferLoads(CellUsageTree &tree, std::vector<NodeId> &loads)
+    : tree_(&tree), loads_(&loads), prev_(deferred_loads) {
+  deferred_loads = this;
+}
+
+CellUsageTree::DeferLoads::~DeferLoads() {
+  CHECK(deferred_loads == this);
+  deferred_loads = prev_;
+}
+
 //
 // CellUsageTree::NodePtr
 //
@@ -111,12 +130,36 @@ void CellUsageTree::set_use_mark_for_is_loaded(bool use_mark) {
   use_mark_ = use_mark;
 }
 
+void CellUsageTree::set_concurrent(bool concurrent) {
+  concurrent_ = concurrent;
+}
+
+void CellUsageTree::apply_loads(const std::vector<NodeId> &loads) {
+  for (auto node_id : loads) {
+    on_load(node_id);
+  }
+}
+
 void CellUsageTree::on_load(NodeId node_id) {
+  for (auto defer = deferred_loads; defer; defer = defer->prev_) {
+    if (defer->tree_ == this) {
+      defer->loads_->push_back(node_id);
+      return;
+    }
+  }
+  std::unique_lock<std::mutex> guard(mutex_, std::defer_lock);
+  if (concurrent_) {
+    guard.lock();
+  }
   nodes_[node_id].is_loaded = true;
 }
 
 CellUsageTree::NodeId CellUsageTree::create_child(NodeId node_id, unsigned ref_id) {
   DCHECK(ref_id < CellTraits::max_refs);
+  std::unique_lock<std::mutex> guard(mutex_, std::defer_lock);
+  if (concurrent_) {
+    guard.lock();
+  }
   NodeId res = nodes_[node_id].children[ref_id];
   if (res) {
     return res;
@@ -23,11 +23,30 @@
 #include "td/utils/int_types.h"
 #include "td/utils/logging.h"
 
+#include <mutex>
+#include <vector>
+
 namespace vm {
 class CellUsageTree : public std::enable_shared_from_this<CellUsageTree> {
  public:
   using NodeId = td::uint32;
 
+  // while alive, loads of cells of the tree made by the current thread are recorded in loads instead of marking
+  // the nodes as loaded; apply_loads() marks them later, so that work which may be discarded leaves no trace
+  class DeferLoads {
+   public:
+    DeferLoads(CellUsageTree &tree, std::vector<NodeId> &loads);
+    DeferLoads(const DeferLoads &) = delete;
+    DeferLoads &operator=(const DeferLoads &) = delete;
+    ~DeferLoads();
+
+   private:
+    friend class CellUsageTree;
+    CellUsageTree *tree_;
+    std::vector<NodeId> *loads_;
+    DeferLoads *prev_;
+  };
+
   struct NodePtr {
    public:
     NodePtr() = default;
@@ -57,7 +76,10 @@ class CellUsageTree : public std::enable_shared_from_this<CellUsageTree> {
   NodeId get_parent(NodeId node_id);
   NodeId get_child(NodeId node_id, unsigned ref_id);
   void set_use_mark_for_is_loaded(bool use_mark = true);
+  // allows cells of the tree to be loaded from several threads at once
+  void set_concurrent(bool concurrent = true);
   NodeId create_child(NodeId node_id, unsigned ref_id);
+  void apply_loads(const std::vector<NodeId> &loads);
 
  private:
   struct Node {
@@ -67,6 +89,8 @@ class CellUsageTree : public std::enable_shared_from_this<CellUsageTree> {
     std::array<td::uint32, CellTraits::max_refs> children{};
   };
   bool use_mark_{false};
+  bool concurrent_{false};
+  std::mutex mutex_;
   std::vector<Node> nodes_{2};
 
   void on_load(NodeId node_id);
@@ -18,6 +18,8 @@
 */
 #pragma once
 
+#include "vm/cells/CellAllocator.h"
+
 namespace vm {
 namespace detail {
 template <class CellT, size_t Size = 0>
@@ -29,6 +31,13 @@ class CellWithArrayStorage : public CellT {
   ~CellWithArrayStorage() {
     CellT::destroy_storage(get_storage());
   }
+  // the cell and its storage are one block of the pool; the sized delete gets the size of the actual instantiation
+  static void* operator new(size_t size) {
+    return CellAllocator::allocate(size);
+  }
+  static void operator delete(void* ptr, size_t size) {
+    CellAllocator::deallocate(ptr, size);
+  }
   template <class... ArgsT>
   static std::unique_ptr<CellT> create(size_t storage_size, ArgsT&&... args) {
     static_assert(CellT::max_storage_size <= 40 * 8, "");
@@ -40,7 +49,7 @@ class CellWithArrayStorage : public CellT {
 #define CASE2(offset) CASE(offset) CASE(offset + 1)
 #define CASE8(offset) CASE2(offset) CASE2(offset + 2) CASE2(offset + 4) CASE2(offset + 6)
 #define CASE32(offset) CASE8(offset) CASE8(offset + 8) CASE8(offset + 16) CASE8(offset + 24)
-    switch (size) { CASE32(0) CASE8(32) }
+    switch (size) { CASE32(1) CASE8(33) }
 #undef CASE
 #undef CASE2
 #undef CASE8
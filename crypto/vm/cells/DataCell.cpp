@@ -26,7 +26,8 @@
 
 namespace vm {
 std::unique_ptr<DataCell> DataCell::create_empty_data_cell(Info info) {
-  return detail::CellWithUniquePtrStorage<DataCell>::create(info.get_storage_size(), info);
+  // storage is never empty: there is at least one hash
+  return detail::CellWithArrayStorage<DataCell>::create(info.get_storage_size(), info);
 }
 
 DataCell::DataCell(Info info) : info_(std::move(info)) {
@@ -22,6 +22,8 @@
 #include "td/utils/HashMap.h"
 #include "td/utils/HashSet.h"
 
+#include <queue>
+
 namespace vm {
 namespace detail {
 class MerkleUpdateApply {
@@ -39,8 +41,12 @@ class MerkleUpdateApply {
   using Key = std::pair<Cell::Hash, int>;
   td::HashMap<Cell::Hash, Ref<Cell>> known_cells_;
   td::HashMap<Key, Ref<Cell>> ready_cells_;
+  td::HashSet<Key> visited_from_;
 
   void dfs_both(Ref<Cell> original, Ref<Cell> update_from, int merkle_depth) {
+    if (!visited_from_.emplace(update_from->get_hash(), merkle_depth).second) {
+      return;
+    }
     CellSlice cs_update_from(NoVm(), update_from);
     known_cells_.emplace(original->get_hash(merkle_depth), original);
     if (cs_update_from.special_type() == Cell::SpecialType::PrunnedBranch) {
@@ -91,6 +97,56 @@ class MerkleUpdateApply {
   }
 };
 
+// Cells are visited in order of decreasing depth, starting from both roots. All parents of a cell are deeper than
+// the cell, so when it is visited it is known whether it was reached from from, from to, or from both. Cells reached
+// from both trees are shared and are not expanded; the others are expanded, so only the differing parts are loaded.
+class MerkleUpdateDiff {
+ public:
+  std::pair<Ref<Cell>, Ref<Cell>> run(Ref<Cell> from, Ref<Cell> to) {
+    add(from, From);
+    add(to, To);
+    while (!queue_.empty()) {
+      auto hash = queue_.top().second;
+      queue_.pop();
+      auto &info = cells_[hash];
+      if (info.sides == (From | To)) {
+        shared_.insert(hash);
+        continue;
+      }
+      CellSlice cs(NoVm(), info.cell);
+      auto sides = info.sides;
+      for (unsigned i = 0; i < cs.size_refs(); i++) {
+        add(cs.prefetch_ref(i), sides);
+      }
+    }
+    cells_.clear();
+    auto is_prunned = [this](const Ref<Cell> &cell) { return shared_.count(cell->get_hash()) != 0; };
+    auto update_from = MerkleProof::generate_raw(std::move(from), is_prunned);
+    auto update_to = MerkleProof::generate_raw(std::move(to), is_prunned);
+    return {std::move(update_from), std::move(update_to)};
+  }
+
+ private:
+  enum { From = 1, To = 2 };
+  struct CellInfo {
+    Ref<Cell> cell;
+    int sides{0};
+  };
+  td::HashMap<Cell::Hash, CellInfo> cells_;
+  td::HashSet<Cell::Hash> shared_;
+  std::priority_queue<std::pair<td::uint16, Cell::Hash>> queue_;
+
+  void add(Ref<Cell> cell, int side) {
+    auto hash = cell->get_hash();
+    auto &info = cells_[hash];
+    if (info.sides == 0) {
+      queue_.emplace(cell->get_depth(), hash);
+      info.cell = std::move(cell);
+    }
+    info.sides |= side;
+  }
+};
+
 class MerkleUpdateValidator {
  public:
   td::Status validate(Ref<Cell> update_from, Ref<Cell> update_to, td::uint32 from_level, td::uint32 to_level) {
@@ -196,6 +252,10 @@ std::pair<Ref<Cell>, Ref<Cell>> MerkleUpdate::generate_raw(Ref<Cell> from, Ref<C
   return {std::move(update_from), std::move(update_to)};
 }
 
+std::pair<Ref<Cell>, Ref<Cell>> MerkleUpdate::generate_diff_raw(Ref<Cell> from, Ref<Cell> to) {
+  return detail::MerkleUpdateDiff().run(std::move(from), std::move(to));
+}
+
 td::Status MerkleUpdate::validate_raw(Ref<Cell> update_from, Ref<Cell> update_to, td::uint32 from_level,
                                       td::uint32 to_level) {
   return detail::MerkleUpdateValidator().validate(std::move(update_from), std::move(update_to), from_level, to_level);
@@ -224,6 +284,14 @@ Ref<Cell> MerkleUpdate::generate(Ref<Cell> from, Ref<Cell> to, CellUsageTree *us
   return CellBuilder::create_merkle_update(res.first, res.second);
 }
 
+Ref<Cell> MerkleUpdate::generate_diff(Ref<Cell> from, Ref<Cell> to) {
+  if (from->get_level() != 0 || to->get_level() != 0) {
+    return {};
+  }
+  auto res = generate_diff_raw(std::move(from), std::move(to));
+  return CellBuilder::create_merkle_update(res.first, res.second);
+}
+
 namespace detail {
 class MerkleCombine {
  public:
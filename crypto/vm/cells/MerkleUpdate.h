@@ -30,6 +30,11 @@ class MerkleUpdate {
  public:
   // from + update == to
   static Ref<Cell> generate(Ref<Cell> from, Ref<Cell> to, CellUsageTree *usage_tree);
+  // from + update == to, where to was not necessarily computed from from (e.g. two distant states of a shard)
+  // Subtrees reachable from both roots are found by comparing the trees and are pruned on both sides, so the update
+  // keeps the paths of from and of to leading to them. A cell of to present in from only inside such a subtree is
+  // not recognized and is stored in full.
+  static Ref<Cell> generate_diff(Ref<Cell> from, Ref<Cell> to);
   // Returns empty Ref<Cell> if something go wrong. If validate(from).is_ok() and may_apply(from, to).is_ok(), then it
   // must not fail.
   static Ref<Cell> apply(Ref<Cell> from, Ref<Cell> update);
@@ -42,6 +47,7 @@ class MerkleUpdate {
   static Ref<Cell> apply_raw(Ref<Cell> from, Ref<Cell> update_from, Ref<Cell> update_to, td::uint32 from_level,
                              td::uint32 to_level);
   static std::pair<Ref<Cell>, Ref<Cell>> generate_raw(Ref<Cell> from, Ref<Cell> to, CellUsageTree *usage_tree);
+  static std::pair<Ref<Cell>, Ref<Cell>> generate_diff_raw(Ref<Cell> from, Ref<Cell> to);
   static td::Status validate_raw(Ref<Cell> update_from, Ref<Cell> update_to, td::uint32 from_level,
                                  td::uint32 to_level);
 
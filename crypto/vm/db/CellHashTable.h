@@ -18,54 +18,175 @@
 */
 #pragma once
 
+#include "td/utils/as.h"
+#include "td/utils/common.h"
+#include "td/utils/logging.h"
 #include "td/utils/Slice.h"
 
-#include <set>
+#include <algorithm>
+#include <deque>
 
 namespace vm {
+// Open addressing hash table (linear probing, backward shift deletion) of InfoT keyed by InfoT::key().
+// Keys are expected to be cryptographic hashes, so the first bytes of a key are used as its hash.
+// InfoT objects themselves live in a separate chunked storage, so references returned by apply()
+// stay valid until the element is erased, even if the table is rehashed in between.
 template <class InfoT>
 class CellHashTable {
  public:
   template <class F>
   InfoT &apply(td::Slice hash, F &&f) {
-    auto it = set_.find(hash);
-    if (it != set_.end()) {
-      auto &res = const_cast<InfoT &>(*it);
+    auto h = hash_key(hash);
+    auto pos = find_pos(hash, h);
+    if (pos != npos) {
+      auto &res = *slots_[pos].info;
       f(res);
       return res;
     }
-    InfoT info;
-    f(info);
-    auto &res = const_cast<InfoT &>(*(set_.insert(std::move(info)).first));
+    auto &res = alloc_info();
+    // f may recursively add new elements to the table, so the slot is chosen only after it returns
+    f(res);
+    insert_slot(h, &res);
     return res;
   }
 
   template <class F>
   void for_each(F &&f) {
-    for (auto &info : set_) {
-      f(info);
+    for (auto &slot : slots_) {
+      if (slot.info != nullptr) {
+        f(static_cast<const InfoT &>(*slot.info));
+      }
     }
   }
   template <class F>
   void filter(F &&f) {
-    for (auto it = set_.begin(); it != set_.end();) {
-      if (f(*it)) {
-        it++;
+    std::vector<Slot> kept;
+    kept.reserve(size_);
+    for (auto &slot : slots_) {
+      if (slot.info == nullptr) {
+        continue;
+      }
+      if (f(static_cast<const InfoT &>(*slot.info))) {
+        kept.push_back(slot);
       } else {
-        it = set_.erase(it);
+        free_info(slot.info);
       }
     }
+    std::fill(slots_.begin(), slots_.end(), Slot());
+    size_ = 0;
+    for (auto &slot : kept) {
+      insert_slot(slot.hash, slot.info);
+    }
   }
   void erase(td::Slice hash) {
-    auto it = set_.find(hash);
-    CHECK(it != set_.end());
-    set_.erase(it);
+    auto pos = find_pos(hash, hash_key(hash));
+    CHECK(pos != npos);
+    free_info(slots_[pos].info);
+    erase_slot(pos);
   }
   size_t size() const {
-    return set_.size();
+    return size_;
   }
 
  private:
-  std::set<InfoT, std::less<>> set_;
+  struct Slot {
+    td::uint64 hash{0};
+    InfoT *info{nullptr};
+  };
+  static constexpr size_t npos = static_cast<size_t>(-1);
+  static constexpr size_t min_capacity = 16;
+
+  std::vector<Slot> slots_;
+  size_t size_{0};
+  std::deque<InfoT> infos_;
+  std::vector<InfoT *> free_infos_;
+
+  static td::uint64 hash_key(td::Slice key) {
+    td::uint64 res;
+    if (key.size() >= sizeof(res)) {
+      res = td::as<td::uint64>(key.ubegin());
+    } else {
+      res = key.size();
+      for (auto c : key) {
+        res = res * 131 + static_cast<unsigned char>(c);
+      }
+    }
+    // keys are usually uniformly distributed already; this only guards against non-hash keys
+    return res * 0x9E3779B97F4A7C15ull;
+  }
+  static td::Slice key_slice(td::Slice key) {
+    return key;
+  }
+  template <class KeyT>
+  static td::Slice key_slice(const KeyT &key) {
+    return key.as_slice();
+  }
+
+  size_t mask() const {
+    return slots_.size() - 1;
+  }
+  size_t find_pos(td::Slice key, td::uint64 h) const {
+    if (slots_.empty()) {
+      return npos;
+    }
+    for (size_t pos = h & mask();; pos = (pos + 1) & mask()) {
+      auto &slot = slots_[pos];
+      if (slot.info == nullptr) {
+        return npos;
+      }
+      if (slot.hash == h && key_slice(slot.info->key()) == key) {
+        return pos;
+      }
+    }
+  }
+  void insert_slot(td::uint64 h, InfoT *info) {
+    if ((size_ + 1) * 2 > slots_.size()) {
+      resize(slots_.empty() ? min_capacity : slots_.size() * 2);
+    }
+    auto pos = h & mask();
+    while (slots_[pos].info != nullptr) {
+      pos = (pos + 1) & mask();
+    }
+    slots_[pos].hash = h;
+    slots_[pos].info = info;
+    size_++;
+  }
+  void erase_slot(size_t pos) {
+    size_--;
+    auto hole = pos;
+    for (pos = (pos + 1) & mask(); slots_[pos].info != nullptr; pos = (pos + 1) & mask()) {
+      auto ideal = slots_[pos].hash & mask();
+      // move the element to the hole, unless its ideal position lies cyclically in (hole, pos]
+      if (((pos - ideal) & mask()) >= ((pos - hole) & mask())) {
+        slots_[hole] = slots_[pos];
+        hole = pos;
+      }
+    }
+    slots_[hole] = Slot();
+  }
+  void resize(size_t new_capacity) {
+    std::vector<Slot> old_slots(new_capacity);
+    std::swap(old_slots, slots_);
+    size_ = 0;
+    for (auto &slot : old_slots) {
+      if (slot.info != nullptr) {
+        insert_slot(slot.hash, slot.info);
+      }
+    }
+  }
+
+  InfoT &alloc_info() {
+    if (free_infos_.empty()) {
+      infos_.emplace_back();
+      return infos_.back();
+    }
+    auto res = free_infos_.back();
+    free_infos_.pop_back();
+    return *res;
+  }
+  void free_info(InfoT *info) {
+    *info = InfoT();
+    free_infos_.push_back(info);
+  }
 };
 }  // namespace vm
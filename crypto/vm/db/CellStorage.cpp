@@ -20,6 +20,7 @@
 #include "vm/db/DynamicBagOfCellsDb.h"
 #include "vm/boc.h"
 #include "td/utils/base64.h"
+#include "td/utils/HashSet.h"
 #include "td/utils/tl_parsers.h"
 #include "td/utils/tl_helpers.h"
 
@@ -122,20 +123,42 @@ class RefcntCellParser {
 };
 }  // namespace
 
-CellLoader::CellLoader(std::shared_ptr<KeyValueReader> reader) : reader_(std::move(reader)) {
+CellLoader::CellLoader(std::shared_ptr<KeyValueReader> reader, std::shared_ptr<DataCellCache> cache,
+                       size_t prefetch_cells)
+    : reader_(std::move(reader)), cache_(std::move(cache)), prefetch_cells_(prefetch_cells) {
   CHECK(reader_);
 }
 
 td::Result<CellLoader::LoadResult> CellLoader::load(td::Slice hash, bool need_data, ExtCellCreator &ext_cell_creator) {
   //LOG(ERROR) << "Storage: load cell " << hash.size() << " " << td::base64_encode(hash);
-  LoadResult res;
   std::string serialized;
   TRY_RESULT(get_status, reader_->get(hash, serialized));
   if (get_status != KeyValue::GetStatus::Ok) {
     DCHECK(get_status == KeyValue::GetStatus::NotFound);
-    return res;
+    return LoadResult();
+  }
+  return parse(serialized, need_data, ext_cell_creator);
+}
+
+td::Result<std::vector<CellLoader::LoadResult>> CellLoader::load_multi(td::Span<td::Slice> hashes, bool need_data,
+                                                                       ExtCellCreator &ext_cell_creator) {
+  std::vector<std::string> serialized;
+  TRY_RESULT(get_statuses, reader_->get_multi(hashes, serialized));
+  std::vector<LoadResult> res(hashes.size());
+  for (size_t i = 0; i < hashes.size(); i++) {
+    if (get_statuses[i] != KeyValue::GetStatus::Ok) {
+      DCHECK(get_statuses[i] == KeyValue::GetStatus::NotFound);
+      continue;
+    }
+    TRY_RESULT(load_result, parse(serialized[i], need_data, ext_cell_creator));
+    res[i] = std::move(load_result);
   }
+  return std::move(res);
+}
 
+td::Result<CellLoader::LoadResult> CellLoader::parse(td::Slice serialized, bool need_data,
+                                                     ExtCellCreator &ext_cell_creator) {
+  LoadResult res;
   res.status = LoadResult::Ok;
 
   RefcntCellParser refcnt_cell(need_data);
@@ -150,6 +173,77 @@ td::Result<CellLoader::LoadResult> CellLoader::load(td::Slice hash, bool need_da
   return res;
 }
 
+td::Result<Ref<DataCell>> CellLoader::load_cell(td::Slice hash, ExtCellCreator &ext_cell_creator) {
+  std::string serialized;
+  if (cache_) {
+    bool cached = cache_->get(hash, serialized);
+    if (!cached && prefetch_cells_ != 0) {
+      TRY_STATUS(prefetch(hash, prefetch_cells_, ext_cell_creator));
+      cached = cache_->get(hash, serialized);
+    }
+    if (cached) {
+      TRY_RESULT(load_result, parse(serialized, true, ext_cell_creator));
+      return std::move(load_result.cell());
+    }
+  }
+  TRY_RESULT(get_status, reader_->get(hash, serialized));
+  if (get_status != KeyValue::GetStatus::Ok) {
+    return td::Status::Error("cell not found");
+  }
+  if (cache_) {
+    cache_->put(hash, serialized);
+  }
+  TRY_RESULT(load_result, parse(serialized, true, ext_cell_creator));
+  return std::move(load_result.cell());
+}
+
+td::Status CellLoader::prefetch(td::Slice hash, size_t max_cells, ExtCellCreator &ext_cell_creator) {
+  if (!cache_) {
+    return td::Status::OK();
+  }
+  td::HashSet<CellHash> visited;
+  std::vector<CellHash> level{CellHash::from_slice(hash)};
+  visited.insert(level[0]);
+  while (!level.empty()) {
+    std::vector<std::string> serialized(level.size());
+    std::vector<td::Slice> missing;
+    std::vector<size_t> missing_pos;
+    for (size_t i = 0; i < level.size(); i++) {
+      if (!cache_->get(level[i].as_slice(), serialized[i])) {
+        missing.push_back(level[i].as_slice());
+        missing_pos.push_back(i);
+      }
+    }
+    if (!missing.empty()) {
+      std::vector<std::string> values;
+      TRY_RESULT(get_statuses, reader_->get_multi(missing, values));
+      for (size_t i = 0; i < missing.size(); i++) {
+        if (get_statuses[i] == KeyValue::GetStatus::Ok) {
+          cache_->put(missing[i], values[i]);
+          serialized[missing_pos[i]] = std::move(values[i]);
+        }
+      }
+    }
+
+    std::vector<CellHash> next_level;
+    for (auto &value : serialized) {
+      if (value.empty() || visited.size() >= max_cells) {
+        continue;
+      }
+      TRY_RESULT(load_result, parse(value, true, ext_cell_creator));
+      auto &cell = load_result.cell();
+      for (unsigned i = 0; i < cell->size_refs() && visited.size() < max_cells; i++) {
+        auto child_hash = cell->get_ref(i)->get_hash();
+        if (visited.insert(child_hash).second) {
+          next_level.push_back(child_hash);
+        }
+      }
+    }
+    level = std::move(next_level);
+  }
+  return td::Status::OK();
+}
+
 CellStorer::CellStorer(KeyValue &kv) : kv_(kv) {
 }
 
@@ -19,11 +19,15 @@
 #pragma once
 #include "td/db/KeyValue.h"
 #include "vm/db/DynamicBagOfCellsDb.h"
+#include "vm/db/DataCellCache.h"
 #include "vm/cells.h"
 
 #include "td/utils/Slice.h"
+#include "td/utils/Span.h"
 #include "td/utils/Status.h"
 
+#include <vector>
+
 namespace vm {
 using KeyValue = td::KeyValue;
 using KeyValueReader = td::KeyValueReader;
@@ -46,11 +50,27 @@ class CellLoader {
     Ref<DataCell> cell_;
     td::int32 refcnt_{0};
   };
-  CellLoader(std::shared_ptr<KeyValueReader> reader);
+  // if prefetch_cells is non-zero and there is a cache, every cache miss in load_cell prefetches up to
+  // prefetch_cells cells of the subtree of the missing cell
+  CellLoader(std::shared_ptr<KeyValueReader> reader, std::shared_ptr<DataCellCache> cache = {},
+             size_t prefetch_cells = 0);
   td::Result<LoadResult> load(td::Slice hash, bool need_data, ExtCellCreator &ext_cell_creator);
+  // same as load for several cells, with one batched lookup in the database
+  td::Result<std::vector<LoadResult>> load_multi(td::Span<td::Slice> hashes, bool need_data,
+                                                 ExtCellCreator &ext_cell_creator);
+  // loads only the cell itself, without its reference count; the record of the cell is taken from the cache
+  // when possible, but the references are always created by ext_cell_creator
+  td::Result<Ref<DataCell>> load_cell(td::Slice hash, ExtCellCreator &ext_cell_creator);
+  // puts into the cache up to max_cells cells of the subtree of the given cell, walking it breadth-first and
+  // loading all missing cells of one level with one batched lookup; does nothing without a cache
+  td::Status prefetch(td::Slice hash, size_t max_cells, ExtCellCreator &ext_cell_creator);
 
  private:
   std::shared_ptr<KeyValueReader> reader_;
+  std::shared_ptr<DataCellCache> cache_;
+  size_t prefetch_cells_;
+
+  static td::Result<LoadResult> parse(td::Slice serialized, bool need_data, ExtCellCreator &ext_cell_creator);
 };
 
 class CellStorer {
@@ -0,0 +1,91 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#include "vm/db/DataCellCache.h"
+
+#include "td/utils/as.h"
+
+#include <algorithm>
+
+namespace vm {
+DataCellCache::DataCellCache(size_t max_bytes, size_t shards_count)
+    : max_shard_bytes_(max_bytes / std::max<size_t>(shards_count, 1))
+    , shards_(std::make_unique<Shard[]>(std::max<size_t>(shards_count, 1)))
+    , shards_count_(std::max<size_t>(shards_count, 1)) {
+}
+
+DataCellCache::Shard &DataCellCache::get_shard(td::Slice hash) {
+  // the first bytes of the hash are used by the hash map itself
+  return shards_[td::as<td::uint32>(hash.ubegin() + 8) % shards_count_];
+}
+
+bool DataCellCache::get(td::Slice hash, std::string &record) {
+  CHECK(hash.size() == CellTraits::hash_bytes);
+  auto &shard = get_shard(hash);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  auto it = shard.nodes.find(CellHash::from_slice(hash));
+  if (it == shard.nodes.end()) {
+    shard.stats.misses++;
+    return false;
+  }
+  shard.stats.hits++;
+  auto node = it->second.get();
+  node->remove();
+  shard.lru.put(node);
+  record = node->record;
+  return true;
+}
+
+void DataCellCache::put(td::Slice hash, td::Slice record) {
+  CHECK(hash.size() == CellTraits::hash_bytes);
+  auto &shard = get_shard(hash);
+  std::lock_guard<std::mutex> guard(shard.mutex);
+  auto &node = shard.nodes[CellHash::from_slice(hash)];
+  if (!node) {
+    node = std::make_unique<Node>();
+    node->hash = CellHash::from_slice(hash);
+    node->record = record.str();
+    // the record, the cache node and its hash map entry
+    node->bytes = node->record.capacity() + sizeof(Node) + sizeof(CellHash) + sizeof(void *);
+    shard.bytes += node->bytes;
+  }
+  node->remove();
+  shard.lru.put(node.get());
+  while (shard.bytes > max_shard_bytes_) {
+    auto lru_node = static_cast<Node *>(shard.lru.get());
+    CHECK(lru_node);
+    shard.bytes -= lru_node->bytes;
+    shard.nodes.erase(lru_node->hash);
+    shard.stats.evictions++;
+  }
+}
+
+DataCellCache::Stats DataCellCache::get_stats() const {
+  Stats res;
+  for (size_t i = 0; i < shards_count_; i++) {
+    auto &shard = shards_[i];
+    std::lock_guard<std::mutex> guard(shard.mutex);
+    res.hits += shard.stats.hits;
+    res.misses += shard.stats.misses;
+    res.evictions += shard.stats.evictions;
+    res.size += shard.nodes.size();
+    res.bytes += shard.bytes;
+  }
+  return res;
+}
+}  // namespace vm
@@ -0,0 +1,77 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#pragma once
+
+#include "vm/cells/CellHash.h"
+
+#include "td/utils/HashMap.h"
+#include "td/utils/List.h"
+#include "td/utils/Slice.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace vm {
+// Memory-bounded cache of cell records read from a cell database, shared by all readers of the database.
+// Records are addressed by the hashes of the cells, so a record read through one snapshot may be returned
+// to a reader of any other snapshot. The cache keeps the serialized records and not the parsed cells: each
+// reader parses a record itself, so the references of the cell are loaded through the snapshot of that reader.
+// The cache is split into shards with separate locks and separate LRU lists.
+class DataCellCache {
+ public:
+  struct Stats {
+    td::uint64 hits{0};
+    td::uint64 misses{0};
+    td::uint64 evictions{0};
+    td::uint64 size{0};
+    td::uint64 bytes{0};
+  };
+
+  // max_bytes bounds the approximate memory used by the cached records
+  explicit DataCellCache(size_t max_bytes, size_t shards_count = 16);
+
+  // copies the record into the given string; returns false if the record is not cached
+  bool get(td::Slice hash, std::string &record);
+  void put(td::Slice hash, td::Slice record);
+
+  Stats get_stats() const;
+
+ private:
+  struct Node : public td::ListNode {
+    CellHash hash;
+    std::string record;
+    size_t bytes{0};
+  };
+  struct Shard {
+    mutable std::mutex mutex;
+    // most recently used records are in the front; declared before nodes, so nodes are destroyed first
+    td::ListNode lru;
+    td::HashMap<CellHash, std::unique_ptr<Node>> nodes;
+    size_t bytes{0};
+    Stats stats;
+  };
+
+  size_t max_shard_bytes_;
+  std::unique_ptr<Shard[]> shards_;
+  size_t shards_count_;
+
+  Shard &get_shard(td::Slice hash);
+};
+}  // namespace vm
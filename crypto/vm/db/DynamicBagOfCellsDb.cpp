@@ -31,12 +31,6 @@
 namespace vm {
 namespace {
 
-class CellDbReader {
- public:
-  virtual ~CellDbReader() = default;
-  virtual td::Result<Ref<DataCell>> load_cell(td::Slice hash) = 0;
-};
-
 struct DynamicBocExtCellExtra {
   std::shared_ptr<CellDbReader> reader;
 };
@@ -63,19 +57,8 @@ struct CellInfo {
   Cell::Hash key() const {
     return cell->get_hash();
   }
-  bool operator<(const CellInfo &other) const {
-    return key() < other.key();
-  }
 };
 
-bool operator<(const CellInfo &a, td::Slice b) {
-  return a.key().as_slice() < b;
-}
-
-bool operator<(td::Slice a, const CellInfo &b) {
-  return a < b.key().as_slice();
-}
-
 class DynamicBagOfCellsDbImpl : public DynamicBagOfCellsDb, private ExtCellCreator {
  public:
   DynamicBagOfCellsDbImpl() {
@@ -187,6 +170,10 @@ class DynamicBagOfCellsDbImpl : public DynamicBagOfCellsDb, private ExtCellCreat
     return td::Status::OK();
   }
 
+  std::shared_ptr<CellDbReader> get_cell_db_reader() override {
+    return cell_db_reader_;
+  }
+
  private:
   std::unique_ptr<CellLoader> loader_;
   std::vector<Ref<Cell>> to_inc_;
@@ -239,9 +226,13 @@ class DynamicBagOfCellsDbImpl : public DynamicBagOfCellsDb, private ExtCellCreat
       if (db_) {
         return db_->load_cell(hash);
       }
-      TRY_RESULT(load_result, cell_loader_->load(hash, true, *this));
-      CHECK(load_result.status == CellLoader::LoadResult::Ok);
-      return std::move(load_result.cell());
+      return cell_loader_->load_cell(hash, *this);
+    }
+    td::Status prefetch(td::Slice hash, size_t max_cells) override {
+      if (db_) {
+        return td::Status::OK();
+      }
+      return cell_loader_->prefetch(hash, max_cells, *this);
     }
 
    private:
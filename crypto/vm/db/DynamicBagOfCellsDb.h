@@ -34,6 +34,18 @@ class ExtCellCreator {
   virtual td::Result<Ref<Cell>> ext_cell(Cell::LevelMask level_mask, td::Slice hash, td::Slice depth) = 0;
 };
 
+// Read-only view of one snapshot of a cell database. Unlike DynamicBagOfCellsDb it may be used from any
+// thread, and it stays valid when the bag of cells switches to a newer snapshot.
+class CellDbReader {
+ public:
+  virtual ~CellDbReader() = default;
+  virtual td::Result<Ref<DataCell>> load_cell(td::Slice hash) = 0;
+  // warms up the cell cache with up to max_cells cells of the subtree of the given cell, if the reader has a cache
+  virtual td::Status prefetch(td::Slice hash, size_t max_cells) {
+    return td::Status::OK();
+  }
+};
+
 class DynamicBagOfCellsDb {
  public:
   virtual ~DynamicBagOfCellsDb() = default;
@@ -55,6 +67,8 @@ class DynamicBagOfCellsDb {
 
   // restart with new loader will also reset stats_diff
   virtual td::Status set_loader(std::unique_ptr<CellLoader> loader) = 0;
+  // reader of the snapshot of the current loader; null if no loader is set
+  virtual std::shared_ptr<CellDbReader> get_cell_db_reader() = 0;
 
   static std::unique_ptr<DynamicBagOfCellsDb> create();
 };
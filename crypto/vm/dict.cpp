@@ -24,6 +24,8 @@
 
 #include "td/utils/bits.h"
 
+#include <algorithm>
+
 namespace vm {
 
 /*
@@ -1669,6 +1671,211 @@ Ref<vm::Cell> DictionaryFixed::extract_prefix_subdict_root(td::ConstBitPtr prefi
   return res.second ? res.first : root_cell;
 }
 
+Ref<Cell> DictionaryFixed::dict_build_sorted(const entry_t* const* begin, const entry_t* const* end, int pos,
+                                             int n) const {
+  CellBuilder cb;
+  if (end - begin == 1) {
+    append_dict_label(cb, (*begin)->first + pos, n, n);
+    return finish_create_leaf(cb, *(*begin)->second);
+  }
+  // the keys are sorted, so the common prefix of the range is that of its first and last keys
+  std::size_t same_upto = 0;
+  td::bitstring::bits_memcmp((*begin)->first + pos, end[-1]->first + pos, n, &same_upto);
+  int c = static_cast<int>(same_upto);
+  assert(c < n);
+  auto mid = std::partition_point(begin, end, [pos, c](const entry_t* entry) { return !entry->first[pos + c]; });
+  auto c1 = dict_build_sorted(begin, mid, pos + c + 1, n - c - 1);
+  auto c2 = dict_build_sorted(mid, end, pos + c + 1, n - c - 1);
+  append_dict_label(cb, (*begin)->first + pos, c, n);
+  return finish_create_fork(cb, std::move(c1), std::move(c2), n - c);
+}
+
+bool DictionaryFixed::build_sorted(const std::vector<entry_t>& entries) {
+  force_validate();
+  if (!is_empty()) {
+    return false;
+  }
+  std::vector<const entry_t*> ptrs;
+  ptrs.reserve(entries.size());
+  for (auto& entry : entries) {
+    if (entry.second.is_null() ||
+        (!ptrs.empty() && td::bitstring::bits_memcmp(ptrs.back()->first, entry.first, key_bits) >= 0)) {
+      return false;
+    }
+    ptrs.push_back(&entry);
+  }
+  if (!ptrs.empty()) {
+    set_root_cell(dict_build_sorted(ptrs.data(), ptrs.data() + ptrs.size(), 0, key_bits));
+  }
+  return true;
+}
+
+void DictionaryFixed::dict_lookup_many(Ref<Cell> dict, const std::size_t* begin, const std::size_t* end,
+                                       const std::vector<td::ConstBitPtr>& keys, int pos, int n,
+                                       std::vector<Ref<CellSlice>>& values) const {
+  LabelParser label{std::move(dict), n, label_mode()};
+  // the keys having the label as a prefix form a subrange of the sorted range
+  while (begin < end && !label.is_prefix_of(keys[*begin] + pos, n)) {
+    ++begin;
+  }
+  auto last = begin;
+  while (last < end && label.is_prefix_of(keys[*last] + pos, n)) {
+    ++last;
+  }
+  end = last;
+  if (begin == end) {
+    return;
+  }
+  n -= label.l_bits;
+  if (n <= 0) {
+    assert(!n);
+    label.skip_label();
+    for (auto it = begin; it < end; ++it) {
+      values[*it] = label.remainder;
+    }
+    return;
+  }
+  pos += label.l_bits;
+  auto mid = std::partition_point(begin, end, [&keys, pos](std::size_t i) { return !keys[i][pos]; });
+  if (begin < mid) {
+    dict_lookup_many(label.remainder->prefetch_ref(0), begin, mid, keys, pos + 1, n - 1, values);
+  }
+  if (mid < end) {
+    dict_lookup_many(label.remainder->prefetch_ref(1), mid, end, keys, pos + 1, n - 1, values);
+  }
+}
+
+std::vector<Ref<CellSlice>> DictionaryFixed::lookup_many(const std::vector<td::ConstBitPtr>& keys) {
+  force_validate();
+  std::vector<Ref<CellSlice>> values(keys.size());
+  if (is_empty() || keys.empty()) {
+    return values;
+  }
+  std::vector<std::size_t> order(keys.size());
+  for (std::size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [this, &keys](std::size_t i, std::size_t j) {
+    return td::bitstring::bits_memcmp(keys[i], keys[j], key_bits) < 0;
+  });
+  dict_lookup_many(get_root_cell(), order.data(), order.data() + order.size(), keys, 0, key_bits, values);
+  return values;
+}
+
+Ref<Cell> DictionaryFixed::dict_set_many(Ref<Cell> dict, const entry_t* const* begin, const entry_t* const* end,
+                                         int pos, int n, SetMode mode, int& changes) const {
+  if (begin == end) {
+    return dict;
+  }
+  if (dict.is_null()) {
+    if (mode == SetMode::Replace) {
+      return dict;
+    }
+    changes += static_cast<int>(end - begin);
+    return dict_build_sorted(begin, end, pos, n);
+  }
+  LabelParser label{dict, n, label_mode()};
+  int l = label.l_bits;
+  // the keys are sorted, so the shortest common prefix with the label is that of the first or of the last key
+  int c_first = label.common_prefix_len((*begin)->first + pos, n);
+  int c_last = label.common_prefix_len(end[-1]->first + pos, n);
+  int c = std::min(c_first, c_last);
+  if (c < l && mode == SetMode::Replace) {
+    // keys diverging from the label are absent, only the others are to be replaced
+    while (begin < end && label.common_prefix_len((*begin)->first + pos, n) < l) {
+      ++begin;
+    }
+    auto last = begin;
+    while (last < end && label.common_prefix_len((*last)->first + pos, n) == l) {
+      ++last;
+    }
+    end = last;
+    if (begin == end) {
+      return dict;
+    }
+    c = l;
+  }
+  CellBuilder cb;
+  if (c == l) {
+    if (l == n) {
+      // a leaf with the only key of the range (the keys are distinct)
+      if (mode == SetMode::Add) {
+        return dict;
+      }
+      ++changes;
+      append_dict_label(cb, (*begin)->first + pos, n, n);
+      return finish_create_leaf(cb, *(*begin)->second);
+    }
+    // a fork, modify both subtrees at once
+    auto mid = std::partition_point(begin, end, [pos, l](const entry_t* entry) { return !entry->first[pos + l]; });
+    int old_changes = changes;
+    auto c1 = dict_set_many(label.remainder->prefetch_ref(0), begin, mid, pos + l + 1, n - l - 1, mode, changes);
+    auto c2 = dict_set_many(label.remainder->prefetch_ref(1), mid, end, pos + l + 1, n - l - 1, mode, changes);
+    if (changes == old_changes) {
+      return dict;
+    }
+    append_dict_label(cb, (*begin)->first + pos, l, n);
+    return finish_create_fork(cb, std::move(c1), std::move(c2), n - l);
+  }
+  // some keys leave the edge after c bits, so a new fork is inserted there (cf. dict_set())
+  // the old edge goes on with the bit opposite to that of a key leaving it
+  bool sw_bit = !(c_first == c ? (*begin)->first : end[-1]->first)[pos + c];
+  int m = n - c - 1;
+  // create the lower portion of the old edge
+  int t = l - c - 1;
+  auto cs = std::move(label.remainder);
+  if (label.l_same) {
+    append_dict_label_same(cb, label.l_same & 1, t, m);
+  } else {
+    cs.write().advance(c + 1);
+    append_dict_label(cb, cs->data_bits(), t, m);
+    cs.unique_write().advance(t);
+  }
+  if (!cell_builder_add_slice_bool(cb, *cs)) {
+    throw VmError{Excno::cell_ov, "cannot change label of an old dictionary cell (?)"};
+  }
+  Ref<Cell> old_edge = cb.finalize();
+  auto mid = std::partition_point(begin, end, [pos, c](const entry_t* entry) { return !entry->first[pos + c]; });
+  Ref<Cell> c1, c2;
+  if (sw_bit) {
+    changes += static_cast<int>(mid - begin);
+    c1 = dict_build_sorted(begin, mid, pos + c + 1, m);
+    c2 = dict_set_many(std::move(old_edge), mid, end, pos + c + 1, m, mode, changes);
+  } else {
+    c1 = dict_set_many(std::move(old_edge), begin, mid, pos + c + 1, m, mode, changes);
+    changes += static_cast<int>(end - mid);
+    c2 = dict_build_sorted(mid, end, pos + c + 1, m);
+  }
+  append_dict_label(cb, (*begin)->first + pos, c, n);
+  return finish_create_fork(cb, std::move(c1), std::move(c2), n - c);
+}
+
+int DictionaryFixed::set_many(const std::vector<entry_t>& entries, SetMode mode) {
+  force_validate();
+  std::vector<const entry_t*> ptrs;
+  ptrs.reserve(entries.size());
+  for (auto& entry : entries) {
+    if (entry.second.is_null()) {
+      return -1;
+    }
+    ptrs.push_back(&entry);
+  }
+  std::sort(ptrs.begin(), ptrs.end(), [this](const entry_t* x, const entry_t* y) {
+    return td::bitstring::bits_memcmp(x->first, y->first, key_bits) < 0;
+  });
+  for (std::size_t i = 1; i < ptrs.size(); i++) {
+    if (!td::bitstring::bits_memcmp(ptrs[i - 1]->first, ptrs[i]->first, key_bits)) {
+      return -1;
+    }
+  }
+  int changes = 0;
+  auto root = dict_set_many(get_root_cell(), ptrs.data(), ptrs.data() + ptrs.size(), 0, key_bits, mode, changes);
+  if (changes) {
+    set_root_cell(std::move(root));
+  }
+  return changes;
+}
+
 std::pair<Ref<Cell>, int> DictionaryFixed::dict_filter(Ref<Cell> dict, td::BitPtr key, int n,
                                                        const DictionaryFixed::filter_func_t& check_leaf) const {
   // std::cerr << "dictionary filter for " << n << "-bit key = " << (key + n - key_bits).to_hex(key_bits - n)
@@ -2657,6 +2864,16 @@ Ref<CellSlice> AugmentedDictionary::lookup(td::ConstBitPtr key, int key_len) {
   return extract_value(lookup_with_extra(key, key_len));
 }
 
+std::vector<Ref<CellSlice>> AugmentedDictionary::lookup_many(const std::vector<td::ConstBitPtr>& keys) {
+  auto values = DictionaryFixed::lookup_many(keys);
+  for (auto& value : values) {
+    if (value.not_null()) {
+      value = extract_value(std::move(value));
+    }
+  }
+  return values;
+}
+
 Ref<Cell> AugmentedDictionary::lookup_ref(td::ConstBitPtr key, int key_len) {
   return extract_value_ref(lookup_with_extra(key, key_len));
 }
@@ -185,6 +185,7 @@ class DictionaryFixed : public DictionaryBase {
   typedef std::function<bool(CellBuilder&, Ref<CellSlice>, Ref<CellSlice>, td::ConstBitPtr, int)> combine_func_t;
   typedef std::function<bool(Ref<CellSlice>, td::ConstBitPtr, int)> foreach_func_t;
   typedef std::function<bool(td::ConstBitPtr, int, Ref<CellSlice>, Ref<CellSlice>)> scan_diff_func_t;
+  typedef std::pair<td::ConstBitPtr, Ref<CellSlice>> entry_t;
 
   DictionaryFixed(int _n, bool validate = true) : DictionaryBase(_n, validate) {
   }
@@ -223,6 +224,15 @@ class DictionaryFixed : public DictionaryBase {
   int get_common_prefix(td::BitPtr buffer, unsigned buffer_len);
   bool cut_prefix_subdict(td::ConstBitPtr prefix, int prefix_len, bool remove_prefix = false);
   Ref<vm::Cell> extract_prefix_subdict_root(td::ConstBitPtr prefix, int prefix_len, bool remove_prefix = false);
+  // fills an empty dictionary with entries sorted by key (increasing, without duplicates),
+  // creating each cell exactly once instead of rebuilding the path to the root for every key as set() does
+  bool build_sorted(const std::vector<entry_t>& entries);
+  // looks up all keys (of key_bits bits) in one walk, loading each node on their common paths once;
+  // returns the values in the order of keys, null for absent keys
+  std::vector<Ref<CellSlice>> lookup_many(const std::vector<td::ConstBitPtr>& keys);
+  // sets all entries (keys in any order, but distinct) as set() with the same mode would,
+  // creating one new root for the whole batch; returns the number of entries set, or -1 for invalid entries
+  int set_many(const std::vector<entry_t>& entries, SetMode mode = SetMode::Set);
   bool check_for_each(const foreach_func_t& foreach_func, bool invert_first = false);
   int filter(filter_func_t check);
   bool combine_with(DictionaryFixed& dict2, const combine_func_t& combine_func, int mode = 0);
@@ -294,6 +304,12 @@ class DictionaryFixed : public DictionaryBase {
   bool dict_check_for_each(Ref<Cell> dict, td::BitPtr key_buffer, int n, int total_key_len,
                            const foreach_func_t& foreach_func, bool invert_first = false) const;
   std::pair<Ref<Cell>, int> dict_filter(Ref<Cell> dict, td::BitPtr key, int n, const filter_func_t& check_leaf) const;
+  Ref<Cell> dict_build_sorted(const entry_t* const* begin, const entry_t* const* end, int pos, int n) const;
+  void dict_lookup_many(Ref<Cell> dict, const std::size_t* begin, const std::size_t* end,
+                        const std::vector<td::ConstBitPtr>& keys, int pos, int n,
+                        std::vector<Ref<CellSlice>>& values) const;
+  Ref<Cell> dict_set_many(Ref<Cell> dict, const entry_t* const* begin, const entry_t* const* end, int pos, int n,
+                          SetMode mode, int& changes) const;
   Ref<Cell> dict_combine_with(Ref<Cell> dict1, Ref<Cell> dict2, td::BitPtr key_buffer, int n, int total_key_len,
                               const combine_func_t& combine_func, int mode = 0, int skip1 = 0, int skip2 = 0) const;
   bool dict_scan_diff(Ref<Cell> dict1, Ref<Cell> dict2, td::BitPtr key_buffer, int n, int total_key_len,
@@ -576,6 +592,7 @@ class AugmentedDictionary final : public DictionaryFixed {
   Ref<CellSlice> lookup(td::ConstBitPtr key, int key_len);
   Ref<Cell> lookup_ref(td::ConstBitPtr key, int key_len);
   Ref<CellSlice> lookup_with_extra(td::ConstBitPtr key, int key_len);
+  std::vector<Ref<CellSlice>> lookup_many(const std::vector<td::ConstBitPtr>& keys);
   std::pair<Ref<CellSlice>, Ref<CellSlice>> lookup_extra(td::ConstBitPtr key, int key_len);
   std::pair<Ref<Cell>, Ref<CellSlice>> lookup_ref_extra(td::ConstBitPtr key, int key_len);
   Ref<CellSlice> lookup_delete(td::ConstBitPtr key, int key_len);
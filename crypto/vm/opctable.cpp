@@ -57,10 +57,35 @@ DispatchTable* OpcodeTable::finalize() {
   }
 
   instruction_list.shrink_to_fit();
+  build_lookup_tables();
   final = true;
   return this;
 }
 
+void OpcodeTable::build_lookup_tables() {
+  const unsigned top_shift = max_opcode_bits - lookup_byte_bits, sub_shift = top_shift - lookup_byte_bits;
+  lookup_top.assign(lookup_byte_count, nullptr);
+  lookup_sub_offset.assign(lookup_byte_count, 0);
+  lookup_sub.clear();
+  for (unsigned i = 0; i < lookup_byte_count; i++) {
+    lookup_top[i] = find_instr_covering(i << top_shift, (i + 1) << top_shift);
+    if (lookup_top[i]) {
+      continue;
+    }
+    lookup_sub_offset[i] = (unsigned)lookup_sub.size();
+    for (unsigned j = 0; j < lookup_byte_count; j++) {
+      unsigned opcode_min = (i << top_shift) | (j << sub_shift);
+      lookup_sub.push_back(find_instr_covering(opcode_min, opcode_min + (1U << sub_shift)));
+    }
+  }
+  lookup_sub.shrink_to_fit();
+}
+
+const OpcodeInstr* OpcodeTable::find_instr_covering(unsigned opcode_min, unsigned opcode_max) const {
+  auto instr = find_instr(opcode_min);
+  return instr->get_opcode_max() >= opcode_max ? instr : nullptr;
+}
+
 OpcodeTable& OpcodeTable::insert(const OpcodeInstr* instr) {
   LOG_IF(FATAL, !insert_bool(instr)) << td::format::lambda([&](auto& sb) {
     sb << "cannot insert instruction into table " << name << ": ";
@@ -100,7 +125,7 @@ bool OpcodeTable::insert_bool(const OpcodeInstr* instr) {
   return true;
 }
 
-const OpcodeInstr* OpcodeTable::lookup_instr(unsigned opcode, unsigned bits) const {
+const OpcodeInstr* OpcodeTable::find_instr(unsigned opcode) const {
   std::size_t i = 0, j = instruction_list.size();
   assert(j);
   while (j - i > 1) {
@@ -114,6 +139,31 @@ const OpcodeInstr* OpcodeTable::lookup_instr(unsigned opcode, unsigned bits) con
   return instruction_list[i].second;
 }
 
+bool OpcodeTable::check_lookup_tables() const {
+  if (!final) {
+    return false;
+  }
+  for (unsigned opcode = 0; opcode < top_opcode; opcode++) {
+    if (lookup_instr(opcode, max_opcode_bits) != find_instr(opcode)) {
+      LOG(ERROR) << "opcode table " << name << ": direct lookup of opcode " << td::format::as_hex(opcode)
+                 << " differs from the binary search";
+      return false;
+    }
+  }
+  return true;
+}
+
+const OpcodeInstr* OpcodeTable::lookup_instr(unsigned opcode, unsigned bits) const {
+  unsigned top = opcode >> (max_opcode_bits - lookup_byte_bits);
+  auto instr = lookup_top[top];
+  if (instr) {
+    return instr;
+  }
+  unsigned sub = (opcode >> (max_opcode_bits - 2 * lookup_byte_bits)) & (lookup_byte_count - 1);
+  instr = lookup_sub[lookup_sub_offset[top] + sub];
+  return instr ? instr : find_instr(opcode);
+}
+
 const OpcodeInstr* OpcodeTable::lookup_instr(const CellSlice& cs, unsigned& opcode, unsigned& bits) const {
   bits = max_opcode_bits;
   unsigned long long prefetch = cs.prefetch_ulong_top(bits);
@@ -88,6 +88,11 @@ dump_arg_instr_func_t dump_2c_add(unsigned add, std::string prefix, std::string
 class OpcodeTable : public DispatchTable {
   std::map<unsigned, const OpcodeInstr*> instructions;
   std::vector<std::pair<unsigned, const OpcodeInstr*>> instruction_list;
+  // direct lookup tables built by finalize(), indexed by the first and by the first two bytes of the opcode;
+  // nullptr means that the range is split between several instructions and the next level must be consulted
+  std::vector<const OpcodeInstr*> lookup_top;
+  std::vector<unsigned> lookup_sub_offset;
+  std::vector<const OpcodeInstr*> lookup_sub;
   std::string name;
   Codepage codepage;
   bool final;
@@ -109,8 +114,14 @@ class OpcodeTable : public DispatchTable {
   int instr_len(const CellSlice& cs) const override;
   bool insert_bool(const OpcodeInstr*);
   OpcodeTable& insert(const OpcodeInstr*);
+  // checks that the direct lookup tables give the same instruction as the binary search for every opcode
+  bool check_lookup_tables() const;
 
  private:
+  enum { lookup_byte_bits = 8, lookup_byte_count = 1 << lookup_byte_bits };
+  void build_lookup_tables();
+  const OpcodeInstr* find_instr(unsigned opcode) const;
+  const OpcodeInstr* find_instr_covering(unsigned opcode_min, unsigned opcode_max) const;
   const OpcodeInstr* lookup_instr(unsigned opcode, unsigned bits) const;
   const OpcodeInstr* lookup_instr(const CellSlice& cs, unsigned& opcode, unsigned& bits) const;
 };
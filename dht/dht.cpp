@@ -100,8 +100,12 @@ void DhtMemberImpl::start_up() {
   alarm_timestamp() = td::Timestamp::in(1.0);
 
   if (!db_root_.empty()) {
+    td::RocksDbOptions db_options;
+    db_options.workload = td::RocksDbOptions::Workload::SmallWrites;
     std::shared_ptr<td::KeyValue> kv = std::make_shared<td::RocksDb>(
-        td::RocksDb::open(PSTRING() << db_root_ << "/dht-" << td::base64url_encode(id_.as_slice())).move_as_ok());
+        td::RocksDb::open(PSTRING() << db_root_ << "/dht-" << td::base64url_encode(id_.as_slice()),
+                          std::move(db_options))
+            .move_as_ok());
     for (td::uint32 bit = 0; bit < 256; bit++) {
       auto key = create_hash_tl_object<ton_api::dht_db_key_bucket>(bit);
       std::string value;
@@ -58,7 +58,7 @@ td::Result<KeyringImpl::PrivateKeyDescr *> KeyringImpl::load_key(PublicKeyHash k
   auto short_id = pub.compute_short_id();
   CHECK(short_id == key_hash);
 
-  auto D = key.create_decryptor_async();
+  auto D = key.create_decryptor();
   D.ensure();
 
   return map_.emplace(short_id, std::make_unique<PrivateKeyDescr>(D.move_as_ok(), pub, false)).first->second.get();
@@ -76,7 +76,7 @@ void KeyringImpl::add_key(PrivateKey key, bool is_temp, td::Promise<td::Unit> pr
   if (db_root_.size() == 0) {
     CHECK(is_temp);
   }
-  auto D = key.create_decryptor_async();
+  auto D = key.create_decryptor();
   D.ensure();
 
   map_.emplace(short_id, std::make_unique<PrivateKeyDescr>(D.move_as_ok(), pub, is_temp));
@@ -186,6 +186,11 @@ void KeyringImpl::decrypt_message(PublicKeyHash key_hash, td::BufferSlice data,
   }
 }
 
+void KeyringImpl::get_decryptor(PublicKeyHash key_hash, td::Promise<std::shared_ptr<Decryptor>> promise) {
+  TRY_RESULT_PROMISE(promise, descr, load_key(key_hash));
+  promise.set_value(std::shared_ptr<Decryptor>(descr->shared_decryptor));
+}
+
 td::actor::ActorOwn<Keyring> Keyring::create(std::string db_root) {
   return td::actor::create_actor<KeyringImpl>("keyring", db_root);
 }
@@ -43,6 +43,8 @@ class Keyring : public td::actor::Actor {
                              td::Promise<std::vector<td::Result<td::BufferSlice>>> promise) = 0;
 
   virtual void decrypt_message(PublicKeyHash key_hash, td::BufferSlice data, td::Promise<td::BufferSlice> promise) = 0;
+  // decryptors don't change their state, so the returned one may be used from several threads at once
+  virtual void get_decryptor(PublicKeyHash key_hash, td::Promise<std::shared_ptr<Decryptor>> promise) = 0;
 
   static td::actor::ActorOwn<Keyring> create(std::string db_root);
 };
@@ -31,10 +31,14 @@ class KeyringImpl : public Keyring {
  private:
   struct PrivateKeyDescr {
     td::actor::ActorOwn<DecryptorAsync> decryptor;
+    std::shared_ptr<Decryptor> shared_decryptor;
     PublicKey public_key;
     bool is_temp;
-    PrivateKeyDescr(td::actor::ActorOwn<DecryptorAsync> decryptor, PublicKey public_key, bool is_temp)
-        : decryptor(std::move(decryptor)), public_key(public_key), is_temp(is_temp) {
+    PrivateKeyDescr(std::shared_ptr<Decryptor> d, PublicKey public_key, bool is_temp)
+        : decryptor(td::actor::create_actor<DecryptorAsync>("decryptor", d))
+        , shared_decryptor(std::move(d))
+        , public_key(public_key)
+        , is_temp(is_temp) {
     }
   };
 
@@ -56,6 +60,7 @@ class KeyringImpl : public Keyring {
                      td::Promise<std::vector<td::Result<td::BufferSlice>>> promise) override;
 
   void decrypt_message(PublicKeyHash key_hash, td::BufferSlice data, td::Promise<td::BufferSlice> promise) override;
+  void get_decryptor(PublicKeyHash key_hash, td::Promise<std::shared_ptr<Decryptor>> promise) override;
 
   KeyringImpl(std::string db_root) : db_root_(db_root) {
   }
@@ -94,6 +94,31 @@ td::Status EncryptorEd25519::check_signature(td::Slice message, td::Slice signat
   return td::status_prefix(pub_.verify_signature(message, signature), "bad signature: ");
 }
 
+td::Status Encryptor::check_signatures_batch(td::Span<SignatureCheck> checks) {
+  std::vector<td::Ed25519::SignatureCheck> ed25519_checks;
+  std::vector<size_t> ed25519_indices;
+  ed25519_checks.reserve(checks.size());
+  ed25519_indices.reserve(checks.size());
+  for (size_t i = 0; i < checks.size(); i++) {
+    auto &check = checks[i];
+    auto E = dynamic_cast<EncryptorEd25519 *>(check.encryptor);
+    if (E) {
+      ed25519_checks.push_back(td::Ed25519::SignatureCheck{&E->public_key(), check.message, check.signature});
+      ed25519_indices.push_back(i);
+    } else {
+      TRY_STATUS_PREFIX(check.encryptor->check_signature(check.message, check.signature),
+                        PSTRING() << "signature #" << i << ": ");
+    }
+  }
+  size_t bad_index = 0;
+  auto S = td::Ed25519::verify_signatures_batch(ed25519_checks, &bad_index);
+  if (S.is_error()) {
+    return td::Status::Error(PSLICE() << "signature #" << ed25519_indices[bad_index] << ": bad signature: "
+                                      << S.message());
+  }
+  return td::Status::OK();
+}
+
 td::Result<td::BufferSlice> DecryptorEd25519::decrypt(td::Slice data) {
   if (data.size() < td::Ed25519::PublicKey::LENGTH + 32) {
     return td::Status::Error(ErrorCode::protoviolation, "message is too short");
@@ -20,6 +20,7 @@
 
 #include "td/actor/actor.h"
 #include "td/utils/buffer.h"
+#include "td/utils/Span.h"
 #include "td/utils/Status.h"
 #include "td/actor/PromiseFuture.h"
 #include "auto/tl/ton_api.h"
@@ -28,10 +29,18 @@ namespace ton {
 
 class Encryptor {
  public:
+  struct SignatureCheck {
+    Encryptor *encryptor;
+    td::Slice message;
+    td::Slice signature;
+  };
+
   virtual td::Result<td::BufferSlice> encrypt(td::Slice data) = 0;
   virtual td::Status check_signature(td::Slice message, td::Slice signature) = 0;
   virtual ~Encryptor() = default;
   static td::Result<std::unique_ptr<Encryptor>> create(const ton_api::PublicKey *id);
+  // checks all signatures in one batch; the error names the first bad signature
+  static td::Status check_signatures_batch(td::Span<SignatureCheck> checks);
 };
 
 class Decryptor {
@@ -75,10 +84,10 @@ class EncryptorAsync : public td::actor::Actor {
 
 class DecryptorAsync : public td::actor::Actor {
  private:
-  std::unique_ptr<Decryptor> decryptor_;
+  std::shared_ptr<Decryptor> decryptor_;
 
  public:
-  DecryptorAsync(std::unique_ptr<Decryptor> decryptor) : decryptor_(std::move(decryptor)) {
+  DecryptorAsync(std::shared_ptr<Decryptor> decryptor) : decryptor_(std::move(decryptor)) {
   }
   auto decrypt(td::BufferSlice data) {
     return decryptor_->decrypt(data.as_slice());
@@ -85,6 +85,9 @@ class EncryptorEd25519 : public Encryptor {
 
   EncryptorEd25519(td::Bits256 key) : pub_(td::SecureString(as_slice(key))) {
   }
+  const td::Ed25519::PublicKey &public_key() const {
+    return pub_;
+  }
 };
 
 class DecryptorEd25519 : public Decryptor {
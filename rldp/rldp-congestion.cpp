@@ -0,0 +1,172 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#include "rldp-congestion.h"
+
+#include <algorithm>
+
+namespace ton {
+
+namespace rldp {
+
+namespace {
+
+constexpr double startup_gain() {
+  return 2.885;
+}
+
+constexpr double window_gain() {
+  return 2.0;
+}
+
+// rate used before the first measurement, the same as the old fixed pacing
+constexpr double initial_bandwidth() {
+  return 1000.0;
+}
+
+// maximal delivery rate over this many rounds is used as the bandwidth estimate
+constexpr size_t bandwidth_filter_rounds() {
+  return 10;
+}
+
+// min_rtt older than this is replaced by the next sample
+constexpr double min_rtt_ttl() {
+  return 10.0;
+}
+
+constexpr double probe_gains[] = {1.25, 0.75, 1, 1, 1, 1, 1, 1};
+
+}  // namespace
+
+RldpCongestionControl::RldpCongestionControl(State state, double now) {
+  if (state.bandwidth > 0 && now - state.updated_at < state_ttl()) {
+    mode_ = Mode::ProbeBandwidth;
+    bandwidth_ = state.bandwidth;
+    bandwidth_samples_.push_back(state.bandwidth);
+    min_rtt_ = state.min_rtt;
+    min_rtt_at_ = state.min_rtt_at;
+  }
+}
+
+RldpCongestionControl::State RldpCongestionControl::get_state(double now) const {
+  State state;
+  state.bandwidth = bandwidth_;
+  state.min_rtt = min_rtt_;
+  state.min_rtt_at = min_rtt_at_;
+  state.updated_at = now;
+  return state;
+}
+
+double RldpCongestionControl::pacing_gain() const {
+  if (mode_ == Mode::Startup) {
+    return startup_gain();
+  }
+  return probe_gains[cycle_index_];
+}
+
+double RldpCongestionControl::pacing_rate() const {
+  auto bandwidth = bandwidth_ > 0 ? bandwidth_ : initial_bandwidth();
+  return pacing_gain() * bandwidth;
+}
+
+td::uint32 RldpCongestionControl::window() const {
+  auto bandwidth = bandwidth_ > 0 ? bandwidth_ : initial_bandwidth();
+  auto gain = mode_ == Mode::Startup ? startup_gain() : window_gain();
+  auto window = gain * bandwidth * rtt();
+  return static_cast<td::uint32>(std::max<double>(min_window(), std::min<double>(max_window(), window)));
+}
+
+void RldpCongestionControl::on_send(td::uint32 seqno, double now) {
+  if (send_time_.size() <= seqno) {
+    send_time_.resize(seqno + 1, 0);
+  }
+  send_time_[seqno] = now;
+  if (!round_started_) {
+    start_round(now);
+  }
+}
+
+void RldpCongestionControl::on_confirm(td::uint32 seqno, double now) {
+  if (has_confirm_ && seqno <= confirmed_seqno_) {
+    return;
+  }
+  if (seqno < send_time_.size() && send_time_[seqno] > 0) {
+    update_rtt(now - send_time_[seqno], now);
+  }
+  td::uint32 sent = has_confirm_ ? seqno - confirmed_seqno_ : seqno + 1;
+  round_delivered_ += std::min(sent, symbols_per_confirm());
+  has_confirm_ = true;
+  confirmed_seqno_ = seqno;
+  if (round_started_ && seqno >= round_end_seqno_) {
+    end_round(now);
+  }
+}
+
+void RldpCongestionControl::on_part_completed() {
+  send_time_.clear();
+  has_confirm_ = false;
+  confirmed_seqno_ = 0;
+  round_started_ = false;
+}
+
+void RldpCongestionControl::start_round(double now) {
+  round_started_ = true;
+  round_end_seqno_ = static_cast<td::uint32>(send_time_.size());
+  round_start_ = now;
+  round_delivered_ = 0;
+}
+
+void RldpCongestionControl::end_round(double now) {
+  auto duration = now - round_start_;
+  if (duration > 0 && round_delivered_ > 0) {
+    bandwidth_samples_.push_back(static_cast<double>(round_delivered_) / duration);
+    if (bandwidth_samples_.size() > bandwidth_filter_rounds()) {
+      bandwidth_samples_.pop_front();
+    }
+    bandwidth_ = *std::max_element(bandwidth_samples_.begin(), bandwidth_samples_.end());
+  }
+
+  if (mode_ == Mode::Startup) {
+    // leave startup when the bandwidth has not grown by a quarter for three rounds
+    if (bandwidth_ >= full_bandwidth_ * 1.25) {
+      full_bandwidth_ = bandwidth_;
+      full_bandwidth_rounds_ = 0;
+    } else if (++full_bandwidth_rounds_ >= 3) {
+      mode_ = Mode::ProbeBandwidth;
+      // start with the draining phase of the cycle to get rid of the queue built during startup
+      cycle_index_ = 1;
+    }
+  } else {
+    cycle_index_ = (cycle_index_ + 1) % (sizeof(probe_gains) / sizeof(probe_gains[0]));
+  }
+  start_round(now);
+}
+
+void RldpCongestionControl::update_rtt(double rtt, double now) {
+  if (rtt <= 0) {
+    return;
+  }
+  if (min_rtt_ <= 0 || rtt <= min_rtt_ || now - min_rtt_at_ > min_rtt_ttl()) {
+    min_rtt_ = rtt;
+    min_rtt_at_ = now;
+  }
+}
+
+}  // namespace rldp
+
+}  // namespace ton
@@ -0,0 +1,111 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#pragma once
+
+#include "td/utils/common.h"
+
+#include <deque>
+#include <vector>
+
+namespace ton {
+
+namespace rldp {
+
+// BBR-style congestion control of RLDP transfers to one peer.
+//
+// The receiver sends a confirm after every symbols_per_confirm() received symbols, carrying the highest seqno
+// received so far. So each confirm means symbols_per_confirm() delivered symbols, and the time since the confirmed
+// symbol was sent is an RTT sample. Once per round trip the delivery rate is measured; the sender paces symbols at
+// the maximum recent delivery rate times a gain, and limits symbols in flight to twice the bandwidth-delay product.
+// Random loss does not reduce the rate, as lost symbols are covered by FEC anyway.
+class RldpCongestionControl {
+ public:
+  // part of the state which is kept between transfers to the same peer
+  struct State {
+    double bandwidth{0};  // symbols per second
+    double min_rtt{0};
+    double min_rtt_at{0};
+    double updated_at{0};
+  };
+
+  static constexpr td::uint32 symbols_per_confirm() {
+    return 10;
+  }
+  static constexpr double default_rtt() {
+    return 0.1;
+  }
+  static constexpr td::uint32 min_window() {
+    return 32;
+  }
+  static constexpr td::uint32 max_window() {
+    return 1 << 16;
+  }
+  // state of a peer without transfers for this long is not reused
+  static constexpr double state_ttl() {
+    return 60.0;
+  }
+
+  RldpCongestionControl(State state, double now);
+
+  State get_state(double now) const;
+
+  // maximal number of sent and not confirmed symbols
+  td::uint32 window() const;
+  // symbols per second
+  double pacing_rate() const;
+  double rtt() const {
+    return min_rtt_ > 0 ? min_rtt_ : default_rtt();
+  }
+
+  void on_send(td::uint32 seqno, double now);
+  void on_confirm(td::uint32 seqno, double now);
+  // seqnos of the next part start from zero again
+  void on_part_completed();
+
+ private:
+  enum class Mode { Startup, ProbeBandwidth };
+
+  Mode mode_{Mode::Startup};
+  double bandwidth_{0};
+  std::deque<double> bandwidth_samples_;
+  double full_bandwidth_{0};
+  td::uint32 full_bandwidth_rounds_{0};
+  td::uint32 cycle_index_{0};
+
+  double min_rtt_{0};
+  double min_rtt_at_{0};
+
+  std::vector<double> send_time_;
+  bool has_confirm_{false};
+  td::uint32 confirmed_seqno_{0};
+
+  bool round_started_{false};
+  td::uint32 round_end_seqno_{0};
+  double round_start_{0};
+  td::uint64 round_delivered_{0};
+
+  double pacing_gain() const;
+  void start_round(double now);
+  void end_round(double now);
+  void update_rtt(double rtt, double now);
+};
+
+}  // namespace rldp
+
+}  // namespace ton
@@ -61,9 +61,18 @@ class RldpIn : public RldpImpl {
   static constexpr td::uint32 lru_size() {
     return 128;
   }
+  // an incoming transfer which is not an answer to a streamed query is dropped if no part of it is received
+  // for this many seconds
+  static constexpr double receive_part_timeout() {
+    return 60.0;
+  }
   TransferId transfer(adnl::AdnlNodeIdShort src, adnl::AdnlNodeIdShort dst, td::Timestamp timeout, td::BufferSlice data,
                       TransferId t = TransferId::zero());
-  void transfer_completed(TransferId transfer_id) override;
+  TransferId transfer(adnl::AdnlNodeIdShort src, adnl::AdnlNodeIdShort dst, td::Timestamp timeout,
+                      std::unique_ptr<StreamSource> source, TransferId t = TransferId::zero());
+  void transfer_completed(TransferId transfer_id, adnl::AdnlNodeIdShort peer_id,
+                          RldpCongestionControl::State congestion_state) override;
+  void receive_finished(TransferId transfer_id) override;
 
   void send_message(adnl::AdnlNodeIdShort src, adnl::AdnlNodeIdShort dst, td::BufferSlice data) override;
   void send_message_ex(adnl::AdnlNodeIdShort src, adnl::AdnlNodeIdShort dst, td::Timestamp timeout,
@@ -79,7 +88,17 @@ class RldpIn : public RldpImpl {
   void answer_query(adnl::AdnlNodeIdShort src, adnl::AdnlNodeIdShort dst, td::Timestamp timeout,
                     adnl::AdnlQueryId query_id, TransferId transfer_id, td::BufferSlice data);
 
+  void send_query_stream(adnl::AdnlNodeIdShort src, adnl::AdnlNodeIdShort dst, std::string name,
+                         std::unique_ptr<StreamSink> sink, td::Timestamp timeout, td::BufferSlice data,
+                         td::uint64 max_answer_size) override;
+  void answer_query_stream(adnl::AdnlNodeIdShort src, adnl::AdnlNodeIdShort dst, td::Timestamp timeout,
+                           adnl::AdnlQueryId query_id, TransferId transfer_id, std::unique_ptr<StreamSource> source);
+  void subscribe_stream(adnl::AdnlNodeIdShort local_id, std::string prefix,
+                        std::unique_ptr<StreamCallback> callback) override;
+
   void alarm_query(adnl::AdnlQueryId query_id, TransferId transfer_id);
+  void stream_query_failed(TransferId transfer_id, td::Status error);
+  void stream_query_completed(TransferId transfer_id);
 
   void process_message_part(adnl::AdnlNodeIdShort source, adnl::AdnlNodeIdShort local_id,
                             ton_api::rldp_messagePart &part);
@@ -100,6 +119,9 @@ class RldpIn : public RldpImpl {
 
   void add_id(adnl::AdnlNodeIdShort local_id) override;
 
+  void start_up() override;
+  void alarm() override;
+
   RldpIn(td::actor::ActorId<adnl::AdnlPeerTable> adnl) : adnl_(adnl) {
   }
 
@@ -118,6 +140,24 @@ class RldpIn : public RldpImpl {
 
   std::map<TransferId, td::uint64> max_size_;
 
+  // the link to a peer is shared by all transfers to it, so the state describes the whole link, and every transfer
+  // starts with an equal part of the bandwidth
+  struct PeerCongestionState {
+    RldpCongestionControl::State state;
+    td::uint32 active_transfers{0};
+  };
+  std::map<adnl::AdnlNodeIdShort, PeerCongestionState> congestion_states_;
+
+  struct StreamQuery {
+    adnl::AdnlQueryId query_id;
+    td::Timestamp timeout;
+    // moved to the receiver when the answer starts arriving
+    std::unique_ptr<StreamSink> sink;
+  };
+  // by transfer id of the answer
+  std::map<TransferId, StreamQuery> stream_queries_;
+  std::map<std::pair<adnl::AdnlNodeIdShort, std::string>, std::unique_ptr<StreamCallback>> stream_callbacks_;
+
   std::set<adnl::AdnlNodeIdShort> local_ids_;
 };
 
@@ -28,31 +28,74 @@ namespace ton {
 namespace rldp {
 
 void RldpTransferSenderImpl::finish() {
-  td::actor::send_closure(rldp_, &RldpImpl::transfer_completed, transfer_id_);
+  td::actor::send_closure(rldp_, &RldpImpl::transfer_completed, transfer_id_, peer_id_,
+                          congestion_control_.get_state(td::Time::now()));
   stop();
 }
 
-void RldpTransferSenderImpl::create_encoder() {
-  if (part_ * slice_size() >= data_.size()) {
+td::uint64 RldpTransferSenderImpl::part_size(td::uint32 part) const {
+  return std::min(slice_size(), total_size_ - part * slice_size());
+}
+
+void RldpTransferSenderImpl::request_part(td::uint32 part) {
+  if (part * slice_size() >= total_size_) {
+    return;
+  }
+  source_->get_part(part * slice_size(), part_size(part),
+                    td::PromiseCreator::lambda([SelfId = actor_id(this), part](td::Result<td::BufferSlice> R) {
+                      td::actor::send_closure(SelfId, &RldpTransferSenderImpl::got_part, part, std::move(R));
+                    }));
+}
+
+void RldpTransferSenderImpl::got_part(td::uint32 part, td::Result<td::BufferSlice> R) {
+  if (R.is_error()) {
+    VLOG(RLDP_NOTICE) << "failed to get part " << part << " of transfer " << transfer_id_ << ": " << R.move_as_error();
     finish();
     return;
   }
-  td::BufferSlice D = data_.clone();
-  D.confirm_read(td::narrow_cast<std::size_t>(part_ * slice_size()));
-  if (D.size() > slice_size()) {
-    D.truncate(td::narrow_cast<std::size_t>(slice_size()));
+  auto data = R.move_as_ok();
+  if (data.size() != part_size(part)) {
+    VLOG(RLDP_WARNING) << "bad size of part " << part << " of transfer " << transfer_id_ << ": expected "
+                       << part_size(part) << ", got " << data.size();
+    finish();
+    return;
   }
-  fec_type_ = td::fec::RaptorQEncoder::Parameters{D.size(), symbol_size(), 0};
-  auto E = fec_type_.create_encoder(std::move(D));
+  CHECK(part == (encoder_ ? part_ + 1 : part_));
+  next_part_ = std::move(data);
+  next_part_ready_ = true;
+  if (!encoder_) {
+    start_next_part();
+  }
+}
+
+void RldpTransferSenderImpl::start_next_part() {
+  CHECK(next_part_ready_);
+  next_part_ready_ = false;
+  create_encoder(std::move(next_part_));
+  request_part(part_ + 1);
+  send_part();
+}
+
+void RldpTransferSenderImpl::create_encoder(td::BufferSlice data) {
+  fec_type_ = td::fec::RaptorQEncoder::Parameters{data.size(), symbol_size(), 0};
+  auto E = fec_type_.create_encoder(std::move(data));
   E.ensure();
   encoder_ = E.move_as_ok();
   seqno_ = 0;
   confirmed_seqno_ = 0;
+  congestion_control_.on_part_completed();
 }
 
 void RldpTransferSenderImpl::start_up() {
-  create_encoder();
-  alarm();
+  total_size_ = source_->size();
+  if (total_size_ == 0) {
+    finish();
+    return;
+  }
+  last_send_at_ = td::Time::now();
+  send_budget_ = min_send_batch();
+  alarm_timestamp() = timeout_;
+  request_part(0);
 }
 
 void RldpTransferSenderImpl::alarm() {
@@ -61,27 +104,47 @@ void RldpTransferSenderImpl::alarm() {
     finish();
     return;
   }
-  alarm_timestamp() = td::Timestamp::in(0.01);
+  if (!encoder_) {
+    alarm_timestamp() = timeout_;
+    return;
+  }
   send_part();
 }
 
 void RldpTransferSenderImpl::send_part() {
-  for (td::uint32 cnt = 0; cnt < 10; cnt++) {
-    if (seqno_ - confirmed_seqno_ <= window_size()) {
-      send_one_part(seqno_++);
-    } else {
+  auto now = td::Time::now();
+  auto rate = congestion_control_.pacing_rate();
+  // unused budget is not accumulated for longer than one alarm interval, so no big bursts are possible
+  send_budget_ = std::min(send_budget_ + (now - last_send_at_) * rate,
+                          std::max(min_send_batch(), rate * max_send_interval()));
+  last_send_at_ = now;
+
+  auto window = congestion_control_.window();
+  while (send_budget_ >= 1 && seqno_ - confirmed_seqno_ < window) {
+    send_one_part(seqno_++);
+    send_budget_ -= 1;
+  }
+  if (seqno_ - confirmed_seqno_ >= window) {
+    // the window is full; resend something from time to time, so that the receiver keeps confirming
+    // even if the last confirms were lost
+    if (now - last_probe_at_ >= max_send_interval()) {
       send_one_part(seqno_);
-      break;
+      last_probe_at_ = now;
     }
+    alarm_timestamp() = td::Timestamp::in(max_send_interval());
+    return;
   }
+  auto wait = (min_send_batch() - send_budget_) / rate;
+  alarm_timestamp() = td::Timestamp::in(std::max(0.001, std::min(max_send_interval(), wait)));
 }
 
 void RldpTransferSenderImpl::send_one_part(td::uint32 seqno) {
+  congestion_control_.on_send(seqno, td::Time::now());
   if (encoder_->get_info().ready_symbol_count <= seqno) {
     encoder_->prepare_more_symbols();
   }
   auto symbol = encoder_->gen_symbol(seqno);
-  auto obj = create_tl_object<ton_api::rldp_messagePart>(transfer_id_, fec_type_.tl(), part_, data_.size(), seqno,
+  auto obj = create_tl_object<ton_api::rldp_messagePart>(transfer_id_, fec_type_.tl(), part_, total_size_, seqno,
                                                          std::move(symbol.data));
   td::actor::send_closure(adnl_, &adnl::Adnl::send_message, local_id_, peer_id_, serialize_tl_object(obj, true));
 }
@@ -90,22 +153,29 @@ void RldpTransferSenderImpl::confirm(td::uint32 part, td::uint32 seqno) {
   if (part == part_) {
     if (seqno >= confirmed_seqno_ && seqno <= seqno_) {
       confirmed_seqno_ = seqno;
+      congestion_control_.on_confirm(seqno, td::Time::now());
     }
   }
 }
 
 void RldpTransferSenderImpl::complete(td::uint32 part) {
-  if (part == part_) {
+  if (part == part_ && encoder_) {
     part_++;
-    create_encoder();
+    encoder_ = nullptr;
+    if (part_ * slice_size() >= total_size_) {
+      finish();
+    } else if (next_part_ready_) {
+      start_next_part();
+    }
   }
 }
 
 td::actor::ActorOwn<RldpTransferSender> RldpTransferSender::create(
-    TransferId transfer_id, adnl::AdnlNodeIdShort local_id, adnl::AdnlNodeIdShort peer_id, td::BufferSlice data,
-    td::Timestamp timeout, td::actor::ActorId<RldpImpl> rldp, td::actor::ActorId<adnl::Adnl> adnl) {
-  return td::actor::create_actor<RldpTransferSenderImpl>("sender", transfer_id, local_id, peer_id, std::move(data),
-                                                         timeout, rldp, adnl);
+    TransferId transfer_id, adnl::AdnlNodeIdShort local_id, adnl::AdnlNodeIdShort peer_id,
+    std::unique_ptr<Rldp::StreamSource> source, td::Timestamp timeout, td::actor::ActorId<RldpImpl> rldp,
+    td::actor::ActorId<adnl::Adnl> adnl, RldpCongestionControl::State congestion_state) {
+  return td::actor::create_actor<RldpTransferSenderImpl>("sender", transfer_id, local_id, peer_id, std::move(source),
+                                                         timeout, rldp, adnl, congestion_state);
 }
 
 void RldpTransferReceiverImpl::receive_part(fec::FecType fec_type, td::uint32 part, td::uint64 total_size,
@@ -115,7 +185,7 @@ void RldpTransferReceiverImpl::receive_part(fec::FecType fec_type, td::uint32 pa
     td::actor::send_closure(adnl_, &adnl::Adnl::send_message, local_id_, peer_id_, serialize_tl_object(obj, true));
     return;
   }
-  if (part > part_) {
+  if (part > part_ || consuming_) {
     return;
   }
   cnt_++;
@@ -143,18 +213,17 @@ void RldpTransferReceiverImpl::receive_part(fec::FecType fec_type, td::uint32 pa
                                           << " data_size=" << data.data.size() << " part=" << part_));
         return;
       }
-      data_.as_slice().remove_prefix(td::narrow_cast<std::size_t>(offset_)).copy_from(data.data.as_slice());
-      offset_ += data.data.size();
-      auto obj = create_tl_object<ton_api::rldp_complete>(transfer_id_, part_);
-      td::actor::send_closure(adnl_, &adnl::Adnl::send_message, local_id_, peer_id_, serialize_tl_object(obj, true));
-      part_++;
-      cnt_ = 0;
-      max_seqno_ = 0;
+      // the part is completed only when the sink has consumed it, so that the sender does not run ahead of a slow
+      // sink; until then symbols of the part are ignored
+      consuming_ = true;
       decoder_ = nullptr;
-      if (offset_ == total_size_) {
-        finish();
-        return;
-      }
+      auto offset = offset_;
+      offset_ += data.data.size();
+      sink_->on_part(offset, std::move(data.data),
+                     td::PromiseCreator::lambda([SelfId = actor_id(this), part = part_](td::Result<td::Unit> R) {
+                       td::actor::send_closure(SelfId, &RldpTransferReceiverImpl::part_consumed, part, std::move(R));
+                     }));
+      return;
     }
   }
 
@@ -165,14 +234,38 @@ void RldpTransferReceiverImpl::receive_part(fec::FecType fec_type, td::uint32 pa
   }
 }
 
+void RldpTransferReceiverImpl::part_consumed(td::uint32 part, td::Result<td::Unit> R) {
+  CHECK(consuming_ && part == part_);
+  if (R.is_error()) {
+    abort(R.move_as_error_prefix("sink error: "));
+    return;
+  }
+  consuming_ = false;
+  auto obj = create_tl_object<ton_api::rldp_complete>(transfer_id_, part_);
+  td::actor::send_closure(adnl_, &adnl::Adnl::send_message, local_id_, peer_id_, serialize_tl_object(obj, true));
+  part_++;
+  cnt_ = 0;
+  max_seqno_ = 0;
+  if (offset_ == total_size_) {
+    finish();
+    return;
+  }
+  if (part_timeout_ > 0) {
+    timeout_ = td::Timestamp::in(part_timeout_);
+    alarm_timestamp() = timeout_;
+  }
+}
+
 void RldpTransferReceiverImpl::abort(td::Status reason) {
   VLOG(RLDP_NOTICE) << "aborted transfer receive: " << reason;
-  promise_.set_error(reason.move_as_error_prefix(PSTRING() << "rldptransfer " << transfer_id_ << ": "));
+  sink_->on_finish(reason.move_as_error_prefix(PSTRING() << "rldptransfer " << transfer_id_ << ": "));
+  td::actor::send_closure(rldp_, &RldpImpl::receive_finished, transfer_id_);
   stop();
 }
 
 void RldpTransferReceiverImpl::finish() {
-  promise_.set_value(data_.clone());
+  sink_->on_finish(td::Unit());
+  td::actor::send_closure(rldp_, &RldpImpl::receive_finished, transfer_id_);
   stop();
 }
 
@@ -182,10 +275,10 @@ void RldpTransferReceiverImpl::alarm() {
 
 td::actor::ActorOwn<RldpTransferReceiver> RldpTransferReceiver::create(
     TransferId transfer_id, adnl::AdnlNodeIdShort local_id, adnl::AdnlNodeIdShort peer_id, td::uint64 total_size,
-    td::Timestamp timeout, td::actor::ActorId<RldpImpl> rldp, td::actor::ActorId<adnl::Adnl> adnl,
-    td::Promise<td::BufferSlice> promise) {
+    td::Timestamp timeout, double part_timeout, td::actor::ActorId<RldpImpl> rldp, td::actor::ActorId<adnl::Adnl> adnl,
+    std::unique_ptr<Rldp::StreamSink> sink) {
   return td::actor::create_actor<RldpTransferReceiverImpl>("receiver", transfer_id, local_id, peer_id, total_size,
-                                                           timeout, rldp, adnl, std::move(promise));
+                                                           timeout, part_timeout, rldp, adnl, std::move(sink));
 }
 
 }  // namespace rldp
@@ -20,6 +20,8 @@
 
 #include "adnl/adnl.h"
 #include "fec/fec.h"
+#include "rldp-congestion.h"
+#include "rldp.h"
 
 namespace ton {
 
@@ -37,9 +39,11 @@ class RldpTransferSender : public td::actor::Actor {
   virtual void complete(td::uint32 part) = 0;
 
   static td::actor::ActorOwn<RldpTransferSender> create(TransferId transfer_id, adnl::AdnlNodeIdShort local_id,
-                                                        adnl::AdnlNodeIdShort peer_id, td::BufferSlice data,
+                                                        adnl::AdnlNodeIdShort peer_id,
+                                                        std::unique_ptr<Rldp::StreamSource> source,
                                                         td::Timestamp timeout, td::actor::ActorId<RldpImpl> rldp,
-                                                        td::actor::ActorId<adnl::Adnl> adnl);
+                                                        td::actor::ActorId<adnl::Adnl> adnl,
+                                                        RldpCongestionControl::State congestion_state);
 };
 
 class RldpTransferReceiver : public td::actor::Actor {
@@ -49,11 +53,14 @@ class RldpTransferReceiver : public td::actor::Actor {
   virtual void receive_part(fec::FecType fec_type, td::uint32 part, td::uint64 total_size, td::uint32 seqno,
                             td::BufferSlice data) = 0;
 
+  // the transfer is aborted at timeout; if part_timeout is non-zero, the timeout is moved part_timeout seconds
+  // ahead every time a part is received
   static td::actor::ActorOwn<RldpTransferReceiver> create(TransferId transfer_id, adnl::AdnlNodeIdShort local_id,
                                                           adnl::AdnlNodeIdShort peer_id, td::uint64 total_size,
-                                                          td::Timestamp timeout, td::actor::ActorId<RldpImpl> rldp,
+                                                          td::Timestamp timeout, double part_timeout,
+                                                          td::actor::ActorId<RldpImpl> rldp,
                                                           td::actor::ActorId<adnl::Adnl> adnl,
-                                                          td::Promise<td::BufferSlice> promise);
+                                                          std::unique_ptr<Rldp::StreamSink> sink);
 };
 
 }  // namespace rldp
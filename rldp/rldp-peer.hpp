@@ -19,6 +19,7 @@
 #pragma once
 
 #include "rldp-peer.h"
+#include "rldp-congestion.h"
 #include "fec/fec.h"
 #include "rldp.hpp"
 
@@ -31,13 +32,18 @@ namespace rldp {
 class RldpTransferSenderImpl : public RldpTransferSender {
  public:
   static constexpr td::uint64 slice_size() {
-    return 2000000;
+    return Rldp::stream_part_size();
   }
   static constexpr td::uint32 symbol_size() {
     return 768;
   }
-  static constexpr td::uint32 window_size() {
-    return 1000;
+  // maximal interval between alarms, also the interval between probes when the window is full
+  static constexpr double max_send_interval() {
+    return 0.01;
+  }
+  // symbols sent in one go, so that alarms are not scheduled for every single symbol
+  static constexpr double min_send_batch() {
+    return 4;
   }
 
   void start_up() override;
@@ -47,21 +53,27 @@ class RldpTransferSenderImpl : public RldpTransferSender {
   void send_one_part(td::uint32 seqno);
   void confirm(td::uint32 part, td::uint32 seqno) override;
   void complete(td::uint32 part) override;
+  void got_part(td::uint32 part, td::Result<td::BufferSlice> R);
 
   RldpTransferSenderImpl(TransferId transfer_id, adnl::AdnlNodeIdShort local_id, adnl::AdnlNodeIdShort peer_id,
-                         td::BufferSlice data, td::Timestamp timeout, td::actor::ActorId<RldpImpl> rldp,
-                         td::actor::ActorId<adnl::Adnl> adnl)
+                         std::unique_ptr<Rldp::StreamSource> source, td::Timestamp timeout,
+                         td::actor::ActorId<RldpImpl> rldp, td::actor::ActorId<adnl::Adnl> adnl,
+                         RldpCongestionControl::State congestion_state)
       : transfer_id_(transfer_id)
       , local_id_(local_id)
       , peer_id_(peer_id)
-      , data_(std::move(data))
+      , source_(std::move(source))
       , timeout_(timeout)
       , rldp_(rldp)
-      , adnl_(adnl) {
+      , adnl_(adnl)
+      , congestion_control_(congestion_state, td::Time::now()) {
   }
 
  private:
-  void create_encoder();
+  td::uint64 part_size(td::uint32 part) const;
+  void request_part(td::uint32 part);
+  void start_next_part();
+  void create_encoder(td::BufferSlice data);
   void finish();
 
   TransferId transfer_id_;
@@ -71,36 +83,50 @@ class RldpTransferSenderImpl : public RldpTransferSender {
 
   td::uint32 seqno_ = 0;
   td::uint32 confirmed_seqno_ = 0;
+  // null while waiting for the data of the current part
   std::unique_ptr<td::fec::Encoder> encoder_;
   fec::FecType fec_type_;
-  td::BufferSlice data_;
+  std::unique_ptr<Rldp::StreamSource> source_;
+  td::uint64 total_size_ = 0;
   td::uint32 part_ = 0;
+  // data of the part following the one being sent
+  td::BufferSlice next_part_;
+  bool next_part_ready_ = false;
 
   td::Timestamp timeout_;
   td::actor::ActorId<RldpImpl> rldp_;
   td::actor::ActorId<adnl::Adnl> adnl_;
+
+  RldpCongestionControl congestion_control_;
+  // symbols which may be sent now according to the pacing rate
+  double send_budget_ = 0;
+  double last_send_at_ = 0;
+  double last_probe_at_ = 0;
 };
 
 class RldpTransferReceiverImpl : public RldpTransferReceiver {
  public:
   void receive_part(fec::FecType fec_type, td::uint32 part, td::uint64 total_size, td::uint32 seqno,
                     td::BufferSlice data) override;
+  void part_consumed(td::uint32 part, td::Result<td::Unit> R);
   void alarm() override;
   void start_up() override {
-    data_ = td::BufferSlice(td::narrow_cast<size_t>(total_size_));
+    alarm_timestamp() = timeout_;
   }
 
   RldpTransferReceiverImpl(TransferId transfer_id, adnl::AdnlNodeIdShort local_id, adnl::AdnlNodeIdShort peer_id,
-                           td::uint64 total_size, td::Timestamp timeout, td::actor::ActorId<RldpImpl> rldp,
-                           td::actor::ActorId<adnl::Adnl> adnl, td::Promise<td::BufferSlice> promise)
+                           td::uint64 total_size, td::Timestamp timeout, double part_timeout,
+                           td::actor::ActorId<RldpImpl> rldp, td::actor::ActorId<adnl::Adnl> adnl,
+                           std::unique_ptr<Rldp::StreamSink> sink)
       : transfer_id_(transfer_id)
       , local_id_(local_id)
       , peer_id_(peer_id)
       , total_size_(total_size)
       , timeout_(timeout)
+      , part_timeout_(part_timeout)
       , rldp_(rldp)
       , adnl_(adnl)
-      , promise_(std::move(promise)) {
+      , sink_(std::move(sink)) {
   }
 
  private:
@@ -117,15 +143,17 @@ class RldpTransferReceiverImpl : public RldpTransferReceiver {
   td::uint32 part_ = 0;
   td::uint32 cnt_ = 0;
   td::uint32 max_seqno_ = 0;
-  td::BufferSlice data_;
+  // the current part is decoded and the sink has not consumed it yet
+  bool consuming_ = false;
 
   std::unique_ptr<td::fec::Decoder> decoder_;
 
   td::Timestamp timeout_;
+  double part_timeout_;
   td::actor::ActorId<RldpImpl> rldp_;
   td::actor::ActorId<adnl::Adnl> adnl_;
 
-  td::Promise<td::BufferSlice> promise_;
+  std::unique_ptr<Rldp::StreamSink> sink_;
 };
 
 }  // namespace rldp
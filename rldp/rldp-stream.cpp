@@ -0,0 +1,183 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#include "rldp-stream.hpp"
+#include "auto/tl/ton_api.h"
+#include "common/errorcode.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ton {
+
+namespace rldp {
+
+void RldpBufferSource::get_part(td::uint64 offset, td::uint64 size, td::Promise<td::BufferSlice> promise) {
+  CHECK(offset + size <= data_.size());
+  auto part = data_.clone();
+  part.confirm_read(td::narrow_cast<std::size_t>(offset));
+  part.truncate(td::narrow_cast<std::size_t>(size));
+  promise.set_value(std::move(part));
+}
+
+void RldpBufferSink::on_part(td::uint64 offset, td::BufferSlice data, td::Promise<td::Unit> promise) {
+  CHECK(offset + data.size() <= total_size_);
+  if (data_.empty()) {
+    data_ = td::BufferSlice(td::narrow_cast<std::size_t>(total_size_));
+  }
+  data_.as_slice().substr(td::narrow_cast<std::size_t>(offset)).copy_from(data.as_slice());
+  promise.set_value(td::Unit());
+}
+
+void RldpBufferSink::on_finish(td::Result<td::Unit> result) {
+  if (result.is_error()) {
+    promise_.set_error(result.move_as_error());
+  } else {
+    promise_.set_value(std::move(data_));
+  }
+}
+
+RldpAnswerSource::RldpAnswerSource(adnl::AdnlQueryId query_id, std::unique_ptr<Rldp::StreamSource> source)
+    : data_size_(source->size()), source_(std::move(source)) {
+  td::int32 id = ton_api::rldp_answer::ID;
+  prefix_.append(reinterpret_cast<const char *>(&id), sizeof(id));
+  prefix_.append(query_id.as_slice().str());
+  // the same length encoding as in td::TlStorerUnsafe::store_string
+  if (data_size_ < 254) {
+    prefix_ += static_cast<char>(data_size_);
+  } else if (data_size_ < (1 << 24)) {
+    prefix_ += static_cast<char>(254);
+    for (int i = 0; i < 3; i++) {
+      prefix_ += static_cast<char>((data_size_ >> (8 * i)) & 255);
+    }
+  } else {
+    prefix_ += static_cast<char>(255);
+    for (int i = 0; i < 7; i++) {
+      prefix_ += static_cast<char>((data_size_ >> (8 * i)) & 255);
+    }
+  }
+  padding_ = (4 - (prefix_.size() + data_size_) % 4) % 4;
+}
+
+td::uint64 RldpAnswerSource::size() const {
+  return prefix_.size() + data_size_ + padding_;
+}
+
+void RldpAnswerSource::get_part(td::uint64 offset, td::uint64 size, td::Promise<td::BufferSlice> promise) {
+  td::uint64 data_begin = prefix_.size();
+  td::uint64 data_end = data_begin + data_size_;
+  auto begin = std::max(offset, data_begin);
+  auto end = std::min(offset + size, data_end);
+  if (begin == offset && end == offset + size) {
+    source_->get_part(offset - data_begin, size, std::move(promise));
+    return;
+  }
+
+  td::BufferSlice result(td::narrow_cast<std::size_t>(size));
+  if (offset < data_begin) {
+    auto len = std::min(size, data_begin - offset);
+    result.as_slice().copy_from(td::Slice(prefix_).substr(td::narrow_cast<std::size_t>(offset),
+                                                          td::narrow_cast<std::size_t>(len)));
+  }
+  if (offset + size > data_end) {
+    auto from = std::max(offset, data_end);
+    std::memset(result.data() + (from - offset), 0, td::narrow_cast<std::size_t>(offset + size - from));
+  }
+  if (begin >= end) {
+    promise.set_value(std::move(result));
+    return;
+  }
+  source_->get_part(begin - data_begin, end - begin,
+                    td::PromiseCreator::lambda([result = std::move(result), pos = begin - offset, len = end - begin,
+                                                promise = std::move(promise)](td::Result<td::BufferSlice> R) mutable {
+                      TRY_RESULT_PROMISE(promise, data, std::move(R));
+                      if (data.size() != len) {
+                        promise.set_error(td::Status::Error(ErrorCode::error, "bad size of stream part"));
+                        return;
+                      }
+                      result.as_slice().substr(td::narrow_cast<std::size_t>(pos)).copy_from(data.as_slice());
+                      promise.set_value(std::move(result));
+                    }));
+}
+
+td::Status RldpAnswerSink::parse_prefix(td::BufferSlice &data) {
+  auto S = data.as_slice();
+  if (S.size() < 37) {
+    return td::Status::Error(ErrorCode::protoviolation, "too short answer");
+  }
+  td::int32 id;
+  std::memcpy(&id, S.data(), sizeof(id));
+  if (id != ton_api::rldp_answer::ID) {
+    return td::Status::Error(ErrorCode::protoviolation, "not an rldp answer");
+  }
+  if (S.substr(4, 32) != query_id_.as_slice()) {
+    return td::Status::Error(ErrorCode::protoviolation, "query id mismatch");
+  }
+  auto header = S.ubegin() + 36;
+  std::size_t header_size;
+  if (header[0] < 254) {
+    data_size_ = header[0];
+    header_size = 1;
+  } else {
+    header_size = header[0] == 254 ? 4 : 8;
+    if (S.size() < 36 + header_size) {
+      return td::Status::Error(ErrorCode::protoviolation, "too short answer");
+    }
+    data_size_ = 0;
+    for (std::size_t i = header_size - 1; i > 0; i--) {
+      data_size_ = (data_size_ << 8) + header[i];
+    }
+  }
+  data.confirm_read(36 + header_size);
+  return td::Status::OK();
+}
+
+void RldpAnswerSink::on_part(td::uint64 offset, td::BufferSlice data, td::Promise<td::Unit> promise) {
+  if (!has_prefix_) {
+    TRY_STATUS_PROMISE(promise, parse_prefix(data));
+    has_prefix_ = true;
+  }
+  auto remaining = data_size_ - offset_;
+  if (data.size() > remaining) {
+    if (data.size() - remaining > 3) {
+      promise.set_error(td::Status::Error(ErrorCode::protoviolation, "answer is longer than declared"));
+      return;
+    }
+    // padding
+    data.truncate(td::narrow_cast<std::size_t>(remaining));
+  }
+  if (data.empty()) {
+    promise.set_value(td::Unit());
+    return;
+  }
+  auto data_offset = offset_;
+  offset_ += data.size();
+  sink_->on_part(data_offset, std::move(data), std::move(promise));
+}
+
+void RldpAnswerSink::on_finish(td::Result<td::Unit> result) {
+  if (result.is_ok() && (!has_prefix_ || offset_ != data_size_)) {
+    result = td::Status::Error(ErrorCode::protoviolation, "truncated answer");
+  }
+  sink_->on_finish(std::move(result));
+  completed_.set_value(td::Unit());
+}
+
+}  // namespace rldp
+
+}  // namespace ton
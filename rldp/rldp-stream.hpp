@@ -0,0 +1,95 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#pragma once
+
+#include "rldp.h"
+#include "adnl/adnl-query.h"
+
+namespace ton {
+
+namespace rldp {
+
+// whole transfer in memory
+class RldpBufferSource : public Rldp::StreamSource {
+ public:
+  explicit RldpBufferSource(td::BufferSlice data) : data_(std::move(data)) {
+  }
+  td::uint64 size() const override {
+    return data_.size();
+  }
+  void get_part(td::uint64 offset, td::uint64 size, td::Promise<td::BufferSlice> promise) override;
+
+ private:
+  td::BufferSlice data_;
+};
+
+// accumulates the transfer and returns it as a whole
+class RldpBufferSink : public Rldp::StreamSink {
+ public:
+  RldpBufferSink(td::uint64 total_size, td::Promise<td::BufferSlice> promise)
+      : total_size_(total_size), promise_(std::move(promise)) {
+  }
+  void on_part(td::uint64 offset, td::BufferSlice data, td::Promise<td::Unit> promise) override;
+  void on_finish(td::Result<td::Unit> result) override;
+
+ private:
+  td::uint64 total_size_;
+  td::BufferSlice data_;
+  td::Promise<td::BufferSlice> promise_;
+};
+
+// Streams an answer to an rldp query: the transfer is a serialized rldp.answer, i.e. the constructor id, the query id
+// and TL bytes (length, data, padding) around the data of the source.
+class RldpAnswerSource : public Rldp::StreamSource {
+ public:
+  RldpAnswerSource(adnl::AdnlQueryId query_id, std::unique_ptr<Rldp::StreamSource> source);
+  td::uint64 size() const override;
+  void get_part(td::uint64 offset, td::uint64 size, td::Promise<td::BufferSlice> promise) override;
+
+ private:
+  std::string prefix_;
+  td::uint64 data_size_;
+  td::uint64 padding_;
+  std::unique_ptr<Rldp::StreamSource> source_;
+};
+
+// Receives a streamed or an ordinary answer to an rldp query, strips the rldp.answer envelope and passes the data
+// to the sink.
+class RldpAnswerSink : public Rldp::StreamSink {
+ public:
+  RldpAnswerSink(adnl::AdnlQueryId query_id, std::unique_ptr<Rldp::StreamSink> sink, td::Promise<td::Unit> completed)
+      : query_id_(query_id), sink_(std::move(sink)), completed_(std::move(completed)) {
+  }
+  void on_part(td::uint64 offset, td::BufferSlice data, td::Promise<td::Unit> promise) override;
+  void on_finish(td::Result<td::Unit> result) override;
+
+ private:
+  td::Status parse_prefix(td::BufferSlice &data);
+
+  adnl::AdnlQueryId query_id_;
+  std::unique_ptr<Rldp::StreamSink> sink_;
+  td::Promise<td::Unit> completed_;
+  bool has_prefix_ = false;
+  td::uint64 data_size_ = 0;
+  td::uint64 offset_ = 0;
+};
+
+}  // namespace rldp
+
+}  // namespace ton
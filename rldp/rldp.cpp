@@ -17,8 +17,10 @@
     Copyright 2017-2019 Telegram Systems LLP
 */
 #include "rldp-in.hpp"
+#include "rldp-stream.hpp"
 #include "auto/tl/ton_api.h"
 #include "auto/tl/ton_api.hpp"
+#include "td/utils/misc.h"
 #include "td/utils/Random.h"
 #include "fec/fec.h"
 
@@ -28,6 +30,11 @@ namespace rldp {
 
 TransferId RldpIn::transfer(adnl::AdnlNodeIdShort src, adnl::AdnlNodeIdShort dst, td::Timestamp timeout,
                             td::BufferSlice data, TransferId t) {
+  return transfer(src, dst, timeout, std::make_unique<RldpBufferSource>(std::move(data)), t);
+}
+
+TransferId RldpIn::transfer(adnl::AdnlNodeIdShort src, adnl::AdnlNodeIdShort dst, td::Timestamp timeout,
+                            std::unique_ptr<StreamSource> source, TransferId t) {
   TransferId transfer_id;
   if (!t.is_zero()) {
     transfer_id = t;
@@ -35,8 +42,12 @@ TransferId RldpIn::transfer(adnl::AdnlNodeIdShort src, adnl::AdnlNodeIdShort dst
     td::Random::secure_bytes(transfer_id.as_slice());
   }
 
-  senders_.emplace(transfer_id,
-                   RldpTransferSender::create(transfer_id, src, dst, std::move(data), timeout, actor_id(this), adnl_));
+  auto &peer_state = congestion_states_[dst];
+  peer_state.active_transfers++;
+  auto congestion_state = peer_state.state;
+  congestion_state.bandwidth /= peer_state.active_transfers;
+  senders_.emplace(transfer_id, RldpTransferSender::create(transfer_id, src, dst, std::move(source), timeout,
+                                                           actor_id(this), adnl_, congestion_state));
   return transfer_id;
 }
 
@@ -87,11 +98,69 @@ void RldpIn::answer_query(adnl::AdnlNodeIdShort src, adnl::AdnlNodeIdShort dst,
   transfer(src, dst, timeout, std::move(B), transfer_id);
 }
 
+void RldpIn::send_query_stream(adnl::AdnlNodeIdShort src, adnl::AdnlNodeIdShort dst, std::string name,
+                               std::unique_ptr<StreamSink> sink, td::Timestamp timeout, td::BufferSlice data,
+                               td::uint64 max_answer_size) {
+  auto query_id = adnl::AdnlQuery::random_query_id();
+
+  auto date = static_cast<td::uint32>(timeout.at_unix()) + 1;
+  auto B = serialize_tl_object(create_tl_object<ton_api::rldp_query>(query_id, max_answer_size, date, std::move(data)),
+                               true);
+
+  auto transfer_id = transfer(src, dst, timeout, std::move(B)) ^ TransferId::ones();
+  max_size_[transfer_id] = max_answer_size;
+  stream_queries_[transfer_id] = StreamQuery{query_id, timeout, std::move(sink)};
+
+  // the query only keeps the timeout, the answer goes from the receiver straight to the sink
+  auto Q = adnl::AdnlQuery::create(
+      td::PromiseCreator::lambda([SelfId = actor_id(this), transfer_id](td::Result<td::BufferSlice> R) {
+        if (R.is_error()) {
+          td::actor::send_closure(SelfId, &RldpIn::stream_query_failed, transfer_id, R.move_as_error());
+        }
+      }),
+      [SelfId = actor_id(this), transfer_id](adnl::AdnlQueryId query_id) {
+        td::actor::send_closure(SelfId, &RldpIn::alarm_query, query_id, transfer_id);
+      },
+      name, timeout, query_id);
+  queries_.emplace(query_id, std::move(Q));
+}
+
+void RldpIn::answer_query_stream(adnl::AdnlNodeIdShort src, adnl::AdnlNodeIdShort dst, td::Timestamp timeout,
+                                 adnl::AdnlQueryId query_id, TransferId transfer_id,
+                                 std::unique_ptr<StreamSource> source) {
+  transfer(src, dst, timeout, std::make_unique<RldpAnswerSource>(query_id, std::move(source)), transfer_id);
+}
+
+void RldpIn::subscribe_stream(adnl::AdnlNodeIdShort local_id, std::string prefix,
+                              std::unique_ptr<StreamCallback> callback) {
+  stream_callbacks_[std::make_pair(local_id, std::move(prefix))] = std::move(callback);
+}
+
 void RldpIn::alarm_query(adnl::AdnlQueryId query_id, TransferId transfer_id) {
   queries_.erase(query_id);
   max_size_.erase(transfer_id);
 }
 
+void RldpIn::stream_query_failed(TransferId transfer_id, td::Status error) {
+  auto it = stream_queries_.find(transfer_id);
+  // if the answer is being received, the receiver reports the error
+  if (it == stream_queries_.end() || !it->second.sink) {
+    return;
+  }
+  it->second.sink->on_finish(std::move(error));
+  stream_queries_.erase(it);
+}
+
+void RldpIn::stream_query_completed(TransferId transfer_id) {
+  auto it = stream_queries_.find(transfer_id);
+  if (it == stream_queries_.end()) {
+    return;
+  }
+  queries_.erase(it->second.query_id);
+  stream_queries_.erase(it);
+  in_transfer_completed(transfer_id);
+}
+
 void RldpIn::receive_message_part(adnl::AdnlNodeIdShort source, adnl::AdnlNodeIdShort local_id, td::BufferSlice data) {
   auto F = fetch_tl_object<ton_api::rldp_MessagePart>(std::move(data), true);
   if (F.is_error()) {
@@ -132,19 +201,35 @@ void RldpIn::process_message_part(adnl::AdnlNodeIdShort source, adnl::AdnlNodeId
       td::actor::send_closure(adnl_, &adnl::Adnl::send_message, local_id, source, serialize_tl_object(obj, true));
       return;
     }
-    auto P = td::PromiseCreator::lambda(
-        [SelfId = actor_id(this), source, local_id, transfer_id = part.transfer_id_](td::Result<td::BufferSlice> R) {
-          if (R.is_error()) {
-            VLOG(RLDP_INFO) << "failed to receive: " << R.move_as_error();
-            return;
-          }
-          td::actor::send_closure(SelfId, &RldpIn::in_transfer_completed, transfer_id);
-          td::actor::send_closure(SelfId, &RldpIn::receive_message, source, local_id, transfer_id, R.move_as_ok());
-        });
+    std::unique_ptr<StreamSink> sink;
+    // answers to streamed queries are bounded by the query timeout, other transfers must receive a part in time
+    auto timeout = td::Timestamp::in(receive_part_timeout());
+    double part_timeout = receive_part_timeout();
+    auto its = stream_queries_.find(part.transfer_id_);
+    if (its != stream_queries_.end() && its->second.sink) {
+      sink = std::make_unique<RldpAnswerSink>(
+          its->second.query_id, std::move(its->second.sink),
+          td::PromiseCreator::lambda([SelfId = actor_id(this), transfer_id = part.transfer_id_](td::Unit) {
+            td::actor::send_closure(SelfId, &RldpIn::stream_query_completed, transfer_id);
+          }));
+      timeout = its->second.timeout;
+      part_timeout = 0;
+    } else {
+      auto P = td::PromiseCreator::lambda(
+          [SelfId = actor_id(this), source, local_id, transfer_id = part.transfer_id_](td::Result<td::BufferSlice> R) {
+            if (R.is_error()) {
+              VLOG(RLDP_INFO) << "failed to receive: " << R.move_as_error();
+              return;
+            }
+            td::actor::send_closure(SelfId, &RldpIn::in_transfer_completed, transfer_id);
+            td::actor::send_closure(SelfId, &RldpIn::receive_message, source, local_id, transfer_id, R.move_as_ok());
+          });
+      sink = std::make_unique<RldpBufferSink>(part.total_size_, std::move(P));
+    }
 
     receivers_.emplace(part.transfer_id_,
-                       RldpTransferReceiver::create(part.transfer_id_, local_id, source, part.total_size_,
-                                                    td::Timestamp::in(60.0), actor_id(this), adnl_, std::move(P)));
+                       RldpTransferReceiver::create(part.transfer_id_, local_id, source, part.total_size_, timeout,
+                                                    part_timeout, actor_id(this), adnl_, std::move(sink)));
     it = receivers_.find(part.transfer_id_);
   }
   auto F = fec::FecType::create(std::move(part.fec_type_));
@@ -191,6 +276,31 @@ void RldpIn::process_message(adnl::AdnlNodeIdShort source, adnl::AdnlNodeIdShort
 
 void RldpIn::process_message(adnl::AdnlNodeIdShort source, adnl::AdnlNodeIdShort local_id, TransferId transfer_id,
                              ton_api::rldp_query &message) {
+  for (auto it = stream_callbacks_.lower_bound(std::make_pair(local_id, std::string()));
+       it != stream_callbacks_.end() && it->first.first == local_id; ++it) {
+    if (!td::begins_with(message.data_.as_slice(), it->first.second)) {
+      continue;
+    }
+    auto S = td::PromiseCreator::lambda(
+        [SelfId = actor_id(this), source, local_id, timeout = td::Timestamp::at_unix(message.timeout_),
+         query_id = message.query_id_, max_answer_size = static_cast<td::uint64>(message.max_answer_size_),
+         transfer_id](td::Result<std::unique_ptr<StreamSource>> R) {
+          if (R.is_error()) {
+            VLOG(RLDP_NOTICE) << "rldp stream query failed: " << R.move_as_error();
+            return;
+          }
+          auto stream = R.move_as_ok();
+          if (stream->size() > max_answer_size) {
+            VLOG(RLDP_NOTICE) << "rldp stream query failed: answer too big";
+            return;
+          }
+          td::actor::send_closure(SelfId, &RldpIn::answer_query_stream, local_id, source, timeout, query_id,
+                                  transfer_id ^ TransferId::ones(), std::move(stream));
+        });
+    VLOG(RLDP_DEBUG) << "delivering rldp stream query";
+    it->second->receive_query(source, local_id, std::move(message.data_), std::move(S));
+    return;
+  }
   auto P = td::PromiseCreator::lambda([SelfId = actor_id(this), source, local_id,
                                        timeout = td::Timestamp::at_unix(message.timeout_), query_id = message.query_id_,
                                        max_answer_size = static_cast<td::uint64>(message.max_answer_size_),
@@ -223,11 +333,47 @@ void RldpIn::process_message(adnl::AdnlNodeIdShort source, adnl::AdnlNodeIdShort
   }
 }
 
-void RldpIn::transfer_completed(TransferId transfer_id) {
+void RldpIn::transfer_completed(TransferId transfer_id, adnl::AdnlNodeIdShort peer_id,
+                                RldpCongestionControl::State congestion_state) {
   senders_.erase(transfer_id);
+  auto it = congestion_states_.find(peer_id);
+  if (it != congestion_states_.end()) {
+    auto &peer_state = it->second;
+    CHECK(peer_state.active_transfers > 0);
+    if (congestion_state.bandwidth > 0) {
+      // the transfer measured its part of the link, which it shared with the other active transfers
+      congestion_state.bandwidth *= peer_state.active_transfers;
+      peer_state.state = congestion_state;
+    }
+    peer_state.active_transfers--;
+    if (peer_state.active_transfers == 0 && peer_state.state.bandwidth <= 0) {
+      congestion_states_.erase(it);
+    }
+  }
   VLOG(RLDP_DEBUG) << "rldp: completed transfer " << transfer_id << "; " << senders_.size() << " out transfer pending ";
 }
 
+void RldpIn::start_up() {
+  alarm_timestamp() = td::Timestamp::in(RldpCongestionControl::state_ttl());
+}
+
+void RldpIn::alarm() {
+  auto now = td::Time::now();
+  for (auto it = congestion_states_.begin(); it != congestion_states_.end();) {
+    if (it->second.active_transfers == 0 &&
+        now - it->second.state.updated_at >= RldpCongestionControl::state_ttl()) {
+      it = congestion_states_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  alarm_timestamp() = td::Timestamp::in(RldpCongestionControl::state_ttl());
+}
+
+void RldpIn::receive_finished(TransferId transfer_id) {
+  receivers_.erase(transfer_id);
+}
+
 void RldpIn::in_transfer_completed(TransferId transfer_id) {
   if (lru_set_.count(transfer_id) == 1) {
     return;
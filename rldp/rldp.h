@@ -37,6 +37,44 @@ class Rldp : public adnl::AdnlSenderInterface {
   virtual void send_message_ex(adnl::AdnlNodeIdShort src, adnl::AdnlNodeIdShort dst, td::Timestamp timeout,
                                td::BufferSlice data) = 0;
 
+  // Streamed transfers keep only a couple of parts of the data in memory, the rest is produced and consumed
+  // part by part. On the wire they are ordinary rldp transfers.
+  static constexpr td::uint64 stream_part_size() {
+    return 2000000;
+  }
+
+  class StreamSource {
+   public:
+    virtual ~StreamSource() = default;
+    virtual td::uint64 size() const = 0;
+    // requests exactly size bytes starting at offset; parts are requested in order, at most two at a time
+    virtual void get_part(td::uint64 offset, td::uint64 size, td::Promise<td::BufferSlice> promise) = 0;
+  };
+
+  class StreamSink {
+   public:
+    virtual ~StreamSink() = default;
+    // parts are delivered in order; the next part is not delivered until promise is set, an error aborts the transfer
+    virtual void on_part(td::uint64 offset, td::BufferSlice data, td::Promise<td::Unit> promise) = 0;
+    // called exactly once
+    virtual void on_finish(td::Result<td::Unit> result) = 0;
+  };
+
+  class StreamCallback {
+   public:
+    virtual ~StreamCallback() = default;
+    virtual void receive_query(adnl::AdnlNodeIdShort src, adnl::AdnlNodeIdShort dst, td::BufferSlice data,
+                               td::Promise<std::unique_ptr<StreamSource>> promise) = 0;
+  };
+
+  // the answer is handed to sink part by part
+  virtual void send_query_stream(adnl::AdnlNodeIdShort src, adnl::AdnlNodeIdShort dst, std::string name,
+                                 std::unique_ptr<StreamSink> sink, td::Timestamp timeout, td::BufferSlice data,
+                                 td::uint64 max_answer_size) = 0;
+  // rldp queries to local_id starting with prefix are answered from the stream returned by callback
+  virtual void subscribe_stream(adnl::AdnlNodeIdShort local_id, std::string prefix,
+                                std::unique_ptr<StreamCallback> callback) = 0;
+
   static td::actor::ActorOwn<Rldp> create(td::actor::ActorId<adnl::Adnl> adnl);
 };
 
@@ -40,7 +40,11 @@ using TransferId = td::Bits256;
 
 class RldpImpl : public Rldp {
  public:
-  virtual void transfer_completed(TransferId transfer_id) = 0;
+  // congestion_state is reused by the following transfers to the same peer
+  virtual void transfer_completed(TransferId transfer_id, adnl::AdnlNodeIdShort peer_id,
+                                  RldpCongestionControl::State congestion_state) = 0;
+  // the receiver of the transfer has finished or aborted it
+  virtual void receive_finished(TransferId transfer_id) = 0;
   //virtual void in_transfer_completed(TransferId transfer_id) = 0;
 };
 
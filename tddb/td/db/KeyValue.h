@@ -17,16 +17,137 @@
     Copyright 2017-2019 Telegram Systems LLP
 */
 #pragma once
+#include "td/utils/Span.h"
 #include "td/utils/Status.h"
 #include "td/utils/logging.h"
+#include "td/utils/misc.h"
+
+#include <memory>
+#include <vector>
+
 namespace td {
+// Iterator over an ordered range of keys. It sees the data as it was at the moment the iterator was created,
+// so writes made after that do not affect it.
+class KeyValueIterator {
+ public:
+  virtual ~KeyValueIterator() = default;
+  // false if the iterator has left the range or an error has occurred
+  virtual bool valid() const = 0;
+  // key and value are valid until the next call of next()
+  virtual Slice key() const = 0;
+  virtual Slice value() const = 0;
+  // moves to the next key in the direction of the iteration
+  virtual void next() = 0;
+  virtual Status status() const = 0;
+};
+
 class KeyValueReader {
  public:
   virtual ~KeyValueReader() = default;
   enum class GetStatus : int32 { Ok, NotFound };
 
+  struct IterateOptions {
+    // keys from [begin, end) are visited in lexicographical order; an empty end means that there is no upper bound
+    std::string begin;
+    std::string end;
+    bool reverse{false};
+    // hint for long sequential scans; 0 means the default of the storage
+    size_t readahead_size{0};
+
+    static IterateOptions range(Slice begin, Slice end, bool reverse = false) {
+      IterateOptions res;
+      res.begin = begin.str();
+      res.end = end.str();
+      res.reverse = reverse;
+      return res;
+    }
+    // all keys starting with the prefix
+    static IterateOptions prefix(Slice prefix, bool reverse = false) {
+      return range(prefix, prefix_end(prefix), reverse);
+    }
+  };
+
   virtual Result<GetStatus> get(Slice key, std::string &value) = 0;
   virtual Result<size_t> count(Slice prefix) = 0;
+
+  virtual Result<std::unique_ptr<KeyValueIterator>> iterator(const IterateOptions &options) {
+    return Status::Error("Iteration is not supported");
+  }
+
+  // looks up several keys at once; values are resized to the number of keys, and values[i] is meaningful only if
+  // the i-th returned status is Ok
+  virtual Result<std::vector<GetStatus>> get_multi(Span<Slice> keys, std::vector<std::string> &values) {
+    values.resize(keys.size());
+    std::vector<GetStatus> res;
+    res.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+      TRY_RESULT(status, get(keys[i], values[i]));
+      res.push_back(status);
+    }
+    return std::move(res);
+  }
+
+ protected:
+  // the smallest key greater than all keys starting with the prefix, or an empty string if there is no such key
+  static std::string prefix_end(Slice prefix) {
+    std::string res = prefix.str();
+    while (!res.empty() && static_cast<unsigned char>(res.back()) == 0xff) {
+      res.pop_back();
+    }
+    if (!res.empty()) {
+      res.back() = static_cast<char>(static_cast<unsigned char>(res.back()) + 1);
+    }
+    return res;
+  }
+
+  static Result<std::unique_ptr<KeyValueIterator>> iterator_prefixed(KeyValueReader &reader, Slice prefix,
+                                                                     const IterateOptions &options) {
+    class Iterator : public KeyValueIterator {
+     public:
+      Iterator(std::unique_ptr<KeyValueIterator> iterator, std::string prefix, bool check_prefix)
+          : iterator_(std::move(iterator)), prefix_(std::move(prefix)), check_prefix_(check_prefix) {
+      }
+      bool valid() const override {
+        return iterator_->valid() && (!check_prefix_ || begins_with(iterator_->key(), prefix_));
+      }
+      Slice key() const override {
+        return iterator_->key().substr(prefix_.size());
+      }
+      Slice value() const override {
+        return iterator_->value();
+      }
+      void next() override {
+        iterator_->next();
+      }
+      Status status() const override {
+        return iterator_->status();
+      }
+
+     private:
+      std::unique_ptr<KeyValueIterator> iterator_;
+      std::string prefix_;
+      bool check_prefix_;
+    };
+
+    IterateOptions prefixed_options = options;
+    prefixed_options.begin = PSTRING() << prefix << options.begin;
+    prefixed_options.end = options.end.empty() ? prefix_end(prefix) : PSTRING() << prefix << options.end;
+    // a prefix of 0xff bytes only has no end key, so the underlying range is not bounded from above
+    bool check_prefix = prefixed_options.end.empty() && !prefix.empty();
+    TRY_RESULT(iterator, reader.iterator(prefixed_options));
+    return std::make_unique<Iterator>(std::move(iterator), prefix.str(), check_prefix);
+  }
+
+  static Result<std::vector<GetStatus>> get_multi_prefixed(KeyValueReader &reader, Slice prefix, Span<Slice> keys,
+                                                           std::vector<std::string> &values) {
+    std::vector<std::string> prefixed_keys;
+    prefixed_keys.reserve(keys.size());
+    for (auto key : keys) {
+      prefixed_keys.push_back(PSTRING() << prefix << key);
+    }
+    std::vector<Slice> slices(prefixed_keys.begin(), prefixed_keys.end());
+    return reader.get_multi(slices, values);
+  }
 };
 
 class PrefixedKeyValueReader : public KeyValueReader {
@@ -37,9 +158,15 @@ class PrefixedKeyValueReader : public KeyValueReader {
   Result<GetStatus> get(Slice key, std::string &value) override {
     return reader_->get(PSLICE() << prefix_ << key, value);
   }
+  Result<std::vector<GetStatus>> get_multi(Span<Slice> keys, std::vector<std::string> &values) override {
+    return get_multi_prefixed(*reader_, prefix_, keys, values);
+  }
   Result<size_t> count(Slice prefix) override {
     return reader_->count(PSLICE() << prefix_ << prefix);
   }
+  Result<std::unique_ptr<KeyValueIterator>> iterator(const IterateOptions &options) override {
+    return iterator_prefixed(*reader_, prefix_, options);
+  }
 
  private:
   std::shared_ptr<KeyValueReader> reader_;
@@ -76,9 +203,15 @@ class PrefixedKeyValue : public KeyValue {
   Result<GetStatus> get(Slice key, std::string &value) override {
     return kv_->get(PSLICE() << prefix_ << key, value);
   }
+  Result<std::vector<GetStatus>> get_multi(Span<Slice> keys, std::vector<std::string> &values) override {
+    return get_multi_prefixed(*kv_, prefix_, keys, values);
+  }
   Result<size_t> count(Slice prefix) override {
     return kv_->count(PSLICE() << prefix_ << prefix);
   }
+  Result<std::unique_ptr<KeyValueIterator>> iterator(const IterateOptions &options) override {
+    return iterator_prefixed(*kv_, prefix_, options);
+  }
   Status set(Slice key, Slice value) override {
     return kv_->set(PSLICE() << prefix_ << key, value);
   }
@@ -20,6 +20,8 @@
 
 #include "td/utils/format.h"
 
+#include <algorithm>
+
 namespace td {
 Result<MemoryKeyValue::GetStatus> MemoryKeyValue::get(Slice key, std::string &value) {
   auto it = map_.find(key);
@@ -52,6 +54,47 @@ Result<size_t> MemoryKeyValue::count(Slice prefix) {
   return res;
 }
 
+namespace {
+class MemoryKeyValueIterator : public KeyValueIterator {
+ public:
+  explicit MemoryKeyValueIterator(std::vector<std::pair<std::string, std::string>> entries)
+      : entries_(std::move(entries)) {
+  }
+  bool valid() const override {
+    return pos_ < entries_.size();
+  }
+  Slice key() const override {
+    return entries_[pos_].first;
+  }
+  Slice value() const override {
+    return entries_[pos_].second;
+  }
+  void next() override {
+    pos_++;
+  }
+  Status status() const override {
+    return Status::OK();
+  }
+
+ private:
+  std::vector<std::pair<std::string, std::string>> entries_;
+  size_t pos_{0};
+};
+}  // namespace
+
+Result<std::unique_ptr<KeyValueIterator>> MemoryKeyValue::iterator(const IterateOptions &options) {
+  auto begin = map_.lower_bound(options.begin);
+  auto end = options.end.empty() ? map_.end() : map_.lower_bound(options.end);
+  std::vector<std::pair<std::string, std::string>> entries;
+  if (options.end.empty() || options.begin < options.end) {
+    entries.assign(begin, end);
+  }
+  if (options.reverse) {
+    std::reverse(entries.begin(), entries.end());
+  }
+  return std::make_unique<MemoryKeyValueIterator>(std::move(entries));
+}
+
 std::unique_ptr<KeyValueReader> MemoryKeyValue::snapshot() {
   auto res = std::make_unique<MemoryKeyValue>();
   res->map_ = map_;
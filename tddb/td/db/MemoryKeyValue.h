@@ -28,6 +28,8 @@ class MemoryKeyValue : public KeyValue {
   Status set(Slice key, Slice value) override;
   Status erase(Slice key) override;
   Result<size_t> count(Slice prefix) override;
+  // the iterator works with a copy of the range, so it may be used while the map is being changed
+  Result<std::unique_ptr<KeyValueIterator>> iterator(const IterateOptions &options) override;
 
   Status begin_transaction() override;
   Status commit_transaction() override;
@@ -19,6 +19,7 @@
 #include "td/db/RocksDb.h"
 
 #include "rocksdb/db.h"
+#include "rocksdb/filter_policy.h"
 #include "rocksdb/table.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/write_batch.h"
@@ -39,6 +40,41 @@ static Slice from_rocksdb(rocksdb::Slice slice) {
 static rocksdb::Slice to_rocksdb(Slice slice) {
   return rocksdb::Slice(slice.data(), slice.size());
 }
+
+static rocksdb::ColumnFamilyOptions get_column_family_options(RocksDbOptions::Workload workload,
+                                                              std::shared_ptr<rocksdb::Cache> cache) {
+  rocksdb::ColumnFamilyOptions options;
+  rocksdb::BlockBasedTableOptions table_options;
+  table_options.block_cache = std::move(cache);
+  switch (workload) {
+    case RocksDbOptions::Workload::Default:
+      break;
+    case RocksDbOptions::Workload::PointLookup:
+      // whole-key bloom filters let most lookups skip the files without the key, and the hash index inside
+      // data blocks replaces the binary search in them. Filters of a large database don't fit in memory, so
+      // filters and indexes are partitioned and their partitions are kept in the block cache, which bounds their
+      // memory. They are cached with high priority, so data blocks of other databases don't evict them, and only
+      // the small top-level blocks are pinned.
+      table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10, false));
+      table_options.data_block_index_type = rocksdb::BlockBasedTableOptions::kDataBlockBinaryAndHash;
+      table_options.index_type = rocksdb::BlockBasedTableOptions::kTwoLevelIndexSearch;
+      table_options.partition_filters = true;
+      table_options.cache_index_and_filter_blocks = true;
+      table_options.cache_index_and_filter_blocks_with_high_priority = true;
+      table_options.pin_top_level_index_and_filter = true;
+      break;
+    case RocksDbOptions::Workload::RangeScan:
+      // fewer and larger reads per scan, and better compression of similar neighbouring keys
+      table_options.block_size = 64 << 10;
+      break;
+    case RocksDbOptions::Workload::SmallWrites:
+      table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10, false));
+      options.write_buffer_size = 16 << 20;
+      break;
+  }
+  options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+  return options;
+}
 }  // namespace
 
 Status RocksDb::destroy(Slice path) {
@@ -59,26 +95,24 @@ RocksDb RocksDb::clone() const {
   return RocksDb{db_, statistics_};
 }
 
-Result<RocksDb> RocksDb::open(std::string path) {
+Result<RocksDb> RocksDb::open(std::string path, RocksDbOptions options) {
   rocksdb::OptimisticTransactionDB *db;
   auto statistics = rocksdb::CreateDBStatistics();
   {
-    rocksdb::Options options;
-
-    static auto cache = rocksdb::NewLRUCache(1 << 30);
+    // index and filter blocks are cached with high priority, so that up to half of the cache is kept for them
+    static auto shared_cache = rocksdb::NewLRUCache(1 << 30, -1, false, 0.5);
+    auto cache = options.block_cache_size == 0 ? shared_cache
+                                               : rocksdb::NewLRUCache(options.block_cache_size, -1, false, 0.5);
 
-    rocksdb::BlockBasedTableOptions table_options;
-    table_options.block_cache = cache;
-    options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
-
-    options.manual_wal_flush = true;
-    options.create_if_missing = true;
-    options.max_background_compactions = 4;
-    options.max_background_flushes = 2;
-    options.bytes_per_sync = 1 << 20;
-    options.writable_file_max_buffer_size = 2 << 14;
-    options.statistics = statistics;
-    TRY_STATUS(from_rocksdb(rocksdb::OptimisticTransactionDB::Open(options, std::move(path), &db)));
+    rocksdb::Options db_options(rocksdb::DBOptions(), get_column_family_options(options.workload, std::move(cache)));
+    db_options.manual_wal_flush = true;
+    db_options.create_if_missing = true;
+    db_options.max_background_compactions = 4;
+    db_options.max_background_flushes = 2;
+    db_options.bytes_per_sync = 1 << 20;
+    db_options.writable_file_max_buffer_size = 2 << 14;
+    db_options.statistics = statistics;
+    TRY_STATUS(from_rocksdb(rocksdb::OptimisticTransactionDB::Open(db_options, std::move(path), &db)));
   }
   return RocksDb(std::shared_ptr<rocksdb::OptimisticTransactionDB>(db), std::move(statistics));
 }
@@ -118,6 +152,44 @@ Result<RocksDb::GetStatus> RocksDb::get(Slice key, std::string &value) {
   return from_rocksdb(status);
 }
 
+Result<std::vector<RocksDb::GetStatus>> RocksDb::get_multi(Span<Slice> keys, std::vector<std::string> &values) {
+  std::vector<rocksdb::Slice> rocksdb_keys;
+  rocksdb_keys.reserve(keys.size());
+  for (auto key : keys) {
+    rocksdb_keys.push_back(to_rocksdb(key));
+  }
+  // the batched interface looks up all keys of one file at once and doesn't copy values found in the block cache
+  std::vector<rocksdb::PinnableSlice> rocksdb_values(keys.size());
+  std::vector<rocksdb::Status> statuses(keys.size());
+  auto column_family = db_->DefaultColumnFamily();
+  rocksdb::ReadOptions options;
+  if (snapshot_) {
+    options.snapshot = snapshot_.get();
+    db_->MultiGet(options, column_family, keys.size(), rocksdb_keys.data(), rocksdb_values.data(), statuses.data());
+  } else if (transaction_) {
+    transaction_->MultiGet(options, column_family, keys.size(), rocksdb_keys.data(), rocksdb_values.data(),
+                           statuses.data());
+  } else {
+    db_->MultiGet(options, column_family, keys.size(), rocksdb_keys.data(), rocksdb_values.data(), statuses.data());
+  }
+  std::vector<GetStatus> res;
+  res.reserve(statuses.size());
+  values.resize(keys.size());
+  for (size_t i = 0; i < statuses.size(); i++) {
+    auto &status = statuses[i];
+    if (status.ok()) {
+      res.push_back(GetStatus::Ok);
+      values[i].assign(rocksdb_values[i].data(), rocksdb_values[i].size());
+    } else if (status.code() == rocksdb::Status::kNotFound) {
+      res.push_back(GetStatus::NotFound);
+      values[i].clear();
+    } else {
+      return from_rocksdb(status);
+    }
+  }
+  return std::move(res);
+}
+
 Status RocksDb::set(Slice key, Slice value) {
   if (write_batch_) {
     return from_rocksdb(write_batch_->Put(to_rocksdb(key), to_rocksdb(value)));
@@ -161,6 +233,75 @@ Result<size_t> RocksDb::count(Slice prefix) {
   return res;
 }
 
+namespace {
+class RocksDbIterator : public KeyValueIterator {
+ public:
+  RocksDbIterator(std::shared_ptr<rocksdb::OptimisticTransactionDB> db, rocksdb::Transaction *transaction,
+                  const rocksdb::Snapshot *snapshot, KeyValueReader::IterateOptions options)
+      : db_(std::move(db)), options_(std::move(options)) {
+    rocksdb::ReadOptions read_options;
+    read_options.snapshot = snapshot;
+    read_options.readahead_size = options_.readahead_size;
+    lower_bound_ = to_rocksdb(options_.begin);
+    read_options.iterate_lower_bound = &lower_bound_;
+    if (!options_.end.empty()) {
+      upper_bound_ = to_rocksdb(options_.end);
+      read_options.iterate_upper_bound = &upper_bound_;
+    }
+    if (snapshot || !transaction) {
+      iterator_.reset(db_->NewIterator(read_options));
+    } else {
+      iterator_.reset(transaction->GetIterator(read_options));
+    }
+
+    if (!options_.reverse) {
+      iterator_->Seek(lower_bound_);
+    } else if (options_.end.empty()) {
+      iterator_->SeekToLast();
+    } else {
+      iterator_->SeekForPrev(upper_bound_);
+      if (iterator_->Valid() && from_rocksdb(iterator_->key()) == options_.end) {
+        iterator_->Prev();
+      }
+    }
+  }
+
+  bool valid() const override {
+    return iterator_->Valid();
+  }
+  Slice key() const override {
+    return from_rocksdb(iterator_->key());
+  }
+  Slice value() const override {
+    return from_rocksdb(iterator_->value());
+  }
+  void next() override {
+    if (options_.reverse) {
+      iterator_->Prev();
+    } else {
+      iterator_->Next();
+    }
+  }
+  Status status() const override {
+    return from_rocksdb(iterator_->status());
+  }
+
+ private:
+  std::shared_ptr<rocksdb::OptimisticTransactionDB> db_;
+  KeyValueReader::IterateOptions options_;
+  // bounds are referenced by the read options of the iterator, so they must outlive it
+  rocksdb::Slice lower_bound_;
+  rocksdb::Slice upper_bound_;
+  std::unique_ptr<rocksdb::Iterator> iterator_;
+};
+}  // namespace
+
+Result<std::unique_ptr<KeyValueIterator>> RocksDb::iterator(const IterateOptions &options) {
+  auto res = std::make_unique<RocksDbIterator>(db_, transaction_.get(), snapshot_.get(), options);
+  TRY_STATUS(res->status());
+  return std::move(res);
+}
+
 Status RocksDb::begin_transaction() {
   write_batch_ = std::make_unique<rocksdb::WriteBatch>();
   //transaction_.reset(db_->BeginTransaction({}, {}));
@@ -34,16 +34,35 @@ class Statistics;
 }  // namespace rocksdb
 
 namespace td {
+struct RocksDbOptions {
+  // access pattern of the database; its table options are chosen by it
+  enum class Workload {
+    Default,
+    // random lookups of small values by hash, e.g. cells
+    PointLookup,
+    // sequential scans over ordered keys, e.g. archive indexes
+    RangeScan,
+    // small databases with frequent small writes, e.g. catchain and DHT
+    SmallWrites
+  };
+
+  Workload workload{Workload::Default};
+  // size of a block cache used only by this database; 0 means the block cache shared by all databases
+  size_t block_cache_size{0};
+};
+
 class RocksDb : public KeyValue {
  public:
   static Status destroy(Slice path);
   RocksDb clone() const;
-  static Result<RocksDb> open(std::string path);
+  static Result<RocksDb> open(std::string path, RocksDbOptions options = {});
 
   Result<GetStatus> get(Slice key, std::string &value) override;
+  Result<std::vector<GetStatus>> get_multi(Span<Slice> keys, std::vector<std::string> &values) override;
   Status set(Slice key, Slice value) override;
   Status erase(Slice key) override;
   Result<size_t> count(Slice prefix) override;
+  Result<std::unique_ptr<KeyValueIterator>> iterator(const IterateOptions &options) override;
 
   Status begin_transaction() override;
   Status commit_transaction() override;
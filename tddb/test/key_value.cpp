@@ -20,10 +20,12 @@
 
 #include "td/db/KeyValueAsync.h"
 #include "td/db/KeyValue.h"
+#include "td/db/MemoryKeyValue.h"
 #include "td/db/RocksDb.h"
 
 #include "td/utils/benchmark.h"
 #include "td/utils/buffer.h"
+#include "td/utils/misc.h"
 #include "td/utils/optional.h"
 #include "td/utils/UInt.h"
 
@@ -61,6 +63,126 @@ TEST(KeyValue, simple) {
   ensure_value(as_slice(x), as_slice(x));
 };
 
+TEST(KeyValue, get_multi) {
+  td::Slice db_name = "testdb";
+  td::RocksDb::destroy(db_name).ignore();
+
+  auto check = [](td::KeyValue &kv) {
+    kv.set("A", "1");
+    kv.set("C", "3");
+    kv.set("pD", "4");
+    kv.set("B", "2");
+    td::PrefixedKeyValue prefixed(std::shared_ptr<td::KeyValue>(&kv, [](td::KeyValue *) {}), "p");
+
+    std::vector<td::Slice> keys{"A", "B", "C", "D"};
+    std::vector<std::string> values;
+    auto expect = [&](td::KeyValueReader &reader, std::vector<td::Slice> expected) {
+      auto statuses = reader.get_multi(keys, values).move_as_ok();
+      ASSERT_EQ(keys.size(), statuses.size());
+      ASSERT_EQ(keys.size(), values.size());
+      for (size_t i = 0; i < keys.size(); i++) {
+        if (expected[i].empty()) {
+          ASSERT_EQ(td::int32(td::KeyValue::GetStatus::NotFound), td::int32(statuses[i]));
+        } else {
+          ASSERT_EQ(td::int32(td::KeyValue::GetStatus::Ok), td::int32(statuses[i]));
+          ASSERT_EQ(expected[i], values[i]);
+        }
+      }
+    };
+    expect(kv, {"1", "2", "3", ""});
+    expect(prefixed, {"", "", "", "4"});
+  };
+
+  td::MemoryKeyValue memory_kv;
+  check(memory_kv);
+  auto rocksdb = td::RocksDb::open(db_name.str()).move_as_ok();
+  check(rocksdb);
+}
+
+TEST(KeyValue, iterator) {
+  td::Slice db_name = "testdb";
+  td::RocksDb::destroy(db_name).ignore();
+
+  auto check = [](td::KeyValue &kv) {
+    for (std::string key : {"a1", "a2", "a3", "b", "b\xff", "c"}) {
+      kv.set(key, PSLICE() << key << "!").ensure();
+    }
+    auto scan = [](td::KeyValueReader &reader, td::KeyValueReader::IterateOptions options) {
+      std::string res;
+      auto iterator = reader.iterator(options).move_as_ok();
+      for (; iterator->valid(); iterator->next()) {
+        ASSERT_TRUE(td::ends_with(iterator->value(), PSLICE() << iterator->key() << "!"));
+        res += PSTRING() << iterator->key() << ",";
+      }
+      iterator->status().ensure();
+      return res;
+    };
+    using Options = td::KeyValueReader::IterateOptions;
+    ASSERT_EQ("a1,a2,a3,b,b\xff,c,", scan(kv, Options()));
+    ASSERT_EQ("c,b\xff,b,a3,a2,a1,", scan(kv, Options::range("", "", true)));
+    ASSERT_EQ("a2,a3,", scan(kv, Options::range("a2", "b")));
+    ASSERT_EQ("a3,a2,", scan(kv, Options::range("a2", "b", true)));
+    ASSERT_EQ("", scan(kv, Options::range("a4", "a9")));
+    ASSERT_EQ("", scan(kv, Options::range("a4", "a9", true)));
+    ASSERT_EQ("b,b\xff,", scan(kv, Options::prefix("b")));
+    ASSERT_EQ("b\xff,b,", scan(kv, Options::prefix("b", true)));
+
+    // the iterator is not affected by later writes
+    auto iterator = kv.iterator(Options::prefix("a")).move_as_ok();
+    kv.erase("a2");
+    kv.set("a0", "");
+    std::string keys;
+    for (; iterator->valid(); iterator->next()) {
+      keys += iterator->key().str();
+    }
+    ASSERT_EQ("a1a2a3", keys);
+
+    td::PrefixedKeyValue prefixed(std::shared_ptr<td::KeyValue>(&kv, [](td::KeyValue *) {}), "b");
+    ASSERT_EQ(",\xff,", scan(prefixed, Options()));
+    ASSERT_EQ("\xff,,", scan(prefixed, Options::range("", "", true)));
+
+    // a prefix of 0xff bytes only has no end key
+    kv.set("\xff\xff" "a", "a!").ensure();
+    td::PrefixedKeyValue last(std::shared_ptr<td::KeyValue>(&kv, [](td::KeyValue *) {}), "\xff\xff");
+    ASSERT_EQ("a,", scan(last, Options()));
+    ASSERT_EQ("a,", scan(last, Options::range("", "", true)));
+    ASSERT_EQ("", scan(last, Options::range("b", "")));
+  };
+
+  td::MemoryKeyValue memory_kv;
+  check(memory_kv);
+  auto rocksdb = td::RocksDb::open(db_name.str()).move_as_ok();
+  check(rocksdb);
+}
+
+TEST(KeyValue, workloads) {
+  td::Slice db_name = "testdb";
+  for (auto workload : {td::RocksDbOptions::Workload::Default, td::RocksDbOptions::Workload::PointLookup,
+                        td::RocksDbOptions::Workload::RangeScan, td::RocksDbOptions::Workload::SmallWrites}) {
+    td::RocksDb::destroy(db_name).ignore();
+    td::RocksDbOptions options;
+    options.workload = workload;
+    options.block_cache_size = 1 << 20;
+    auto db = td::RocksDb::open(db_name.str(), options).move_as_ok();
+    for (int i = 0; i < 1000; i++) {
+      db.set(PSLICE() << "key" << i, PSLICE() << "value" << i).ensure();
+    }
+    // lookups go through the table files, with their filters and indexes
+    db.flush().ensure();
+
+    std::vector<std::string> keys{"key0", "key999", "key1000"};
+    std::vector<td::Slice> key_slices(keys.begin(), keys.end());
+    std::vector<std::string> values;
+    auto statuses = db.get_multi(key_slices, values).move_as_ok();
+    ASSERT_TRUE(statuses[0] == td::KeyValue::GetStatus::Ok);
+    ASSERT_EQ("value0", values[0]);
+    ASSERT_TRUE(statuses[1] == td::KeyValue::GetStatus::Ok);
+    ASSERT_EQ("value999", values[1]);
+    ASSERT_TRUE(statuses[2] == td::KeyValue::GetStatus::NotFound);
+    ASSERT_EQ(111u, db.count("key9").move_as_ok());
+  }
+}
+
 TEST(KeyValue, async_simple) {
   td::Slice db_name = "testdb";
   td::RocksDb::destroy(db_name).ignore();
@@ -0,0 +1,97 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2019 Telegram Systems LLP
+*/
+#include "td/db/RocksDb.h"
+
+#include "td/utils/benchmark.h"
+#include "td/utils/logging.h"
+#include "td/utils/misc.h"
+#include "td/utils/Random.h"
+#include "td/utils/UInt.h"
+
+#include <algorithm>
+#include <vector>
+
+// random point lookups of 32-byte keys, like loading cells by hash; a half of the keys looked up are missing
+class BenchRocksDbPointLookup : public td::Benchmark {
+ public:
+  BenchRocksDbPointLookup(std::string name, td::RocksDbOptions::Workload workload, size_t keys_count)
+      : name_(std::move(name)), workload_(workload), keys_count_(keys_count) {
+  }
+  std::string get_description() const override {
+    return PSTRING() << "RocksDb point lookups, " << keys_count_ << " keys, " << name_ << " options";
+  }
+  void start_up() override {
+    path_ = "rocksdb-bench-" + name_;
+    td::RocksDb::destroy(path_).ignore();
+    td::RocksDbOptions options;
+    options.workload = workload_;
+    db_ = std::make_unique<td::RocksDb>(td::RocksDb::open(path_, std::move(options)).move_as_ok());
+
+    td::Random::Xorshift128plus rnd(123);
+    keys_.resize(keys_count_ * 2);
+    for (auto &key : keys_) {
+      for (auto &x : key.raw) {
+        x = static_cast<td::uint8>(rnd());
+      }
+    }
+    // keys with even indices are stored, the other ones are missing
+    std::string value(100, 'v');
+    for (size_t i = 0; i < keys_count_; i += batch_size) {
+      db_->begin_transaction().ensure();
+      for (size_t j = i; j < std::min(i + batch_size, keys_count_); j++) {
+        db_->set(keys_[j * 2].as_slice(), value).ensure();
+      }
+      db_->commit_transaction().ensure();
+    }
+    db_->flush().ensure();
+  }
+  void run(int n) override {
+    std::string value;
+    size_t found = 0;
+    for (int i = 0; i < n; i++) {
+      auto &key = keys_[td::Random::fast(0, static_cast<int>(keys_.size()) - 1)];
+      found += db_->get(key.as_slice(), value).move_as_ok() == td::KeyValue::GetStatus::Ok;
+    }
+    td::do_not_optimize_away(found);
+  }
+  void tear_down() override {
+    db_.reset();
+    keys_.clear();
+    td::RocksDb::destroy(path_).ignore();
+  }
+
+ private:
+  static constexpr size_t batch_size = 10000;
+
+  std::string name_;
+  td::RocksDbOptions::Workload workload_;
+  size_t keys_count_;
+  std::string path_;
+  std::unique_ptr<td::RocksDb> db_;
+  std::vector<td::UInt256> keys_;
+};
+
+int main() {
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
+  for (size_t keys_count : {100000, 1000000}) {
+    td::bench(BenchRocksDbPointLookup("default", td::RocksDbOptions::Workload::Default, keys_count));
+    td::bench(BenchRocksDbPointLookup("point-lookup", td::RocksDbOptions::Workload::PointLookup, keys_count));
+  }
+  return 0;
+}
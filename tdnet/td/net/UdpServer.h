@@ -34,7 +34,9 @@ class UdpServer : public td::actor::Actor {
   };
   virtual void send(td::UdpMessage &&message) = 0;
 
-  static Result<actor::ActorOwn<UdpServer>> create(td::Slice name, int32 port, std::unique_ptr<Callback> callback);
+  // use_io_uring is experimental and is not enabled by any server, see UdpSocketFd::open
+  static Result<actor::ActorOwn<UdpServer>> create(td::Slice name, int32 port, std::unique_ptr<Callback> callback,
+                                                   bool use_io_uring = false, bool reuse_port = false);
   static Result<actor::ActorOwn<UdpServer>> create_via_tcp(td::Slice name, int32 port,
                                                            std::unique_ptr<Callback> callback);
 };
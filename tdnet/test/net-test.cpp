@@ -18,12 +18,19 @@
 */
 #include "td/actor/actor.h"
 #include "td/net/UdpServer.h"
+#include "td/utils/port/sleep.h"
 #include "td/utils/tests.h"
 
+#if TD_PORT_POSIX
+#include <sys/socket.h>
+#endif
+
+#include <set>
+
 class PingPong : public td::actor::Actor {
  public:
-  PingPong(int port, td::IPAddress dest, bool use_tcp, bool is_first)
-      : port_(port), dest_(std::move(dest)), use_tcp_(use_tcp) {
+  PingPong(int port, td::IPAddress dest, bool use_tcp, bool use_io_uring, bool is_first)
+      : port_(port), dest_(std::move(dest)), use_tcp_(use_tcp), use_io_uring_(use_io_uring) {
     if (is_first) {
       state_ = Send;
       to_send_cnt_ = 5;
@@ -38,6 +45,7 @@ class PingPong : public td::actor::Actor {
   bool is_closing_{false};
   bool is_closing_delayed_{false};
   bool use_tcp_{false};
+  bool use_io_uring_{false};
   enum State { Send, Receive } state_{State::Receive};
   int cnt_{0};
   int to_send_cnt_{0};
@@ -61,7 +69,7 @@ class PingPong : public td::actor::Actor {
                         .move_as_ok();
     } else {
       udp_server_ = td::UdpServer::create(PSLICE() << "UdpServer " << td::tag("port", port_), port_,
-                                          std::make_unique<Callback>(actor_shared(this)))
+                                          std::make_unique<Callback>(actor_shared(this)), use_io_uring_)
                         .move_as_ok();
     }
 
@@ -143,14 +151,14 @@ class PingPong : public td::actor::Actor {
   }
 };
 
-void run_server(int from_port, int to_port, bool is_first, bool use_tcp) {
+void run_server(int from_port, int to_port, bool is_first, bool use_tcp, bool use_io_uring) {
   td::IPAddress to_ip;
   to_ip.init_host_port("localhost", to_port).ensure();
 
   td::actor::Scheduler scheduler({1});
   scheduler.run_in_context([&] {
     td::actor::create_actor<PingPong>(td::actor::ActorOptions().with_name("PingPong"), from_port, to_ip, use_tcp,
-                                      is_first)
+                                      use_io_uring, is_first)
         .release();
   });
   scheduler.run();
@@ -159,9 +167,73 @@ void run_server(int from_port, int to_port, bool is_first, bool use_tcp) {
 TEST(Net, PingPong) {
   SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
   for (auto use_tcp : {false, true}) {
-    auto a = td::thread([use_tcp] { run_server(8091, 8092, true, use_tcp); });
-    auto b = td::thread([use_tcp] { run_server(8092, 8091, false, use_tcp); });
+    auto a = td::thread([use_tcp] { run_server(8091, 8092, true, use_tcp, false); });
+    auto b = td::thread([use_tcp] { run_server(8092, 8091, false, use_tcp, false); });
     a.join();
     b.join();
   }
 }
+
+TEST(Net, PingPongIoUring) {
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(ERROR));
+  // falls back to the usual system calls if io_uring isn't supported
+  auto a = td::thread([] { run_server(8091, 8092, true, false, true); });
+  auto b = td::thread([] { run_server(8092, 8091, false, false, true); });
+  a.join();
+  b.join();
+}
+
+#if TD_PORT_POSIX
+TEST(Net, UdpReusePort) {
+  for (auto use_io_uring : {false, true}) {
+    td::IPAddress any_port;
+    any_port.init_ipv4_port("127.0.0.1", 1).ensure();
+    any_port.set_port(0);
+    std::vector<td::UdpSocketFd> sockets;
+    sockets.push_back(td::UdpSocketFd::open(any_port, use_io_uring, true).move_as_ok());
+    // the other sockets are bound to the port chosen by the system for the first one
+    sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+    CHECK(getsockname(sockets[0].get_native_fd().fd(), reinterpret_cast<sockaddr *>(&addr), &addr_len) == 0);
+    td::IPAddress address;
+    address.init_sockaddr(reinterpret_cast<sockaddr *>(&addr), addr_len).ensure();
+    address.init_ipv4_port("127.0.0.1", address.get_port()).ensure();
+    for (int i = 1; i < 4; i++) {
+      sockets.push_back(td::UdpSocketFd::open(address, use_io_uring, true).move_as_ok());
+    }
+
+    // datagrams from different source ports are spread between the sockets, and each of them is received once
+    const int count = 32;
+    for (int i = 0; i < count; i++) {
+      auto sender = td::UdpSocketFd::open(any_port).move_as_ok();
+      std::string data = PSTRING() << "datagram" << i;
+      bool is_sent = false;
+      sender.send_message(td::UdpSocketFd::OutboundMessage{&address, data}, is_sent).ensure();
+      CHECK(is_sent);
+    }
+    std::set<std::string> received;
+    size_t received_count = 0;
+    for (int attempt = 0; attempt < 100 && received_count < count; attempt++) {
+      for (auto &socket : sockets) {
+        while (true) {
+          char buffer[64];
+          td::IPAddress from;
+          td::Status error;
+          td::UdpSocketFd::InboundMessage message{&from, td::MutableSlice(buffer, sizeof(buffer)), &error};
+          bool is_received = false;
+          socket.receive_message(message, is_received).ensure();
+          if (!is_received) {
+            break;
+          }
+          error.ensure();
+          received.insert(message.data.str());
+          received_count++;
+        }
+      }
+      td::usleep_for(10000);
+    }
+    ASSERT_EQ(static_cast<size_t>(count), received_count);
+    ASSERT_EQ(static_cast<size_t>(count), received.size());
+  }
+}
+#endif
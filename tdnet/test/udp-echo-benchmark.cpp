@@ -0,0 +1,188 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2019 Telegram Systems LLP
+*/
+#include "td/actor/actor.h"
+#include "td/net/UdpServer.h"
+
+#include "td/utils/misc.h"
+#include "td/utils/OptionsParser.h"
+#include "td/utils/Time.h"
+
+#include <ctime>
+
+// Client keeps a fixed number of datagrams in flight to an echo server running in the same process;
+// every received echo is sent again, so the packet rate is limited only by the UDP stack and the socket backend
+struct EchoOptions {
+  int port{8095};
+  int size{1024};  // typical size of an ADNL datagram
+  int window{64};
+  double duration{5};
+  bool use_io_uring{false};
+};
+
+class UdpEchoBenchmark : public td::actor::Actor {
+ public:
+  explicit UdpEchoBenchmark(EchoOptions options) : options_(options) {
+  }
+
+ private:
+  EchoOptions options_;
+  td::actor::ActorOwn<td::UdpServer> server_;
+  td::actor::ActorOwn<td::UdpServer> client_;
+  td::IPAddress server_address_;
+  td::uint64 echoes_{0};
+  td::uint64 errors_{0};
+  bool is_closing_{false};
+  int closed_servers_{0};
+  double start_time_{0};
+  std::clock_t start_clock_{0};
+
+  class Callback : public td::UdpServer::Callback {
+   public:
+    Callback(td::actor::ActorShared<UdpEchoBenchmark> benchmark, bool is_server)
+        : benchmark_(std::move(benchmark)), is_server_(is_server) {
+    }
+
+   private:
+    td::actor::ActorShared<UdpEchoBenchmark> benchmark_;
+    bool is_server_;
+    void on_udp_message(td::UdpMessage udp_message) override {
+      send_closure(benchmark_, &UdpEchoBenchmark::on_udp_message, std::move(udp_message), is_server_);
+    }
+  };
+
+  void start_up() override {
+    server_address_.init_ipv4_port("127.0.0.1", options_.port).ensure();
+    server_ = td::UdpServer::create("EchoServer", options_.port,
+                                    std::make_unique<Callback>(actor_shared(this), true), options_.use_io_uring)
+                  .move_as_ok();
+    client_ = td::UdpServer::create("EchoClient", options_.port + 1,
+                                    std::make_unique<Callback>(actor_shared(this), false), options_.use_io_uring)
+                  .move_as_ok();
+
+    for (int i = 0; i < options_.window; i++) {
+      td::BufferSlice data(options_.size);
+      data.as_slice().fill('a');
+      send_closure(client_, &td::UdpServer::send, td::UdpMessage{server_address_, std::move(data), {}});
+    }
+    start_time_ = td::Time::now();
+    start_clock_ = std::clock();
+    alarm_timestamp() = td::Timestamp::in(options_.duration);
+  }
+
+  void on_udp_message(td::UdpMessage message, bool is_server) {
+    if (is_closing_) {
+      return;
+    }
+    if (message.error.is_error()) {
+      errors_++;
+      return;
+    }
+    if (is_server) {
+      send_closure(server_, &td::UdpServer::send, std::move(message));
+    } else {
+      echoes_++;
+      send_closure(client_, &td::UdpServer::send, td::UdpMessage{server_address_, std::move(message.data), {}});
+    }
+  }
+
+  void alarm() override {
+    auto elapsed = td::Time::now() - start_time_;
+    auto cpu_time = static_cast<double>(std::clock() - start_clock_) / CLOCKS_PER_SEC;
+    // every echo is two datagrams, each of them is sent once and received once
+    auto datagrams = static_cast<double>(echoes_) * 2;
+    LOG(PLAIN) << "datagrams of " << options_.size << " bytes, window " << options_.window << ": "
+               << td::format::as_time(elapsed) << ", " << echoes_ << " echoes, "
+               << static_cast<td::int64>(datagrams / elapsed) << " datagrams/s, "
+               << td::format::as_time(datagrams > 0 ? cpu_time / datagrams : 0) << " CPU per datagram, " << errors_
+               << " errors";
+    is_closing_ = true;
+    server_.reset();
+    client_.reset();
+  }
+
+  void hangup_shared() override {
+    // a server was closed
+    if (++closed_servers_ == 2) {
+      stop();
+    }
+  }
+
+  void tear_down() override {
+    td::actor::SchedulerContext::get()->stop();
+  }
+};
+
+int main(int argc, char *argv[]) {
+  // a warning is printed if io_uring isn't supported
+  SET_VERBOSITY_LEVEL(VERBOSITY_NAME(WARNING));
+  td::OptionsParser options_parser;
+  options_parser.set_description("UDP echo over the loopback interface: packets per second and CPU per packet");
+
+  EchoOptions options;
+  bool only_io_uring = false;
+  bool only_default = false;
+  options_parser.add_option('p', "port", "server port, the client uses the next one", [&](td::Slice arg) {
+    TRY_RESULT(port, td::to_integer_safe<int>(arg));
+    options.port = port;
+    return td::Status::OK();
+  });
+  options_parser.add_option('s', "size", "datagram size", [&](td::Slice arg) {
+    TRY_RESULT(size, td::to_integer_safe<int>(arg));
+    options.size = size;
+    return td::Status::OK();
+  });
+  options_parser.add_option('w', "window", "number of datagrams in flight", [&](td::Slice arg) {
+    TRY_RESULT(window, td::to_integer_safe<int>(arg));
+    options.window = window;
+    return td::Status::OK();
+  });
+  options_parser.add_option('t', "time", "duration of each run in seconds", [&](td::Slice arg) {
+    options.duration = td::to_double(arg);
+    return td::Status::OK();
+  });
+  options_parser.add_option('u', "io-uring", "run only with io_uring", [&]() {
+    only_io_uring = true;
+    return td::Status::OK();
+  });
+  options_parser.add_option('d', "default", "run only with recvmmsg/sendmmsg", [&]() {
+    only_default = true;
+    return td::Status::OK();
+  });
+  auto status = options_parser.run(argc, argv);
+  if (status.is_error()) {
+    LOG(ERROR) << status.error();
+    LOG(PLAIN) << options_parser;
+    return 1;
+  }
+
+  for (auto use_io_uring : {false, true}) {
+    if ((use_io_uring && only_default) || (!use_io_uring && only_io_uring)) {
+      continue;
+    }
+    options.use_io_uring = use_io_uring;
+    LOG(PLAIN) << (use_io_uring ? "io_uring" : "recvmmsg/sendmmsg");
+    td::actor::Scheduler scheduler({1});
+    scheduler.run_in_context([&] {
+      td::actor::create_actor<UdpEchoBenchmark>(td::actor::ActorOptions().with_name("UdpEchoBenchmark"), options)
+          .release();
+    });
+    scheduler.run();
+  }
+  return 0;
+}
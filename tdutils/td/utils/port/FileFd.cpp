@@ -328,6 +328,35 @@ Result<size_t> FileFd::pwrite(Slice slice, int64 offset) {
   return OS_ERROR(PSLICE() << "Pwrite to " << get_native_fd() << " at offset " << offset << " has failed");
 }
 
+Result<size_t> FileFd::pwritev(Span<IoSlice> slices, int64 offset) {
+  if (offset < 0) {
+    return Status::Error("Offset must be non-negative");
+  }
+#if TD_PORT_POSIX && !TD_DARWIN
+  auto native_fd = get_native_fd().fd();
+  TRY_RESULT(offset_off_t, narrow_cast_safe<off_t>(offset));
+  TRY_RESULT(slices_size, narrow_cast_safe<int>(slices.size()));
+  auto bytes_written =
+      detail::skip_eintr([&] { return ::pwritev(native_fd, slices.begin(), slices_size, offset_off_t); });
+  bool success = bytes_written >= 0;
+  if (success) {
+    return narrow_cast<size_t>(bytes_written);
+  }
+  return OS_ERROR(PSLICE() << "Pwritev to " << get_native_fd() << " at offset " << offset << " has failed");
+#else
+  size_t res = 0;
+  for (auto slice : slices) {
+    auto data = as_slice(slice);
+    TRY_RESULT(size, pwrite(data, offset + res));
+    res += size;
+    if (size != data.size()) {
+      break;
+    }
+  }
+  return res;
+#endif
+}
+
 Result<size_t> FileFd::pread(MutableSlice slice, int64 offset) const {
   if (offset < 0) {
     return Status::Error("Offset must be non-negative");
@@ -54,6 +54,7 @@ class FileFd {
   Result<size_t> read(MutableSlice slice) TD_WARN_UNUSED_RESULT;
 
   Result<size_t> pwrite(Slice slice, int64 offset) TD_WARN_UNUSED_RESULT;
+  Result<size_t> pwritev(Span<IoSlice> slices, int64 offset) TD_WARN_UNUSED_RESULT;
   Result<size_t> pread(MutableSlice slice, int64 offset) const TD_WARN_UNUSED_RESULT;
 
   enum class LockFlags { Write, Read, Unlock };
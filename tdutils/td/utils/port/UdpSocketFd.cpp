@@ -45,6 +45,14 @@
 #endif
 #endif  // TD_PORT_POSIX
 
+#if TD_HAVE_IO_URING
+#include "td/utils/port/detail/IoUring.h"
+
+#include <endian.h>
+#include <poll.h>
+#include <sys/mman.h>
+#endif
+
 #include <array>
 #include <atomic>
 #include <cstring>
@@ -470,18 +478,285 @@ class UdpSocketSendHelper {
   struct iovec io_vec_;
 };
 
+#if TD_HAVE_IO_URING
+// Receives datagrams with a single multishot recvmsg into buffers provided to the kernel through a buffer ring.
+// The ring descriptor is polled instead of the socket: it becomes readable when there are new completions.
+// Datagrams are still sent with sendmmsg, which is synchronous for UDP anyway, and asynchronous completions of
+// sends would only cause extra wakeups.
+class UdpSocketIoUring {
+ public:
+  UdpSocketIoUring(NativeFd ring_fd, unique_ptr<IoUring> ring) : ring_(std::move(ring)), info_(std::move(ring_fd)) {
+  }
+  UdpSocketIoUring(const UdpSocketIoUring &) = delete;
+  UdpSocketIoUring &operator=(const UdpSocketIoUring &) = delete;
+  UdpSocketIoUring(UdpSocketIoUring &&) = delete;
+  UdpSocketIoUring &operator=(UdpSocketIoUring &&) = delete;
+  ~UdpSocketIoUring() {
+    // the ring must be destroyed before the memory it writes to
+    info_.move_as_native_fd().close();
+    ring_.reset();
+    if (buffer_ring_ != nullptr) {
+      munmap(buffer_ring_, buffer_ring_size());
+    }
+    if (buffers_ != nullptr) {
+      munmap(buffers_, buffers_size());
+    }
+  }
+
+  // takes the socket only on success
+  static Result<unique_ptr<UdpSocketIoUring>> create(NativeFd &socket_fd) {
+    auto ring = make_unique<IoUring>();
+    // all provided buffers may be filled before the completions are processed
+    TRY_RESULT(ring_fd, ring->init(RING_ENTRIES, 2 * BUFFER_COUNT));
+    auto result = make_unique<UdpSocketIoUring>(std::move(ring_fd), std::move(ring));
+    TRY_STATUS(result->init_buffers());
+    result->socket_fd_ = std::move(socket_fd);
+    auto status = result->start();
+    if (status.is_error()) {
+      socket_fd = std::move(result->socket_fd_);
+      return std::move(status);
+    }
+    return std::move(result);
+  }
+
+  PollableFdInfo &get_poll_info() {
+    return info_;
+  }
+  const PollableFdInfo &get_poll_info() const {
+    return info_;
+  }
+  const NativeFd &get_native_fd() const {
+    return socket_fd_;
+  }
+
+  Status receive_messages(MutableSpan<UdpSocketFd::InboundMessage> messages, size_t &cnt) {
+    cnt = 0;
+    if (received_.empty()) {
+      process_completions();
+    }
+    Status status;
+    while (cnt < messages.size() && !received_.empty() && status.is_ok()) {
+      auto completion = received_.pop();
+      if (completion.res < 0) {
+        status = Status::PosixError(-completion.res, PSLICE() << "Receive from " << socket_fd_ << " has failed");
+        continue;
+      }
+      CHECK(completion.flags & IORING_CQE_F_BUFFER);
+      auto buffer_id = narrow_cast<uint16>(completion.flags >> IORING_CQE_BUFFER_SHIFT);
+      from_buffer(buffers_ + buffer_id * BUFFER_SIZE, messages[cnt]);
+      recycle_buffer(buffer_id);
+      cnt++;
+    }
+    store_release(&buffer_ring_[0].resv, buffer_ring_tail_);
+    if (received_.empty()) {
+      process_completions();
+    }
+    if (received_.empty()) {
+      if (!is_receiving_) {
+        start_receive();
+        TRY_STATUS(ring_->submit());
+      }
+      info_.clear_flags(PollFlags::Read());
+    }
+    return status;
+  }
+
+  // the ring is polled instead of the socket, so it must be notified when the socket becomes writable again
+  Status wait_writable() {
+    if (is_waiting_writable_) {
+      return Status::OK();
+    }
+    auto sqe = ring_->get_sqe();
+    CHECK(sqe != nullptr);
+    uint32 events = POLLOUT;
+#if __BYTE_ORDER == __BIG_ENDIAN
+    events = (events << 16) | (events >> 16);
+#endif
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = socket_fd_.fd();
+    sqe->poll32_events = events;
+    sqe->user_data = WRITABLE_USER_DATA;
+    is_waiting_writable_ = true;
+    return ring_->submit();
+  }
+
+ private:
+  static constexpr uint32 RING_ENTRIES = 16;
+  static constexpr uint32 BUFFER_COUNT = 256;
+  static constexpr uint16 BUFFER_GROUP_ID = 0;
+  static constexpr size_t MAX_PAYLOAD_SIZE = 2048;
+  static constexpr size_t BUFFER_SIZE =
+      sizeof(struct io_uring_recvmsg_out) + sizeof(sockaddr_storage) + MAX_PAYLOAD_SIZE;
+  static constexpr uint64 RECEIVE_USER_DATA = 0;
+  static constexpr uint64 WRITABLE_USER_DATA = 1;
+
+  struct Completion {
+    int32 res;
+    uint32 flags;
+  };
+
+  NativeFd socket_fd_;
+  char *buffers_{nullptr};
+  // struct io_uring_buf_ring isn't used, because the flexible array in it has wrong offset in C++;
+  // the tail of the ring is stored in resv field of the first entry
+  struct io_uring_buf *buffer_ring_{nullptr};
+  uint16 buffer_ring_tail_{0};
+  struct msghdr receive_header_;
+  bool is_receiving_{false};
+  bool is_waiting_writable_{false};
+  VectorQueue<Completion> received_;
+  unique_ptr<IoUring> ring_;
+  PollableFdInfo info_;
+
+  static size_t buffer_ring_size() {
+    return BUFFER_COUNT * sizeof(struct io_uring_buf);
+  }
+  static size_t buffers_size() {
+    return BUFFER_COUNT * BUFFER_SIZE;
+  }
+
+  static void store_release(uint16 *ptr, uint16 value) {
+    reinterpret_cast<std::atomic<uint16> *>(ptr)->store(value, std::memory_order_release);
+  }
+
+  Status init_buffers() {
+    // buffer ring must be page aligned
+    auto buffer_ring = mmap(nullptr, buffer_ring_size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer_ring == MAP_FAILED) {
+      return OS_ERROR("Failed to allocate io_uring buffer ring");
+    }
+    buffer_ring_ = static_cast<struct io_uring_buf *>(buffer_ring);
+    auto buffers = mmap(nullptr, buffers_size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffers == MAP_FAILED) {
+      return OS_ERROR("Failed to allocate io_uring buffers");
+    }
+    buffers_ = static_cast<char *>(buffers);
+    TRY_STATUS(ring_->register_buffer_ring(buffer_ring_, BUFFER_COUNT, BUFFER_GROUP_ID));
+    for (uint16 i = 0; i < BUFFER_COUNT; i++) {
+      recycle_buffer(i);
+    }
+    store_release(&buffer_ring_[0].resv, buffer_ring_tail_);
+
+    std::memset(&receive_header_, 0, sizeof(receive_header_));
+    receive_header_.msg_namelen = sizeof(sockaddr_storage);
+    return Status::OK();
+  }
+
+  void recycle_buffer(uint16 buffer_id) {
+    auto &buffer = buffer_ring_[buffer_ring_tail_ & (BUFFER_COUNT - 1)];
+    buffer.addr = reinterpret_cast<uint64>(buffers_ + buffer_id * BUFFER_SIZE);
+    buffer.len = static_cast<uint32>(BUFFER_SIZE);
+    buffer.bid = buffer_id;
+    buffer_ring_tail_++;
+  }
+
+  // buffer rings are supported since Linux 5.19, but multishot recvmsg only since 6.0, and before that the receive
+  // is completed at once with EINVAL, so the first receive is checked before the socket is used
+  Status start() {
+    start_receive();
+    TRY_STATUS(ring_->submit());
+    process_completions();
+    if (!is_receiving_) {
+      auto res = received_.empty() ? 0 : received_.front().res;
+      return Status::PosixError(res < 0 ? -res : EINVAL, "Multishot recvmsg isn't supported");
+    }
+    return Status::OK();
+  }
+
+  void start_receive() {
+    auto sqe = ring_->get_sqe();
+    CHECK(sqe != nullptr);
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = socket_fd_.fd();
+    sqe->addr = reinterpret_cast<uint64>(&receive_header_);
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP_ID;
+    sqe->user_data = RECEIVE_USER_DATA;
+    is_receiving_ = true;
+  }
+
+  void process_completions() {
+    if (ring_->has_overflow()) {
+      ring_->flush_overflow().ignore();
+    }
+    while (auto cqe = ring_->peek_cqe()) {
+      if (cqe->user_data == RECEIVE_USER_DATA) {
+        if (!(cqe->flags & IORING_CQE_F_MORE)) {
+          is_receiving_ = false;
+        }
+        // there were no free buffers, the receive is restarted when some of them are recycled
+        if (cqe->res != -ENOBUFS) {
+          received_.push(Completion{cqe->res, cqe->flags});
+        }
+      } else {
+        // PollFlags::Write() is restored by the poll, because the ring is always writable
+        CHECK(cqe->user_data == WRITABLE_USER_DATA);
+        is_waiting_writable_ = false;
+      }
+      ring_->pop_cqe();
+    }
+  }
+
+  // the layout of the buffer is described by receive_header_
+  static void from_buffer(char *buffer, UdpSocketFd::InboundMessage &message) {
+    auto out = reinterpret_cast<struct io_uring_recvmsg_out *>(buffer);
+    auto name = buffer + sizeof(*out);
+    auto payload = name + sizeof(sockaddr_storage);
+    if (message.from != nullptr) {
+      message.from
+          ->init_sockaddr(reinterpret_cast<struct sockaddr *>(name),
+                          narrow_cast<socklen_t>(min(static_cast<size_t>(out->namelen), sizeof(sockaddr_storage))))
+          .ignore();
+    }
+    if (message.error) {
+      *message.error = Status::OK();
+    }
+    if ((out->flags & MSG_TRUNC) || out->payloadlen > message.data.size()) {
+      if (message.error) {
+        *message.error = Status::Error(501, "message too long");
+      }
+      message.data.truncate(0);
+      return;
+    }
+    message.data.truncate(out->payloadlen);
+    message.data.copy_from(Slice(payload, out->payloadlen));
+  }
+};
+#endif
+
 class UdpSocketFdImpl {
  public:
   explicit UdpSocketFdImpl(NativeFd fd) : info_(std::move(fd)) {
   }
+#if TD_HAVE_IO_URING
+  explicit UdpSocketFdImpl(unique_ptr<UdpSocketIoUring> io_uring) : io_uring_(std::move(io_uring)) {
+  }
+#endif
   PollableFdInfo &get_poll_info() {
+#if TD_HAVE_IO_URING
+    if (io_uring_) {
+      return io_uring_->get_poll_info();
+    }
+#endif
     return info_;
   }
   const PollableFdInfo &get_poll_info() const {
+#if TD_HAVE_IO_URING
+    if (io_uring_) {
+      return io_uring_->get_poll_info();
+    }
+#endif
     return info_;
   }
 
   const NativeFd &get_native_fd() const {
+#if TD_HAVE_IO_URING
+    if (io_uring_) {
+      return io_uring_->get_native_fd();
+    }
+#endif
     return info_.native_fd();
   }
   Status get_pending_error() {
@@ -494,6 +769,14 @@ class UdpSocketFdImpl {
   }
   Status receive_message(UdpSocketFd::InboundMessage &message, bool &is_received) {
     is_received = false;
+#if TD_HAVE_IO_URING
+    if (io_uring_ && !get_poll_info().get_flags().has_pending_error()) {
+      size_t cnt;
+      auto status = io_uring_->receive_messages(MutableSpan<UdpSocketFd::InboundMessage>(&message, 1), cnt);
+      is_received = cnt != 0;
+      return status;
+    }
+#endif
     int flags = 0;
     if (get_poll_info().get_flags().has_pending_error()) {
 #ifdef MSG_ERRQUEUE
@@ -577,6 +860,11 @@ class UdpSocketFdImpl {
 #endif
     ) {
       get_poll_info().clear_flags(PollFlags::Write());
+#if TD_HAVE_IO_URING
+      if (io_uring_) {
+        return io_uring_->wait_writable();
+      }
+#endif
       return Status::OK();
     }
 
@@ -634,6 +922,12 @@ class UdpSocketFdImpl {
   }
 
   Status receive_messages(MutableSpan<UdpSocketFd::InboundMessage> messages, size_t &cnt) {
+#if TD_HAVE_IO_URING
+    // errors are received from the error queue of the socket as usual
+    if (io_uring_ && !get_poll_info().get_flags().has_pending_error()) {
+      return io_uring_->receive_messages(messages, cnt);
+    }
+#endif
 #if TD_HAS_MMSG
     return receive_messages_fast(messages, cnt);
 #else
@@ -643,6 +937,9 @@ class UdpSocketFdImpl {
 
  private:
   PollableFdInfo info_;
+#if TD_HAVE_IO_URING
+  unique_ptr<UdpSocketIoUring> io_uring_;
+#endif
 
   Status send_messages_slow(Span<UdpSocketFd::OutboundMessage> messages, size_t &cnt) {
     cnt = 0;
@@ -757,7 +1054,7 @@ const PollableFdInfo &UdpSocketFd::get_poll_info() const {
   return impl_->get_poll_info();
 }
 
-Result<UdpSocketFd> UdpSocketFd::open(const IPAddress &address) {
+Result<UdpSocketFd> UdpSocketFd::open(const IPAddress &address, bool use_io_uring, bool reuse_port) {
   NativeFd native_fd{socket(address.get_address_family(), SOCK_DGRAM, IPPROTO_UDP)};
   if (!native_fd) {
     return OS_SOCKET_ERROR("Failed to create a socket");
@@ -771,6 +1068,15 @@ Result<UdpSocketFd> UdpSocketFd::open(const IPAddress &address) {
   BOOL flags = TRUE;
 #endif
   setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&flags), sizeof(flags));
+  if (reuse_port) {
+#ifdef SO_REUSEPORT
+    if (setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<const char *>(&flags), sizeof(flags)) != 0) {
+      return OS_SOCKET_ERROR("Failed to set SO_REUSEPORT");
+    }
+#else
+    return Status::Error("SO_REUSEPORT isn't supported");
+#endif
+  }
   // TODO: SO_REUSEADDR, SO_KEEPALIVE, TCP_NODELAY, SO_SNDBUF, SO_RCVBUF, TCP_QUICKACK, SO_LINGER
 
   auto bind_addr = address.get_any_addr();
@@ -779,6 +1085,15 @@ Result<UdpSocketFd> UdpSocketFd::open(const IPAddress &address) {
   if (e_bind != 0) {
     return OS_SOCKET_ERROR("Failed to bind a socket");
   }
+#if TD_HAVE_IO_URING
+  if (use_io_uring) {
+    auto r_io_uring = detail::UdpSocketIoUring::create(native_fd);
+    if (r_io_uring.is_ok()) {
+      return UdpSocketFd(make_unique<detail::UdpSocketFdImpl>(r_io_uring.move_as_ok()));
+    }
+    LOG(WARNING) << "Failed to use io_uring for UDP socket: " << r_io_uring.error();
+  }
+#endif
   return UdpSocketFd(make_unique<detail::UdpSocketFdImpl>(std::move(native_fd)));
 }
 
@@ -794,7 +1109,11 @@ bool UdpSocketFd::empty() const {
 }
 
 const NativeFd &UdpSocketFd::get_native_fd() const {
+#if TD_PORT_POSIX
+  return impl_->get_native_fd();
+#else
   return get_poll_info().native_fd();
+#endif
 }
 
 #if TD_PORT_POSIX
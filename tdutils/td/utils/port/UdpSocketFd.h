@@ -60,7 +60,12 @@ class UdpSocketFd {
   Result<uint32> maximize_snd_buffer(uint32 max_buffer_size = 0);
   Result<uint32> maximize_rcv_buffer(uint32 max_buffer_size = 0);
 
-  static Result<UdpSocketFd> open(const IPAddress &address) TD_WARN_UNUSED_RESULT;
+  // use_io_uring selects the experimental io_uring receive backend, which is off by default: it lowers latency of
+  // a lightly loaded socket, but is slower than recvmmsg under saturation. If io_uring isn't supported by
+  // the system, the socket falls back to the usual system calls;
+  // with reuse_port several sockets may be bound to the same port, and the kernel spreads datagrams between them
+  static Result<UdpSocketFd> open(const IPAddress &address, bool use_io_uring = false,
+                                  bool reuse_port = false) TD_WARN_UNUSED_RESULT;
 
   PollableFdInfo &get_poll_info();
   const PollableFdInfo &get_poll_info() const;
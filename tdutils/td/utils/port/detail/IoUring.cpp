@@ -0,0 +1,185 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2019 Telegram Systems LLP
+*/
+#include "td/utils/port/detail/IoUring.h"
+
+char disable_linker_warning_about_empty_file_io_uring_cpp TD_UNUSED;
+
+#if TD_HAVE_IO_URING
+
+#include "td/utils/logging.h"
+#include "td/utils/port/detail/PollableFd.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+namespace td {
+namespace detail {
+
+static uint32 load_acquire(const uint32 *ptr) {
+  return reinterpret_cast<const std::atomic<uint32> *>(ptr)->load(std::memory_order_acquire);
+}
+
+static void store_release(uint32 *ptr, uint32 value) {
+  reinterpret_cast<std::atomic<uint32> *>(ptr)->store(value, std::memory_order_release);
+}
+
+static Result<void *> map_ring(int fd, size_t size, off_t offset) {
+  auto ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+  if (ptr == MAP_FAILED) {
+    return OS_ERROR("Failed to map io_uring");
+  }
+  return ptr;
+}
+
+IoUring::~IoUring() {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+}
+
+Result<NativeFd> IoUring::init(uint32 entries, uint32 completion_entries) {
+  CHECK(fd_ == -1);
+  struct io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = completion_entries;
+  auto ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+  if (ring_fd < 0) {
+    return OS_ERROR("io_uring_setup failed");
+  }
+  NativeFd result(ring_fd);
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    sq_ring_size_ = cq_ring_size_ = max(sq_ring_size_, cq_ring_size_);
+  }
+  TRY_RESULT_ASSIGN(sq_ring_, map_ring(ring_fd, sq_ring_size_, IORING_OFF_SQ_RING));
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    cq_ring_ = sq_ring_;
+  } else {
+    TRY_RESULT_ASSIGN(cq_ring_, map_ring(ring_fd, cq_ring_size_, IORING_OFF_CQ_RING));
+  }
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  TRY_RESULT(sqes, map_ring(ring_fd, sqes_size_, IORING_OFF_SQES));
+  sqes_ = static_cast<struct io_uring_sqe *>(sqes);
+
+  auto sq_ring = static_cast<char *>(sq_ring_);
+  sq_head_ = reinterpret_cast<uint32 *>(sq_ring + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<uint32 *>(sq_ring + params.sq_off.tail);
+  sq_flags_ = reinterpret_cast<uint32 *>(sq_ring + params.sq_off.flags);
+  sq_mask_ = *reinterpret_cast<uint32 *>(sq_ring + params.sq_off.ring_mask);
+  sq_entries_ = params.sq_entries;
+  sq_local_tail_ = *sq_tail_;
+  // submission queue entries are always used in order, so the indirection array is the identity
+  auto sq_array = reinterpret_cast<uint32 *>(sq_ring + params.sq_off.array);
+  for (uint32 i = 0; i < sq_entries_; i++) {
+    sq_array[i] = i;
+  }
+
+  auto cq_ring = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<uint32 *>(cq_ring + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<uint32 *>(cq_ring + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<uint32 *>(cq_ring + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<struct io_uring_cqe *>(cq_ring + params.cq_off.cqes);
+
+  fd_ = ring_fd;
+  return std::move(result);
+}
+
+struct io_uring_sqe *IoUring::get_sqe() {
+  if (sq_local_tail_ - load_acquire(sq_head_) >= sq_entries_) {
+    return nullptr;
+  }
+  auto sqe = &sqes_[sq_local_tail_ & sq_mask_];
+  sq_local_tail_++;
+  std::memset(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+Status IoUring::submit() {
+  return enter(0, 0);
+}
+
+Status IoUring::submit_and_wait(uint32 min_completions) {
+  return enter(min_completions, IORING_ENTER_GETEVENTS);
+}
+
+Status IoUring::enter(uint32 min_completions, uint32 flags) {
+  store_release(sq_tail_, sq_local_tail_);
+  // entries, which weren't consumed by a previous call, are submitted too
+  auto to_submit = sq_local_tail_ - load_acquire(sq_head_);
+  if (to_submit == 0 && flags == 0) {
+    return Status::OK();
+  }
+  auto res = detail::skip_eintr(
+      [&] { return syscall(__NR_io_uring_enter, fd_, to_submit, min_completions, flags, nullptr, 0); });
+  if (res < 0) {
+    return OS_ERROR("io_uring_enter failed");
+  }
+  return Status::OK();
+}
+
+const struct io_uring_cqe *IoUring::peek_cqe() const {
+  auto head = *cq_head_;
+  if (head == load_acquire(cq_tail_)) {
+    return nullptr;
+  }
+  return &cqes_[head & cq_mask_];
+}
+
+void IoUring::pop_cqe() {
+  store_release(cq_head_, *cq_head_ + 1);
+}
+
+bool IoUring::has_overflow() const {
+  return (load_acquire(sq_flags_) & IORING_SQ_CQ_OVERFLOW) != 0;
+}
+
+Status IoUring::flush_overflow() {
+  return enter(0, IORING_ENTER_GETEVENTS);
+}
+
+Status IoUring::register_buffer_ring(void *ring, uint32 entries, uint16 group_id) {
+  struct io_uring_buf_reg reg;
+  std::memset(&reg, 0, sizeof(reg));
+  reg.ring_addr = reinterpret_cast<uint64>(ring);
+  reg.ring_entries = entries;
+  reg.bgid = group_id;
+  if (syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+    return OS_ERROR("Failed to register io_uring buffer ring");
+  }
+  return Status::OK();
+}
+
+}  // namespace detail
+}  // namespace td
+
+#endif
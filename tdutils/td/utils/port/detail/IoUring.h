@@ -0,0 +1,93 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2019 Telegram Systems LLP
+*/
+#pragma once
+
+#include "td/utils/port/config.h"
+
+#include "td/utils/common.h"
+
+#if TD_HAVE_IO_URING
+
+#include "td/utils/port/detail/NativeFd.h"
+#include "td/utils/Status.h"
+
+#include <linux/io_uring.h>
+
+namespace td {
+namespace detail {
+
+// Submission and completion queues of an io_uring instance, set up with raw system calls.
+// Used only by the experimental io_uring backend of UdpSocketFd, which is off by default.
+class IoUring {
+ public:
+  IoUring() = default;
+  IoUring(const IoUring &) = delete;
+  IoUring &operator=(const IoUring &) = delete;
+  IoUring(IoUring &&) = delete;
+  IoUring &operator=(IoUring &&) = delete;
+  ~IoUring();
+
+  // returns file descriptor of the ring, which becomes readable when there are unprocessed completions;
+  // the descriptor is owned by the caller and must not be closed before the object is destroyed
+  Result<NativeFd> init(uint32 entries, uint32 completion_entries) TD_WARN_UNUSED_RESULT;
+
+  // returns nullptr if the submission queue is full
+  struct io_uring_sqe *get_sqe();
+  Status submit() TD_WARN_UNUSED_RESULT;
+  Status submit_and_wait(uint32 min_completions) TD_WARN_UNUSED_RESULT;
+
+  // returns nullptr if there are no completions
+  const struct io_uring_cqe *peek_cqe() const;
+  void pop_cqe();
+
+  // completions, which didn't fit into the completion queue, are kept by the kernel until the next system call
+  bool has_overflow() const;
+  Status flush_overflow() TD_WARN_UNUSED_RESULT;
+
+  Status register_buffer_ring(void *ring, uint32 entries, uint16 group_id) TD_WARN_UNUSED_RESULT;
+
+ private:
+  int fd_{-1};
+
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  struct io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+
+  uint32 *sq_tail_{nullptr};
+  uint32 *sq_flags_{nullptr};
+  uint32 sq_mask_{0};
+  uint32 sq_entries_{0};
+  uint32 *sq_head_{nullptr};
+  uint32 sq_local_tail_{0};
+
+  uint32 *cq_head_{nullptr};
+  uint32 *cq_tail_{nullptr};
+  uint32 cq_mask_{0};
+  struct io_uring_cqe *cqes_{nullptr};
+
+  Status enter(uint32 min_completions, uint32 flags) TD_WARN_UNUSED_RESULT;
+};
+
+}  // namespace detail
+}  // namespace td
+
+#endif
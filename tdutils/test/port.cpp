@@ -134,6 +134,27 @@ TEST(Port, Writev) {
   ASSERT_EQ(expected_content, content);
 }
 
+TEST(Port, Pwritev) {
+  std::vector<IoSlice> vec;
+  CSlice test_file_path = "test.txt";
+  unlink(test_file_path).ignore();
+  auto fd = FileFd::open(test_file_path, FileFd::Write | FileFd::Read | FileFd::CreateNew).move_as_ok();
+  vec.push_back(as_io_slice("ab"));
+  vec.push_back(as_io_slice(""));
+  vec.push_back(as_io_slice("cde"));
+  ASSERT_EQ(5u, fd.pwritev(vec, 0).move_as_ok());
+  vec.clear();
+  vec.push_back(as_io_slice("XY"));
+  vec.push_back(as_io_slice("fgh"));
+  ASSERT_EQ(5u, fd.pwritev(vec, 3).move_as_ok());
+  ASSERT_TRUE(fd.pwritev(vec, -1).is_error());
+  Slice expected_content = "abcXYfgh";
+  ASSERT_EQ(static_cast<int64>(expected_content.size()), fd.get_size().ok());
+  std::string content(expected_content.size(), '\0');
+  ASSERT_EQ(content.size(), fd.pread(content, 0).move_as_ok());
+  ASSERT_EQ(expected_content, content);
+}
+
 #if TD_PORT_POSIX && !TD_THREAD_UNSUPPORTED
 #include <signal.h>
 #include <sys/syscall.h>
@@ -37,6 +37,74 @@
 #include <memory>
 #include <set>
 
+namespace {
+
+char stream_byte(td::uint64 pos) {
+  return static_cast<char>(pos * 7 + pos / 1000);
+}
+
+// answers are produced part by part
+class StreamCallback : public ton::rldp::Rldp::StreamCallback {
+ public:
+  class Source : public ton::rldp::Rldp::StreamSource {
+   public:
+    explicit Source(td::uint64 size) : size_(size) {
+    }
+    td::uint64 size() const override {
+      return size_;
+    }
+    void get_part(td::uint64 offset, td::uint64 size, td::Promise<td::BufferSlice> promise) override {
+      CHECK(offset == next_offset_);
+      CHECK(size <= ton::rldp::Rldp::stream_part_size());
+      next_offset_ += size;
+      td::BufferSlice data{size};
+      for (td::uint64 i = 0; i < size; i++) {
+        data.as_slice()[i] = stream_byte(offset + i);
+      }
+      promise.set_value(std::move(data));
+    }
+
+   private:
+    td::uint64 size_;
+    td::uint64 next_offset_ = 0;
+  };
+
+  void receive_query(ton::adnl::AdnlNodeIdShort src, ton::adnl::AdnlNodeIdShort dst, td::BufferSlice data,
+                     td::Promise<std::unique_ptr<ton::rldp::Rldp::StreamSource>> promise) override {
+    CHECK(data.size() == 5);
+    td::uint32 size = *reinterpret_cast<const td::uint32 *>(data.as_slice().remove_prefix(1).begin());
+    promise.set_value(std::make_unique<Source>(size));
+  }
+};
+
+// checks the answer of StreamCallback without keeping it in memory
+class StreamSink : public ton::rldp::Rldp::StreamSink {
+ public:
+  StreamSink(td::uint64 size, td::Promise<td::Unit> promise) : size_(size), promise_(std::move(promise)) {
+  }
+  void on_part(td::uint64 offset, td::BufferSlice data, td::Promise<td::Unit> promise) override {
+    CHECK(offset == received_);
+    CHECK(data.size() <= ton::rldp::Rldp::stream_part_size());
+    for (size_t i = 0; i < data.size(); i++) {
+      CHECK(data.as_slice()[i] == stream_byte(offset + i));
+    }
+    received_ += data.size();
+    promise.set_value(td::Unit());
+  }
+  void on_finish(td::Result<td::Unit> result) override {
+    result.ensure();
+    CHECK(received_ == size_);
+    promise_.set_value(td::Unit());
+  }
+
+ private:
+  td::uint64 size_;
+  td::uint64 received_ = 0;
+  td::Promise<td::Unit> promise_;
+};
+
+}  // namespace
+
 int main() {
   SET_VERBOSITY_LEVEL(verbosity_INFO);
 
@@ -136,54 +204,76 @@ int main() {
     td::actor::send_closure(adnl, &ton::adnl::Adnl::subscribe, dst, "1", std::make_unique<Callback>(remaining));
   });
 
-  std::vector<td::uint32> sizes{1, 1024, 1 << 20, 2 << 20, 3 << 20, 10 << 20, 16 << 20};
-
-  for (auto &size : sizes) {
-    LOG(ERROR) << "testing delivering of packet of size " << size;
-
-    auto f = td::Clocks::system();
-    scheduler.run_in_context([&] {
-      remaining++;
-      td::actor::send_closure(rldp, &ton::rldp::Rldp::send_query_ex, src, dst, std::string("t"),
-                              td::PromiseCreator::lambda([&](td::Result<td::BufferSlice> R) {
-                                R.ensure();
-                                remaining--;
-                              }),
-                              td::Timestamp::in(1024.0), send_packet(size), size + 1024);
-    });
-
-    auto t = td::Timestamp::in(1024.0);
-    while (scheduler.run(16)) {
-      if (!remaining) {
-        break;
-      }
-      if (t.is_in_past()) {
-        LOG(FATAL) << "failed to receive packets: remaining=" << remaining;
+  auto test_sizes = [&](const std::vector<td::uint32> &sizes) {
+    for (auto &size : sizes) {
+      LOG(ERROR) << "testing delivering of packet of size " << size;
+
+      auto f = td::Clocks::system();
+      scheduler.run_in_context([&] {
+        remaining++;
+        td::actor::send_closure(rldp, &ton::rldp::Rldp::send_query_ex, src, dst, std::string("t"),
+                                td::PromiseCreator::lambda([&](td::Result<td::BufferSlice> R) {
+                                  R.ensure();
+                                  remaining--;
+                                }),
+                                td::Timestamp::in(1024.0), send_packet(size), size + 1024);
+      });
+
+      auto t = td::Timestamp::in(1024.0);
+      while (scheduler.run(16)) {
+        if (!remaining) {
+          break;
+        }
+        if (t.is_in_past()) {
+          LOG(FATAL) << "failed to receive packets: remaining=" << remaining;
+        }
       }
+
+      auto time = td::Clocks::system() - f;
+      LOG(ERROR) << "success. Time=" << time << " Speed=" << size / time / (1 << 20) << "MiB/s";
     }
+  };
 
-    LOG(ERROR) << "success. Time=" << (td::Clocks::system() - f);
-  }
+  std::vector<td::uint32> sizes{1, 1024, 1 << 20, 2 << 20, 3 << 20, 10 << 20, 16 << 20};
+  test_sizes(sizes);
 
   scheduler.run_in_context([&] {
     td::actor::send_closure(network_manager, &ton::adnl::TestLoopbackNetworkManager::set_loss_probability, 0.1);
   });
   LOG(ERROR) << "set loss to 10%";
+  test_sizes(sizes);
 
-  for (auto &size : sizes) {
-    LOG(ERROR) << "testing delivering of packet of size " << size;
+  std::vector<td::uint32> short_sizes{1, 1024, 1 << 20, 3 << 20};
 
-    auto f = td::Clocks::system();
-    scheduler.run_in_context([&] {
-      remaining++;
-      td::actor::send_closure(rldp, &ton::rldp::Rldp::send_query_ex, src, dst, std::string("t"),
-                              td::PromiseCreator::lambda([&](td::Result<td::BufferSlice> R) {
-                                R.ensure();
-                                remaining--;
-                              }),
-                              td::Timestamp::in(1024.0), send_packet(size), size + 1024);
-    });
+  scheduler.run_in_context([&] {
+    td::actor::send_closure(network_manager, &ton::adnl::TestLoopbackNetworkManager::set_loss_probability, 0.0);
+    td::actor::send_closure(network_manager, &ton::adnl::TestLoopbackNetworkManager::set_latency, 0.02);
+  });
+  LOG(ERROR) << "set latency to 20ms";
+  test_sizes(short_sizes);
 
+  scheduler.run_in_context([&] {
+    td::actor::send_closure(network_manager, &ton::adnl::TestLoopbackNetworkManager::set_loss_probability, 0.1);
+  });
+  LOG(ERROR) << "set latency to 20ms, loss to 10%";
+  test_sizes(short_sizes);
+
+  scheduler.run_in_context([&] {
+    td::actor::send_closure(network_manager, &ton::adnl::TestLoopbackNetworkManager::set_loss_probability, 0.0);
+    td::actor::send_closure(network_manager, &ton::adnl::TestLoopbackNetworkManager::set_latency, 0.01);
+    td::actor::send_closure(network_manager, &ton::adnl::TestLoopbackNetworkManager::set_bandwidth, 5000.0, 500);
+  });
+  LOG(ERROR) << "set latency to 10ms, bandwidth to 5000 packets/s";
+  test_sizes(short_sizes);
+
+  scheduler.run_in_context([&] {
+    td::actor::send_closure(network_manager, &ton::adnl::TestLoopbackNetworkManager::set_latency, 0.0);
+    td::actor::send_closure(network_manager, &ton::adnl::TestLoopbackNetworkManager::set_bandwidth, 0.0, 0);
+    td::actor::send_closure(rldp, &ton::rldp::Rldp::subscribe_stream, dst, std::string("2"),
+                            std::make_unique<StreamCallback>());
+  });
+
+  auto wait = [&] {
     auto t = td::Timestamp::in(1024.0);
     while (scheduler.run(16)) {
       if (!remaining) {
@@ -193,10 +283,77 @@ int main() {
         LOG(FATAL) << "failed to receive packets: remaining=" << remaining;
       }
     }
+  };
 
+  for (td::uint32 size : std::vector<td::uint32>{1, 1024, 1 << 20, 10 << 20}) {
+    LOG(ERROR) << "testing streamed answer of size " << size;
+    auto f = td::Clocks::system();
+    scheduler.run_in_context([&] {
+      remaining++;
+      auto query = send_packet(size);
+      query.as_slice()[0] = '2';
+      auto sink = std::make_unique<StreamSink>(size, td::PromiseCreator::lambda([&](td::Unit) { remaining--; }));
+      td::actor::send_closure(rldp, &ton::rldp::Rldp::send_query_stream, src, dst, std::string("t"), std::move(sink),
+                              td::Timestamp::in(1024.0), std::move(query), size + 1024);
+    });
+    wait();
     LOG(ERROR) << "success. Time=" << (td::Clocks::system() - f);
   }
 
+  LOG(ERROR) << "testing streamed answer as an ordinary one";
+  scheduler.run_in_context([&] {
+    remaining++;
+    auto query = send_packet(3 << 20);
+    query.as_slice()[0] = '2';
+    td::actor::send_closure(rldp, &ton::rldp::Rldp::send_query_ex, src, dst, std::string("t"),
+                            td::PromiseCreator::lambda([&](td::Result<td::BufferSlice> R) {
+                              if (R.is_error()) {
+                                LOG(FATAL) << "query failed: " << R.move_as_error();
+                                return;
+                              }
+                              auto data = R.move_as_ok();
+                              CHECK(data.size() == 3 << 20);
+                              for (size_t i = 0; i < data.size(); i++) {
+                                CHECK(data.as_slice()[i] == stream_byte(i));
+                              }
+                              remaining--;
+                            }),
+                            td::Timestamp::in(1024.0), std::move(query), (3 << 20) + 1024);
+  });
+  wait();
+
+  LOG(ERROR) << "testing ordinary answer as a streamed one";
+  scheduler.run_in_context([&] {
+    class Sink : public ton::rldp::Rldp::StreamSink {
+     public:
+      explicit Sink(std::atomic<td::uint32> &remaining) : remaining_(remaining) {
+      }
+      void on_part(td::uint64 offset, td::BufferSlice data, td::Promise<td::Unit> promise) override {
+        CHECK(offset == data_.size());
+        data_ += data.as_slice().str();
+        promise.set_value(td::Unit());
+      }
+      void on_finish(td::Result<td::Unit> result) override {
+        result.ensure();
+        CHECK(data_.size() == 3 << 20);
+        td::Slice data = data_;
+        CHECK(td::crc32c(data.truncate(data.size() - 4)) ==
+              *reinterpret_cast<const td::uint32 *>(td::Slice(data_).remove_prefix(data_.size() - 4).begin()));
+        remaining_--;
+      }
+
+     private:
+      std::atomic<td::uint32> &remaining_;
+      std::string data_;
+    };
+    remaining++;
+    td::actor::send_closure(rldp, &ton::rldp::Rldp::send_query_stream, src, dst, std::string("t"),
+                            std::make_unique<Sink>(remaining), td::Timestamp::in(1024.0), send_packet(3 << 20),
+                            (3 << 20) + 1024);
+  });
+  wait();
+  LOG(ERROR) << "success";
+
   td::rmrf(db_root_).ensure();
   std::_Exit(0);
   return 0;
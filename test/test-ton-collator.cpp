@@ -45,6 +45,7 @@
 
 #include "validator/fabric.h"
 #include "validator/impl/collator.h"
+#include "validator/impl/validate-query.hpp"
 #include "crypto/vm/cp0.h"
 #include "crypto/block/block-db.h"
 
@@ -428,6 +429,18 @@ int main(int argc, char *argv[]) {
                    return td::Status::Error("cannot parse BlockIdExt");
                  }
                });
+  p.add_option('t', "validate-threads", "number of threads re-running transactions when validating the new block",
+               [&](td::Slice arg) {
+                 TRY_RESULT(threads, td::to_integer_safe<int>(arg));
+                 ton::validator::validate_query_threads = threads;
+                 return td::Status::OK();
+               });
+  p.add_option('j', "collate-threads", "number of threads executing transactions ahead of time when collating",
+               [&](td::Slice arg) {
+                 TRY_RESULT(threads, td::to_integer_safe<int>(arg));
+                 ton::collator_threads = threads;
+                 return td::Status::OK();
+               });
   p.add_option('d', "daemonize", "set SIGHUP", [&]() {
     td::set_signal_handler(td::SignalType::HangUp, [](int sig) {
 #if TD_DARWIN || TD_LINUX
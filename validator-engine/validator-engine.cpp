@@ -1056,6 +1056,8 @@ td::Status ValidatorEngine::load_global_config() {
   if (db_depth_ <= 32) {
     validator_options_.write().set_filedb_depth(db_depth_);
   }
+  validator_options_.write().set_tx_index_enabled(tx_index_);
+  validator_options_.write().set_persistent_state_deltas_enabled(persistent_state_deltas_);
 
   std::vector<ton::BlockIdExt> h;
   for (auto &x : conf.validator_->hardforks_) {
@@ -1362,7 +1364,7 @@ void ValidatorEngine::start() {
 }
 
 void ValidatorEngine::start_adnl() {
-  adnl_network_manager_ = ton::adnl::AdnlNetworkManager::create(config_.out_port);
+  adnl_network_manager_ = ton::adnl::AdnlNetworkManager::create(config_.out_port, udp_receivers_);
   adnl_ = ton::adnl::Adnl::create(db_root_, keyring_.get());
   td::actor::send_closure(adnl_, &ton::adnl::Adnl::register_network_manager, adnl_network_manager_.get());
 
@@ -2969,6 +2971,37 @@ int main(int argc, char *argv[]) {
                  acts.push_back([&x, v]() { td::actor::send_closure(x, &ValidatorEngine::set_sync_ttl, v); });
                  return td::Status::OK();
                });
+  p.add_option('U', "udp-receivers",
+               "number of SO_REUSEPORT sockets receiving packets on each UDP port, decrypting them on their own "
+               "threads (default=1)",
+               [&](td::Slice arg) {
+                 auto v = td::to_integer<td::uint32>(arg);
+                 if (v < 1 || v > 256) {
+                   return td::Status::Error(ton::ErrorCode::error,
+                                            "bad value for --udp-receivers: should be in range [1..256]");
+                 }
+                 acts.push_back([&x, v]() { td::actor::send_closure(x, &ValidatorEngine::set_udp_receivers, v); });
+                 return td::Status::OK();
+               });
+  p.add_option('T', "tx-index",
+               "keep an index of account transactions, so that liteserver getTransactions queries for long "
+               "histories are answered without walking them one block at a time. Only blocks applied after the "
+               "option is enabled are indexed (no backfill), and entries are not removed when old blocks are "
+               "garbage collected. A block is indexed after it is archived; if indexing fails, a warning is logged "
+               "and the block stays missing from the index",
+               [&]() {
+                 acts.push_back([&x]() { td::actor::send_closure(x, &ValidatorEngine::set_tx_index); });
+                 return td::Status::OK();
+               });
+  p.add_option('P', "persistent-state-deltas",
+               "store a persistent state as a delta against the latest full persistent state of the same shard "
+               "when there is one. A full state is stored at most every 9th time, and it is kept until all deltas "
+               "against it are deleted. Deltas are served to other nodes as full states, which are rebuilt from "
+               "the delta and the base file on first request",
+               [&]() {
+                 acts.push_back([&x]() { td::actor::send_closure(x, &ValidatorEngine::set_persistent_state_deltas); });
+                 return td::Status::OK();
+               });
   td::uint32 threads = 7;
   p.add_option('t', "threads", PSTRING() << "number of threads (default=" << threads << ")", [&](td::Slice fname) {
     td::int32 v;
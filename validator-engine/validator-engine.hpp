@@ -196,6 +196,9 @@ class ValidatorEngine : public td::actor::Actor {
   td::Clocks::Duration archive_ttl_ = 0;
   td::Clocks::Duration key_proof_ttl_ = 0;
   td::uint32 db_depth_ = 33;
+  td::uint32 udp_receivers_ = 1;
+  bool tx_index_ = false;
+  bool persistent_state_deltas_ = false;
   bool read_config_ = false;
   bool started_keyring_ = false;
   bool started_ = false;
@@ -214,6 +217,15 @@ class ValidatorEngine : public td::actor::Actor {
   void set_db_depth(td::uint32 value) {
     db_depth_ = value;
   }
+  void set_udp_receivers(td::uint32 value) {
+    udp_receivers_ = value;
+  }
+  void set_tx_index() {
+    tx_index_ = true;
+  }
+  void set_persistent_state_deltas() {
+    persistent_state_deltas_ = true;
+  }
   void set_state_ttl(td::Clocks::Duration t) {
     state_ttl_ = t;
   }
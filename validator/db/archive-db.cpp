@@ -42,7 +42,9 @@ void ArchiveFile::start_up() {
     return;
   }
   package_ = std::make_shared<Package>(R.move_as_ok());
-  index_ = std::make_shared<td::RocksDb>(td::RocksDb::open(path_ + ".index").move_as_ok());
+  td::RocksDbOptions db_options;
+  db_options.workload = td::RocksDbOptions::Workload::RangeScan;
+  index_ = std::make_shared<td::RocksDb>(td::RocksDb::open(path_ + ".index", std::move(db_options)).move_as_ok());
 
   std::string value;
   auto R2 = index_->get("status", value);
@@ -20,6 +20,7 @@
 #include "td/actor/MultiPromise.h"
 #include "td/utils/overloaded.h"
 #include "files-async.hpp"
+#include "persistent-state-delta.hpp"
 #include "td/db/RocksDb.h"
 #include "common/delay.h"
 
@@ -283,6 +284,20 @@ void ArchiveManager::written_perm_state(FileReferenceShort id) {
   perm_states_.emplace(id.hash(), id);
 }
 
+void ArchiveManager::written_perm_state_delta(FileReferenceShort id, FileHash base) {
+  auto hash = id.hash();
+  perm_states_.emplace(hash, id);
+  perm_state_bases_[hash] = base;
+}
+
+void ArchiveManager::release_perm_state_base(FileHash base) {
+  auto it = perm_state_base_refs_.find(base);
+  CHECK(it != perm_state_base_refs_.end());
+  if (--it->second == 0) {
+    perm_state_base_refs_.erase(it);
+  }
+}
+
 void ArchiveManager::add_zero_state(BlockIdExt block_id, td::BufferSlice data, td::Promise<td::Unit> promise) {
   auto id = FileReference{fileref::ZeroState{block_id}};
   auto hash = id.hash();
@@ -328,6 +343,94 @@ void ArchiveManager::add_persistent_state(BlockIdExt block_id, BlockIdExt master
       .release();
 }
 
+void ArchiveManager::add_persistent_state_gen(BlockIdExt block_id, BlockIdExt masterchain_block_id,
+                                              std::function<td::Status(td::FileFd&)> write_state,
+                                              td::Promise<td::Unit> promise) {
+  auto id = FileReference{fileref::PersistentState{block_id, masterchain_block_id}};
+  auto hash = id.hash();
+  if (perm_states_.find(hash) != perm_states_.end()) {
+    promise.set_value(td::Unit());
+    return;
+  }
+
+  auto path = db_root_ + "/archive/states/" + id.filename_short();
+  auto P = td::PromiseCreator::lambda(
+      [SelfId = actor_id(this), id = id.shortref(), promise = std::move(promise)](td::Result<std::string> R) mutable {
+        if (R.is_error()) {
+          promise.set_error(R.move_as_error());
+        } else {
+          td::actor::send_closure(SelfId, &ArchiveManager::written_perm_state, id);
+          promise.set_value(td::Unit());
+        }
+      });
+  td::actor::create_actor<db::WriteFile>("writefile", db_root_ + "/archive/tmp/", path, std::move(write_state),
+                                         std::move(P))
+      .release();
+}
+
+void ArchiveManager::add_persistent_state_delta(BlockIdExt block_id, BlockIdExt masterchain_block_id,
+                                                td::Ref<vm::Cell> root,
+                                                std::function<td::Status(td::FileFd&)> write_state,
+                                                td::Promise<td::Unit> promise) {
+  auto id = FileReference{fileref::PersistentState{block_id, masterchain_block_id}};
+  auto hash = id.hash();
+  if (perm_states_.find(hash) != perm_states_.end()) {
+    promise.set_value(td::Unit());
+    return;
+  }
+
+  // the base is the latest full persistent state of the same shard; deltas are never taken against deltas
+  const FileReferenceShort *base = nullptr;
+  BlockSeqno base_seqno = 0;
+  for (auto &p : perm_states_) {
+    if (perm_state_bases_.count(p.first)) {
+      continue;
+    }
+    auto refs = perm_state_base_refs_.find(p.first);
+    if (refs != perm_state_base_refs_.end() && refs->second >= max_persistent_state_deltas()) {
+      continue;
+    }
+    p.second.ref().visit(td::overloaded(
+        [&](const fileref::PersistentStateShort &x) {
+          if (x.shard_id == block_id.shard_full() && x.masterchain_seqno < masterchain_block_id.seqno() &&
+              (!base || x.masterchain_seqno > base_seqno)) {
+            base = &p.second;
+            base_seqno = x.masterchain_seqno;
+          }
+        },
+        [&](const auto &obj) {}));
+  }
+  if (!base) {
+    add_persistent_state_gen(block_id, masterchain_block_id, std::move(write_state), std::move(promise));
+    return;
+  }
+
+  auto base_hash = base->hash();
+  auto base_path = db_root_ + "/archive/states/" + base->filename_short();
+  perm_state_base_refs_[base_hash]++;
+  auto write_delta = [root = std::move(root), base_hash, base_path](td::FileFd &fd) {
+    return db::PersistentStateDelta::write(fd, root, base_hash, base_path);
+  };
+
+  auto path = db_root_ + "/archive/states/" + id.filename_short();
+  auto P = td::PromiseCreator::lambda([SelfId = actor_id(this), id = id.shortref(), block_id, masterchain_block_id,
+                                       base_hash, write_state = std::move(write_state),
+                                       promise = std::move(promise)](td::Result<std::string> R) mutable {
+    if (R.is_error()) {
+      LOG(WARNING) << "cannot write persistent state delta, storing full state: " << R.move_as_error();
+      td::actor::send_closure(SelfId, &ArchiveManager::release_perm_state_base, base_hash);
+      td::actor::send_closure(SelfId, &ArchiveManager::add_persistent_state_gen, block_id, masterchain_block_id,
+                              std::move(write_state), std::move(promise));
+    } else {
+      td::actor::send_closure(SelfId, &ArchiveManager::written_perm_state_delta, id, base_hash);
+      promise.set_value(td::Unit());
+    }
+  });
+  td::actor::create_actor<db::WriteFile>("writefile", db_root_ + "/archive/tmp/", path, std::move(write_delta),
+                                         std::move(P))
+      .release();
+}
+
 void ArchiveManager::get_zero_state(BlockIdExt block_id, td::Promise<td::BufferSlice> promise) {
   auto id = FileReference{fileref::ZeroState{block_id}};
   auto hash = id.hash();
@@ -359,8 +462,10 @@ void ArchiveManager::get_persistent_state(BlockIdExt block_id, BlockIdExt master
     return;
   }
 
-  auto path = db_root_ + "/archive/states/" + id.filename_short();
-  td::actor::create_actor<db::ReadFile>("readfile", path, 0, -1, 0, std::move(promise)).release();
+  get_perm_state_path(hash, [promise = std::move(promise)](td::Result<std::string> R) mutable {
+    TRY_RESULT_PROMISE(promise, path, std::move(R));
+    td::actor::create_actor<db::ReadFile>("readfile", path, 0, -1, 0, std::move(promise)).release();
+  });
 }
 
 void ArchiveManager::get_persistent_state_slice(BlockIdExt block_id, BlockIdExt masterchain_block_id, td::int64 offset,
@@ -372,8 +477,81 @@ void ArchiveManager::get_persistent_state_slice(BlockIdExt block_id, BlockIdExt
     return;
   }
 
-  auto path = db_root_ + "/archive/states/" + id.filename_short();
-  td::actor::create_actor<db::ReadFile>("readfile", path, offset, max_size, 0, std::move(promise)).release();
+  get_perm_state_path(hash, [offset, max_size, promise = std::move(promise)](td::Result<std::string> R) mutable {
+    TRY_RESULT_PROMISE(promise, path, std::move(R));
+    td::actor::create_actor<db::ReadFile>("readfile", path, offset, max_size, 0, std::move(promise)).release();
+  });
+}
+
+void ArchiveManager::get_perm_state_path(FileHash hash, td::Promise<std::string> promise) {
+  auto it = perm_states_.find(hash);
+  CHECK(it != perm_states_.end());
+  auto path = db_root_ + "/archive/states/" + it->second.filename_short();
+  auto base_it = perm_state_bases_.find(hash);
+  if (base_it == perm_state_bases_.end()) {
+    promise.set_value(std::move(path));
+    return;
+  }
+
+  // deltas are served as full states, so their full copies are kept for a few recently read ones
+  auto full_path = db_root_ + "/archive/states-full/" + it->second.filename_short();
+  auto r = std::find(perm_state_reconstructed_.begin(), perm_state_reconstructed_.end(), hash);
+  if (r != perm_state_reconstructed_.end()) {
+    perm_state_reconstructed_.erase(r);
+    perm_state_reconstructed_.push_back(hash);
+    promise.set_value(std::move(full_path));
+    return;
+  }
+  auto &waiting = perm_state_reconstructing_[hash];
+  waiting.push_back(std::move(promise));
+  if (waiting.size() > 1) {
+    return;
+  }
+
+  auto base = perm_states_.find(base_it->second);
+  CHECK(base != perm_states_.end());
+  auto base_path = db_root_ + "/archive/states/" + base->second.filename_short();
+  auto reconstruct = [path, base_path](td::FileFd &fd) {
+    return db::PersistentStateDelta::reconstruct(path, base_path, fd);
+  };
+  auto P = td::PromiseCreator::lambda([SelfId = actor_id(this), hash](td::Result<std::string> R) {
+    td::actor::send_closure(SelfId, &ArchiveManager::reconstructed_perm_state, hash, std::move(R));
+  });
+  td::actor::create_actor<db::WriteFile>("writefile", db_root_ + "/archive/tmp/", full_path, std::move(reconstruct),
+                                         std::move(P))
+      .release();
+}
+
+void ArchiveManager::reconstructed_perm_state(FileHash hash, td::Result<std::string> R) {
+  auto it = perm_state_reconstructing_.find(hash);
+  CHECK(it != perm_state_reconstructing_.end());
+  auto promises = std::move(it->second);
+  perm_state_reconstructing_.erase(it);
+  if (R.is_error()) {
+    LOG(ERROR) << "cannot reconstruct persistent state from delta: " << R.error();
+    for (auto &promise : promises) {
+      promise.set_error(R.error().clone());
+    }
+    return;
+  }
+  auto path = R.move_as_ok();
+  if (perm_states_.find(hash) == perm_states_.end()) {
+    td::unlink(path).ignore();
+    for (auto &promise : promises) {
+      promise.set_error(td::Status::Error(ErrorCode::notready, "state file not in db"));
+    }
+    return;
+  }
+
+  perm_state_reconstructed_.push_back(hash);
+  while (perm_state_reconstructed_.size() > max_reconstructed_persistent_states()) {
+    auto &F = perm_states_[perm_state_reconstructed_.front()];
+    td::unlink(db_root_ + "/archive/states-full/" + F.filename_short()).ignore();
+    perm_state_reconstructed_.erase(perm_state_reconstructed_.begin());
+  }
+  for (auto &promise : promises) {
+    promise.set_value(std::string(path));
+  }
 }
 
 void ArchiveManager::check_persistent_state(BlockIdExt block_id, BlockIdExt masterchain_block_id,
@@ -798,6 +976,8 @@ void ArchiveManager::start_up() {
   td::mkdir(db_root_ + "/archive/tmp/").ensure();
   td::mkdir(db_root_ + "/archive/packages/").ensure();
   td::mkdir(db_root_ + "/archive/states/").ensure();
+  td::rmrf(db_root_ + "/archive/states-full/").ignore();
+  td::mkdir(db_root_ + "/archive/states-full/").ensure();
   td::mkdir(db_root_ + "/files/").ensure();
   td::mkdir(db_root_ + "/files/packages/").ensure();
   index_ = std::make_shared<td::RocksDb>(td::RocksDb::open(db_root_ + "/files/globalindex").move_as_ok());
@@ -843,9 +1023,25 @@ void ArchiveManager::start_up() {
       }
       auto f = R.move_as_ok();
       auto hash = f.hash();
+      auto B = db::PersistentStateDelta::read_base(db_root_ + "/archive/states/" + f.filename_short());
+      if (B.is_ok() && !B.ok().is_zero()) {
+        perm_state_bases_[hash] = B.move_as_ok();
+      }
       perm_states_[hash] = std::move(f);
     }
   }).ensure();
+  for (auto it = perm_state_bases_.begin(); it != perm_state_bases_.end();) {
+    if (perm_states_.count(it->second) == 0) {
+      auto f = perm_states_.find(it->first);
+      LOG(ERROR) << "deleting state file '" << f->second.filename_short() << "': base state is missing";
+      td::unlink(db_root_ + "/archive/states/" + f->second.filename_short()).ignore();
+      perm_states_.erase(f);
+      it = perm_state_bases_.erase(it);
+    } else {
+      perm_state_base_refs_[it->second]++;
+      it++;
+    }
+  }
 
   persistent_state_gc(FileHash::zero());
 }
@@ -900,8 +1096,7 @@ void ArchiveManager::persistent_state_gc(FileHash last) {
                                [&](const auto &obj) { res = -1; }));
 
   if (res == -1) {
-    td::unlink(db_root_ + "/archive/states/" + F.filename_short()).ignore();
-    perm_states_.erase(it);
+    delete_perm_state(hash);
   }
   if (res != 0) {
     delay_action([hash, SelfId = actor_id(
@@ -929,18 +1124,37 @@ void ArchiveManager::got_gc_masterchain_handle(ConstBlockHandle handle, FileHash
     auto ttl = ValidatorManager::persistent_state_ttl(handle->unix_time());
     to_del = ttl < td::Clocks::system();
   }
-  auto it = perm_states_.find(hash);
-  CHECK(it != perm_states_.end());
-  auto &F = it->second;
+  CHECK(perm_states_.find(hash) != perm_states_.end());
+  if (to_del && perm_state_base_refs_.count(hash)) {
+    // deltas of later states are stored against this one
+    to_del = false;
+  }
   if (to_del) {
-    td::unlink(db_root_ + "/archive/states/" + F.filename_short()).ignore();
-    perm_states_.erase(it);
+    delete_perm_state(hash);
   }
   delay_action([hash, SelfId = actor_id(
                           this)]() { td::actor::send_closure(SelfId, &ArchiveManager::persistent_state_gc, hash); },
                td::Timestamp::in(1.0));
 }
 
+void ArchiveManager::delete_perm_state(FileHash hash) {
+  auto it = perm_states_.find(hash);
+  CHECK(it != perm_states_.end());
+  auto &F = it->second;
+  td::unlink(db_root_ + "/archive/states/" + F.filename_short()).ignore();
+  auto base_it = perm_state_bases_.find(hash);
+  if (base_it != perm_state_bases_.end()) {
+    release_perm_state_base(base_it->second);
+    perm_state_bases_.erase(base_it);
+    auto r = std::find(perm_state_reconstructed_.begin(), perm_state_reconstructed_.end(), hash);
+    if (r != perm_state_reconstructed_.end()) {
+      td::unlink(db_root_ + "/archive/states-full/" + F.filename_short()).ignore();
+      perm_state_reconstructed_.erase(r);
+    }
+  }
+  perm_states_.erase(it);
+}
+
 PackageId ArchiveManager::get_temp_package_id() const {
   return get_temp_package_id_by_unixtime(static_cast<UnixTime>(td::Clocks::system()));
 }
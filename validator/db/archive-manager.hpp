@@ -71,6 +71,11 @@ class ArchiveManager : public td::actor::Actor {
   void add_zero_state(BlockIdExt block_id, td::BufferSlice data, td::Promise<td::Unit> promise);
   void add_persistent_state(BlockIdExt block_id, BlockIdExt masterchain_block_id, td::BufferSlice data,
                             td::Promise<td::Unit> promise);
+  void add_persistent_state_gen(BlockIdExt block_id, BlockIdExt masterchain_block_id,
+                                std::function<td::Status(td::FileFd&)> write_state, td::Promise<td::Unit> promise);
+  // stores the state as a delta against an older persistent state of the shard, or with write_state if there is none
+  void add_persistent_state_delta(BlockIdExt block_id, BlockIdExt masterchain_block_id, td::Ref<vm::Cell> root,
+                                  std::function<td::Status(td::FileFd&)> write_state, td::Promise<td::Unit> promise);
   void get_zero_state(BlockIdExt block_id, td::Promise<td::BufferSlice> promise);
   void get_persistent_state(BlockIdExt block_id, BlockIdExt masterchain_block_id, td::Promise<td::BufferSlice> promise);
   void get_persistent_state_slice(BlockIdExt block_id, BlockIdExt masterchain_block_id, td::int64 offset,
@@ -104,6 +109,13 @@ class ArchiveManager : public td::actor::Actor {
   static constexpr td::uint32 key_archive_size() {
     return 200000;
   }
+  static constexpr td::uint32 max_persistent_state_deltas() {
+    return 8;
+  }
+  // full copies of delta persistent states kept for reading
+  static constexpr size_t max_reconstructed_persistent_states() {
+    return 2;
+  }
 
  private:
   struct FileDescription {
@@ -139,6 +151,11 @@ class ArchiveManager : public td::actor::Actor {
   }
 
   std::map<FileHash, FileReferenceShort> perm_states_;
+  // delta persistent state -> its base; a base is not deleted while deltas refer to it
+  std::map<FileHash, FileHash> perm_state_bases_;
+  std::map<FileHash, td::uint32> perm_state_base_refs_;
+  std::map<FileHash, std::vector<td::Promise<std::string>>> perm_state_reconstructing_;
+  std::vector<FileHash> perm_state_reconstructed_;
 
   void load_package(PackageId seqno);
   void delete_package(PackageId seqno, td::Promise<td::Unit> promise);
@@ -163,6 +180,11 @@ class ArchiveManager : public td::actor::Actor {
   PackageId get_prev_temp_file_desc_idx(PackageId id);
 
   void written_perm_state(FileReferenceShort id);
+  void written_perm_state_delta(FileReferenceShort id, FileHash base);
+  void release_perm_state_base(FileHash base);
+  void get_perm_state_path(FileHash hash, td::Promise<std::string> promise);
+  void reconstructed_perm_state(FileHash hash, td::Result<std::string> R);
+  void delete_perm_state(FileHash hash);
 
   void persistent_state_gc(FileHash last);
   void got_gc_masterchain_handle(ConstBlockHandle handle, FileHash hash);
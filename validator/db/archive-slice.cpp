@@ -32,28 +32,48 @@ namespace validator {
 
 void PackageWriter::append(std::string filename, td::BufferSlice data,
                            td::Promise<std::pair<td::uint64, td::uint64>> promise) {
-  auto offset = package_->append(std::move(filename), std::move(data), !async_mode_);
-  auto size = package_->size();
-
-  promise.set_value(std::pair<td::uint64, td::uint64>{offset, size});
+  if (pending_.empty()) {
+    alarm_timestamp() = td::Timestamp::in(flush_delay());
+  }
+  pending_size_ += data.size();
+  pending_.push_back(Package::Entry{std::move(filename), std::move(data)});
+  pending_promises_.push_back(std::move(promise));
+  if (pending_size_ >= max_pending_size()) {
+    flush();
+  }
 }
 
-class PackageReader : public td::actor::Actor {
- public:
-  PackageReader(std::shared_ptr<Package> package, td::uint64 offset,
-                td::Promise<std::pair<std::string, td::BufferSlice>> promise)
-      : package_(std::move(package)), offset_(offset), promise_(std::move(promise)) {
+void PackageWriter::flush() {
+  alarm_timestamp() = td::Timestamp::never();
+  if (pending_.empty()) {
+    return;
   }
-  void start_up() {
-    promise_.set_result(package_->read(offset_));
-    stop();
+  auto offsets = package_->append_batch(pending_, !async_mode_);
+  auto size = package_->size();
+  pending_.clear();
+  pending_size_ = 0;
+
+  auto promises = std::move(pending_promises_);
+  pending_promises_.clear();
+  for (size_t i = 0; i < promises.size(); i++) {
+    // the same package size the entry would get if it was appended alone
+    auto end = i + 1 < offsets.size() ? offsets[i + 1] : size;
+    promises[i].set_value(std::pair<td::uint64, td::uint64>{offsets[i], end});
   }
+}
 
- private:
-  std::shared_ptr<Package> package_;
-  td::uint64 offset_;
-  td::Promise<std::pair<std::string, td::BufferSlice>> promise_;
-};
+void PackageReader::read(std::shared_ptr<const PackageMapping> mapping, td::uint64 offset,
+                         td::Promise<std::pair<std::string, td::BufferSlice>> promise) {
+  if (mapping) {
+    auto R = mapping->read(offset);
+    if (R.is_ok()) {
+      promise.set_value(R.move_as_ok());
+      return;
+    }
+    // the entry may be only partially mapped if it was being written during mapping
+  }
+  promise.set_result(package_->read(offset));
+}
 
 void ArchiveSlice::add_handle(BlockHandle handle, td::Promise<td::Unit> promise) {
   if (destroyed_) {
@@ -258,6 +278,11 @@ void ArchiveSlice::get_file(FileReference ref_id, td::Promise<td::BufferSlice> p
     return;
   }
   auto offset = td::to_integer<td::uint64>(value);
+  auto mapped_size = mapping_ ? mapping_->size() : 0;
+  if (offset >= mapped_size && package_->size() >= mapped_size + remap_threshold()) {
+    remap_package();
+    mapped_size = mapping_ ? mapping_->size() : 0;
+  }
   auto P = td::PromiseCreator::lambda(
       [promise = std::move(promise)](td::Result<std::pair<std::string, td::BufferSlice>> R) mutable {
         if (R.is_error()) {
@@ -266,7 +291,9 @@ void ArchiveSlice::get_file(FileReference ref_id, td::Promise<td::BufferSlice> p
           promise.set_value(std::move(R.move_as_ok().second));
         }
       });
-  td::actor::create_actor<PackageReader>("reader", package_, offset, std::move(P)).release();
+  auto &reader = readers_[next_reader_++ % readers_.size()];
+  td::actor::send_closure(reader, &PackageReader::read, offset < mapped_size ? mapping_ : nullptr, offset,
+                          std::move(P));
 }
 
 void ArchiveSlice::get_block_common(AccountIdPrefixFull account_id,
@@ -421,7 +448,9 @@ void ArchiveSlice::start_up() {
     return;
   }
   package_ = std::make_shared<Package>(R.move_as_ok());
-  kv_ = std::make_shared<td::RocksDb>(td::RocksDb::open(prefix_ + ".index").move_as_ok());
+  td::RocksDbOptions db_options;
+  db_options.workload = td::RocksDbOptions::Workload::RangeScan;
+  kv_ = std::make_shared<td::RocksDb>(td::RocksDb::open(prefix_ + ".index", std::move(db_options)).move_as_ok());
 
   std::string value;
   auto R2 = kv_->get("status", value);
@@ -434,7 +463,22 @@ void ArchiveSlice::start_up() {
     package_->truncate(0);
   }
 
+  remap_package();
+
   writer_ = td::actor::create_actor<PackageWriter>("writer", package_);
+  for (size_t i = 0; i < readers_count(); i++) {
+    readers_.push_back(td::actor::create_actor<PackageReader>("reader", package_));
+  }
+}
+
+void ArchiveSlice::remap_package() {
+  auto R = package_->map();
+  if (R.is_error()) {
+    LOG(WARNING) << "failed to map archive '" << prefix_ << ".pack': " << R.move_as_error();
+    mapping_ = nullptr;
+    return;
+  }
+  mapping_ = std::make_shared<const PackageMapping>(R.move_as_ok());
 }
 
 void ArchiveSlice::begin_transaction() {
@@ -497,7 +541,9 @@ void ArchiveSlice::destroy(td::Promise<td::Unit> promise) {
   destroyed_ = true;
 
   writer_.reset();
+  readers_.clear();
   package_ = nullptr;
+  mapping_ = nullptr;
   kv_ = nullptr;
 
   td::unlink(prefix_ + ".pack").ensure();
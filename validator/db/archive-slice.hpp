@@ -33,6 +33,7 @@ class PackageWriter : public td::actor::Actor {
 
   void append(std::string filename, td::BufferSlice data, td::Promise<std::pair<td::uint64, td::uint64>> promise);
   void set_async_mode(bool mode, td::Promise<td::Unit> promise) {
+    flush();
     async_mode_ = mode;
     if (!async_mode_) {
       package_->sync();
@@ -40,9 +41,44 @@ class PackageWriter : public td::actor::Actor {
     promise.set_value(td::Unit());
   }
 
+  void alarm() override {
+    flush();
+  }
+  void tear_down() override {
+    flush();
+  }
+
  private:
+  // appends received within flush_delay() after the first one are written together and share one fsync
+  void flush();
+
   std::shared_ptr<Package> package_;
   bool async_mode_ = false;
+
+  std::vector<Package::Entry> pending_;
+  std::vector<td::Promise<std::pair<td::uint64, td::uint64>>> pending_promises_;
+  td::uint64 pending_size_ = 0;
+
+  static constexpr td::uint64 max_pending_size() {
+    return 1 << 24;
+  }
+  static constexpr double flush_delay() {
+    return 0.002;
+  }
+};
+
+// a slice keeps a few long-lived readers, so that reads of mapped entries, which may fault in cold pages, run
+// outside of the slice actor without creating an actor per request
+class PackageReader : public td::actor::Actor {
+ public:
+  PackageReader(std::shared_ptr<Package> package) : package_(std::move(package)) {
+  }
+
+  void read(std::shared_ptr<const PackageMapping> mapping, td::uint64 offset,
+            td::Promise<std::pair<std::string, td::BufferSlice>> promise);
+
+ private:
+  std::shared_ptr<Package> package_;
 };
 
 class ArchiveSlice : public td::actor::Actor {
@@ -77,6 +113,7 @@ class ArchiveSlice : public td::actor::Actor {
  private:
   void written_data(BlockHandle handle, td::Promise<td::Unit> promise);
   void add_file_cont(FileReference ref_id, td::uint64 offset, td::uint64 size, td::Promise<td::Unit> promise);
+  void remap_package();
 
   /* ltdb */
   td::BufferSlice get_db_key_lt_desc(ShardIdFull shard);
@@ -94,8 +131,20 @@ class ArchiveSlice : public td::actor::Actor {
 
   std::string prefix_;
   std::shared_ptr<Package> package_;
+  // files below mapping_->size() are read by the readers_ from memory, the rest from the file; readers keep
+  // the mapping alive after a remap
+  std::shared_ptr<const PackageMapping> mapping_;
   std::shared_ptr<td::KeyValue> kv_;
   td::actor::ActorOwn<PackageWriter> writer_;
+  std::vector<td::actor::ActorOwn<PackageReader>> readers_;
+  size_t next_reader_ = 0;
+
+  static constexpr td::uint64 remap_threshold() {
+    return 1 << 24;
+  }
+  static constexpr size_t readers_count() {
+    return 4;
+  }
 };
 
 }  // namespace validator
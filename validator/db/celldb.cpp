@@ -28,15 +28,18 @@ namespace ton {
 
 namespace validator {
 
-CellDbIn::CellDbIn(td::actor::ActorId<RootDb> root_db, td::actor::ActorId<CellDb> parent, std::string path)
-    : root_db_(root_db), parent_(parent), path_(std::move(path)) {
+CellDbIn::CellDbIn(td::actor::ActorId<RootDb> root_db, td::actor::ActorId<CellDb> parent, std::string path,
+                   std::shared_ptr<vm::DataCellCache> cell_cache)
+    : root_db_(root_db), parent_(parent), path_(std::move(path)), cell_cache_(std::move(cell_cache)) {
 }
 
 void CellDbIn::start_up() {
-  cell_db_ = std::make_shared<td::RocksDb>(td::RocksDb::open(path_).move_as_ok());
+  td::RocksDbOptions db_options;
+  db_options.workload = td::RocksDbOptions::Workload::PointLookup;
+  cell_db_ = std::make_shared<td::RocksDb>(td::RocksDb::open(path_, std::move(db_options)).move_as_ok());
 
   boc_ = vm::DynamicBagOfCellsDb::create();
-  boc_->set_loader(std::make_unique<vm::CellLoader>(cell_db_->snapshot())).ensure();
+  boc_->set_loader(std::make_unique<vm::CellLoader>(cell_db_->snapshot(), cell_cache_)).ensure();
   td::actor::send_closure(parent_, &CellDb::update_snapshot, cell_db_->snapshot());
 
   alarm_timestamp() = td::Timestamp::in(10.0);
@@ -96,7 +99,7 @@ void CellDbIn::store_cell(BlockIdExt block_id, td::Ref<vm::Cell> cell, td::Promi
   set_block(key_hash, std::move(D));
   cell_db_->commit_transaction().ensure();
 
-  boc_->set_loader(std::make_unique<vm::CellLoader>(cell_db_->snapshot())).ensure();
+  boc_->set_loader(std::make_unique<vm::CellLoader>(cell_db_->snapshot(), cell_cache_)).ensure();
   td::actor::send_closure(parent_, &CellDb::update_snapshot, cell_db_->snapshot());
 
   promise.set_result(boc_->load_cell(cell->get_hash().as_slice()));
@@ -189,7 +192,7 @@ void CellDbIn::gc_cont2(BlockHandle handle) {
   cell_db_->commit_transaction().ensure();
   alarm_timestamp() = td::Timestamp::now();
 
-  boc_->set_loader(std::make_unique<vm::CellLoader>(cell_db_->snapshot())).ensure();
+  boc_->set_loader(std::make_unique<vm::CellLoader>(cell_db_->snapshot(), cell_cache_)).ensure();
   td::actor::send_closure(parent_, &CellDb::update_snapshot, cell_db_->snapshot());
 
   DCHECK(get_block(last_gc_).is_error());
@@ -251,7 +254,7 @@ void CellDb::load_cell(RootHash hash, td::Promise<td::Ref<vm::DataCell>> promise
   if (!started_) {
     td::actor::send_closure(cell_db_, &CellDbIn::load_cell, hash, std::move(promise));
   } else {
-    auto R = boc_->load_cell(hash.as_slice());
+    auto R = cell_db_reader_->load_cell(hash.as_slice());
     if (R.is_error()) {
       td::actor::send_closure(cell_db_, &CellDbIn::load_cell, hash, std::move(promise));
     } else {
@@ -260,13 +263,33 @@ void CellDb::load_cell(RootHash hash, td::Promise<td::Ref<vm::DataCell>> promise
   }
 }
 
+void CellDb::get_cell_db_reader(td::Promise<std::shared_ptr<vm::CellDbReader>> promise) {
+  if (!started_) {
+    promise.set_error(td::Status::Error(ErrorCode::notready, "celldb is not started yet"));
+    return;
+  }
+  promise.set_value(std::shared_ptr<vm::CellDbReader>(cell_db_reader_));
+}
+
 void CellDb::store_cell(BlockIdExt block_id, td::Ref<vm::Cell> cell, td::Promise<td::Ref<vm::DataCell>> promise) {
   td::actor::send_closure(cell_db_, &CellDbIn::store_cell, block_id, std::move(cell), std::move(promise));
 }
 
 void CellDb::start_up() {
   boc_ = vm::DynamicBagOfCellsDb::create();
-  cell_db_ = td::actor::create_actor<CellDbIn>("celldbin", root_db_, actor_id(this), path_);
+  cell_cache_ = std::make_shared<vm::DataCellCache>(cell_cache_max_bytes());
+  cell_db_ = td::actor::create_actor<CellDbIn>("celldbin", root_db_, actor_id(this), path_, cell_cache_);
+}
+
+void CellDb::prepare_stats(td::Promise<std::vector<std::pair<std::string, std::string>>> promise) {
+  auto stats = cell_cache_->get_stats();
+  std::vector<std::pair<std::string, std::string>> vec;
+  vec.emplace_back("cellcache.hits", td::to_string(stats.hits));
+  vec.emplace_back("cellcache.misses", td::to_string(stats.misses));
+  vec.emplace_back("cellcache.evictions", td::to_string(stats.evictions));
+  vec.emplace_back("cellcache.size", td::to_string(stats.size));
+  vec.emplace_back("cellcache.bytes", td::to_string(stats.bytes));
+  promise.set_value(std::move(vec));
 }
 
 CellDbIn::DbEntry::DbEntry(tl_object_ptr<ton_api::db_celldb_value> entry)
@@ -41,7 +41,8 @@ class CellDbIn : public td::actor::Actor {
   void load_cell(RootHash hash, td::Promise<td::Ref<vm::DataCell>> promise);
   void store_cell(BlockIdExt block_id, td::Ref<vm::Cell> cell, td::Promise<td::Ref<vm::DataCell>> promise);
 
-  CellDbIn(td::actor::ActorId<RootDb> root_db, td::actor::ActorId<CellDb> parent, std::string path);
+  CellDbIn(td::actor::ActorId<RootDb> root_db, td::actor::ActorId<CellDb> parent, std::string path,
+           std::shared_ptr<vm::DataCellCache> cell_cache);
 
   void start_up() override;
   void alarm() override;
@@ -81,6 +82,7 @@ class CellDbIn : public td::actor::Actor {
   td::actor::ActorId<CellDb> parent_;
 
   std::string path_;
+  std::shared_ptr<vm::DataCellCache> cell_cache_;
 
   std::unique_ptr<vm::DynamicBagOfCellsDb> boc_;
   std::shared_ptr<vm::KeyValue> cell_db_;
@@ -94,8 +96,12 @@ class CellDb : public td::actor::Actor {
   void store_cell(BlockIdExt block_id, td::Ref<vm::Cell> cell, td::Promise<td::Ref<vm::DataCell>> promise);
   void update_snapshot(std::unique_ptr<td::KeyValueReader> snapshot) {
     started_ = true;
-    boc_->set_loader(std::make_unique<vm::CellLoader>(std::move(snapshot))).ensure();
+    boc_->set_loader(std::make_unique<vm::CellLoader>(std::move(snapshot), cell_cache_)).ensure();
+    cell_db_reader_ = boc_->get_cell_db_reader();
   }
+  // returns a thread-safe reader of the latest committed snapshot, so that heavy readers do not wait for this actor
+  void get_cell_db_reader(td::Promise<std::shared_ptr<vm::CellDbReader>> promise);
+  void prepare_stats(td::Promise<std::vector<std::pair<std::string, std::string>>> promise);
 
   CellDb(td::actor::ActorId<RootDb> root_db, std::string path) : root_db_(root_db), path_(path) {
   }
@@ -108,7 +114,14 @@ class CellDb : public td::actor::Actor {
 
   td::actor::ActorOwn<CellDbIn> cell_db_;
 
+  // cells loaded by both CellDb and CellDbIn readers, shared across all snapshots
+  static constexpr size_t cell_cache_max_bytes() {
+    return size_t{128} << 20;
+  }
+  std::shared_ptr<vm::DataCellCache> cell_cache_;
+
   std::unique_ptr<vm::DynamicBagOfCellsDb> boc_;
+  std::shared_ptr<vm::CellDbReader> cell_db_reader_;
   bool started_ = false;
 };
 
@@ -19,6 +19,8 @@
 #include "package.hpp"
 #include "common/errorcode.h"
 
+#include <array>
+
 namespace ton {
 
 namespace {
@@ -42,40 +44,132 @@ constexpr td::uint16 entry_header_magic() {
 constexpr td::uint32 package_header_magic() {
   return 0xae8fdd01;
 }
+
+constexpr td::uint32 entry_header_size() {
+  return 8;
+}
+
+// linux limit (IOV_MAX) on the number of buffers in one pwritev
+constexpr std::size_t max_write_slices() {
+  return 1024;
+}
+
+// small entries are read with a single pread into a per-thread buffer and then copied out, so that a returned
+// entry does not keep the whole buffer alive
+constexpr td::uint32 read_prefetch_size() {
+  return 1 << 14;
+}
+
+struct EntryHeader {
+  td::uint32 fname_size;
+  td::uint32 data_size;
+};
+
+using RawEntryHeader = std::array<td::uint32, 2>;
+
+RawEntryHeader make_entry_header(td::Slice filename, td::Slice data) {
+  CHECK(data.size() <= max_data_size());
+  CHECK(filename.size() <= max_filename_size());
+  return RawEntryHeader{{entry_header_magic() + (td::narrow_cast<td::uint32>(filename.size()) << 16),
+                         td::narrow_cast<td::uint32>(data.size())}};
+}
+
+void add_write_slice(std::vector<td::IoSlice> &slices, td::Slice slice) {
+  if (!slice.empty()) {
+    slices.push_back(td::as_io_slice(slice));
+  }
+}
+
+td::Result<EntryHeader> parse_entry_header(td::Slice data, td::uint64 offset) {
+  if (data.size() < entry_header_size()) {
+    return td::Status::Error(ErrorCode::notready, "too short read");
+  }
+  td::uint32 header[2];
+  td::MutableSlice(reinterpret_cast<td::uint8 *>(header), entry_header_size()).copy_from(data.truncate(8));
+  if ((header[0] & 0xffff) != entry_header_magic()) {
+    return td::Status::Error(ErrorCode::notready,
+                             PSTRING() << "bad entry magic " << (header[0] & 0xffff) << " offset=" << offset);
+  }
+  return EntryHeader{header[0] >> 16, header[1]};
+}
 }  // namespace
 
-Package::Package(td::FileFd fd) : fd_(std::move(fd)) {
+Package::Package(td::FileFd fd) : fd_(std::move(fd)), size_(fd_.get_size().move_as_ok()) {
+}
+
+Package::Package(Package &&p)
+    : fd_(std::move(p.fd_)), size_(p.size_.load()), writes_count_(p.writes_count_.load()) {
 }
 
 td::Status Package::truncate(td::uint64 size) {
   TRY_STATUS(fd_.seek(size + header_size()));
-  return fd_.truncate_to_current_position(size + header_size());
+  TRY_STATUS(fd_.truncate_to_current_position(size + header_size()));
+  size_ = size + header_size();
+  return td::Status::OK();
+}
+
+void Package::write_all(std::vector<td::IoSlice> &slices, td::uint64 offset) {
+  std::size_t pos = 0;
+  while (pos < slices.size()) {
+    auto count = std::min(slices.size() - pos, max_write_slices());
+    auto written = fd_.pwritev(td::Span<td::IoSlice>(slices.data() + pos, count), offset).move_as_ok();
+    CHECK(written > 0);
+    offset += written;
+    while (written > 0) {
+      auto slice = td::as_slice(slices[pos]);
+      if (written < slice.size()) {
+        slices[pos] = td::as_io_slice(slice.substr(written));
+        break;
+      }
+      written -= slice.size();
+      pos++;
+    }
+  }
 }
 
 td::uint64 Package::append(std::string filename, td::Slice data, bool sync) {
-  CHECK(data.size() <= max_data_size());
-  CHECK(filename.size() <= max_filename_size());
-  auto size = fd_.get_size().move_as_ok();
-  auto orig_size = size;
-  td::uint32 header[2];
-  header[0] = entry_header_magic() + (td::narrow_cast<td::uint32>(filename.size()) << 16);
-  header[1] = td::narrow_cast<td::uint32>(data.size());
-  CHECK(fd_.pwrite(td::Slice(reinterpret_cast<const td::uint8*>(header), 8), size).move_as_ok() == 8);
-  size += 8;
-  CHECK(fd_.pwrite(filename, size).move_as_ok() == filename.size());
-  size += filename.size();
-  while (data.size() != 0) {
-    auto R = fd_.pwrite(data, size);
-    R.ensure();
-    auto x = R.move_as_ok();
-    CHECK(x > 0);
-    size += x;
-    data.remove_prefix(x);
+  auto header = make_entry_header(filename, data);
+  auto offset = size_.load();
+  std::vector<td::IoSlice> slices;
+  add_write_slice(slices, td::Slice(reinterpret_cast<const td::uint8 *>(header.data()), entry_header_size()));
+  add_write_slice(slices, filename);
+  add_write_slice(slices, data);
+  write_all(slices, offset);
+  size_ = offset + entry_header_size() + filename.size() + data.size();
+  writes_count_++;
+  if (sync) {
+    fd_.sync().ensure();
+  }
+  return offset - header_size();
+}
+
+std::vector<td::uint64> Package::append_batch(const std::vector<Entry> &entries, bool sync) {
+  std::vector<RawEntryHeader> headers;
+  headers.reserve(entries.size());
+  std::vector<td::IoSlice> slices;
+  slices.reserve(entries.size() * 3);
+  std::vector<td::uint64> offsets;
+  offsets.reserve(entries.size());
+  auto offset = size_.load();
+  auto end = offset;
+  for (auto &entry : entries) {
+    headers.push_back(make_entry_header(entry.filename, entry.data.as_slice()));
+    add_write_slice(slices, td::Slice(reinterpret_cast<const td::uint8 *>(headers.back().data()), entry_header_size()));
+    add_write_slice(slices, entry.filename);
+    add_write_slice(slices, entry.data.as_slice());
+    offsets.push_back(end - header_size());
+    end += entry_header_size() + entry.filename.size() + entry.data.size();
   }
+  if (entries.empty()) {
+    return offsets;
+  }
+  write_all(slices, offset);
+  size_ = end;
+  writes_count_++;
   if (sync) {
     fd_.sync().ensure();
   }
-  return orig_size - header_size();
+  return offsets;
 }
 
 void Package::sync() {
@@ -83,40 +177,78 @@ void Package::sync() {
 }
 
 td::uint64 Package::size() const {
-  return fd_.get_size().move_as_ok() - header_size();
+  return size_.load() - header_size();
 }
 
 td::Result<std::pair<std::string, td::BufferSlice>> Package::read(td::uint64 offset) const {
   offset += header_size();
 
-  td::uint32 header[2];
-  TRY_RESULT(s1, fd_.pread(td::MutableSlice(reinterpret_cast<td::uint8*>(header), 8), offset));
-  if (s1 != 8) {
-    return td::Status::Error(ErrorCode::notready, "too short read");
-  }
-  if ((header[0] & 0xffff) != entry_header_magic()) {
-    return td::Status::Error(ErrorCode::notready,
-                             PSTRING() << "bad entry magic " << (header[0] & 0xffff) << " offset=" << offset);
-  }
-  offset += 8;
-  auto fname_size = header[0] >> 16;
-  auto data_size = header[1];
+  static thread_local std::array<char, read_prefetch_size()> buf;
+  TRY_RESULT(s1, fd_.pread(td::MutableSlice(buf.data(), buf.size()), offset));
+  td::Slice prefetched(buf.data(), s1);
+  TRY_RESULT(header, parse_entry_header(prefetched, offset));
+  auto fname_size = header.fname_size;
+  auto data_size = header.data_size;
 
   std::string fname(fname_size, '\0');
-  TRY_RESULT(s2, fd_.pread(fname, offset));
-  if (s2 != fname_size) {
-    return td::Status::Error(ErrorCode::notready, "too short read (filename)");
+  prefetched.remove_prefix(entry_header_size());
+  auto fname_prefetched = std::min<std::size_t>(fname_size, prefetched.size());
+  td::MutableSlice(fname).copy_from(prefetched.substr(0, fname_prefetched));
+  prefetched.remove_prefix(fname_prefetched);
+  offset += entry_header_size() + fname_prefetched;
+  if (fname_prefetched < fname_size) {
+    TRY_RESULT(s2, fd_.pread(td::MutableSlice(fname).substr(fname_prefetched), offset));
+    if (s2 != fname_size - fname_prefetched) {
+      return td::Status::Error(ErrorCode::notready, "too short read (filename)");
+    }
+    offset += s2;
   }
-  offset += fname_size;
 
+  if (prefetched.size() >= data_size) {
+    return std::pair<std::string, td::BufferSlice>{std::move(fname), td::BufferSlice(prefetched.truncate(data_size))};
+  }
   td::BufferSlice data{data_size};
-  TRY_RESULT(s3, fd_.pread(data.as_slice(), offset));
-  if (s3 != data_size) {
+  data.as_slice().copy_from(prefetched);
+  offset += prefetched.size();
+  TRY_RESULT(s3, fd_.pread(data.as_slice().substr(prefetched.size()), offset));
+  if (s3 != data_size - prefetched.size()) {
     return td::Status::Error(ErrorCode::notready, "too short read (data)");
   }
   return std::pair<std::string, td::BufferSlice>{std::move(fname), std::move(data)};
 }
 
+td::Result<PackageMapping> Package::map() const {
+  TRY_RESULT(size, fd_.get_size());
+  if (size <= header_size()) {
+    return PackageMapping{};
+  }
+  TRY_RESULT(mapping, td::MemoryMapping::create_from_file(fd_));
+  return PackageMapping{std::move(mapping)};
+}
+
+td::uint64 PackageMapping::size() const {
+  if (!mapping_) {
+    return 0;
+  }
+  return mapping_.value().as_slice().size() - header_size();
+}
+
+td::Result<std::pair<std::string, td::BufferSlice>> PackageMapping::read(td::uint64 offset) const {
+  if (offset >= size()) {
+    return td::Status::Error(ErrorCode::notready, "offset is not mapped");
+  }
+  offset += header_size();
+  auto entry = mapping_.value().as_slice().substr(static_cast<std::size_t>(offset));
+  TRY_RESULT(header, parse_entry_header(entry, offset));
+  entry.remove_prefix(entry_header_size());
+  if (entry.size() < static_cast<td::uint64>(header.fname_size) + header.data_size) {
+    return td::Status::Error(ErrorCode::notready, "entry is not mapped");
+  }
+  std::string fname = entry.substr(0, header.fname_size).str();
+  entry.remove_prefix(header.fname_size);
+  return std::pair<std::string, td::BufferSlice>{std::move(fname), td::BufferSlice{entry.substr(0, header.data_size)}};
+}
+
 td::Result<td::uint64> Package::advance(td::uint64 offset) {
   offset += header_size();
 
@@ -130,7 +262,7 @@ td::Result<td::uint64> Package::advance(td::uint64 offset) {
   }
 
   offset += 8 + (header[0] >> 16) + header[1];
-  if (offset > static_cast<td::uint64>(fd_.get_size().move_as_ok())) {
+  if (offset > size_.load()) {
     return td::Status::Error(ErrorCode::notready, "truncated read");
   }
   return offset - header_size();
@@ -174,7 +306,7 @@ td::Result<Package> Package::open(std::string path, bool read_only, bool create)
 void Package::iterate(std::function<bool(std::string, td::BufferSlice, td::uint64)> func) {
   td::uint64 p = 0;
 
-  td::uint64 size = fd_.get_size().move_as_ok();
+  td::uint64 size = size_.load();
   if (size < header_size()) {
     LOG(ERROR) << "too short archive";
     return;
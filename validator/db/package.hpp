@@ -20,34 +20,74 @@
 
 #include "td/actor/actor.h"
 #include "td/utils/port/FileFd.h"
+#include "td/utils/port/IoSlice.h"
+#include "td/utils/port/MemoryMapping.h"
 #include "td/utils/buffer.h"
+#include "td/utils/optional.h"
+
+#include <atomic>
 
 namespace ton {
 
+class PackageMapping;
+
 class Package {
  public:
   static td::Result<Package> open(std::string path, bool read_only = false, bool create = false);
 
   Package(td::FileFd fd);
-  Package(Package &&p) = default;
+  Package(Package &&p);
   ~Package();
 
   td::Status truncate(td::uint64 size);
 
+  struct Entry {
+    std::string filename;
+    td::BufferSlice data;
+  };
+
   td::uint64 append(std::string filename, td::Slice data, bool sync = true);
+  // writes all entries with vectored writes and at most one fsync; returns offsets of the entries
+  std::vector<td::uint64> append_batch(const std::vector<Entry> &entries, bool sync = true);
   void sync();
   td::uint64 size() const;
+  // number of append() and non-empty append_batch() calls
+  td::uint64 writes_count() const {
+    return writes_count_;
+  }
   td::Result<std::pair<std::string, td::BufferSlice>> read(td::uint64 offset) const;
 
   td::Result<td::uint64> advance(td::uint64 offset);
   void iterate(std::function<bool(std::string, td::BufferSlice, td::uint64)> func);
 
+  // maps current contents of the package; entries appended later are not visible through the mapping
+  td::Result<PackageMapping> map() const;
+
   td::FileFd &fd() {
     return fd_;
   }
 
  private:
   td::FileFd fd_;
+  // size of the file including the header; only the writer changes it, readers may run on other threads
+  std::atomic<td::uint64> size_{0};
+  std::atomic<td::uint64> writes_count_{0};
+
+  void write_all(std::vector<td::IoSlice> &slices, td::uint64 offset);
+};
+
+// Read-only view of a package prefix. Package files are append-only, so the mapped part never changes.
+class PackageMapping {
+ public:
+  PackageMapping() = default;
+  explicit PackageMapping(td::MemoryMapping mapping) : mapping_(std::move(mapping)) {
+  }
+
+  td::uint64 size() const;
+  td::Result<std::pair<std::string, td::BufferSlice>> read(td::uint64 offset) const;
+
+ private:
+  td::optional<td::MemoryMapping> mapping_;
 };
 
 }  // namespace ton
@@ -0,0 +1,108 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#include "persistent-state-delta.hpp"
+#include "vm/boc.h"
+#include "vm/cells/MerkleUpdate.h"
+#include "vm/db/BlobView.h"
+#include "vm/db/StaticBagOfCellsDb.h"
+#include "td/utils/as.h"
+#include "td/utils/filesystem.h"
+
+namespace ton {
+
+namespace validator {
+
+namespace db {
+
+namespace {
+
+// the returned db must outlive the cells loaded from it
+td::Result<std::shared_ptr<vm::StaticBagOfCellsDb>> open_base(std::string base_path) {
+  TRY_RESULT(blob, vm::FileBlobView::create(base_path));
+  return vm::StaticBagOfCellsDbLazy::create(std::move(blob));
+}
+
+td::Status write_all(td::FileFd &fd, td::Slice data) {
+  while (!data.empty()) {
+    TRY_RESULT(size, fd.write(data));
+    data.remove_prefix(size);
+  }
+  return td::Status::OK();
+}
+
+}  // namespace
+
+td::Status PersistentStateDelta::write(td::FileFd &fd, td::Ref<vm::Cell> root, FileHash base_hash,
+                                       std::string base_path) {
+  TRY_RESULT(base, open_base(std::move(base_path)));
+  TRY_RESULT(base_root, base->get_root_cell(0));
+  auto update = vm::MerkleUpdate::generate_diff(std::move(base_root), root);
+  if (update.is_null()) {
+    return td::Status::Error("cannot generate a diff against the base state");
+  }
+  TRY_RESULT(data, vm::std_boc_serialize(std::move(update), 31));
+
+  td::BufferSlice header(header_size());
+  td::as<td::uint32>(header.data()) = magic();
+  header.as_slice().substr(4).copy_from(base_hash.as_slice());
+  header.as_slice().substr(4 + 32).copy_from(root->get_hash().as_slice());
+  TRY_STATUS(write_all(fd, header.as_slice()));
+  return write_all(fd, data.as_slice());
+}
+
+td::Result<FileHash> PersistentStateDelta::read_base(std::string path) {
+  TRY_RESULT(header, td::read_file(path, header_size()));
+  if (header.size() < header_size() || td::as<td::uint32>(header.data()) != magic()) {
+    return FileHash::zero();
+  }
+  FileHash base_hash;
+  base_hash.as_slice().copy_from(header.as_slice().substr(4, 32));
+  return base_hash;
+}
+
+td::Status PersistentStateDelta::reconstruct(std::string path, std::string base_path, td::FileFd &fd) {
+  TRY_RESULT(data, td::read_file(path));
+  if (data.size() < header_size() || td::as<td::uint32>(data.data()) != magic()) {
+    return td::Status::Error("not a persistent state delta");
+  }
+  RootHash root_hash;
+  root_hash.as_slice().copy_from(data.as_slice().substr(4 + 32, 32));
+  TRY_RESULT(update, vm::std_boc_deserialize(data.as_slice().substr(header_size())));
+
+  TRY_RESULT(base, open_base(std::move(base_path)));
+  TRY_RESULT(base_root, base->get_root_cell(0));
+  auto root = vm::MerkleUpdate::apply(std::move(base_root), std::move(update));
+  if (root.is_null()) {
+    return td::Status::Error("cannot apply the delta to the base state");
+  }
+  if (root->get_hash().as_slice() != root_hash.as_slice()) {
+    return td::Status::Error("root hash mismatch after applying the delta");
+  }
+
+  vm::BagOfCells boc;
+  boc.set_root(std::move(root));
+  TRY_STATUS(boc.import_cells());
+  return boc.serialize_to_file(fd, 31);
+}
+
+}  // namespace db
+
+}  // namespace validator
+
+}  // namespace ton
@@ -0,0 +1,56 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#pragma once
+
+#include "td/utils/port/FileFd.h"
+#include "ton/ton-types.h"
+#include "vm/cells.h"
+
+namespace ton {
+
+namespace validator {
+
+namespace db {
+
+// A persistent state stored relative to an older full persistent state file of the same shard (the base).
+// The file starts with a header: magic, hash of the file reference of the base and root hash of the state.
+// It is followed by a bag of cells with a Merkle update from the base state to the state. Cells of the base
+// are loaded lazily from the base file, only where the two states differ.
+class PersistentStateDelta {
+ public:
+  static constexpr td::uint32 magic() {
+    return 0x3d5e4a71;
+  }
+  static constexpr size_t header_size() {
+    return 4 + 32 + 32;
+  }
+
+  // writes a delta of the state with the given root against the full state file at base_path
+  static td::Status write(td::FileFd &fd, td::Ref<vm::Cell> root, FileHash base_hash, std::string base_path);
+  // returns the hash of the base file reference, or zero hash if the file at path holds a full state
+  static td::Result<FileHash> read_base(std::string path);
+  // writes the full state serialized as a bag of cells, as it would be stored without deltas
+  static td::Status reconstruct(std::string path, std::string base_path, td::FileFd &fd);
+};
+
+}  // namespace db
+
+}  // namespace validator
+
+}  // namespace ton
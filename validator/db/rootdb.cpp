@@ -270,12 +270,31 @@ void RootDb::get_block_state(ConstBlockHandle handle, td::Promise<td::Ref<ShardS
   }
 }
 
+void RootDb::get_cell_db_reader(td::Promise<std::shared_ptr<vm::CellDbReader>> promise) {
+  td::actor::send_closure(cell_db_, &CellDb::get_cell_db_reader, std::move(promise));
+}
+
 void RootDb::store_persistent_state_file(BlockIdExt block_id, BlockIdExt masterchain_block_id, td::BufferSlice state,
                                          td::Promise<td::Unit> promise) {
   td::actor::send_closure(archive_db_, &ArchiveManager::add_persistent_state, block_id, masterchain_block_id,
                           std::move(state), std::move(promise));
 }
 
+void RootDb::store_persistent_state_file_gen(BlockIdExt block_id, BlockIdExt masterchain_block_id,
+                                             std::function<td::Status(td::FileFd&)> write_state,
+                                             td::Promise<td::Unit> promise) {
+  td::actor::send_closure(archive_db_, &ArchiveManager::add_persistent_state_gen, block_id, masterchain_block_id,
+                          std::move(write_state), std::move(promise));
+}
+
+void RootDb::store_persistent_state_file_delta(BlockIdExt block_id, BlockIdExt masterchain_block_id,
+                                               td::Ref<vm::Cell> root,
+                                               std::function<td::Status(td::FileFd&)> write_state,
+                                               td::Promise<td::Unit> promise) {
+  td::actor::send_closure(archive_db_, &ArchiveManager::add_persistent_state_delta, block_id, masterchain_block_id,
+                          std::move(root), std::move(write_state), std::move(promise));
+}
+
 void RootDb::get_persistent_state_file(BlockIdExt block_id, BlockIdExt masterchain_block_id,
                                        td::Promise<td::BufferSlice> promise) {
   td::actor::send_closure(archive_db_, &ArchiveManager::get_persistent_state, block_id, masterchain_block_id,
@@ -319,6 +338,16 @@ void RootDb::try_get_static_file(FileHash file_hash, td::Promise<td::BufferSlice
 }
 
 void RootDb::apply_block(BlockHandle handle, td::Promise<td::Unit> promise) {
+  if (!tx_index_db_.empty()) {
+    // block data is read back from the archive, so index the block only after the archiver has stored it
+    promise = td::PromiseCreator::lambda([tx_index_db = tx_index_db_.get(), handle,
+                                          promise = std::move(promise)](td::Result<td::Unit> R) mutable {
+      if (R.is_ok()) {
+        td::actor::send_closure(tx_index_db, &TxIndexDb::index_block, handle);
+      }
+      promise.set_result(std::move(R));
+    });
+  }
   td::actor::create_actor<BlockArchiver>("archiver", std::move(handle), archive_db_.get(), std::move(promise))
       .release();
 }
@@ -335,6 +364,16 @@ void RootDb::get_block_by_seqno(AccountIdPrefixFull account, BlockSeqno seqno, t
   td::actor::send_closure(archive_db_, &ArchiveManager::get_block_by_seqno, account, seqno, std::move(promise));
 }
 
+void RootDb::get_account_transactions(WorkchainId workchain, StdSmcAddress addr, LogicalTime lt, td::uint32 count,
+                                      td::Promise<std::vector<AccountTransactionId>> promise) {
+  if (tx_index_db_.empty()) {
+    promise.set_error(td::Status::Error(ErrorCode::notready, "transaction index is disabled"));
+    return;
+  }
+  td::actor::send_closure(tx_index_db_, &TxIndexDb::get_account_transactions, workchain, addr, lt, count,
+                          std::move(promise));
+}
+
 void RootDb::update_init_masterchain_block(BlockIdExt block, td::Promise<td::Unit> promise) {
   td::actor::send_closure(state_db_, &StateDb::update_init_masterchain_block, block, std::move(promise));
 }
@@ -390,6 +429,9 @@ void RootDb::start_up() {
   state_db_ = td::actor::create_actor<StateDb>("statedb", actor_id(this), root_path_ + "/state/");
   static_files_db_ = td::actor::create_actor<StaticFilesDb>("staticfilesdb", actor_id(this), root_path_ + "/static/");
   archive_db_ = td::actor::create_actor<ArchiveManager>("archive", actor_id(this), root_path_);
+  if (tx_index_) {
+    tx_index_db_ = td::actor::create_actor<TxIndexDb>("txindexdb", actor_id(this), root_path_ + "/txindex/");
+  }
 }
 
 void RootDb::archive(BlockHandle handle, td::Promise<td::Unit> promise) {
@@ -407,6 +449,10 @@ void RootDb::allow_block_gc(BlockIdExt block_id, td::Promise<bool> promise) {
 
 void RootDb::prepare_stats(td::Promise<std::vector<std::pair<std::string, std::string>>> promise) {
   auto merger = StatsMerger::create(std::move(promise));
+  td::actor::send_closure(cell_db_, &CellDb::prepare_stats, merger.make_promise("celldb."));
+  if (!tx_index_db_.empty()) {
+    td::actor::send_closure(tx_index_db_, &TxIndexDb::prepare_stats, merger.make_promise("txindex."));
+  }
 }
 
 void RootDb::truncate(td::Ref<MasterchainState> state, td::Promise<td::Unit> promise) {
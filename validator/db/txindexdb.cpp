@@ -0,0 +1,192 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#include "txindexdb.hpp"
+#include "rootdb.hpp"
+
+#include "block/block-auto.h"
+#include "block/block-parse.h"
+#include "td/db/RocksDb.h"
+#include "td/utils/tl_helpers.h"
+#include "vm/dict.h"
+
+namespace ton {
+
+namespace validator {
+
+namespace {
+
+// key: workchain (4 bytes) + account address (32 bytes) + transaction lt (8 bytes), all big-endian, so that the
+// transactions of one account are adjacent and ordered by lt
+std::string account_key(WorkchainId workchain, const StdSmcAddress &addr) {
+  std::string res(4 + 32, '\0');
+  auto w = static_cast<td::uint32>(workchain);
+  for (int i = 0; i < 4; i++) {
+    res[i] = static_cast<char>(w >> (24 - 8 * i));
+  }
+  std::memcpy(&res[4], addr.data(), 32);
+  return res;
+}
+
+std::string transaction_key(WorkchainId workchain, const StdSmcAddress &addr, LogicalTime lt) {
+  auto res = account_key(workchain, addr);
+  for (int i = 0; i < 8; i++) {
+    res += static_cast<char>(lt >> (56 - 8 * i));
+  }
+  return res;
+}
+
+// value: id of the block and hash of the transaction; the workchain is already a part of the key
+struct TxIndexValue {
+  ShardId shard;
+  BlockSeqno seqno;
+  RootHash root_hash;
+  FileHash file_hash;
+  Bits256 hash;
+
+  template <class StorerT>
+  void store(StorerT &storer) const {
+    using td::store;
+    store(shard, storer);
+    store(seqno, storer);
+    storer.store_binary(root_hash);
+    storer.store_binary(file_hash);
+    storer.store_binary(hash);
+  }
+  template <class ParserT>
+  void parse(ParserT &parser) {
+    using td::parse;
+    parse(shard, parser);
+    parse(seqno, parser);
+    root_hash = parser.template fetch_binary<RootHash>();
+    file_hash = parser.template fetch_binary<FileHash>();
+    hash = parser.template fetch_binary<Bits256>();
+  }
+};
+
+}  // namespace
+
+void TxIndexDb::start_up() {
+  if (kv_) {
+    return;
+  }
+  td::RocksDbOptions db_options;
+  db_options.workload = td::RocksDbOptions::Workload::RangeScan;
+  kv_ = std::make_shared<td::RocksDb>(td::RocksDb::open(db_path_, std::move(db_options)).move_as_ok());
+}
+
+void TxIndexDb::index_block(ConstBlockHandle handle) {
+  auto P = td::PromiseCreator::lambda(
+      [SelfId = actor_id(this), block_id = handle->id()](td::Result<td::Ref<BlockData>> R) {
+        if (R.is_error()) {
+          LOG(WARNING) << "cannot index transactions of block " << block_id.to_str() << ": " << R.move_as_error();
+        } else {
+          td::actor::send_closure(SelfId, &TxIndexDb::index_block_data, R.move_as_ok());
+        }
+      });
+  td::actor::send_closure(root_db_, &RootDb::get_block_data, std::move(handle), std::move(P));
+}
+
+void TxIndexDb::index_block_data(td::Ref<BlockData> block) {
+  auto block_id = block->block_id();
+  std::vector<std::pair<std::string, std::string>> entries;
+  try {
+    block::gen::Block::Record blk;
+    block::gen::BlockExtra::Record extra;
+    if (!(tlb::unpack_cell(block->root_cell(), blk) && tlb::unpack_cell(std::move(blk.extra), extra))) {
+      LOG(ERROR) << "cannot index transactions of block " << block_id.to_str() << ": cannot unpack block";
+      return;
+    }
+    vm::AugmentedDictionary acc_dict{vm::load_cell_slice_ref(extra.account_blocks), 256,
+                                     block::tlb::aug_ShardAccountBlocks};
+    bool ok = acc_dict.check_for_each_extra([&](td::Ref<vm::CellSlice> value, td::Ref<vm::CellSlice>,
+                                                td::ConstBitPtr key, int key_len) {
+      CHECK(key_len == 256);
+      StdSmcAddress addr{key};
+      block::gen::AccountBlock::Record acc_blk;
+      if (!tlb::csr_unpack(std::move(value), acc_blk)) {
+        return false;
+      }
+      vm::AugmentedDictionary trans_dict{vm::DictNonEmpty(), std::move(acc_blk.transactions), 64,
+                                         block::tlb::aug_AccountTransactions};
+      return trans_dict.check_for_each_extra([&](td::Ref<vm::CellSlice> tvalue, td::Ref<vm::CellSlice>,
+                                                 td::ConstBitPtr tkey, int tkey_len) {
+        CHECK(tkey_len == 64);
+        auto root = tvalue->prefetch_ref();
+        if (root.is_null()) {
+          return false;
+        }
+        TxIndexValue v{block_id.id.shard, block_id.id.seqno, block_id.root_hash, block_id.file_hash,
+                       root->get_hash().bits()};
+        entries.emplace_back(transaction_key(block_id.id.workchain, addr, tkey.get_uint(64)), td::serialize(v));
+        return true;
+      });
+    });
+    if (!ok) {
+      LOG(ERROR) << "cannot index transactions of block " << block_id.to_str() << ": invalid account blocks";
+      return;
+    }
+  } catch (vm::VmError &err) {
+    LOG(ERROR) << "cannot index transactions of block " << block_id.to_str() << ": " << err.get_msg();
+    return;
+  }
+
+  kv_->begin_transaction().ensure();
+  for (auto &e : entries) {
+    kv_->set(e.first, e.second).ensure();
+  }
+  kv_->commit_transaction().ensure();
+  indexed_blocks_++;
+  indexed_transactions_ += entries.size();
+}
+
+void TxIndexDb::get_account_transactions(WorkchainId workchain, StdSmcAddress addr, LogicalTime lt, td::uint32 count,
+                                         td::Promise<std::vector<AccountTransactionId>> promise) {
+  auto prefix = account_key(workchain, addr);
+  auto options = lt == std::numeric_limits<LogicalTime>::max()
+                     ? td::KeyValue::IterateOptions::prefix(prefix, true)
+                     : td::KeyValue::IterateOptions::range(prefix, transaction_key(workchain, addr, lt + 1), true);
+  TRY_RESULT_PROMISE(promise, it, kv_->iterator(options));
+
+  std::vector<AccountTransactionId> res;
+  for (; it->valid() && res.size() < count; it->next()) {
+    auto key = it->key();
+    CHECK(key.size() == prefix.size() + 8);
+    LogicalTime tx_lt = 0;
+    for (auto c : key.remove_prefix(prefix.size())) {
+      tx_lt = (tx_lt << 8) | static_cast<td::uint8>(c);
+    }
+    TxIndexValue v;
+    TRY_STATUS_PROMISE(promise, td::unserialize(v, it->value()));
+    res.push_back(
+        AccountTransactionId{tx_lt, v.hash, BlockIdExt{workchain, v.shard, v.seqno, v.root_hash, v.file_hash}});
+  }
+  TRY_STATUS_PROMISE(promise, it->status());
+  promise.set_value(std::move(res));
+}
+
+void TxIndexDb::prepare_stats(td::Promise<std::vector<std::pair<std::string, std::string>>> promise) {
+  std::vector<std::pair<std::string, std::string>> stats;
+  stats.emplace_back("indexed_blocks", td::to_string(indexed_blocks_));
+  stats.emplace_back("indexed_transactions", td::to_string(indexed_transactions_));
+  promise.set_value(std::move(stats));
+}
+
+}  // namespace validator
+
+}  // namespace ton
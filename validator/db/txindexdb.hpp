@@ -0,0 +1,68 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#pragma once
+
+#include "td/actor/actor.h"
+#include "td/db/KeyValue.h"
+#include "ton/ton-types.h"
+
+#include "validator/interfaces/db.h"
+
+namespace ton {
+
+namespace validator {
+
+class RootDb;
+
+// Optional index of account transactions, filled when blocks are applied. For every account it keeps the
+// logical times and hashes of its transactions together with the ids of the blocks containing them, so that
+// a page of an account history is found by one range scan instead of a lookup by lt per transaction.
+class TxIndexDb : public td::actor::Actor {
+ public:
+  TxIndexDb(td::actor::ActorId<RootDb> root_db, std::string path) : root_db_(root_db), db_path_(std::move(path)) {
+  }
+  // the index is kept in kv instead of a database opened at the path
+  TxIndexDb(td::actor::ActorId<RootDb> root_db, std::shared_ptr<td::KeyValue> kv)
+      : kv_(std::move(kv)), root_db_(root_db) {
+  }
+
+  void start_up() override;
+
+  void index_block(ConstBlockHandle handle);
+  void index_block_data(td::Ref<BlockData> block);
+
+  // at most count transactions with logical time not greater than lt, latest first
+  void get_account_transactions(WorkchainId workchain, StdSmcAddress addr, LogicalTime lt, td::uint32 count,
+                                td::Promise<std::vector<AccountTransactionId>> promise);
+
+  void prepare_stats(td::Promise<std::vector<std::pair<std::string, std::string>>> promise);
+
+ private:
+  std::shared_ptr<td::KeyValue> kv_;
+
+  td::actor::ActorId<RootDb> root_db_;
+  std::string db_path_;
+
+  td::uint64 indexed_blocks_{0};
+  td::uint64 indexed_transactions_{0};
+};
+
+}  // namespace validator
+
+}  // namespace ton
@@ -26,7 +26,7 @@ namespace ton {
 namespace validator {
 
 td::actor::ActorOwn<Db> create_db_actor(td::actor::ActorId<ValidatorManager> manager, std::string db_root_,
-                                        td::uint32 depth);
+                                        td::uint32 depth, bool tx_index = false);
 td::actor::ActorOwn<LiteServerCache> create_liteserver_cache_actor(td::actor::ActorId<ValidatorManager> manager,
                                                                    std::string db_root);
 
@@ -76,6 +76,7 @@ class Collator final : public td::actor::Actor {
   static constexpr int max_ext_msg_size = 65535;   // 64k
   static constexpr int max_blk_sign_size = 65535;  // 64k
   static constexpr bool shard_splitting_enabled = true;
+  static constexpr int max_speculative_msgs = 256;  // inbound messages executed ahead of time at once
 
  public:
   Collator(ShardIdFull shard, td::uint32 min_ts, BlockIdExt min_masterchain_block_id, std::vector<BlockIdExt> prev,
@@ -116,6 +117,7 @@ class Collator final : public td::actor::Actor {
   std::map<BlockSeqno, Ref<MasterchainStateQ>> aux_mc_states_;
   std::vector<block::McShardDescr> neighbors_;
   std::unique_ptr<block::OutputQueueMerger> nb_out_msgs_;
+  std::unique_ptr<block::OutputQueueMerger> nb_out_msgs_ahead_;  // runs ahead of nb_out_msgs_ for speculation
   std::vector<ton::StdSmcAddress> special_smcs;
   std::vector<std::pair<ton::StdSmcAddress, int>> ticktock_smcs;
   Ref<vm::Cell> prev_block_root;
@@ -174,6 +176,17 @@ class Collator final : public td::actor::Actor {
   Ref<vm::Cell> shard_account_blocks_;  // ShardAccountBlocks
   std::vector<Ref<vm::Cell>> collated_roots_;
   std::unique_ptr<ton::BlockCandidate> block_candidate;
+  // ordinary transaction executed ahead of time against a copy of its account
+  struct SpeculativeTransaction {
+    ton::LogicalTime min_lt;                    // trans_min_lt the transaction has been created with
+    ton::LogicalTime base_end_lt;               // last_trans_end_lt_ of the account before the transaction
+    ton::Bits256 base_hash;                     // hash of the account state before the transaction
+    std::unique_ptr<block::Transaction> trans;  // null if an inbound external message has been rejected
+    std::unique_ptr<block::Account> account;    // account state after the transaction
+    std::vector<vm::CellUsageTree::NodeId> loads;  // cells of the previous state loaded, marked on commit
+  };
+  std::map<ton::Bits256, SpeculativeTransaction> speculative_trans_;  // by inbound message hash
+  std::vector<std::unique_ptr<block::Account>> speculative_base_;     // account copies speculation started from
 
   td::PerfWarningTimer perf_timer_{"collate", 0.1};
   //
@@ -221,6 +234,15 @@ class Collator final : public td::actor::Actor {
   bool create_ticktock_transactions(int mask);
   bool create_ticktock_transaction(const ton::StdSmcAddress& smc_addr, ton::LogicalTime req_start_lt, int mask);
   Ref<vm::Cell> create_ordinary_transaction(Ref<vm::Cell> msg_root);
+  td::Result<std::unique_ptr<block::Transaction>> run_ordinary_transaction(const block::Account& acc,
+                                                                           Ref<vm::Cell> msg_root, bool external,
+                                                                           ton::LogicalTime trans_min_lt) const;
+  bool commit_speculative_transaction(block::Account& acc, Ref<vm::Cell> msg_root, ton::LogicalTime trans_min_lt,
+                                      Ref<vm::Cell>& trans_root);
+  std::unique_ptr<block::Account> make_speculative_account(td::ConstBitPtr addr);
+  int speculation_threads() const;
+  void speculate_transactions(const std::vector<Ref<vm::Cell>>& msgs, ton::LogicalTime ext_min_lt);
+  int speculate_inbound_internal_messages(int max_count);
   bool unpack_last_mc_state();
   bool unpack_last_state();
   bool unpack_merge_last_state();
@@ -33,11 +33,16 @@
 #include "fabric.h"
 #include "validator-set.hpp"
 #include "top-shard-descr.hpp"
+#include "td/utils/Timer.h"
+#include "td/utils/port/thread.h"
+#include "worker-pool.hpp"
+#include <atomic>
 #include <ctime>
 
 namespace ton {
 
 int collator_settings = 0;
+int collator_threads = 0;
 
 namespace validator {
 using td::Ref;
@@ -1624,6 +1629,9 @@ bool Collator::do_collate() {
   CHECK(!nb_out_msgs_);
   LOG(DEBUG) << "creating OutputQueueMerger";
   nb_out_msgs_ = std::make_unique<block::OutputQueueMerger>(shard, neighbors_);
+  if (speculation_threads() > 1) {
+    nb_out_msgs_ahead_ = std::make_unique<block::OutputQueueMerger>(shard, neighbors_);
+  }
   // 1.4. compute created / minted / recovered
   if (!init_value_create()) {
     return fatal_error("cannot compute the value to be created / minted / recovered");
@@ -2100,77 +2108,267 @@ Ref<vm::Cell> Collator::create_ordinary_transaction(Ref<vm::Cell> msg_root) {
     // transactions processing external messages must have lt larger than all processed internal messages
     trans_min_lt = std::max(trans_min_lt, last_proc_int_msg_.first);
   }
+  Ref<vm::Cell> trans_root;
+  if (commit_speculative_transaction(*acc, msg_root, trans_min_lt, trans_root)) {
+    return trans_root;
+  }
+  auto res = run_ordinary_transaction(*acc, std::move(msg_root), external, trans_min_lt);
+  if (res.is_error()) {
+    fatal_error(res.move_as_error());
+    return {};
+  }
+  auto trans = res.move_as_ok();
+  if (!trans) {
+    return {};
+  }
+  if (!trans->update_limits(*block_limit_status_)) {
+    fatal_error("cannot update block limit status to include the new transaction");
+    return {};
+  }
+  trans_root = trans->commit(*acc);
+  if (trans_root.is_null()) {
+    fatal_error("cannot commit new transaction for smart contract "s + addr.to_hex());
+    return {};
+  }
+  register_new_msgs(*trans);
+  update_max_lt(acc->last_trans_end_lt_);
+  return trans_root;
+}
+
+// creates and serializes an ordinary transaction without committing it to the account or to the block,
+// so it may run on a worker thread; returns nullptr if an inbound external message has not been accepted
+td::Result<std::unique_ptr<block::Transaction>> Collator::run_ordinary_transaction(
+    const block::Account& acc, Ref<vm::Cell> msg_root, bool external, ton::LogicalTime trans_min_lt) const {
+  auto addr = acc.addr.to_hex();
   std::unique_ptr<block::Transaction> trans =
-      std::make_unique<block::Transaction>(*acc, block::Transaction::tr_ord, trans_min_lt + 1, now_, msg_root);
+      std::make_unique<block::Transaction>(acc, block::Transaction::tr_ord, trans_min_lt + 1, now_, msg_root);
   bool ihr_delivered = false;  // FIXME
   if (!trans->unpack_input_msg(ihr_delivered, &action_phase_cfg_)) {
     if (external) {
       // inbound external message was not accepted
-      LOG(DEBUG) << "inbound external message rejected by account " << addr.to_hex()
-                 << " before smart-contract execution";
-      return {};
+      LOG(DEBUG) << "inbound external message rejected by account " << addr << " before smart-contract execution";
+      return nullptr;
     }
-    fatal_error("cannot unpack input message for a new transaction");
-    return {};
+    return td::Status::Error(-666, "cannot unpack input message for a new transaction");
   }
   if (trans->bounce_enabled) {
     if (!trans->prepare_storage_phase(storage_phase_cfg_, true)) {
-      fatal_error("cannot create storage phase of a new transaction for smart contract "s + addr.to_hex());
-      return {};
+      return td::Status::Error(-666, "cannot create storage phase of a new transaction for smart contract "s + addr);
     }
     if (!external && !trans->prepare_credit_phase()) {
-      fatal_error("cannot create credit phase of a new transaction for smart contract "s + addr.to_hex());
-      return {};
+      return td::Status::Error(-666, "cannot create credit phase of a new transaction for smart contract "s + addr);
     }
   } else {
     if (!external && !trans->prepare_credit_phase()) {
-      fatal_error("cannot create credit phase of a new transaction for smart contract "s + addr.to_hex());
-      return {};
+      return td::Status::Error(-666, "cannot create credit phase of a new transaction for smart contract "s + addr);
     }
     if (!trans->prepare_storage_phase(storage_phase_cfg_, true)) {
-      fatal_error("cannot create storage phase of a new transaction for smart contract "s + addr.to_hex());
-      return {};
+      return td::Status::Error(-666, "cannot create storage phase of a new transaction for smart contract "s + addr);
     }
   }
   if (!trans->prepare_compute_phase(compute_phase_cfg_)) {
-    fatal_error("cannot create compute phase of a new transaction for smart contract "s + addr.to_hex());
-    return {};
+    return td::Status::Error(-666, "cannot create compute phase of a new transaction for smart contract "s + addr);
   }
   if (!trans->compute_phase->accepted) {
     if (external) {
       // inbound external message was not accepted
-      LOG(DEBUG) << "inbound external message rejected by transaction " << addr.to_hex();
-      return {};
+      LOG(DEBUG) << "inbound external message rejected by transaction " << addr;
+      return nullptr;
     } else if (trans->compute_phase->skip_reason == block::ComputePhase::sk_none) {
-      fatal_error("new ordinary transaction for smart contract "s + addr.to_hex() +
-                  " has not been accepted by the smart contract (?)");
-      return {};
+      return td::Status::Error(-666, "new ordinary transaction for smart contract "s + addr +
+                                         " has not been accepted by the smart contract (?)");
     }
   }
   if (trans->compute_phase->success && !trans->prepare_action_phase(action_phase_cfg_)) {
-    fatal_error("cannot create action phase of a new transaction for smart contract "s + addr.to_hex());
-    return {};
+    return td::Status::Error(-666, "cannot create action phase of a new transaction for smart contract "s + addr);
   }
   if (trans->bounce_enabled && !trans->compute_phase->success && !trans->prepare_bounce_phase(action_phase_cfg_)) {
-    fatal_error("cannot create bounce phase of a new transaction for smart contract "s + addr.to_hex());
-    return {};
+    return td::Status::Error(-666, "cannot create bounce phase of a new transaction for smart contract "s + addr);
   }
   if (!trans->serialize()) {
-    fatal_error("cannot serialize new transaction for smart contract "s + addr.to_hex());
-    return {};
+    return td::Status::Error(-666, "cannot serialize new transaction for smart contract "s + addr);
   }
-  if (!trans->update_limits(*block_limit_status_)) {
+  return std::move(trans);
+}
+
+// uses the result of the speculative execution of the transaction processing msg_root, if it has been executed
+// against the current state of the account; returns false if the transaction has to be executed anew
+bool Collator::commit_speculative_transaction(block::Account& acc, Ref<vm::Cell> msg_root,
+                                              ton::LogicalTime trans_min_lt, Ref<vm::Cell>& trans_root) {
+  auto it = speculative_trans_.find(msg_root->get_hash().bits());
+  if (it == speculative_trans_.end()) {
+    return false;
+  }
+  auto spec = std::move(it->second);
+  speculative_trans_.erase(it);
+  if (spec.min_lt != trans_min_lt || spec.base_end_lt != acc.last_trans_end_lt_ ||
+      spec.base_hash != acc.total_state->get_hash().bits()) {
+    LOG(DEBUG) << "account " << acc.addr.to_hex() << " has been changed since speculative execution, re-executing";
+    return false;
+  }
+  trans_root = {};
+  if (!spec.trans) {
+    LOG(DEBUG) << "inbound external message rejected by account " << acc.addr.to_hex();
+    return true;
+  }
+  if (!spec.trans->update_limits(*block_limit_status_)) {
     fatal_error("cannot update block limit status to include the new transaction");
-    return {};
+    return true;
   }
-  auto trans_root = trans->commit(*acc);
-  if (trans_root.is_null()) {
-    fatal_error("cannot commit new transaction for smart contract "s + addr.to_hex());
-    return {};
+  state_usage_tree_->apply_loads(spec.loads);
+  acc = std::move(*spec.account);
+  // the next speculative transaction of this account may still refer to the moved-out copy
+  speculative_base_.push_back(std::move(spec.account));
+  trans_root = spec.trans->root;
+  register_new_msgs(*spec.trans);
+  update_max_lt(acc.last_trans_end_lt_);
+  return true;
+}
+
+// copy of the account to execute speculative transactions against; loads no cells into state_usage_tree_
+std::unique_ptr<block::Account> Collator::make_speculative_account(td::ConstBitPtr addr) {
+  auto found = lookup_account(addr);
+  if (found) {
+    return std::make_unique<block::Account>(*found);
+  }
+  std::vector<vm::CellUsageTree::NodeId> loads;
+  vm::CellUsageTree::DeferLoads defer{*state_usage_tree_, loads};
+  auto dict_entry = account_dict->lookup_extra(addr, 256);
+  auto acc = make_account_from(addr, std::move(dict_entry.first), std::move(dict_entry.second), true);
+  if (!acc || !acc->belongs_to_shard(shard)) {
+    return nullptr;
+  }
+  return acc;
+}
+
+int Collator::speculation_threads() const {
+  return collator_threads > 0
+             ? collator_threads
+             : static_cast<int>(td::min(td::thread::hardware_concurrency(), WorkerPool::max_threads()));
+}
+
+// executes ordinary transactions for msgs (in the order they will be processed) on several threads before they are
+// processed, each account against its own copy of the current state; transactions of one account are chained.
+// Cells of the previous state loaded meanwhile are marked in state_usage_tree_ only when a transaction is committed,
+// and accounts are not added to the collection, so that discarded results do not get into the block.
+void Collator::speculate_transactions(const std::vector<Ref<vm::Cell>>& msgs, ton::LogicalTime ext_min_lt) {
+  struct Chain {
+    std::unique_ptr<block::Account> base;
+    std::vector<std::size_t> msgs;
+  };
+  std::vector<Chain> chains;
+  std::map<ton::StdSmcAddress, std::size_t> chain_idx;
+  std::vector<bool> external(msgs.size());
+  for (std::size_t i = 0; i < msgs.size(); i++) {
+    auto cs = vm::load_cell_slice(msgs[i]);
+    Ref<vm::CellSlice> dest;
+    block::gen::CommonMsgInfo::Record_ext_in_msg_info ext_info;
+    block::gen::CommonMsgInfo::Record_int_msg_info int_info;
+    switch (block::gen::t_CommonMsgInfo.get_tag(cs)) {
+      case block::gen::CommonMsgInfo::ext_in_msg_info:
+        if (tlb::unpack(cs, ext_info)) {
+          dest = std::move(ext_info.dest);
+          external[i] = true;
+        }
+        break;
+      case block::gen::CommonMsgInfo::int_msg_info:
+        if (tlb::unpack(cs, int_info)) {
+          dest = std::move(int_info.dest);
+        }
+        break;
+      default:
+        break;
+    }
+    ton::WorkchainId wc;
+    ton::StdSmcAddress addr;
+    if (dest.is_null() || !block::tlb::t_MsgAddressInt.extract_std_address(dest, wc, addr) ||
+        wc != shard.workchain || !is_our_address(addr)) {
+      continue;
+    }
+    auto it = chain_idx.find(addr);
+    if (it == chain_idx.end()) {
+      auto base = make_speculative_account(addr.cbits());
+      if (!base) {
+        continue;  // left to serial processing, which reports the error
+      }
+      it = chain_idx.emplace(addr, chains.size()).first;
+      chains.push_back(Chain{std::move(base), {}});
+    }
+    chains[it->second].msgs.push_back(i);
+  }
+  std::size_t threads = speculation_threads();
+  if (chains.size() < 2 || threads < 2) {
+    return;
+  }
+  std::vector<SpeculativeTransaction> results(msgs.size());
+  std::vector<char> done(msgs.size(), 0);
+  std::atomic<std::size_t> next_chain{0};
+  auto run = [&] {
+    for (std::size_t i; (i = next_chain++) < chains.size();) {
+      const block::Account* acc = chains[i].base.get();
+      for (auto j : chains[i].msgs) {
+        auto& res = results[j];
+        res.min_lt = external[j] ? ext_min_lt : start_lt;
+        res.base_end_lt = acc->last_trans_end_lt_;
+        res.base_hash = acc->total_state->get_hash().bits();
+        vm::CellUsageTree::DeferLoads defer{*state_usage_tree_, res.loads};
+        try {
+          auto R = run_ordinary_transaction(*acc, msgs[j], external[j], res.min_lt);
+          if (R.is_error()) {
+            break;
+          }
+          res.trans = R.move_as_ok();
+          if (res.trans) {
+            res.account = std::make_unique<block::Account>(*acc);
+            if (!res.trans->commit_copy(*res.account)) {
+              break;
+            }
+            acc = res.account.get();
+          }
+        } catch (vm::VmError&) {
+          break;
+        } catch (vm::VmVirtError&) {
+          break;
+        }
+        done[j] = 1;
+      }
+    }
+  };
+  state_usage_tree_->set_concurrent(true);
+  td::Timer timer;
+  WorkerPool::get().run(td::min(threads, chains.size()), run);
+  state_usage_tree_->set_concurrent(false);
+  LOG(INFO) << "executed transactions for " << msgs.size() << " messages to " << chains.size() << " accounts on up to "
+            << threads << " threads in " << timer.elapsed() << "s";
+  for (std::size_t j = 0; j < msgs.size(); j++) {
+    if (done[j]) {
+      speculative_trans_[msgs[j]->get_hash().bits()] = std::move(results[j]);
+    }
+  }
+  for (auto& chain : chains) {
+    speculative_base_.push_back(std::move(chain.base));
   }
-  register_new_msgs(*trans);
-  update_max_lt(acc->last_trans_end_lt_);
-  return trans_root;
+}
+
+// executes ahead of time the transactions for the next inbound internal messages (up to max_count of them);
+// returns the number of messages nb_out_msgs_ahead_ has advanced by
+int Collator::speculate_inbound_internal_messages(int max_count) {
+  std::vector<Ref<vm::Cell>> msgs;
+  int count = 0;
+  for (; count < max_count && !nb_out_msgs_ahead_->is_eof(); count++) {
+    auto kv = nb_out_msgs_ahead_->extract_cur();
+    if (kv && kv->msg.not_null()) {
+      // messages processed before are skipped by process_inbound_message()
+      vm::CellSlice cs{*kv->msg};
+      block::EnqueuedMsgDescr enq_msg_descr;
+      if (enq_msg_descr.unpack(cs) && !processed_upto_->already_processed(enq_msg_descr)) {
+        msgs.push_back(std::move(enq_msg_descr.msg_));
+      }
+    }
+    nb_out_msgs_ahead_->next();
+  }
+  speculate_transactions(msgs, start_lt);
+  return count;
 }
 
 void Collator::update_max_lt(ton::LogicalTime lt) {
@@ -2582,12 +2780,16 @@ bool Collator::process_inbound_message(Ref<vm::CellSlice> enq_msg, ton::LogicalT
 }
 
 bool Collator::process_inbound_internal_messages() {
+  int ahead = 0;  // messages of nb_out_msgs_ already passed by nb_out_msgs_ahead_
   while (!block_full_ && !nb_out_msgs_->is_eof()) {
     block_full_ = !block_limit_status_->fits(block::ParamLimits::cl_normal);
     if (block_full_) {
       LOG(INFO) << "BLOCK FULL, stop processing inbound internal messages";
       break;
     }
+    if (!ahead && nb_out_msgs_ahead_) {
+      ahead = speculate_inbound_internal_messages(max_speculative_msgs);
+    }
     auto kv = nb_out_msgs_->extract_cur();
     CHECK(kv && kv->msg.not_null());
     LOG(DEBUG) << "processing inbound message with (lt,hash)=(" << kv->lt << "," << kv->key.to_hex()
@@ -2605,18 +2807,31 @@ bool Collator::process_inbound_internal_messages() {
       return fatal_error("error processing inbound internal message");
     }
     nb_out_msgs_->next();
+    ahead -= (ahead > 0);
   }
   inbound_queues_empty_ = nb_out_msgs_->is_eof();
+  speculative_trans_.clear();
+  speculative_base_.clear();
   return true;
 }
 
 bool Collator::process_inbound_external_messages() {
   bool full = !block_limit_status_->fits(block::ParamLimits::cl_soft);
-  for (auto& ext_msg_pair : ext_msg_list_) {
+  bool speculate = speculation_threads() > 1;
+  auto ext_min_lt = std::max(start_lt, last_proc_int_msg_.first);  // as in create_ordinary_transaction()
+  for (std::size_t i = 0; i < ext_msg_list_.size(); i++) {
+    auto& ext_msg_pair = ext_msg_list_[i];
     if (full) {
       LOG(INFO) << "BLOCK FULL, stop processing external messages";
       break;
     }
+    if (speculate && i % max_speculative_msgs == 0) {
+      std::vector<Ref<vm::Cell>> msgs;
+      for (std::size_t j = i; j < ext_msg_list_.size() && j < i + max_speculative_msgs; j++) {
+        msgs.push_back(ext_msg_list_[j].first);
+      }
+      speculate_transactions(msgs, ext_min_lt);
+    }
     auto ext_msg = ext_msg_pair.first;
     ton::Bits256 hash{ext_msg->get_hash().bits()};
     int r = process_external_message(std::move(ext_msg));
@@ -2637,6 +2852,8 @@ bool Collator::process_inbound_external_messages() {
       break;
     }
   }
+  speculative_trans_.clear();
+  speculative_base_.clear();
   return true;
 }
 
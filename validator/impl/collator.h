@@ -27,6 +27,8 @@ namespace ton {
 using td::Ref;
 
 extern int collator_settings;  // +1 = force want_split, +2 = force want_merge
+// number of threads executing transactions of different accounts ahead of time (0 = hardware concurrency, 1 = none)
+extern int collator_threads;
 
 class Collator : public td::actor::Actor {
  protected:
@@ -33,6 +33,7 @@
 #include "top-shard-descr.hpp"
 #include "ton/ton-io.hpp"
 #include "liteserver.hpp"
+#include "liteserver-cache.hpp"
 #include "validator/fabric.h"
 
 namespace ton {
@@ -40,13 +41,13 @@ namespace ton {
 namespace validator {
 
 td::actor::ActorOwn<Db> create_db_actor(td::actor::ActorId<ValidatorManager> manager, std::string db_root_,
-                                        td::uint32 depth) {
-  return td::actor::create_actor<RootDb>("db", manager, db_root_, depth);
+                                        td::uint32 depth, bool tx_index) {
+  return td::actor::create_actor<RootDb>("db", manager, db_root_, depth, tx_index);
 }
 
 td::actor::ActorOwn<LiteServerCache> create_liteserver_cache_actor(td::actor::ActorId<ValidatorManager> manager,
                                                                    std::string db_root) {
-  return td::actor::create_actor<LiteServerCache>("cache");
+  return td::actor::create_actor<LiteServerCacheImpl>("litecache", std::move(manager));
 }
 
 td::Result<td::Ref<BlockData>> create_block(BlockIdExt block_id, td::BufferSlice data) {
@@ -216,7 +217,11 @@ void run_collate_query(ShardIdFull shard, td::uint32 min_ts, const BlockIdExt& m
 
 void run_liteserver_query(td::BufferSlice data, td::actor::ActorId<ValidatorManager> manager,
                           td::actor::ActorId<LiteServerCache> cache, td::Promise<td::BufferSlice> promise) {
-  LiteQuery::run_query(std::move(data), std::move(manager), std::move(promise));
+  if (cache.empty()) {
+    LiteQuery::run_query(std::move(data), std::move(manager), std::move(promise));
+    return;
+  }
+  td::actor::send_closure(cache, &LiteServerCache::run_query, std::move(data), std::move(promise));
 }
 
 void run_validate_shard_block_description(td::BufferSlice data, BlockHandle masterchain_block,
@@ -0,0 +1,184 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#include "liteserver-cache.hpp"
+#include "liteserver.hpp"
+#include "auto/tl/lite_api.h"
+#include "auto/tl/lite_api.hpp"
+#include "tl-utils/lite-utils.hpp"
+
+#include "td/utils/as.h"
+#include "td/utils/misc.h"
+
+namespace ton {
+
+namespace validator {
+
+LiteServerCacheImpl::QueryKind LiteServerCacheImpl::get_query_kind(td::Slice data) {
+  if (data.size() < 4) {
+    return QueryKind::NotCacheable;
+  }
+  switch (td::as<td::int32>(data.data())) {
+    case lite_api::liteServer_getMasterchainInfo::ID:
+      return QueryKind::LastMasterchainBlock;
+    case lite_api::liteServer_getBlock::ID:
+    case lite_api::liteServer_getBlockHeader::ID:
+    case lite_api::liteServer_getShardInfo::ID:
+    case lite_api::liteServer_getAllShardsInfo::ID:
+    case lite_api::liteServer_getOneTransaction::ID:
+    case lite_api::liteServer_getTransactions::ID:
+    case lite_api::liteServer_listBlockTransactions::ID:
+    case lite_api::liteServer_getConfigAll::ID:
+    case lite_api::liteServer_getConfigParams::ID:
+      return QueryKind::Permanent;
+    case lite_api::liteServer_getAccountState::ID: {
+      // seqno ~0U of a masterchain block stands for the last masterchain block
+      auto F = fetch_tl_object<lite_api::liteServer_getAccountState>(data, true);
+      if (F.is_error()) {
+        return QueryKind::NotCacheable;
+      }
+      return F.ok()->id_->seqno_ == static_cast<td::int32>(~0U) ? QueryKind::LastMasterchainBlock
+                                                                 : QueryKind::Permanent;
+    }
+    default:
+      // getTime, getMasterchainInfoExt and getValidatorStats depend on the current time, runSmcMethod uses
+      // a random seed, sendMessage has side effects, results of lookupBlock and getBlockProof without a target
+      // block depend on the known blocks, and states are too big to be cached
+      return QueryKind::NotCacheable;
+  }
+}
+
+void LiteServerCacheImpl::run_query(td::BufferSlice data, td::Promise<td::BufferSlice> promise) {
+  auto kind = get_query_kind(data.as_slice());
+  if (kind == QueryKind::NotCacheable) {
+    not_cacheable_++;
+    run_uncached_query(std::move(data), std::move(promise));
+    return;
+  }
+
+  auto key = data.as_slice().str();
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    hits_++;
+    auto entry = it->second.get();
+    entry->remove();
+    lru_.put(entry);
+    promise.set_value(entry->response.clone());
+    return;
+  }
+
+  auto &pending = pending_[key];
+  if (!pending.promises.empty()) {
+    coalesced_++;
+    pending.promises.push_back(std::move(promise));
+    return;
+  }
+  misses_++;
+  pending.promises.push_back(std::move(promise));
+  pending.last_masterchain_block = kind == QueryKind::LastMasterchainBlock;
+  pending.generation = generation_;
+  auto P = td::PromiseCreator::lambda([SelfId = actor_id(this), key](td::Result<td::BufferSlice> R) mutable {
+    td::actor::send_closure(SelfId, &LiteServerCacheImpl::got_response, std::move(key), std::move(R));
+  });
+  run_uncached_query(std::move(data), std::move(P));
+}
+
+void LiteServerCacheImpl::run_uncached_query(td::BufferSlice data, td::Promise<td::BufferSlice> promise) {
+  LiteQuery::run_query(std::move(data), manager_, std::move(promise));
+}
+
+void LiteServerCacheImpl::got_response(std::string key, td::Result<td::BufferSlice> R) {
+  auto it = pending_.find(key);
+  CHECK(it != pending_.end());
+  auto pending = std::move(it->second);
+  pending_.erase(it);
+
+  if (R.is_error()) {
+    for (auto &promise : pending.promises) {
+      promise.set_error(R.error().clone());
+    }
+    return;
+  }
+  auto response = R.move_as_ok();
+  for (auto &promise : pending.promises) {
+    promise.set_value(response.clone());
+  }
+  // a response to a query about the last masterchain block may be outdated already
+  if (!pending.last_masterchain_block || pending.generation == generation_) {
+    add_entry(std::move(key), std::move(response), pending.last_masterchain_block);
+  }
+}
+
+void LiteServerCacheImpl::add_entry(std::string key, td::BufferSlice response, bool last_masterchain_block) {
+  auto entry_size = key.size() + response.size();
+  // one big response, like a block, must not push out everything else
+  if (entry_size > max_size_ / 16) {
+    return;
+  }
+  if (last_masterchain_block) {
+    last_masterchain_block_keys_.push_back(key);
+  }
+  auto &entry = entries_[key];
+  CHECK(!entry);
+  entry = std::make_unique<Entry>();
+  entry->key = std::move(key);
+  entry->response = std::move(response);
+  lru_.put(entry.get());
+  size_ += entry_size;
+
+  while (size_ > max_size_) {
+    auto lru_entry = static_cast<Entry *>(lru_.get());
+    CHECK(lru_entry);
+    erase_entry(lru_entry);
+    evictions_++;
+  }
+}
+
+void LiteServerCacheImpl::erase_entry(Entry *entry) {
+  size_ -= entry->key.size() + entry->response.size();
+  // the key must outlive the lookup in the hash map
+  auto key = std::move(entry->key);
+  entries_.erase(key);
+}
+
+void LiteServerCacheImpl::new_masterchain_block() {
+  generation_++;
+  for (auto &key : last_masterchain_block_keys_) {
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      erase_entry(it->second.get());
+    }
+  }
+  last_masterchain_block_keys_.clear();
+}
+
+void LiteServerCacheImpl::prepare_stats(td::Promise<std::vector<std::pair<std::string, std::string>>> promise) {
+  std::vector<std::pair<std::string, std::string>> vec;
+  vec.emplace_back("hits", td::to_string(hits_));
+  vec.emplace_back("misses", td::to_string(misses_));
+  vec.emplace_back("coalesced", td::to_string(coalesced_));
+  vec.emplace_back("notcacheable", td::to_string(not_cacheable_));
+  vec.emplace_back("evictions", td::to_string(evictions_));
+  vec.emplace_back("entries", td::to_string(entries_.size()));
+  vec.emplace_back("size", td::to_string(size_));
+  promise.set_value(std::move(vec));
+}
+
+}  // namespace validator
+
+}  // namespace ton
@@ -0,0 +1,94 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#pragma once
+
+#include "interfaces/liteserver.h"
+#include "interfaces/validator-manager.h"
+
+#include "td/utils/List.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ton {
+
+namespace validator {
+
+// Cache of serialized liteserver responses, keyed by the serialized query. Only queries whose answer is fully
+// determined by their parameters (a block id and account, config parameters etc.) are cached, plus
+// getMasterchainInfo, which is cached until the next masterchain block. Concurrent identical queries are run once.
+class LiteServerCacheImpl : public LiteServerCache {
+ public:
+  static constexpr size_t default_max_size = 64 << 20;
+
+  explicit LiteServerCacheImpl(td::actor::ActorId<ValidatorManager> manager, size_t max_size = default_max_size)
+      : manager_(std::move(manager)), max_size_(max_size) {
+  }
+
+  void run_query(td::BufferSlice data, td::Promise<td::BufferSlice> promise) override;
+  void new_masterchain_block() override;
+  void prepare_stats(td::Promise<std::vector<std::pair<std::string, std::string>>> promise) override;
+
+ protected:
+  // runs a query, which is not answered from the cache, by the liteserver
+  virtual void run_uncached_query(td::BufferSlice data, td::Promise<td::BufferSlice> promise);
+
+ private:
+  enum class QueryKind { NotCacheable, Permanent, LastMasterchainBlock };
+
+  struct Entry : public td::ListNode {
+    std::string key;
+    td::BufferSlice response;
+  };
+  struct PendingQuery {
+    std::vector<td::Promise<td::BufferSlice>> promises;
+    bool last_masterchain_block;
+    td::uint64 generation;
+  };
+
+  td::actor::ActorId<ValidatorManager> manager_;
+  size_t max_size_;
+  size_t size_{0};
+  // incremented on every masterchain block
+  td::uint64 generation_{0};
+
+  // most recently used entries are in the front
+  td::ListNode lru_;
+  std::map<std::string, std::unique_ptr<Entry>> entries_;
+  std::map<std::string, PendingQuery> pending_;
+  // keys of the cached responses which depend on the last masterchain block
+  std::vector<std::string> last_masterchain_block_keys_;
+
+  td::uint64 hits_{0};
+  td::uint64 misses_{0};
+  td::uint64 coalesced_{0};
+  td::uint64 not_cacheable_{0};
+  td::uint64 evictions_{0};
+
+  static QueryKind get_query_kind(td::Slice data);
+  void got_response(std::string key, td::Result<td::BufferSlice> R);
+  void add_entry(std::string key, td::BufferSlice response, bool last_masterchain_block);
+  void erase_entry(Entry *entry);
+};
+
+}  // namespace validator
+
+}  // namespace ton
@@ -382,15 +382,13 @@ void LiteQuery::perform_getState(BlockIdExt blkid) {
     return;
   }
   if (blkid.id.seqno) {
-    td::actor::send_closure_later(manager_, &ValidatorManager::get_shard_state_from_db_short, blkid,
-                                  [Self = actor_id(this), blkid](td::Result<Ref<ton::validator::ShardState>> res) {
-                                    if (res.is_error()) {
-                                      td::actor::send_closure(Self, &LiteQuery::abort_query, res.move_as_error());
-                                    } else {
-                                      td::actor::send_closure_later(Self, &LiteQuery::continue_getState, blkid,
-                                                                    res.move_as_ok());
-                                    }
-                                  });
+    load_shard_state(blkid, [Self = actor_id(this), blkid](td::Result<Ref<ton::validator::ShardState>> res) {
+      if (res.is_error()) {
+        td::actor::send_closure(Self, &LiteQuery::abort_query, res.move_as_error());
+      } else {
+        td::actor::send_closure_later(Self, &LiteQuery::continue_getState, blkid, res.move_as_ok());
+      }
+    });
   } else {
     td::actor::send_closure_later(manager_, &ValidatorManager::get_zero_state, blkid,
                                   [Self = actor_id(this), blkid](td::Result<td::BufferSlice> res) {
@@ -508,19 +506,48 @@ bool LiteQuery::request_mc_block_state(BlockIdExt blkid) {
   }
   base_blk_id_ = blkid;
   ++pending_;
-  td::actor::send_closure_later(
-      manager_, &ValidatorManager::get_shard_state_from_db_short, blkid,
-      [Self = actor_id(this), blkid](td::Result<Ref<ShardState>> res) {
-        if (res.is_error()) {
-          td::actor::send_closure(Self, &LiteQuery::abort_query,
-                                  res.move_as_error_prefix("cannot load state for "s + blkid.to_str() + " : "));
-        } else {
-          td::actor::send_closure_later(Self, &LiteQuery::got_mc_block_state, blkid, res.move_as_ok());
-        }
-      });
+  load_shard_state(blkid, [Self = actor_id(this), blkid](td::Result<Ref<ShardState>> res) {
+    if (res.is_error()) {
+      td::actor::send_closure(Self, &LiteQuery::abort_query,
+                              res.move_as_error_prefix("cannot load state for "s + blkid.to_str() + " : "));
+    } else {
+      td::actor::send_closure_later(Self, &LiteQuery::got_mc_block_state, blkid, res.move_as_ok());
+    }
+  });
   return true;
 }
 
+// Loads the state of a block through a snapshot reader of the cell db, so that the cells are loaded on this actor
+// and the query does not wait in the queue of CellDb behind other loads and commits.
+void LiteQuery::load_shard_state(BlockIdExt blkid, td::Promise<Ref<ShardState>> promise) {
+  auto P = td::PromiseCreator::lambda([Self = actor_id(this), manager = manager_,
+                                       promise = std::move(promise)](td::Result<BlockHandle> R) mutable {
+    TRY_RESULT_PROMISE(promise, handle, std::move(R));
+    if (!handle->inited_state_boc()) {
+      promise.set_error(td::Status::Error(ErrorCode::notready, "state not in db"));
+      return;
+    }
+    if (handle->deleted_state_boc()) {
+      promise.set_error(td::Status::Error(ErrorCode::error, "state already gc'd"));
+      return;
+    }
+    td::actor::send_closure(manager, &ValidatorManager::get_cell_db_reader,
+                            [Self, handle = std::move(handle), promise = std::move(promise)](
+                                td::Result<std::shared_ptr<vm::CellDbReader>> R) mutable {
+                              TRY_RESULT_PROMISE(promise, reader, std::move(R));
+                              td::actor::send_closure_later(Self, &LiteQuery::load_shard_state_cont, std::move(handle),
+                                                            std::move(reader), std::move(promise));
+                            });
+  });
+  td::actor::send_closure_later(manager_, &ValidatorManager::get_block_handle, blkid, false, std::move(P));
+}
+
+void LiteQuery::load_shard_state_cont(ConstBlockHandle handle, std::shared_ptr<vm::CellDbReader> reader,
+                                      td::Promise<Ref<ShardState>> promise) {
+  TRY_RESULT_PROMISE(promise, root, reader->load_cell(handle->state().as_slice()));
+  promise.set_result(create_shard_state(handle->id(), std::move(root)));
+}
+
 bool LiteQuery::request_mc_block_data_state(BlockIdExt blkid) {
   return request_mc_block_data(blkid) && request_mc_block_state(blkid);
 }
@@ -539,16 +566,14 @@ bool LiteQuery::request_block_state(BlockIdExt blkid) {
   }
   blk_id_ = blkid;
   ++pending_;
-  td::actor::send_closure_later(
-      manager_, &ValidatorManager::get_shard_state_from_db_short, blkid,
-      [Self = actor_id(this), blkid](td::Result<Ref<ShardState>> res) {
-        if (res.is_error()) {
-          td::actor::send_closure(Self, &LiteQuery::abort_query,
-                                  res.move_as_error_prefix("cannot load state for "s + blkid.to_str() + " : "));
-        } else {
-          td::actor::send_closure_later(Self, &LiteQuery::got_block_state, blkid, res.move_as_ok());
-        }
-      });
+  load_shard_state(blkid, [Self = actor_id(this), blkid](td::Result<Ref<ShardState>> res) {
+    if (res.is_error()) {
+      td::actor::send_closure(Self, &LiteQuery::abort_query,
+                              res.move_as_error_prefix("cannot load state for "s + blkid.to_str() + " : "));
+    } else {
+      td::actor::send_closure_later(Self, &LiteQuery::got_block_state, blkid, res.move_as_ok());
+    }
+  });
   return true;
 }
 
@@ -1203,7 +1228,56 @@ void LiteQuery::perform_getTransactions(WorkchainId workchain, StdSmcAddress add
   acc_addr_ = addr;
   trans_lt_ = lt;
   trans_hash_ = hash;
-  continue_getTransactions(count, false);
+  ++pending_;
+  td::actor::send_closure_later(
+      manager_, &ValidatorManager::get_account_transactions_from_db, workchain, addr, lt, count,
+      [Self = actor_id(this), count](td::Result<std::vector<AccountTransactionId>> res) {
+        td::actor::send_closure_later(Self, &LiteQuery::got_indexed_transactions, count, std::move(res));
+      });
+}
+
+void LiteQuery::got_indexed_transactions(unsigned remaining, td::Result<std::vector<AccountTransactionId>> res) {
+  --pending_;
+  if (res.is_error()) {
+    // the transaction index is disabled, walk the history one block at a time
+    LOG(DEBUG) << "getTransactions() : transaction index is not available: " << res.move_as_error();
+    continue_getTransactions(remaining, false);
+    return;
+  }
+  std::map<BlockIdExt, std::vector<LogicalTime>> blocks;
+  for (auto& tx : res.move_as_ok()) {
+    blocks[tx.block_id].push_back(tx.lt);
+  }
+  LOG(DEBUG) << "getTransactions() : transaction index refers to " << blocks.size() << " blocks";
+  if (blocks.empty()) {
+    continue_getTransactions(remaining, false);
+    return;
+  }
+  // load all blocks at once; continue_getTransactions() still checks every transaction against its predecessor
+  pending_ += static_cast<int>(blocks.size());
+  for (auto& b : blocks) {
+    td::actor::send_closure_later(
+        manager_, &ValidatorManager::get_block_data_from_db_short, b.first,
+        [Self = actor_id(this), blkid = b.first, lts = std::move(b.second), remaining](td::Result<Ref<BlockData>> res) {
+          td::actor::send_closure_later(Self, &LiteQuery::got_indexed_block, blkid, std::move(lts), std::move(res),
+                                        remaining);
+        });
+  }
+}
+
+void LiteQuery::got_indexed_block(BlockIdExt blkid, std::vector<LogicalTime> lts, td::Result<Ref<BlockData>> res,
+                                  unsigned remaining) {
+  if (res.is_error()) {
+    LOG(DEBUG) << "getTransactions() : cannot load indexed block " << blkid.to_str() << ": " << res.move_as_error();
+  } else {
+    auto block = res.move_as_ok();
+    for (auto lt : lts) {
+      indexed_blocks_[lt] = std::make_pair(blkid, block);
+    }
+  }
+  if (!--pending_) {
+    continue_getTransactions(remaining, false);
+  }
 }
 
 void LiteQuery::continue_getTransactions(unsigned remaining, bool exact) {
@@ -1266,6 +1340,15 @@ void LiteQuery::continue_getTransactions(unsigned remaining, bool exact) {
     finish_getTransactions();
     return;
   }
+  auto it = indexed_blocks_.find(trans_lt_);
+  if (it != indexed_blocks_.end()) {
+    LOG(DEBUG) << "using indexed block " << it->second.first.to_str() << " for transaction with lt=" << trans_lt_;
+    blk_id_ = it->second.first;
+    block_ = std::move(it->second.second);
+    indexed_blocks_.erase(it);
+    continue_getTransactions(remaining, true);
+    return;
+  }
   ++pending_;
   LOG(DEBUG) << "sending get_block_by_lt_from_db() query to manager for " << acc_workchain_ << ":" << acc_addr_.to_hex()
              << " " << trans_lt_;
@@ -1652,16 +1735,14 @@ void LiteQuery::perform_getBlockProof(ton::BlockIdExt from, ton::BlockIdExt to,
   if (mode & 1) {
     if (mode & 0x1000) {
       BlockIdExt bblk = (from.seqno() > to.seqno()) ? from : to;
-      td::actor::send_closure_later(manager_, &ValidatorManager::get_shard_state_from_db_short, bblk,
-                                    [Self = actor_id(this), from, to, bblk, mode](td::Result<Ref<ShardState>> res) {
-                                      if (res.is_error()) {
-                                        td::actor::send_closure(Self, &LiteQuery::abort_query, res.move_as_error());
-                                      } else {
-                                        td::actor::send_closure_later(Self, &LiteQuery::continue_getBlockProof, from,
-                                                                      to, mode, bblk,
-                                                                      Ref<MasterchainStateQ>(res.move_as_ok()));
-                                      }
-                                    });
+      load_shard_state(bblk, [Self = actor_id(this), from, to, bblk, mode](td::Result<Ref<ShardState>> res) {
+        if (res.is_error()) {
+          td::actor::send_closure(Self, &LiteQuery::abort_query, res.move_as_error());
+        } else {
+          td::actor::send_closure_later(Self, &LiteQuery::continue_getBlockProof, from, to, mode, bblk,
+                                        Ref<MasterchainStateQ>(res.move_as_ok()));
+        }
+      });
     } else {
       td::actor::send_closure_later(
           manager_, &ton::validator::ValidatorManager::get_top_masterchain_state_block,
@@ -55,6 +55,7 @@ class LiteQuery : public td::actor::Actor {
   std::vector<Ref<vm::Cell>> roots_;
   std::vector<Ref<td::CntObject>> aux_objs_;
   std::vector<ton::BlockIdExt> blk_ids_;
+  std::map<LogicalTime, std::pair<BlockIdExt, Ref<BlockData>>> indexed_blocks_;  // by transaction lt
   std::unique_ptr<block::BlockProofChain> chain_;
   Ref<vm::Stack> stack_;
 
@@ -105,6 +106,9 @@ class LiteQuery : public td::actor::Actor {
   void perform_getOneTransaction(BlockIdExt blkid, WorkchainId workchain, StdSmcAddress addr, LogicalTime lt);
   void continue_getOneTransaction();
   void perform_getTransactions(WorkchainId workchain, StdSmcAddress addr, LogicalTime lt, Bits256 hash, unsigned count);
+  void got_indexed_transactions(unsigned remaining, td::Result<std::vector<AccountTransactionId>> res);
+  void got_indexed_block(BlockIdExt blkid, std::vector<LogicalTime> lts, td::Result<Ref<BlockData>> res,
+                         unsigned remaining);
   void continue_getTransactions(unsigned remaining, bool exact);
   void continue_getTransactions_2(BlockIdExt blkid, Ref<BlockData> block, unsigned remaining);
   void abort_getTransactions(td::Status error, ton::BlockIdExt blkid);
@@ -140,6 +144,9 @@ class LiteQuery : public td::actor::Actor {
   bool request_mc_block_data_state(BlockIdExt blkid);
   bool request_mc_proof(BlockIdExt blkid, int mode = 0);
   bool request_zero_state(BlockIdExt blkid);
+  void load_shard_state(BlockIdExt blkid, td::Promise<Ref<ShardState>> promise);
+  void load_shard_state_cont(ConstBlockHandle handle, std::shared_ptr<vm::CellDbReader> reader,
+                             td::Promise<Ref<ShardState>> promise);
   void got_block_state(BlockIdExt blkid, Ref<ShardState> state);
   void got_mc_block_state(BlockIdExt blkid, Ref<ShardState> state);
   void got_block_data(BlockIdExt blkid, Ref<BlockData> data);
@@ -26,6 +26,7 @@
 #include "vm/cells/MerkleUpdate.h"
 #include "block/block-parse.h"
 #include "block/block-auto.h"
+#include "worker-pool.hpp"
 
 #define LAZY_STATE_DESERIALIZE 1
 
@@ -136,7 +137,11 @@ td::Status ShardStateQ::validate_deep() const {
     return td::Status::Error(-668,
                              "cannot validate serialized shard state because no serialized shard state is present");
   }
-  auto res = vm::std_boc_deserialize(data.as_slice());
+  // large (persistent) states are deserialized and hashed on the threads of the worker pool
+  int threads = data.size() >= (1 << 24) ? static_cast<int>(WorkerPool::max_threads()) : 1;
+  auto res = vm::std_boc_deserialize(data.as_slice(), false, threads, [](int threads, const std::function<void()> &f) {
+    WorkerPool::get().run(threads, f);
+  });
   if (res.is_error()) {
     return res.move_as_error();
   }
@@ -301,6 +306,29 @@ td::Result<td::BufferSlice> ShardStateQ::serialize() const {
   return st_res.move_as_ok();
 }
 
+td::Status ShardStateQ::serialize_to_file(td::FileFd& fd) const {
+  td::PerfWarningTimer perf_timer_{"serializestatetofile", 1.0};
+  if (!data.is_null()) {
+    auto slice = data.as_slice();
+    while (!slice.empty()) {
+      TRY_RESULT(size, fd.write(slice));
+      slice.remove_prefix(size);
+    }
+    return td::Status::OK();
+  }
+  if (root.is_null()) {
+    return td::Status::Error(-666, "cannot serialize an uninitialized state");
+  }
+  vm::BagOfCells new_boc;
+  new_boc.set_root(root);
+  TRY_STATUS(new_boc.import_cells());
+  auto S = new_boc.serialize_to_file(fd, 31);
+  if (S.is_error()) {
+    LOG(ERROR) << "cannot serialize a shardchain state";
+  }
+  return S;
+}
+
 MasterchainStateQ::MasterchainStateQ(const BlockIdExt& _id, td::BufferSlice _data)
     : MasterchainState(), ShardStateQ(_id, std::move(_data)) {
 }
@@ -19,6 +19,7 @@
 #include "validate-query.hpp"
 #include "top-shard-descr.hpp"
 #include "validator-set.hpp"
+#include "worker-pool.hpp"
 #include "adnl/utils.hpp"
 #include "ton/ton-tl.hpp"
 #include "ton/ton-io.hpp"
@@ -31,6 +32,8 @@
 #include "vm/cells/MerkleProof.h"
 #include "vm/cells/MerkleUpdate.h"
 #include "common/errorlog.h"
+#include "td/utils/Timer.h"
+#include <atomic>
 #include <ctime>
 
 namespace ton {
@@ -39,6 +42,8 @@ namespace validator {
 using td::Ref;
 using namespace std::literals::string_literals;
 
+int validate_query_threads = 0;
+
 std::string ErrorCtx::as_string() const {
   std::string a;
   for (const auto& s : entries_) {
@@ -3977,23 +3982,23 @@ std::unique_ptr<block::Account> ValidateQuery::make_account_from(td::ConstBitPtr
 }
 
 // similar to Collator::make_account()
-std::unique_ptr<block::Account> ValidateQuery::unpack_account(td::ConstBitPtr addr) {
+std::unique_ptr<block::Account> ValidateQuery::unpack_account(AccountTransactions& res, td::ConstBitPtr addr) {
   auto dict_entry = ps_.account_dict_->lookup_extra(addr, 256);
   auto new_acc = make_account_from(addr, std::move(dict_entry.first), std::move(dict_entry.second));
   if (!new_acc) {
-    reject_query("cannot load state of account "s + addr.to_hex(256) + " from previous shardchain state");
+    res.reject_query("cannot load state of account "s + addr.to_hex(256) + " from previous shardchain state");
     return {};
   }
   if (!new_acc->belongs_to_shard(shard_)) {
-    reject_query(PSTRING() << "old state of account " << addr.to_hex(256)
-                           << " does not really belong to current shard");
+    res.reject_query(PSTRING() << "old state of account " << addr.to_hex(256)
+                               << " does not really belong to current shard");
     return {};
   }
   return new_acc;
 }
 
-bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalTime lt, Ref<vm::Cell> trans_root,
-                                          bool is_first, bool is_last) {
+bool ValidateQuery::check_one_transaction(AccountTransactions& res, block::Account& account, ton::LogicalTime lt,
+                                          Ref<vm::Cell> trans_root, bool is_first, bool is_last) {
   LOG(DEBUG) << "checking transaction " << lt << " of account " << account.addr.to_hex();
   const StdSmcAddress& addr = account.addr;
   block::gen::Transaction::Record trans;
@@ -4007,17 +4012,17 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
   if (in_msg_root.not_null()) {
     auto in_descr_cs = in_msg_dict_->lookup(in_msg_root->get_hash().as_bitslice());
     if (in_descr_cs.is_null()) {
-      return reject_query(PSTRING() << "inbound message with hash " << in_msg_root->get_hash().to_hex()
-                                    << " of transaction " << lt << " of account " << addr.to_hex()
-                                    << " does not have a corresponding InMsg record");
+      return res.reject_query(PSTRING() << "inbound message with hash " << in_msg_root->get_hash().to_hex()
+                                        << " of transaction " << lt << " of account " << addr.to_hex()
+                                        << " does not have a corresponding InMsg record");
     }
     auto tag = block::gen::t_InMsg.get_tag(*in_descr_cs);
     if (tag != block::gen::InMsg::msg_import_ext && tag != block::gen::InMsg::msg_import_fin &&
         tag != block::gen::InMsg::msg_import_imm && tag != block::gen::InMsg::msg_import_ihr) {
-      return reject_query(PSTRING() << "inbound message with hash " << in_msg_root->get_hash().to_hex()
-                                    << " of transaction " << lt << " of account " << addr.to_hex()
-                                    << " has an invalid InMsg record (not one of msg_import_ext, msg_import_fin, "
-                                       "msg_import_imm or msg_import_ihr)");
+      return res.reject_query(PSTRING() << "inbound message with hash " << in_msg_root->get_hash().to_hex()
+                                        << " of transaction " << lt << " of account " << addr.to_hex()
+                                        << " has an invalid InMsg record (not one of msg_import_ext, msg_import_fin, "
+                                           "msg_import_imm or msg_import_ihr)");
     }
     // once we know there is a InMsg with correct hash, we already know that it contains a message with this hash (by the verification of InMsg), so it is our message
     // have still to check its destination address and imported value
@@ -4032,12 +4037,12 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
       block::gen::CommonMsgInfo::Record_int_msg_info info;
       CHECK(tlb::unpack_cell_inexact(in_msg_root, info));
       if (info.created_lt >= lt) {
-        return reject_query(PSTRING() << "transaction " << lt << " of " << addr.to_hex()
-                                      << " processed inbound message created later at logical time "
-                                      << info.created_lt);
+        return res.reject_query(PSTRING() << "transaction " << lt << " of " << addr.to_hex()
+                                          << " processed inbound message created later at logical time "
+                                          << info.created_lt);
       }
       if (info.created_lt != start_lt_ || !is_special_in_msg(*in_descr_cs)) {
-        msg_proc_lt_.emplace_back(addr, lt, info.created_lt);
+        res.msg_proc_lt.emplace_back(addr, lt, info.created_lt);
       }
       dest = std::move(info.dest);
       CHECK(money_imported.validate_unpack(info.value));
@@ -4051,15 +4056,16 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
     StdSmcAddress d_addr;
     CHECK(block::tlb::t_MsgAddressInt.extract_std_address(dest, d_wc, d_addr));
     if (d_wc != workchain() || d_addr != addr) {
-      return reject_query(PSTRING() << "inbound message of transaction " << lt << " of account " << addr.to_hex()
-                                    << " has a different destination address " << d_wc << ":" << d_addr.to_hex());
+      return res.reject_query(PSTRING() << "inbound message of transaction " << lt << " of account " << addr.to_hex()
+                                        << " has a different destination address " << d_wc << ":" << d_addr.to_hex());
     }
     auto in_msg_trans = in_descr_cs->prefetch_ref(1);  // trans:^Transaction
     CHECK(in_msg_trans.not_null());
     if (in_msg_trans->get_hash() != trans_root->get_hash()) {
-      return reject_query(PSTRING() << "InMsg record for inbound message with hash " << in_msg_root->get_hash().to_hex()
-                                    << " of transaction " << lt << " of account " << addr.to_hex()
-                                    << " refers to a different processing transaction");
+      return res.reject_query(PSTRING() << "InMsg record for inbound message with hash "
+                                        << in_msg_root->get_hash().to_hex() << " of transaction " << lt
+                                        << " of account " << addr.to_hex()
+                                        << " refers to a different processing transaction");
     }
   }
   // check output messages
@@ -4069,14 +4075,15 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
     CHECK(out_msg_root.not_null());  // we have pre-checked this
     auto out_descr_cs = out_msg_dict_->lookup(out_msg_root->get_hash().as_bitslice());
     if (out_descr_cs.is_null()) {
-      return reject_query(PSTRING() << "outbound message #" << i + 1 << " with hash "
-                                    << out_msg_root->get_hash().to_hex() << " of transaction " << lt << " of account "
-                                    << addr.to_hex() << " does not have a corresponding OutMsg record");
+      return res.reject_query(PSTRING() << "outbound message #" << i + 1 << " with hash "
+                                        << out_msg_root->get_hash().to_hex() << " of transaction " << lt
+                                        << " of account " << addr.to_hex()
+                                        << " does not have a corresponding OutMsg record");
     }
     auto tag = block::gen::t_OutMsg.get_tag(*out_descr_cs);
     if (tag != block::gen::OutMsg::msg_export_ext && tag != block::gen::OutMsg::msg_export_new &&
         tag != block::gen::OutMsg::msg_export_imm) {
-      return reject_query(
+      return res.reject_query(
           PSTRING() << "outbound message #" << i + 1 << " with hash " << out_msg_root->get_hash().to_hex()
                     << " of transaction " << lt << " of account " << addr.to_hex()
                     << " has an invalid OutMsg record (not one of msg_export_ext, msg_export_new or msg_export_imm)");
@@ -4107,16 +4114,17 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
     StdSmcAddress ss_addr;  // s_addr is some macros in Windows
     CHECK(block::tlb::t_MsgAddressInt.extract_std_address(src, s_wc, ss_addr));
     if (s_wc != workchain() || ss_addr != addr) {
-      return reject_query(PSTRING() << "outbound message #" << i + 1 << " of transaction " << lt << " of account "
-                                    << addr.to_hex() << " has a different source address " << s_wc << ":"
-                                    << ss_addr.to_hex());
+      return res.reject_query(PSTRING() << "outbound message #" << i + 1 << " of transaction " << lt << " of account "
+                                        << addr.to_hex() << " has a different source address " << s_wc << ":"
+                                        << ss_addr.to_hex());
     }
     auto out_msg_trans = out_descr_cs->prefetch_ref(1);  // trans:^Transaction
     CHECK(out_msg_trans.not_null());
     if (out_msg_trans->get_hash() != trans_root->get_hash()) {
-      return reject_query(PSTRING() << "OutMsg record for outbound message #" << i + 1 << " with hash "
-                                    << out_msg_root->get_hash().to_hex() << " of transaction " << lt << " of account "
-                                    << addr.to_hex() << " refers to a different processing transaction");
+      return res.reject_query(PSTRING() << "OutMsg record for outbound message #" << i + 1 << " with hash "
+                                        << out_msg_root->get_hash().to_hex() << " of transaction " << lt
+                                        << " of account " << addr.to_hex()
+                                        << " refers to a different processing transaction");
     }
   }
   CHECK(money_exported.is_valid());
@@ -4130,99 +4138,107 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
       tag == block::gen::TransactionDescr::trans_split_prepare ||
       tag == block::gen::TransactionDescr::trans_split_install) {
     if (is_masterchain()) {
-      return reject_query(
+      return res.reject_query(
           PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                     << " is a split/merge prepare/install transaction, which is impossible in a masterchain block");
     }
     bool split = (tag == block::gen::TransactionDescr::trans_split_prepare ||
                   tag == block::gen::TransactionDescr::trans_split_install);
     if (split && !before_split_) {
-      return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
-                                    << " is a split prepare/install transaction, but this block is not before a split");
+      return res.reject_query(
+          PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+                    << " is a split prepare/install transaction, but this block is not before a split");
     }
     if (split && !is_last) {
-      return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
-                                    << " is a split prepare/install transaction, but it is not the last transaction "
-                                       "for this account in this block");
+      return res.reject_query(
+          PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+                    << " is a split prepare/install transaction, but it is not the last transaction "
+                       "for this account in this block");
     }
     if (!split && !after_merge_) {
-      return reject_query(
+      return res.reject_query(
           PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                     << " is a merge prepare/install transaction, but this block is not immediately after a merge");
     }
     if (!split && !is_first) {
-      return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
-                                    << " is a merge prepare/install transaction, but it is not the first transaction "
-                                       "for this account in this block");
+      return res.reject_query(
+          PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+                    << " is a merge prepare/install transaction, but it is not the first transaction "
+                       "for this account in this block");
     }
     // check later a global configuration flag in config_.global_flags_
     // (for now, split/merge transactions are always globally disabled)
-    return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
-                                  << " is a split/merge prepare/install transaction, which are globally disabled");
+    return res.reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+                                      << " is a split/merge prepare/install transaction, which are globally disabled");
   }
   if (tag == block::gen::TransactionDescr::trans_tick_tock) {
     if (!is_masterchain()) {
-      return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
-                                    << " is a tick-tock transaction, which is impossible outside a masterchain block");
+      return res.reject_query(
+          PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+                    << " is a tick-tock transaction, which is impossible outside a masterchain block");
     }
     if (!account.is_special) {
-      return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
-                                    << " is a tick-tock transaction, but this account is not listed as special");
+      return res.reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+                                        << " is a tick-tock transaction, but this account is not listed as special");
     }
     bool is_tock = td_cs.prefetch_ulong(4) & 1;  // trans_tick_tock$001 is_tock:Bool ...
     if (!is_tock) {
       if (!is_first) {
-        return reject_query(
+        return res.reject_query(
             PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                       << " is a tick transaction, but this is not the first transaction of this account");
       }
       if (lt != start_lt_ + 1) {
-        return reject_query(
+        return res.reject_query(
             PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                       << " is a tick transaction, but its logical start time differs from block's start time "
                       << start_lt_ << " by more than one");
       }
       if (!account.tick) {
-        return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
-                                      << " is a tick transaction, but this account has not enabled tick transactions");
+        return res.reject_query(
+            PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+                      << " is a tick transaction, but this account has not enabled tick transactions");
       }
     } else {
       if (!is_last) {
-        return reject_query(
+        return res.reject_query(
             PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                       << " is a tock transaction, but this is not the last transaction of this account");
       }
       if (!account.tock) {
-        return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
-                                      << " is a tock transaction, but this account has not enabled tock transactions");
+        return res.reject_query(
+            PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+                      << " is a tock transaction, but this account has not enabled tock transactions");
       }
     }
   }
   if (is_first && is_masterchain() && account.is_special && account.tick &&
       (tag != block::gen::TransactionDescr::trans_tick_tock || (td_cs.prefetch_ulong(4) & 1)) && !account.created) {
-    return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
-                                  << " is the first transaction for this special tick account in this block, but the "
-                                     "transaction is not a tick transaction");
+    return res.reject_query(
+        PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+                  << " is the first transaction for this special tick account in this block, but the "
+                     "transaction is not a tick transaction");
   }
   if (is_last && is_masterchain() && account.is_special && account.tock &&
       (tag != block::gen::TransactionDescr::trans_tick_tock || !(td_cs.prefetch_ulong(4) & 1)) &&
       trans.end_status == block::gen::AccountStatus::acc_state_active) {
-    return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
-                                  << " is the last transaction for this special tock account in this block, but the "
-                                     "transaction is not a tock transaction");
+    return res.reject_query(
+        PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+                  << " is the last transaction for this special tock account in this block, but the "
+                     "transaction is not a tock transaction");
   }
   if (tag == block::gen::TransactionDescr::trans_storage && !is_first) {
-    return reject_query(
+    return res.reject_query(
         PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
                   << " is a storage transaction, but it is not the first transaction for this account in this block");
   }
   // check that the original account state has correct hash
   CHECK(account.total_state.not_null());
   if (hash_upd.old_hash != account.total_state->get_hash().bits()) {
-    return reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
-                                  << " claims that the original account state hash must be "
-                                  << hash_upd.old_hash.to_hex() << " but the actual value is "
-                                  << account.total_state->get_hash().to_hex());
+    return res.reject_query(PSTRING() << "transaction " << lt << " of account " << addr.to_hex()
+                                      << " claims that the original account state hash must be "
+                                      << hash_upd.old_hash.to_hex() << " but the actual value is "
+                                      << account.total_state->get_hash().to_hex());
   }
   // some type-specific checks
   int trans_type = block::Transaction::tr_none;
@@ -4230,8 +4246,8 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
     case block::gen::TransactionDescr::trans_ord: {
       trans_type = block::Transaction::tr_ord;
       if (in_msg_root.is_null()) {
-        return reject_query(PSTRING() << "ordinary transaction " << lt << " of account " << addr.to_hex()
-                                      << " has no inbound message");
+        return res.reject_query(PSTRING() << "ordinary transaction " << lt << " of account " << addr.to_hex()
+                                          << " has no inbound message");
       }
       need_credit_phase = !external;
       break;
@@ -4239,78 +4255,78 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
     case block::gen::TransactionDescr::trans_storage: {
       trans_type = block::Transaction::tr_storage;
       if (in_msg_root.not_null()) {
-        return reject_query(PSTRING() << "storage transaction " << lt << " of account " << addr.to_hex()
-                                      << " has an inbound message");
+        return res.reject_query(PSTRING() << "storage transaction " << lt << " of account " << addr.to_hex()
+                                          << " has an inbound message");
       }
       if (trans.outmsg_cnt) {
-        return reject_query(PSTRING() << "storage transaction " << lt << " of account " << addr.to_hex()
-                                      << " has at least one outbound message");
+        return res.reject_query(PSTRING() << "storage transaction " << lt << " of account " << addr.to_hex()
+                                          << " has at least one outbound message");
       }
       // FIXME
-      return reject_query(PSTRING() << "unable to verify storage transaction " << lt << " of account "
-                                    << addr.to_hex());
+      return res.reject_query(PSTRING() << "unable to verify storage transaction " << lt << " of account "
+                                        << addr.to_hex());
       break;
     }
     case block::gen::TransactionDescr::trans_tick_tock: {
       bool is_tock = (td_cs.prefetch_ulong(4) & 1);
       trans_type = is_tock ? block::Transaction::tr_tock : block::Transaction::tr_tick;
       if (in_msg_root.not_null()) {
-        return reject_query(PSTRING() << (is_tock ? "tock" : "tick") << " transaction " << lt << " of account "
-                                      << addr.to_hex() << " has an inbound message");
+        return res.reject_query(PSTRING() << (is_tock ? "tock" : "tick") << " transaction " << lt << " of account "
+                                          << addr.to_hex() << " has an inbound message");
       }
       break;
     }
     case block::gen::TransactionDescr::trans_merge_prepare: {
       trans_type = block::Transaction::tr_merge_prepare;
       if (in_msg_root.not_null()) {
-        return reject_query(PSTRING() << "merge prepare transaction " << lt << " of account " << addr.to_hex()
-                                      << " has an inbound message");
+        return res.reject_query(PSTRING() << "merge prepare transaction " << lt << " of account " << addr.to_hex()
+                                          << " has an inbound message");
       }
       if (trans.outmsg_cnt != 1) {
-        return reject_query(PSTRING() << "merge prepare transaction " << lt << " of account " << addr.to_hex()
-                                      << " must have exactly one outbound message");
+        return res.reject_query(PSTRING() << "merge prepare transaction " << lt << " of account " << addr.to_hex()
+                                          << " must have exactly one outbound message");
       }
       // FIXME
-      return reject_query(PSTRING() << "unable to verify merge prepare transaction " << lt << " of account "
-                                    << addr.to_hex());
+      return res.reject_query(PSTRING() << "unable to verify merge prepare transaction " << lt << " of account "
+                                        << addr.to_hex());
       break;
     }
     case block::gen::TransactionDescr::trans_merge_install: {
       trans_type = block::Transaction::tr_merge_install;
       if (in_msg_root.is_null()) {
-        return reject_query(PSTRING() << "merge install transaction " << lt << " of account " << addr.to_hex()
-                                      << " has no inbound message");
+        return res.reject_query(PSTRING() << "merge install transaction " << lt << " of account " << addr.to_hex()
+                                          << " has no inbound message");
       }
       need_credit_phase = true;
       // FIXME
-      return reject_query(PSTRING() << "unable to verify merge install transaction " << lt << " of account "
-                                    << addr.to_hex());
+      return res.reject_query(PSTRING() << "unable to verify merge install transaction " << lt << " of account "
+                                        << addr.to_hex());
       break;
     }
     case block::gen::TransactionDescr::trans_split_prepare: {
       trans_type = block::Transaction::tr_split_prepare;
       if (in_msg_root.not_null()) {
-        return reject_query(PSTRING() << "split prepare transaction " << lt << " of account " << addr.to_hex()
-                                      << " has an inbound message");
+        return res.reject_query(PSTRING() << "split prepare transaction " << lt << " of account " << addr.to_hex()
+                                          << " has an inbound message");
       }
       if (trans.outmsg_cnt > 1) {
-        return reject_query(PSTRING() << "split prepare transaction " << lt << " of account " << addr.to_hex()
-                                      << " must have exactly one outbound message");
+        return res.reject_query(PSTRING() << "split prepare transaction " << lt << " of account " << addr.to_hex()
+                                          << " must have exactly one outbound message");
       }
       // FIXME
-      return reject_query(PSTRING() << "unable to verify split prepare transaction " << lt << " of account "
-                                    << addr.to_hex());
+      return res.reject_query(PSTRING() << "unable to verify split prepare transaction " << lt << " of account "
+                                        << addr.to_hex());
       break;
     }
     case block::gen::TransactionDescr::trans_split_install: {
       trans_type = block::Transaction::tr_split_install;
       if (in_msg_root.is_null()) {
-        return reject_query(PSTRING() << "split install transaction " << lt << " of account " << addr.to_hex()
-                                      << " has no inbound message");
+        return res.reject_query(PSTRING() << "split install transaction " << lt << " of account " << addr.to_hex()
+                                          << " has no inbound message");
       }
       // FIXME
-      return reject_query(PSTRING() << "unable to verify split install transaction " << lt << " of account "
-                                    << addr.to_hex());
+      return res.reject_query(PSTRING() << "unable to verify split install transaction " << lt << " of account "
+                                        << addr.to_hex());
       break;
     }
   }
@@ -4323,64 +4339,64 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
   if (in_msg_root.not_null()) {
     if (!trs->unpack_input_msg(ihr_delivered, &action_phase_cfg_)) {
       // inbound external message was not accepted
-      return reject_query(PSTRING() << "could not unpack inbound " << (external ? "external" : "internal")
-                                    << " message processed by ordinary transaction " << lt << " of account "
-                                    << addr.to_hex());
+      return res.reject_query(PSTRING() << "could not unpack inbound " << (external ? "external" : "internal")
+                                        << " message processed by ordinary transaction " << lt << " of account "
+                                        << addr.to_hex());
     }
   }
   if (trs->bounce_enabled) {
     if (!trs->prepare_storage_phase(storage_phase_cfg_, true)) {
-      return reject_query(PSTRING() << "cannot re-create storage phase of transaction " << lt << " for smart contract "
-                                    << addr.to_hex());
+      return res.reject_query(PSTRING() << "cannot re-create storage phase of transaction " << lt
+                                        << " for smart contract " << addr.to_hex());
     }
     if (need_credit_phase && !trs->prepare_credit_phase()) {
-      return reject_query(PSTRING() << "cannot create re-credit phase of transaction " << lt << " for smart contract "
-                                    << addr.to_hex());
+      return res.reject_query(PSTRING() << "cannot create re-credit phase of transaction " << lt
+                                        << " for smart contract " << addr.to_hex());
     }
   } else {
     if (need_credit_phase && !trs->prepare_credit_phase()) {
-      return reject_query(PSTRING() << "cannot re-create credit phase of transaction " << lt << " for smart contract "
-                                    << addr.to_hex());
+      return res.reject_query(PSTRING() << "cannot re-create credit phase of transaction " << lt
+                                        << " for smart contract " << addr.to_hex());
     }
     if (!trs->prepare_storage_phase(storage_phase_cfg_, true)) {
-      return reject_query(PSTRING() << "cannot re-create storage phase of transaction " << lt << " for smart contract "
-                                    << addr.to_hex());
+      return res.reject_query(PSTRING() << "cannot re-create storage phase of transaction " << lt
+                                        << " for smart contract " << addr.to_hex());
     }
   }
   if (!trs->prepare_compute_phase(compute_phase_cfg_)) {
-    return reject_query(PSTRING() << "cannot re-create compute phase of transaction " << lt << " for smart contract "
-                                  << addr.to_hex());
+    return res.reject_query(PSTRING() << "cannot re-create compute phase of transaction " << lt
+                                      << " for smart contract " << addr.to_hex());
   }
   if (!trs->compute_phase->accepted) {
     if (external) {
-      return reject_query(PSTRING() << "inbound external message claimed to be processed by ordinary transaction " << lt
-                                    << " of account " << addr.to_hex()
-                                    << " was in fact rejected (such transaction cannot appear in valid blocks)");
+      return res.reject_query(PSTRING() << "inbound external message claimed to be processed by ordinary transaction "
+                                        << lt << " of account " << addr.to_hex()
+                                        << " was in fact rejected (such transaction cannot appear in valid blocks)");
     } else if (trs->compute_phase->skip_reason == block::ComputePhase::sk_none) {
-      return reject_query(PSTRING() << "inbound internal message processed by ordinary transaction " << lt
-                                    << " of account " << addr.to_hex() << " was not processed without any reason");
+      return res.reject_query(PSTRING() << "inbound internal message processed by ordinary transaction " << lt
+                                        << " of account " << addr.to_hex() << " was not processed without any reason");
     }
   }
   if (trs->compute_phase->success && !trs->prepare_action_phase(action_phase_cfg_)) {
-    return reject_query(PSTRING() << "cannot re-create action phase of transaction " << lt << " for smart contract "
-                                  << addr.to_hex());
+    return res.reject_query(PSTRING() << "cannot re-create action phase of transaction " << lt << " for smart contract "
+                                      << addr.to_hex());
   }
   if (trs->bounce_enabled && !trs->compute_phase->success && !trs->prepare_bounce_phase(action_phase_cfg_)) {
-    return reject_query(PSTRING() << "cannot re-create bounce phase of  transaction " << lt << " for smart contract "
-                                  << addr.to_hex());
+    return res.reject_query(PSTRING() << "cannot re-create bounce phase of  transaction " << lt
+                                      << " for smart contract " << addr.to_hex());
   }
   if (!trs->serialize()) {
-    return reject_query(PSTRING() << "cannot re-create the serialization of  transaction " << lt
-                                  << " for smart contract " << addr.to_hex());
+    return res.reject_query(PSTRING() << "cannot re-create the serialization of  transaction " << lt
+                                      << " for smart contract " << addr.to_hex());
   }
   if (block_limit_status_ && !trs->update_limits(*block_limit_status_)) {
-    return fatal_error(PSTRING() << "cannot update block limit status to include transaction " << lt << " of account "
-                                 << addr.to_hex());
+    return res.fatal_error(PSTRING() << "cannot update block limit status to include transaction " << lt
+                                     << " of account " << addr.to_hex());
   }
   auto trans_root2 = trs->commit(account);
   if (trans_root2.is_null()) {
-    return reject_query(PSTRING() << "the re-created transaction " << lt << " for smart contract " << addr.to_hex()
-                                  << " could not be committed");
+    return res.reject_query(PSTRING() << "the re-created transaction " << lt << " for smart contract " << addr.to_hex()
+                                      << " could not be committed");
   }
   // now compare the re-created transaction with the one we have
   if (trans_root2->get_hash() != trans_root->get_hash()) {
@@ -4390,34 +4406,34 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
       std::cerr << "re-created transaction " << lt << " of " << addr.to_hex() << ": ";
       block::gen::t_Transaction.print_ref(std::cerr, trans_root2);
     }
-    return reject_query(PSTRING() << "the transaction " << lt << " of " << addr.to_hex() << " has hash "
-                                  << trans_root->get_hash().to_hex()
-                                  << " different from that of the recreated transaction "
-                                  << trans_root2->get_hash().to_hex());
+    return res.reject_query(PSTRING() << "the transaction " << lt << " of " << addr.to_hex() << " has hash "
+                                      << trans_root->get_hash().to_hex()
+                                      << " different from that of the recreated transaction "
+                                      << trans_root2->get_hash().to_hex());
   }
   block::gen::Transaction::Record trans2;
   block::gen::HASH_UPDATE::Record hash_upd2;
   if (!(tlb::unpack_cell(trans_root2, trans2) &&
         tlb::type_unpack_cell(std::move(trans2.state_update), block::gen::t_HASH_UPDATE_Account, hash_upd2))) {
-    return fatal_error(PSTRING() << "cannot unpack the re-created transaction " << lt << " of " << addr.to_hex());
+    return res.fatal_error(PSTRING() << "cannot unpack the re-created transaction " << lt << " of " << addr.to_hex());
   }
   if (hash_upd2.old_hash != hash_upd.old_hash) {
-    return fatal_error(PSTRING() << "the re-created transaction " << lt << " of " << addr.to_hex()
-                                 << " is invalid: it starts from account state with different hash");
+    return res.fatal_error(PSTRING() << "the re-created transaction " << lt << " of " << addr.to_hex()
+                                     << " is invalid: it starts from account state with different hash");
   }
   if (hash_upd2.new_hash != account.total_state->get_hash().bits()) {
-    return fatal_error(
+    return res.fatal_error(
         PSTRING() << "the re-created transaction " << lt << " of " << addr.to_hex()
                   << " is invalid: its claimed new account hash differs from the actual new account state");
   }
   if (hash_upd.new_hash != account.total_state->get_hash().bits()) {
-    return reject_query(PSTRING() << "transaction " << lt << " of " << addr.to_hex()
-                                  << " is invalid: it claims that the new account state hash is "
-                                  << hash_upd.new_hash.to_hex() << " but the re-computed value is "
-                                  << hash_upd2.new_hash.to_hex());
+    return res.reject_query(PSTRING() << "transaction " << lt << " of " << addr.to_hex()
+                                      << " is invalid: it claims that the new account state hash is "
+                                      << hash_upd.new_hash.to_hex() << " but the re-computed value is "
+                                      << hash_upd2.new_hash.to_hex());
   }
   if (!trans.r1.out_msgs->contents_equal(*trans2.r1.out_msgs)) {
-    return reject_query(
+    return res.reject_query(
         PSTRING()
         << "transaction " << lt << " of " << addr.to_hex()
         << " is invalid: it has produced a set of outbound messages different from that listed in the transaction");
@@ -4426,26 +4442,43 @@ bool ValidateQuery::check_one_transaction(block::Account& account, ton::LogicalT
   auto new_balance = account.get_balance();
   block::CurrencyCollection total_fees;
   if (!total_fees.validate_unpack(trans.total_fees)) {
-    return reject_query(PSTRING() << "transaction " << lt << " of " << addr.to_hex()
-                                  << " has an invalid total_fees value");
+    return res.reject_query(PSTRING() << "transaction " << lt << " of " << addr.to_hex()
+                                      << " has an invalid total_fees value");
   }
   if (old_balance + money_imported != new_balance + money_exported + total_fees) {
-    return reject_query(PSTRING() << "transaction " << lt << " of " << addr.to_hex()
-                                  << " violates the currency flow condition: old balance=" << old_balance.to_str()
-                                  << " + imported=" << money_imported.to_str() << " does not equal new balance="
-                                  << new_balance.to_str() << " + exported=" << money_exported.to_str()
-                                  << " + total_fees=" << total_fees.to_str());
+    return res.reject_query(PSTRING() << "transaction " << lt << " of " << addr.to_hex()
+                                      << " violates the currency flow condition: old balance=" << old_balance.to_str()
+                                      << " + imported=" << money_imported.to_str() << " does not equal new balance="
+                                      << new_balance.to_str() << " + exported=" << money_exported.to_str()
+                                      << " + total_fees=" << total_fees.to_str());
   }
   return true;
 }
 
+bool ValidateQuery::AccountTransactions::reject_query(std::string err_msg) {
+  if (!failed) {
+    failed = true;
+    error = error_ctx.as_string() + err_msg;
+  }
+  return false;
+}
+
+bool ValidateQuery::AccountTransactions::fatal_error(std::string err_msg) {
+  if (!failed) {
+    failed = fatal = true;
+    error = error_ctx.as_string() + err_msg;
+  }
+  return false;
+}
+
 // NB: may be run in parallel for different accounts
-bool ValidateQuery::check_account_transactions(const StdSmcAddress& acc_addr, Ref<vm::CellSlice> acc_blk_root) {
+bool ValidateQuery::check_account_transactions(AccountTransactions& res) {
+  const StdSmcAddress& acc_addr = res.addr;
   block::gen::AccountBlock::Record acc_blk;
-  CHECK(tlb::csr_unpack(std::move(acc_blk_root), acc_blk) && acc_blk.account_addr == acc_addr);
-  auto account_p = unpack_account(acc_addr.cbits());
+  CHECK(tlb::csr_unpack(res.acc_blk_root, acc_blk) && acc_blk.account_addr == acc_addr);
+  auto account_p = unpack_account(res, acc_addr.cbits());
   if (!account_p) {
-    return reject_query("cannot unpack old state of account "s + acc_addr.to_hex());
+    return res.reject_query("cannot unpack old state of account "s + acc_addr.to_hex());
   }
   auto& account = *account_p;
   CHECK(account.addr == acc_addr);
@@ -4454,48 +4487,100 @@ bool ValidateQuery::check_account_transactions(const StdSmcAddress& acc_addr, Re
   td::BitArray<64> min_trans, max_trans;
   CHECK(trans_dict.get_minmax_key(min_trans).not_null() && trans_dict.get_minmax_key(max_trans, true).not_null());
   ton::LogicalTime min_trans_lt = min_trans.to_ulong(), max_trans_lt = max_trans.to_ulong();
-  if (!trans_dict.check_for_each_extra([this, &account, min_trans_lt, max_trans_lt](Ref<vm::CellSlice> value,
-                                                                                    Ref<vm::CellSlice> extra,
-                                                                                    td::ConstBitPtr key, int key_len) {
+  if (!trans_dict.check_for_each_extra([this, &res, &account, min_trans_lt, max_trans_lt](
+                                           Ref<vm::CellSlice> value, Ref<vm::CellSlice> extra, td::ConstBitPtr key,
+                                           int key_len) {
         CHECK(key_len == 64);
         ton::LogicalTime lt = key.get_uint(64);
         extra.clear();
-        return check_one_transaction(account, lt, value->prefetch_ref(), lt == min_trans_lt, lt == max_trans_lt);
+        return check_one_transaction(res, account, lt, value->prefetch_ref(), lt == min_trans_lt, lt == max_trans_lt);
       })) {
-    return reject_query("at least one Transaction of account "s + acc_addr.to_hex() + " is invalid");
+    return res.reject_query("at least one Transaction of account "s + acc_addr.to_hex() + " is invalid");
   }
   if (is_masterchain() && account.libraries_changed()) {
-    return scan_account_libraries(account.orig_library, account.library, acc_addr);
+    return scan_account_libraries(res, account.orig_library, account.library);
   } else {
     return true;
   }
 }
 
+// runs on a worker thread, so exceptions cannot reach try_validate()
+bool ValidateQuery::run_check_account_transactions(AccountTransactions& res) {
+  try {
+    return check_account_transactions(res);
+  } catch (vm::VmError& err) {
+    return res.fatal_error(err.get_msg());
+  } catch (vm::VmVirtError& err) {
+    return res.fatal_error(err.get_msg());
+  }
+}
+
 bool ValidateQuery::check_transactions() {
   LOG(INFO) << "checking all transactions";
-  return account_blocks_dict_->check_for_each_extra(
-      [this](Ref<vm::CellSlice> value, Ref<vm::CellSlice> extra, td::ConstBitPtr key, int key_len) {
+  std::vector<AccountTransactions> accounts;
+  account_blocks_dict_->check_for_each_extra(
+      [&](Ref<vm::CellSlice> value, Ref<vm::CellSlice> extra, td::ConstBitPtr key, int key_len) {
         CHECK(key_len == 256);
-        return check_account_transactions(key, std::move(value));
+        accounts.emplace_back(key, std::move(value), error_ctx_);
+        return true;
       });
+  // the transactions of different accounts depend only on the previous state and on the block itself,
+  // so they are re-run on several threads (block limits are accumulated across accounts, so not with them)
+  std::size_t threads =
+      validate_query_threads > 0 ? static_cast<unsigned>(validate_query_threads) : WorkerPool::max_threads();
+  if (block_limit_status_ || accounts.size() < 2 * threads) {
+    threads = 1;
+  }
+  // accounts are taken in order, so all accounts before the first failed one are checked whatever the scheduling
+  std::atomic<std::size_t> next_account{0}, first_failed{accounts.size()};
+  auto run = [&] {
+    while (true) {
+      auto i = next_account++;
+      if (i >= first_failed.load()) {
+        break;
+      }
+      if (!run_check_account_transactions(accounts[i])) {
+        auto failed = first_failed.load();
+        while (i < failed && !first_failed.compare_exchange_weak(failed, i)) {
+        }
+      }
+    }
+  };
+  td::Timer timer;
+  WorkerPool::get().run(threads, run);
+  LOG(INFO) << "re-ran transactions of " << accounts.size() << " accounts on up to " << threads << " threads in "
+            << timer.elapsed() << "s";
+  auto failed = first_failed.load();
+  if (failed < accounts.size()) {
+    auto& res = accounts[failed];
+    // the error already carries the error context
+    auto guard = error_ctx_.set_guard(std::vector<std::string>{});
+    return res.fatal ? fatal_error(std::move(res.error)) : reject_query(std::move(res.error));
+  }
+  for (auto& res : accounts) {
+    msg_proc_lt_.insert(msg_proc_lt_.end(), res.msg_proc_lt.begin(), res.msg_proc_lt.end());
+    lib_publishers_.insert(lib_publishers_.end(), res.lib_publishers.begin(), res.lib_publishers.end());
+  }
+  return true;
 }
 
 // similar to Collator::update_account_public_libraries()
-bool ValidateQuery::scan_account_libraries(Ref<vm::Cell> orig_libs, Ref<vm::Cell> final_libs, const td::Bits256& addr) {
+bool ValidateQuery::scan_account_libraries(AccountTransactions& res, Ref<vm::Cell> orig_libs,
+                                           Ref<vm::Cell> final_libs) {
   vm::Dictionary dict1{std::move(orig_libs), 256}, dict2{std::move(final_libs), 256};
   return dict1.scan_diff(
              dict2,
-             [this, &addr](td::ConstBitPtr key, int n, Ref<vm::CellSlice> val1, Ref<vm::CellSlice> val2) -> bool {
+             [&res](td::ConstBitPtr key, int n, Ref<vm::CellSlice> val1, Ref<vm::CellSlice> val2) -> bool {
                CHECK(n == 256);
                bool f = block::is_public_library(key, std::move(val1));
                bool g = block::is_public_library(key, val2);
                if (f != g) {
-                 lib_publishers_.emplace_back(key, addr, g);
+                 res.lib_publishers.emplace_back(key, res.addr, g);
                }
                return true;
              },
              3) ||
-         reject_query("error scanning old and new libraries of account "s + addr.to_hex());
+         res.reject_query("error scanning old and new libraries of account "s + res.addr.to_hex());
 }
 
 bool ValidateQuery::check_all_ticktock_processed() {
@@ -106,6 +106,10 @@ inline ErrorCtxSet ErrorCtx::set_guard(std::vector<std::string> str_list) {
  *
  */
 
+// number of threads re-running the transactions of different accounts in ValidateQuery
+// (0 = all threads of WorkerPool); the threads are taken from WorkerPool, so there are never more than its size
+extern int validate_query_threads;
+
 class ValidateQuery : public td::actor::Actor {
  public:
   ValidateQuery(ShardIdFull shard, UnixTime min_ts, BlockIdExt min_masterchain_block_id, std::vector<BlockIdExt> prev,
@@ -221,6 +225,24 @@ class ValidateQuery : public td::actor::Actor {
 
   td::PerfWarningTimer perf_timer_{"validateblock", 0.1};
 
+  // transactions of one account are re-run on some worker thread; the outcomes are merged in account order
+  struct AccountTransactions {
+    StdSmcAddress addr;
+    Ref<vm::CellSlice> acc_blk_root;
+    std::vector<std::tuple<Bits256, LogicalTime, LogicalTime>> msg_proc_lt;
+    std::vector<std::tuple<Bits256, Bits256, bool>> lib_publishers;
+    bool failed{false};
+    bool fatal{false};
+    // a copy of the error context of the query, as the query's own one must not be used from worker threads
+    ErrorCtx error_ctx;
+    std::string error;
+    AccountTransactions(td::ConstBitPtr addr, Ref<vm::CellSlice> acc_blk_root, ErrorCtx error_ctx)
+        : addr(addr), acc_blk_root(std::move(acc_blk_root)), error_ctx(std::move(error_ctx)) {
+    }
+    bool reject_query(std::string err_msg);
+    bool fatal_error(std::string err_msg);
+  };
+
   static constexpr td::uint32 priority() {
     return 2;
   }
@@ -334,12 +356,13 @@ class ValidateQuery : public td::actor::Actor {
   bool check_delivered_dequeued();
   std::unique_ptr<block::Account> make_account_from(td::ConstBitPtr addr, Ref<vm::CellSlice> account,
                                                     Ref<vm::CellSlice> extra);
-  std::unique_ptr<block::Account> unpack_account(td::ConstBitPtr addr);
-  bool check_one_transaction(block::Account& account, LogicalTime lt, Ref<vm::Cell> trans_root, bool is_first,
-                             bool is_last);
-  bool check_account_transactions(const StdSmcAddress& acc_addr, Ref<vm::CellSlice> acc_tr);
+  std::unique_ptr<block::Account> unpack_account(AccountTransactions& res, td::ConstBitPtr addr);
+  bool check_one_transaction(AccountTransactions& res, block::Account& account, LogicalTime lt,
+                             Ref<vm::Cell> trans_root, bool is_first, bool is_last);
+  bool check_account_transactions(AccountTransactions& res);
+  bool run_check_account_transactions(AccountTransactions& res);
   bool check_transactions();
-  bool scan_account_libraries(Ref<vm::Cell> orig_libs, Ref<vm::Cell> final_libs, const td::Bits256& addr);
+  bool scan_account_libraries(AccountTransactions& res, Ref<vm::Cell> orig_libs, Ref<vm::Cell> final_libs);
   bool check_all_ticktock_processed();
   bool check_message_processing_order();
   bool check_special_message(Ref<vm::Cell> in_msg_root, const block::CurrencyCollection& amount,
@@ -34,19 +34,28 @@ const ValidatorDescr *ValidatorSetQ::find_validator(const NodeIdShort &id) const
   return it < ids_map_.end() && it->first == id ? &ids_[it->second] : nullptr;
 }
 
+Encryptor *ValidatorSetQ::get_encryptor(const ValidatorDescr *vdescr) const {
+  auto &table = *encryptor_table_;
+  std::call_once(table.init_flag, [&] {
+    table.encryptors.reserve(ids_.size());
+    for (auto &descr : ids_) {
+      table.encryptors.push_back(ValidatorFullId{descr.key}.create_encryptor().move_as_ok());
+    }
+  });
+  return table.encryptors[vdescr - ids_.data()].get();
+}
+
 bool ValidatorSetQ::is_validator(NodeIdShort id) const {
   return find_validator(id);
 }
 
-td::Result<ValidatorWeight> ValidatorSetQ::check_signatures(RootHash root_hash, FileHash file_hash,
-                                                            td::Ref<BlockSignatureSet> signatures) const {
-  auto &sigs = signatures->signatures();
-
-  auto block = create_serialize_tl_object<ton_api::ton_blockId>(root_hash, file_hash);
-
+td::Result<ValidatorWeight> ValidatorSetQ::check_signatures_common(td::Slice block,
+                                                                   const std::vector<BlockSignature> &sigs) const {
   ValidatorWeight weight = 0;
 
   std::set<NodeIdShort> nodes;
+  std::vector<Encryptor::SignatureCheck> checks;
+  checks.reserve(sigs.size());
   for (auto &sig : sigs) {
     if (nodes.count(sig.node) == 1) {
       return td::Status::Error(ErrorCode::protoviolation, "duplicate node to sign");
@@ -58,46 +67,27 @@ td::Result<ValidatorWeight> ValidatorSetQ::check_signatures(RootHash root_hash,
       return td::Status::Error(ErrorCode::protoviolation, "unknown node to sign");
     }
 
-    auto E = ValidatorFullId{vdescr->key}.create_encryptor().move_as_ok();
-    TRY_STATUS(E->check_signature(block.as_slice(), sig.signature.as_slice()));
+    checks.push_back(Encryptor::SignatureCheck{get_encryptor(vdescr), block, sig.signature.as_slice()});
     weight += vdescr->weight;
   }
 
   if (weight * 3 <= total_weight_ * 2) {
     return td::Status::Error(ErrorCode::protoviolation, "too small sig weight");
   }
+  TRY_STATUS(Encryptor::check_signatures_batch(checks));
   return weight;
 }
 
+td::Result<ValidatorWeight> ValidatorSetQ::check_signatures(RootHash root_hash, FileHash file_hash,
+                                                            td::Ref<BlockSignatureSet> signatures) const {
+  auto block = create_serialize_tl_object<ton_api::ton_blockId>(root_hash, file_hash);
+  return check_signatures_common(block.as_slice(), signatures->signatures());
+}
+
 td::Result<ValidatorWeight> ValidatorSetQ::check_approve_signatures(RootHash root_hash, FileHash file_hash,
                                                                     td::Ref<BlockSignatureSet> signatures) const {
-  auto &sigs = signatures->signatures();
-
   auto block = create_serialize_tl_object<ton_api::ton_blockIdApprove>(root_hash, file_hash);
-
-  ValidatorWeight weight = 0;
-
-  std::set<NodeIdShort> nodes;
-  for (auto &sig : sigs) {
-    if (nodes.count(sig.node) == 1) {
-      return td::Status::Error(ErrorCode::protoviolation, "duplicate node to sign");
-    }
-    nodes.insert(sig.node);
-
-    auto vdescr = find_validator(sig.node);
-    if (!vdescr) {
-      return td::Status::Error(ErrorCode::protoviolation, "unknown node to sign");
-    }
-
-    auto E = ValidatorFullId{vdescr->key}.create_encryptor().move_as_ok();
-    TRY_STATUS(E->check_signature(block.as_slice(), sig.signature.as_slice()));
-    weight += vdescr->weight;
-  }
-
-  if (weight * 3 <= total_weight_ * 2) {
-    return td::Status::Error(ErrorCode::protoviolation, "too small sig weight");
-  }
-  return weight;
+  return check_signatures_common(block.as_slice(), signatures->signatures());
 }
 
 ValidatorSetQ::ValidatorSetQ(CatchainSeqno cc_seqno, ShardIdFull from, std::vector<ValidatorDescr> nodes)
@@ -25,6 +25,7 @@
 #include "block/mc-config.h"
 
 #include <map>
+#include <mutex>
 
 namespace ton {
 
@@ -63,7 +64,16 @@ class ValidatorSetQ : public ValidatorSet {
   std::vector<ValidatorDescr> ids_;
   std::vector<std::pair<NodeIdShort, size_t>> ids_map_;
 
+  // encryptors of all validators, created on the first signature check and shared by copies of the set
+  struct EncryptorTable {
+    std::once_flag init_flag;
+    std::vector<std::unique_ptr<Encryptor>> encryptors;
+  };
+  std::shared_ptr<EncryptorTable> encryptor_table_ = std::make_shared<EncryptorTable>();
+
   const ValidatorDescr* find_validator(const NodeIdShort& id) const;
+  Encryptor* get_encryptor(const ValidatorDescr* vdescr) const;
+  td::Result<ValidatorWeight> check_signatures_common(td::Slice block, const std::vector<BlockSignature>& sigs) const;
 };
 
 class ValidatorSetCompute {
@@ -0,0 +1,118 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#include "worker-pool.hpp"
+
+#include <memory>
+
+namespace ton {
+
+namespace validator {
+
+WorkerPool &WorkerPool::get() {
+#if TD_THREAD_UNSUPPORTED
+  static WorkerPool pool(0);
+#else
+  static WorkerPool pool(td::max(td::min(td::thread::hardware_concurrency(), max_threads()), 1u) - 1);
+#endif
+  return pool;
+}
+
+WorkerPool::WorkerPool(size_t threads) {
+#if !TD_THREAD_UNSUPPORTED
+  for (size_t i = 0; i < threads; i++) {
+    threads_.emplace_back([this] { loop(); });
+  }
+#endif
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    close_ = true;
+  }
+  cond_.notify_all();
+#if !TD_THREAD_UNSUPPORTED
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+#endif
+}
+
+void WorkerPool::loop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [&] { return close_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+void WorkerPool::run(size_t threads, const std::function<void()> &f) {
+  struct Run {
+    std::mutex mutex;
+    std::condition_variable cond;
+    size_t started{0};
+    size_t finished{0};
+    bool done{false};
+  };
+  auto state = std::make_shared<Run>();
+  size_t helpers = 0;
+#if !TD_THREAD_UNSUPPORTED
+  helpers = td::min(threads, threads_.size() + 1);
+  helpers = helpers > 0 ? helpers - 1 : 0;
+#endif
+  if (helpers > 0) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < helpers; i++) {
+      // a task taken after the calling thread has finished does nothing, as the work is already done
+      tasks_.push_back([state, &f] {
+        {
+          std::lock_guard<std::mutex> guard(state->mutex);
+          if (state->done) {
+            return;
+          }
+          state->started++;
+        }
+        f();
+        {
+          std::lock_guard<std::mutex> guard(state->mutex);
+          state->finished++;
+        }
+        state->cond.notify_all();
+      });
+    }
+    lock.unlock();
+    cond_.notify_all();
+  }
+  f();
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->done = true;
+  state->cond.wait(lock, [&] { return state->started == state->finished; });
+}
+
+}  // namespace validator
+
+}  // namespace ton
@@ -0,0 +1,65 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#pragma once
+
+#include "td/utils/common.h"
+#include "td/utils/port/thread.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace ton {
+
+namespace validator {
+
+// Fixed set of threads shared by all collator and validator queries for running the parts of one query in
+// parallel, so that concurrent queries do not multiply the number of threads.
+class WorkerPool {
+ public:
+  static constexpr unsigned max_threads() {
+    return 8;
+  }
+  // the pool of the process, with min(hardware concurrency, max_threads()) - 1 threads
+  static WorkerPool &get();
+
+  explicit WorkerPool(size_t threads);
+  ~WorkerPool();
+
+  // runs f on the calling thread and on up to threads - 1 free threads of the pool, and returns when all the calls
+  // have finished; f must distribute the work between its calls by itself. The calling thread never waits for
+  // a busy pool, so the work is done even if all threads of the pool are taken by other queries.
+  void run(size_t threads, const std::function<void()> &f);
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<std::function<void()>> tasks_;
+  bool close_{false};
+#if !TD_THREAD_UNSUPPORTED
+  std::vector<td::thread> threads_;
+#endif
+
+  void loop();
+};
+
+}  // namespace validator
+
+}  // namespace ton
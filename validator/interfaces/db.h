@@ -50,9 +50,17 @@ class Db : public td::actor::Actor {
   virtual void store_block_state(BlockHandle handle, td::Ref<ShardState> state,
                                  td::Promise<td::Ref<ShardState>> promise) = 0;
   virtual void get_block_state(ConstBlockHandle handle, td::Promise<td::Ref<ShardState>> promise) = 0;
+  virtual void get_cell_db_reader(td::Promise<std::shared_ptr<vm::CellDbReader>> promise) = 0;
 
   virtual void store_persistent_state_file(BlockIdExt block_id, BlockIdExt masterchain_block_id, td::BufferSlice state,
                                            td::Promise<td::Unit> promise) = 0;
+  virtual void store_persistent_state_file_gen(BlockIdExt block_id, BlockIdExt masterchain_block_id,
+                                               std::function<td::Status(td::FileFd&)> write_state,
+                                               td::Promise<td::Unit> promise) = 0;
+  virtual void store_persistent_state_file_delta(BlockIdExt block_id, BlockIdExt masterchain_block_id,
+                                                 td::Ref<vm::Cell> root,
+                                                 std::function<td::Status(td::FileFd&)> write_state,
+                                                 td::Promise<td::Unit> promise) = 0;
   virtual void get_persistent_state_file(BlockIdExt block_id, BlockIdExt masterchain_block_id,
                                          td::Promise<td::BufferSlice> promise) = 0;
   virtual void get_persistent_state_file_slice(BlockIdExt block_id, BlockIdExt masterchain_block_id, td::int64 offset,
@@ -77,6 +85,8 @@ class Db : public td::actor::Actor {
                                       td::Promise<ConstBlockHandle> promise) = 0;
   virtual void get_block_by_seqno(AccountIdPrefixFull account, BlockSeqno seqno,
                                   td::Promise<ConstBlockHandle> promise) = 0;
+  virtual void get_account_transactions(WorkchainId workchain, StdSmcAddress addr, LogicalTime lt, td::uint32 count,
+                                        td::Promise<std::vector<AccountTransactionId>> promise) = 0;
 
   virtual void update_init_masterchain_block(BlockIdExt block, td::Promise<td::Unit> promise) = 0;
   virtual void get_init_masterchain_block(td::Promise<BlockIdExt> promise) = 0;
@@ -19,6 +19,11 @@
 #pragma once
 
 #include "td/actor/actor.h"
+#include "td/utils/buffer.h"
+
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace ton {
 
@@ -27,6 +32,12 @@ namespace validator {
 class LiteServerCache : public td::actor::Actor {
  public:
   virtual ~LiteServerCache() = default;
+
+  // answers the query with a cached response if there is one, otherwise runs it and caches the response
+  virtual void run_query(td::BufferSlice data, td::Promise<td::BufferSlice> promise) = 0;
+  // drops responses which depend on the last masterchain block
+  virtual void new_masterchain_block() = 0;
+  virtual void prepare_stats(td::Promise<std::vector<std::pair<std::string, std::string>>> promise) = 0;
 };
 
 }  // namespace validator
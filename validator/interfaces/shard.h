@@ -25,6 +25,7 @@
 #include "block.h"
 #include "message-queue.h"
 #include "vm/cells.h"
+#include "td/utils/port/FileFd.h"
 #include "proof.h"
 
 namespace ton {
@@ -55,6 +56,8 @@ class ShardState : public td::CntObject {
   virtual td::Result<std::pair<td::Ref<ShardState>, td::Ref<ShardState>>> split() const = 0;
 
   virtual td::Result<td::BufferSlice> serialize() const = 0;
+  // same as serialize(), but writes to fd without building the whole serialization in memory
+  virtual td::Status serialize_to_file(td::FileFd& fd) const = 0;
 };
 
 class MasterchainState : virtual public ShardState {
@@ -27,6 +27,7 @@
 #include "message-queue.h"
 #include "validator/validator.h"
 #include "liteserver.h"
+#include "vm/db/DynamicBagOfCellsDb.h"
 
 namespace ton {
 
@@ -57,6 +58,16 @@ class ValidatorManager : public ValidatorManagerInterface {
                                td::Promise<td::Ref<ShardState>> promise) = 0;
   virtual void store_persistent_state_file(BlockIdExt block_id, BlockIdExt masterchain_block_id, td::BufferSlice state,
                                            td::Promise<td::Unit> promise) = 0;
+  // thread-safe read-only view of the latest committed cell db snapshot
+  virtual void get_cell_db_reader(td::Promise<std::shared_ptr<vm::CellDbReader>> promise) = 0;
+  virtual void store_persistent_state_file_gen(BlockIdExt block_id, BlockIdExt masterchain_block_id,
+                                               std::function<td::Status(td::FileFd&)> write_state,
+                                               td::Promise<td::Unit> promise) = 0;
+  // stores a delta against an older persistent state of the shard, or calls write_state if there is no such state
+  virtual void store_persistent_state_file_delta(BlockIdExt block_id, BlockIdExt masterchain_block_id,
+                                                 td::Ref<vm::Cell> root,
+                                                 std::function<td::Status(td::FileFd&)> write_state,
+                                                 td::Promise<td::Unit> promise) = 0;
   virtual void store_zero_state_file(BlockIdExt block_id, td::BufferSlice state, td::Promise<td::Unit> promise) = 0;
   virtual void wait_block_state(BlockHandle handle, td::uint32 priority, td::Timestamp timeout,
                                 td::Promise<td::Ref<ShardState>> promise) = 0;
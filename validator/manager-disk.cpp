@@ -27,6 +27,7 @@
 #include "manager.h"
 #include "ton/ton-io.hpp"
 #include "td/utils/overloaded.h"
+#include "td/utils/Timer.h"
 
 namespace ton {
 
@@ -134,8 +135,9 @@ void ValidatorManagerImpl::sync_complete(td::Promise<td::Unit> promise) {
 
 void ValidatorManagerImpl::validate_fake(BlockCandidate candidate, std::vector<BlockIdExt> prev, BlockIdExt last,
                                          td::Ref<ValidatorSet> val_set) {
-  auto P = td::PromiseCreator::lambda([SelfId = actor_id(this), c = candidate.clone(), prev, last,
-                                       val_set](td::Result<ValidateCandidateResult> R) mutable {
+  auto P = td::PromiseCreator::lambda([SelfId = actor_id(this), c = candidate.clone(), prev, last, val_set,
+                                       timer = td::Timer()](td::Result<ValidateCandidateResult> R) mutable {
+    LOG(INFO) << "validation of block " << c.id.to_str() << " took " << timer.elapsed() << "s";
     if (R.is_ok()) {
       auto v = R.move_as_ok();
       v.visit(td::overloaded(
@@ -576,6 +578,10 @@ void ValidatorManagerImpl::get_shard_state_from_db_short(BlockIdExt block_id,
   get_block_handle(block_id, false, std::move(P));
 }
 
+void ValidatorManagerImpl::get_cell_db_reader(td::Promise<std::shared_ptr<vm::CellDbReader>> promise) {
+  td::actor::send_closure(db_, &Db::get_cell_db_reader, std::move(promise));
+}
+
 void ValidatorManagerImpl::get_block_candidate_from_db(PublicKey source, BlockIdExt id,
                                                        FileHash collated_data_file_hash,
                                                        td::Promise<BlockCandidate> promise) {
@@ -633,6 +639,12 @@ void ValidatorManagerImpl::get_block_by_seqno_from_db(AccountIdPrefixFull accoun
   td::actor::send_closure(db_, &Db::get_block_by_seqno, account, seqno, std::move(promise));
 }
 
+void ValidatorManagerImpl::get_account_transactions_from_db(WorkchainId workchain, StdSmcAddress addr, LogicalTime lt,
+                                                            td::uint32 count,
+                                                            td::Promise<std::vector<AccountTransactionId>> promise) {
+  td::actor::send_closure(db_, &Db::get_account_transactions, workchain, addr, lt, count, std::move(promise));
+}
+
 void ValidatorManagerImpl::finished_wait_state(BlockIdExt block_id, td::Result<td::Ref<ShardState>> R) {
   auto it = wait_state_.find(block_id);
   if (it != wait_state_.end()) {
@@ -680,6 +692,21 @@ void ValidatorManagerImpl::store_persistent_state_file(BlockIdExt block_id, Bloc
                           std::move(promise));
 }
 
+void ValidatorManagerImpl::store_persistent_state_file_gen(BlockIdExt block_id, BlockIdExt masterchain_block_id,
+                                                           std::function<td::Status(td::FileFd&)> write_state,
+                                                           td::Promise<td::Unit> promise) {
+  td::actor::send_closure(db_, &Db::store_persistent_state_file_gen, block_id, masterchain_block_id,
+                          std::move(write_state), std::move(promise));
+}
+
+void ValidatorManagerImpl::store_persistent_state_file_delta(BlockIdExt block_id, BlockIdExt masterchain_block_id,
+                                                             td::Ref<vm::Cell> root,
+                                                             std::function<td::Status(td::FileFd&)> write_state,
+                                                             td::Promise<td::Unit> promise) {
+  td::actor::send_closure(db_, &Db::store_persistent_state_file_delta, block_id, masterchain_block_id, std::move(root),
+                          std::move(write_state), std::move(promise));
+}
+
 void ValidatorManagerImpl::store_zero_state_file(BlockIdExt block_id, td::BufferSlice state,
                                                  td::Promise<td::Unit> promise) {
   td::actor::send_closure(db_, &Db::store_zero_state_file, block_id, std::move(state), std::move(promise));
@@ -882,7 +909,7 @@ void ValidatorManagerImpl::send_top_shard_block_description(td::Ref<ShardTopBloc
 }
 
 void ValidatorManagerImpl::start_up() {
-  db_ = create_db_actor(actor_id(this), db_root_, opts_->get_filedb_depth());
+  db_ = create_db_actor(actor_id(this), db_root_, opts_->get_filedb_depth(), opts_->tx_index_enabled());
 
   auto P = td::PromiseCreator::lambda([SelfId = actor_id(this)](td::Result<ValidatorManagerInitResult> R) {
     R.ensure();
@@ -881,6 +881,10 @@ void ValidatorManagerImpl::get_shard_state_from_db_short(BlockIdExt block_id,
   get_block_handle(block_id, false, std::move(P));
 }
 
+void ValidatorManagerImpl::get_cell_db_reader(td::Promise<std::shared_ptr<vm::CellDbReader>> promise) {
+  td::actor::send_closure(db_, &Db::get_cell_db_reader, std::move(promise));
+}
+
 void ValidatorManagerImpl::get_block_candidate_from_db(PublicKey source, BlockIdExt id,
                                                        FileHash collated_data_file_hash,
                                                        td::Promise<BlockCandidate> promise) {
@@ -952,6 +956,12 @@ void ValidatorManagerImpl::get_block_by_seqno_from_db(AccountIdPrefixFull accoun
   td::actor::send_closure(db_, &Db::get_block_by_seqno, account, seqno, std::move(promise));
 }
 
+void ValidatorManagerImpl::get_account_transactions_from_db(WorkchainId workchain, StdSmcAddress addr, LogicalTime lt,
+                                                            td::uint32 count,
+                                                            td::Promise<std::vector<AccountTransactionId>> promise) {
+  td::actor::send_closure(db_, &Db::get_account_transactions, workchain, addr, lt, count, std::move(promise));
+}
+
 void ValidatorManagerImpl::finished_wait_state(BlockHandle handle, td::Result<td::Ref<ShardState>> R) {
   auto it = wait_state_.find(handle->id());
   if (it != wait_state_.end()) {
@@ -1032,6 +1042,21 @@ void ValidatorManagerImpl::store_persistent_state_file(BlockIdExt block_id, Bloc
                           std::move(promise));
 }
 
+void ValidatorManagerImpl::store_persistent_state_file_gen(BlockIdExt block_id, BlockIdExt masterchain_block_id,
+                                                           std::function<td::Status(td::FileFd&)> write_state,
+                                                           td::Promise<td::Unit> promise) {
+  td::actor::send_closure(db_, &Db::store_persistent_state_file_gen, block_id, masterchain_block_id,
+                          std::move(write_state), std::move(promise));
+}
+
+void ValidatorManagerImpl::store_persistent_state_file_delta(BlockIdExt block_id, BlockIdExt masterchain_block_id,
+                                                             td::Ref<vm::Cell> root,
+                                                             std::function<td::Status(td::FileFd&)> write_state,
+                                                             td::Promise<td::Unit> promise) {
+  td::actor::send_closure(db_, &Db::store_persistent_state_file_delta, block_id, masterchain_block_id, std::move(root),
+                          std::move(write_state), std::move(promise));
+}
+
 void ValidatorManagerImpl::store_zero_state_file(BlockIdExt block_id, td::BufferSlice state,
                                                  td::Promise<td::Unit> promise) {
   td::actor::send_closure(db_, &Db::store_zero_state_file, block_id, std::move(state), std::move(promise));
@@ -1375,7 +1400,7 @@ void ValidatorManagerImpl::send_block_broadcast(BlockBroadcast broadcast) {
 }
 
 void ValidatorManagerImpl::start_up() {
-  db_ = create_db_actor(actor_id(this), db_root_, opts_->get_filedb_depth());
+  db_ = create_db_actor(actor_id(this), db_root_, opts_->get_filedb_depth(), opts_->tx_index_enabled());
   lite_server_cache_ = create_liteserver_cache_actor(actor_id(this), db_root_);
   token_manager_ = td::actor::create_actor<TokenManager>("tokenmanager");
   td::mkdir(db_root_ + "/tmp/").ensure();
@@ -1573,6 +1598,10 @@ void ValidatorManagerImpl::new_masterchain_block() {
     }
   }
 
+  if (!lite_server_cache_.empty()) {
+    td::actor::send_closure(lite_server_cache_, &LiteServerCache::new_masterchain_block);
+  }
+
   if (last_masterchain_seqno_ % 1024 == 0) {
     LOG(WARNING) << "applied masterchain block " << last_masterchain_block_id_;
   }
@@ -2259,6 +2288,9 @@ void ValidatorManagerImpl::prepare_stats(td::Promise<std::vector<std::pair<std::
   merger.make_promise("").set_value(std::move(vec));
 
   td::actor::send_closure(db_, &Db::prepare_stats, merger.make_promise("db."));
+  if (!lite_server_cache_.empty()) {
+    td::actor::send_closure(lite_server_cache_, &LiteServerCache::prepare_stats, merger.make_promise("litecache."));
+  }
 }
 
 void ValidatorManagerImpl::truncate(td::Ref<MasterchainState> state, td::Promise<td::Unit> promise) {
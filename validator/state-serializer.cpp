@@ -178,15 +178,11 @@ void AsyncStateSerializer::got_masterchain_state(td::Ref<MasterchainState> state
     shards_.push_back(v->top_block_id());
   }
 
-  auto B = masterchain_state_->serialize();
-  B.ensure();
   auto P = td::PromiseCreator::lambda([SelfId = actor_id(this)](td::Result<td::Unit> R) {
     R.ensure();
     td::actor::send_closure(SelfId, &AsyncStateSerializer::stored_masterchain_state);
   });
-
-  td::actor::send_closure(manager_, &ValidatorManager::store_persistent_state_file, masterchain_handle_->id(),
-                          masterchain_handle_->id(), B.move_as_ok(), std::move(P));
+  store_state(masterchain_handle_->id(), std::move(state), std::move(P));
 }
 
 void AsyncStateSerializer::stored_masterchain_state() {
@@ -207,17 +203,42 @@ void AsyncStateSerializer::got_shard_handle(BlockHandle handle) {
 }
 
 void AsyncStateSerializer::got_shard_state(BlockHandle handle, td::Ref<ShardState> state) {
-  auto B = state->serialize().move_as_ok();
   auto P = td::PromiseCreator::lambda([SelfId = actor_id(this)](td::Result<td::Unit> R) {
     R.ensure();
     td::actor::send_closure(SelfId, &AsyncStateSerializer::success_handler);
   });
-  td::actor::send_closure(manager_, &ValidatorManager::store_persistent_state_file, handle->id(),
-                          masterchain_handle_->id(), std::move(B), std::move(P));
+  store_state(handle->id(), std::move(state), std::move(P));
   LOG(INFO) << "storing persistent state for " << masterchain_handle_->id().seqno() << ":" << handle->id().id.shard;
   next_idx_++;
 }
 
+void AsyncStateSerializer::store_state(BlockIdExt block_id, td::Ref<ShardState> state, td::Promise<td::Unit> promise) {
+  auto P = td::PromiseCreator::lambda([manager = manager_, opts = opts_, block_id,
+                                       masterchain_block_id = masterchain_handle_->id(),
+                                       state = std::move(state), promise = std::move(promise)](
+                                          td::Result<std::shared_ptr<vm::CellDbReader>> R) mutable {
+    std::shared_ptr<vm::CellDbReader> reader;
+    if (R.is_ok()) {
+      reader = R.move_as_ok();
+    }
+    auto write_data = [state, reader](td::FileFd& fd) {
+      // the whole state is walked, so its cells are loaded into the cell cache in batches beforehand
+      if (reader) {
+        reader->prefetch(state->root_hash().as_slice(), prefetch_cells()).ignore();
+      }
+      return state->serialize_to_file(fd);
+    };
+    if (opts->persistent_state_deltas_enabled()) {
+      td::actor::send_closure(manager, &ValidatorManager::store_persistent_state_file_delta, block_id,
+                              masterchain_block_id, state->root_cell(), std::move(write_data), std::move(promise));
+      return;
+    }
+    td::actor::send_closure(manager, &ValidatorManager::store_persistent_state_file_gen, block_id,
+                            masterchain_block_id, std::move(write_data), std::move(promise));
+  });
+  td::actor::send_closure(manager_, &ValidatorManager::get_cell_db_reader, std::move(P));
+}
+
 void AsyncStateSerializer::fail_handler(td::Status reason) {
   VLOG(VALIDATOR_NOTICE) << "failure: " << reason;
   attempt_++;
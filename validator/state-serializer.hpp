@@ -56,6 +56,10 @@ class AsyncStateSerializer : public td::actor::Actor {
   static constexpr td::uint32 max_attempt() {
     return 128;
   }
+  // cells of a state prefetched before it is serialized; a part of the shared cell cache
+  static constexpr size_t prefetch_cells() {
+    return 1 << 18;
+  }
 
   bool need_serialize(BlockHandle handle);
   bool need_monitor(ShardIdFull shard);
@@ -72,6 +76,7 @@ class AsyncStateSerializer : public td::actor::Actor {
   void stored_masterchain_state();
   void got_shard_handle(BlockHandle handle);
   void got_shard_state(BlockHandle handle, td::Ref<ShardState> state);
+  void store_state(BlockIdExt block_id, td::Ref<ShardState> state, td::Promise<td::Unit> promise);
 
   void get_masterchain_seqno(td::Promise<BlockSeqno> promise) {
     promise.set_result(last_block_id_.id.seqno);
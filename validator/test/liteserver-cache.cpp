@@ -0,0 +1,231 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#include "td/utils/tests.h"
+
+#include "validator/impl/liteserver-cache.hpp"
+
+#include "auto/tl/lite_api.h"
+#include "td/actor/actor.h"
+#include "tl-utils/lite-utils.hpp"
+#include "ton/lite-tl.hpp"
+#include "td/utils/as.h"
+
+namespace {
+
+using ton::validator::LiteServerCache;
+using ton::validator::LiteServerCacheImpl;
+
+// the queries are answered by the test instead of a liteserver
+class TestLiteServerCache : public LiteServerCacheImpl {
+ public:
+  struct Query {
+    std::string data;
+    td::Promise<td::BufferSlice> promise;
+  };
+
+  TestLiteServerCache(size_t max_size, std::shared_ptr<std::vector<Query>> queries)
+      : LiteServerCacheImpl({}, max_size), queries_(std::move(queries)) {
+  }
+
+ protected:
+  void run_uncached_query(td::BufferSlice data, td::Promise<td::BufferSlice> promise) override {
+    queries_->push_back(Query{data.as_slice().str(), std::move(promise)});
+  }
+
+ private:
+  std::shared_ptr<std::vector<Query>> queries_;
+};
+
+class CacheTester {
+ public:
+  using Answer = std::shared_ptr<td::Result<td::BufferSlice>>;
+
+  explicit CacheTester(size_t max_size) {
+    scheduler_.run_in_context(
+        [&] { cache_ = td::actor::create_actor<TestLiteServerCache>("cache", max_size, queries_); });
+    run();
+  }
+  ~CacheTester() {
+    scheduler_.run_in_context([&] {
+      cache_.reset();
+      td::actor::SchedulerContext::get()->stop();
+    });
+    while (scheduler_.run(1)) {
+    }
+  }
+
+  Answer query(td::int32 id, td::Slice params) {
+    td::BufferSlice data(4 + params.size());
+    td::as<td::int32>(data.data()) = id;
+    data.as_slice().substr(4).copy_from(params);
+    return query(std::move(data));
+  }
+  Answer query(td::BufferSlice data) {
+    auto answer = std::make_shared<td::Result<td::BufferSlice>>(td::Status::Error("no answer"));
+    scheduler_.run_in_context([&] {
+      td::actor::send_closure(
+          cache_, &LiteServerCache::run_query, std::move(data),
+          td::PromiseCreator::lambda([answer](td::Result<td::BufferSlice> R) { *answer = std::move(R); }));
+    });
+    run();
+    return answer;
+  }
+  // queries run by the liteserver so far
+  size_t queries_count() const {
+    return queries_->size();
+  }
+  void answer(size_t i, td::Result<td::BufferSlice> R) {
+    scheduler_.run_in_context([&] { queries_->at(i).promise.set_result(std::move(R)); });
+    run();
+  }
+  void new_masterchain_block() {
+    scheduler_.run_in_context([&] { td::actor::send_closure(cache_, &LiteServerCache::new_masterchain_block); });
+    run();
+  }
+
+ private:
+  td::actor::Scheduler scheduler_{{0}};
+  std::shared_ptr<std::vector<TestLiteServerCache::Query>> queries_ =
+      std::make_shared<std::vector<TestLiteServerCache::Query>>();
+  td::actor::ActorOwn<TestLiteServerCache> cache_;
+
+  void run() {
+    for (int i = 0; i < 10; i++) {
+      scheduler_.run(0);
+    }
+  }
+};
+
+constexpr td::int32 get_block_id = ton::lite_api::liteServer_getBlock::ID;
+
+}  // namespace
+
+TEST(LiteServerCache, lru) {
+  // entries are 10 bytes long: 4 bytes of query id, 1 byte of parameters and 5 bytes of response
+  CacheTester tester(160);
+  auto get_block = [&](char c) {
+    auto count = tester.queries_count();
+    auto answer = tester.query(get_block_id, td::Slice(&c, 1));
+    if (tester.queries_count() != count) {
+      tester.answer(count, td::BufferSlice(PSLICE() << "resp" << c));
+    }
+    CHECK(answer->is_ok());
+    ASSERT_EQ(PSTRING() << "resp" << c, answer->ok().as_slice());
+    return tester.queries_count() != count;
+  };
+
+  // 16 entries fill the cache exactly
+  for (char c = 'a'; c < 'a' + 16; c++) {
+    ASSERT_TRUE(get_block(c));
+  }
+  ASSERT_TRUE(!get_block('a'));
+  // 'b' is the least recently used entry now
+  ASSERT_TRUE(get_block('z'));
+  ASSERT_TRUE(!get_block('a'));
+  ASSERT_TRUE(!get_block('c'));
+  ASSERT_TRUE(get_block('b'));
+
+  // responses bigger than max_size / 16 are not cached
+  auto count = tester.queries_count();
+  for (int i = 0; i < 2; i++) {
+    auto answer = tester.query(get_block_id, "x");
+    ASSERT_EQ(count + i + 1, tester.queries_count());
+    tester.answer(count + i, td::BufferSlice("big response"));
+    ASSERT_EQ("big response", answer->ok().as_slice());
+  }
+}
+
+TEST(LiteServerCache, coalescing) {
+  CacheTester tester(1 << 20);
+  auto first = tester.query(get_block_id, "a");
+  auto second = tester.query(get_block_id, "a");
+  ASSERT_EQ(1u, tester.queries_count());
+  tester.answer(0, td::BufferSlice("block"));
+  ASSERT_EQ("block", first->ok().as_slice());
+  ASSERT_EQ("block", second->ok().as_slice());
+
+  // errors are passed to all waiting queries and are not cached
+  first = tester.query(get_block_id, "b");
+  second = tester.query(get_block_id, "b");
+  ASSERT_EQ(2u, tester.queries_count());
+  tester.answer(1, td::Status::Error(651, "block not found"));
+  ASSERT_EQ(651, first->error().code());
+  ASSERT_EQ(651, second->error().code());
+  first = tester.query(get_block_id, "b");
+  ASSERT_EQ(3u, tester.queries_count());
+  tester.answer(2, td::BufferSlice("block"));
+  ASSERT_EQ("block", first->ok().as_slice());
+}
+
+TEST(LiteServerCache, masterchain_info) {
+  constexpr td::int32 get_masterchain_info_id = ton::lite_api::liteServer_getMasterchainInfo::ID;
+  CacheTester tester(1 << 20);
+  tester.query(get_masterchain_info_id, "");
+  tester.answer(0, td::BufferSlice("info 1"));
+  ASSERT_EQ("info 1", tester.query(get_masterchain_info_id, "")->ok().as_slice());
+  ASSERT_EQ(1u, tester.queries_count());
+
+  // a new masterchain block drops the cached response
+  tester.new_masterchain_block();
+  auto answer = tester.query(get_masterchain_info_id, "");
+  ASSERT_EQ(2u, tester.queries_count());
+
+  // and a response to a query started before a new block is not cached
+  tester.new_masterchain_block();
+  tester.answer(1, td::BufferSlice("info 2"));
+  ASSERT_EQ("info 2", answer->ok().as_slice());
+  answer = tester.query(get_masterchain_info_id, "");
+  ASSERT_EQ(3u, tester.queries_count());
+  tester.answer(2, td::BufferSlice("info 3"));
+  ASSERT_EQ("info 3", answer->ok().as_slice());
+  ASSERT_EQ("info 3", tester.query(get_masterchain_info_id, "")->ok().as_slice());
+  ASSERT_EQ(3u, tester.queries_count());
+}
+
+TEST(LiteServerCache, account_state) {
+  auto get_account_state = [](ton::BlockSeqno seqno) {
+    ton::BlockIdExt block_id{ton::masterchainId, ton::shardIdAll, seqno, ton::RootHash::zero(), ton::FileHash::zero()};
+    return ton::serialize_tl_object(
+        ton::create_tl_object<ton::lite_api::liteServer_getAccountState>(
+            ton::create_tl_lite_block_id(block_id),
+            ton::create_tl_object<ton::lite_api::liteServer_accountId>(ton::masterchainId, td::Bits256::zero())),
+        true);
+  };
+  CacheTester tester(1 << 20);
+
+  // the state in a given block is cached for good
+  auto answer = tester.query(get_account_state(10));
+  tester.answer(0, td::BufferSlice("state 10"));
+  ASSERT_EQ("state 10", answer->ok().as_slice());
+  tester.new_masterchain_block();
+  ASSERT_EQ("state 10", tester.query(get_account_state(10))->ok().as_slice());
+  ASSERT_EQ(1u, tester.queries_count());
+
+  // seqno ~0U stands for the last masterchain block, so the response is dropped with a new masterchain block
+  answer = tester.query(get_account_state(~0U));
+  tester.answer(1, td::BufferSlice("state 11"));
+  ASSERT_EQ("state 11", answer->ok().as_slice());
+  ASSERT_EQ("state 11", tester.query(get_account_state(~0U))->ok().as_slice());
+  ASSERT_EQ(2u, tester.queries_count());
+  tester.new_masterchain_block();
+  answer = tester.query(get_account_state(~0U));
+  ASSERT_EQ(3u, tester.queries_count());
+  tester.answer(2, td::BufferSlice("state 12"));
+  ASSERT_EQ("state 12", answer->ok().as_slice());
+}
@@ -0,0 +1,118 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#include "td/utils/tests.h"
+
+#include "validator/db/archive-slice.hpp"
+#include "validator/db/package.hpp"
+
+#include "td/actor/actor.h"
+#include "td/utils/port/path.h"
+
+TEST(Package, group_commit) {
+  td::CSlice path = "test-package.pack";
+  td::unlink(path).ignore();
+  auto package = std::make_shared<ton::Package>(ton::Package::open(path.str(), false, true).move_as_ok());
+
+  const size_t entries = 5;
+  std::vector<std::pair<td::uint64, td::uint64>> results;
+
+  td::actor::Scheduler scheduler({1});
+  auto watcher = td::create_shared_destructor([] { td::actor::SchedulerContext::get()->stop(); });
+  scheduler.run_in_context([&, watcher = std::move(watcher)]() mutable {
+    auto writer = std::make_shared<td::actor::ActorOwn<ton::validator::PackageWriter>>(
+        td::actor::create_actor<ton::validator::PackageWriter>("writer", package));
+    for (size_t i = 0; i < entries; i++) {
+      td::actor::send_closure(
+          *writer, &ton::validator::PackageWriter::append, PSTRING() << "file" << i,
+          td::BufferSlice(PSLICE() << "data" << i),
+          [&results, entries, writer, watcher](td::Result<std::pair<td::uint64, td::uint64>> R) mutable {
+            results.push_back(R.move_as_ok());
+            if (results.size() == entries) {
+              writer->reset();
+            }
+          });
+    }
+    watcher.reset();
+  });
+  scheduler.run();
+
+  // all appends were queued before the flush alarm, so they were written at once
+  CHECK(package->writes_count() == 1);
+  CHECK(results.size() == entries);
+  for (size_t i = 0; i < entries; i++) {
+    auto R = package->read(results[i].first).move_as_ok();
+    std::string filename = PSTRING() << "file" << i;
+    std::string data = PSTRING() << "data" << i;
+    CHECK(R.first == filename);
+    CHECK(R.second.as_slice() == data);
+    CHECK(results[i].second == (i + 1 < entries ? results[i + 1].first : package->size()));
+  }
+  CHECK(results[0].first == 0);
+
+  package.reset();
+  td::unlink(path).ignore();
+}
+
+TEST(Package, reader) {
+  td::CSlice path = "test-package-reader.pack";
+  td::unlink(path).ignore();
+  auto package = std::make_shared<ton::Package>(ton::Package::open(path.str(), false, true).move_as_ok());
+
+  // entries both smaller and larger than the read prefetch, some of them appended after the mapping
+  std::vector<std::pair<std::string, std::string>> entries;
+  std::vector<td::uint64> offsets;
+  for (size_t i = 0; i < 4; i++) {
+    entries.emplace_back(PSTRING() << "file" << i, std::string(i % 2 ? 40000 : 100, static_cast<char>('a' + i)));
+  }
+  for (size_t i = 0; i < 2; i++) {
+    offsets.push_back(package->append(entries[i].first, entries[i].second));
+  }
+  auto mapping = std::make_shared<const ton::PackageMapping>(package->map().move_as_ok());
+  for (size_t i = 2; i < entries.size(); i++) {
+    offsets.push_back(package->append(entries[i].first, entries[i].second));
+  }
+
+  size_t done = 0;
+  td::actor::Scheduler scheduler({1});
+  auto watcher = td::create_shared_destructor([] { td::actor::SchedulerContext::get()->stop(); });
+  scheduler.run_in_context([&, watcher = std::move(watcher)]() mutable {
+    auto reader = std::make_shared<td::actor::ActorOwn<ton::validator::PackageReader>>(
+        td::actor::create_actor<ton::validator::PackageReader>("reader", package));
+    for (size_t i = 0; i < entries.size(); i++) {
+      // the mapping is also passed for the entries beyond it, they are then read from the file
+      td::actor::send_closure(
+          *reader, &ton::validator::PackageReader::read, mapping, offsets[i],
+          [&, i, reader, watcher](td::Result<std::pair<std::string, td::BufferSlice>> R) mutable {
+            auto entry = R.move_as_ok();
+            CHECK(entry.first == entries[i].first);
+            CHECK(entry.second.as_slice() == entries[i].second);
+            if (++done == entries.size()) {
+              reader->reset();
+            }
+          });
+    }
+    watcher.reset();
+  });
+  scheduler.run();
+  CHECK(done == entries.size());
+
+  mapping.reset();
+  package.reset();
+  td::unlink(path).ignore();
+}
@@ -0,0 +1,110 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#include "td/utils/tests.h"
+
+#include "validator/db/persistent-state-delta.hpp"
+
+#include "vm/boc.h"
+#include "vm/dict.h"
+#include "td/utils/filesystem.h"
+#include "td/utils/port/path.h"
+
+namespace {
+
+void set_value(vm::Dictionary &dict, td::uint32 key, td::uint64 value) {
+  td::BitArray<32> k;
+  k.store_ulong(key);
+  vm::CellBuilder cb;
+  cb.store_long(value, 64);
+  CHECK(dict.set_ref(k, vm::CellBuilder().store_ref(cb.finalize()).finalize()));
+}
+
+td::FileFd create_file(td::CSlice path) {
+  return td::FileFd::open(path, td::FileFd::Write | td::FileFd::CreateNew).move_as_ok();
+}
+
+}  // namespace
+
+TEST(PersistentStateDelta, reconstruct) {
+  td::CSlice base_path = "test-state-base.boc";
+  td::CSlice delta_path = "test-state.delta";
+  td::CSlice full_path = "test-state-full.boc";
+  for (auto path : {base_path, delta_path, full_path}) {
+    td::unlink(path).ignore();
+  }
+
+  vm::Dictionary dict{32};
+  for (td::uint32 i = 0; i < 20000; i++) {
+    set_value(dict, i, i);
+  }
+  auto base_root = dict.get_root_cell();
+  {
+    auto fd = create_file(base_path);
+    vm::BagOfCells boc;
+    boc.set_root(base_root);
+    boc.import_cells().ensure();
+    boc.serialize_to_file(fd, 31).ensure();
+  }
+
+  for (td::uint32 i = 0; i < 20000; i += 1000) {
+    set_value(dict, i, i + 1);
+  }
+  set_value(dict, 100000, 1);
+  auto root = dict.get_root_cell();
+  ton::FileHash base_hash;
+  base_hash.as_slice().fill('a');
+  {
+    auto fd = create_file(delta_path);
+    ton::validator::db::PersistentStateDelta::write(fd, root, base_hash, base_path.str()).ensure();
+  }
+
+  CHECK(ton::validator::db::PersistentStateDelta::read_base(base_path.str()).move_as_ok().is_zero());
+  CHECK(ton::validator::db::PersistentStateDelta::read_base(delta_path.str()).move_as_ok() == base_hash);
+  auto base_size = td::read_file(base_path).move_as_ok().size();
+  auto delta_size = td::read_file(delta_path).move_as_ok().size();
+  LOG(INFO) << "full state: " << base_size << " bytes, delta: " << delta_size << " bytes";
+  CHECK(delta_size * 10 < base_size);
+
+  {
+    auto fd = create_file(full_path);
+    ton::validator::db::PersistentStateDelta::reconstruct(delta_path.str(), base_path.str(), fd).ensure();
+  }
+  auto full = vm::std_boc_deserialize(td::read_file(full_path).move_as_ok()).move_as_ok();
+  CHECK(full->get_hash() == root->get_hash());
+
+  // a delta is applied only to the base it was made against
+  {
+    auto fd = create_file(base_path.str() + ".other");
+    vm::BagOfCells boc;
+    boc.set_root(root);
+    boc.import_cells().ensure();
+    boc.serialize_to_file(fd, 31).ensure();
+  }
+  td::unlink(full_path).ignore();
+  {
+    auto fd = create_file(full_path);
+    CHECK(ton::validator::db::PersistentStateDelta::reconstruct(delta_path.str(), base_path.str() + ".other", fd)
+              .is_error());
+  }
+
+  for (auto path : {base_path, delta_path, full_path}) {
+    td::unlink(path).ignore();
+  }
+  td::unlink(base_path.str() + ".other").ignore();
+}
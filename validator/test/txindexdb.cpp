@@ -0,0 +1,156 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#include "td/utils/tests.h"
+
+#include "validator/db/txindexdb.hpp"
+#include "validator/fabric.h"
+
+#include "block/block-parse.h"
+#include "td/db/MemoryKeyValue.h"
+#include "td/utils/crypto.h"
+#include "vm/boc.h"
+#include "vm/dict.h"
+
+namespace {
+
+// the index writes every block in one transaction; in memory the entries are simply applied at once
+class TestKeyValue : public td::MemoryKeyValue {
+ public:
+  td::Status begin_transaction() override {
+    return td::Status::OK();
+  }
+  td::Status commit_transaction() override {
+    return td::Status::OK();
+  }
+};
+
+td::Ref<vm::Cell> make_transaction(const ton::StdSmcAddress &addr, ton::LogicalTime lt) {
+  vm::CellBuilder cb;
+  cb.store_long(7, 4)                      // transaction$0111
+      .store_bits(addr.bits(), 256)        // account_addr:bits256
+      .store_long(lt, 64)                  // lt:uint64
+      .store_zeroes(256 + 64 + 32 + 15)    // prev_trans_hash prev_trans_lt now outmsg_cnt
+      .store_zeroes(2 + 2)                 // orig_status end_status
+      .store_ref(vm::CellBuilder().finalize())
+      .store_zeroes(4 + 1);                // total_fees:CurrencyCollection
+  return cb.finalize();
+}
+
+// a block containing only the account blocks, which is all the index looks at
+td::Ref<ton::validator::BlockData> make_block(
+    ton::BlockSeqno seqno, const std::vector<std::pair<ton::StdSmcAddress, std::vector<ton::LogicalTime>>> &accounts,
+    std::map<ton::LogicalTime, ton::Bits256> &hashes) {
+  vm::AugmentedDictionary acc_dict{256, block::tlb::aug_ShardAccountBlocks};
+  for (auto &account : accounts) {
+    vm::AugmentedDictionary trans_dict{64, block::tlb::aug_AccountTransactions};
+    for (auto lt : account.second) {
+      auto trans = make_transaction(account.first, lt);
+      hashes[lt] = trans->get_hash().bits();
+      CHECK(trans_dict.set_ref(td::BitArray<64>{static_cast<long long>(lt)}, trans, vm::Dictionary::SetMode::Add));
+    }
+    vm::CellBuilder cb;
+    cb.store_long(5, 4)  // acc_trans#5
+        .store_bits(account.first.bits(), 256)
+        .append_cellslice(vm::load_cell_slice(std::move(trans_dict).extract_root_cell()))
+        .store_ref(vm::CellBuilder().store_long(0x72, 8).store_zeroes(512).finalize());
+    CHECK(acc_dict.set(account.first.bits(), 256, vm::load_cell_slice_ref(cb.finalize()),
+                       vm::Dictionary::SetMode::Add));
+  }
+  vm::CellBuilder account_blocks;
+  account_blocks.append_cellslice(std::move(acc_dict).extract_root());
+  auto empty = vm::CellBuilder().finalize();
+  auto extra = vm::CellBuilder()
+                   .store_long(0x4a33f6fd, 32)
+                   .store_ref(empty)
+                   .store_ref(empty)
+                   .store_ref(account_blocks.finalize())
+                   .store_zeroes(256 + 256 + 1)
+                   .finalize();
+  auto root = vm::CellBuilder()
+                  .store_long(0x11ef55aa, 32)
+                  .store_long(-239, 32)
+                  .store_ref(empty)
+                  .store_ref(empty)
+                  .store_ref(empty)
+                  .store_ref(extra)
+                  .finalize();
+  auto data = vm::std_boc_serialize(root, 31).move_as_ok();
+  ton::FileHash file_hash;
+  td::sha256(data.as_slice(), file_hash.as_slice());
+  ton::BlockIdExt block_id{ton::basechainId, ton::shardIdAll, seqno, root->get_hash().bits(), file_hash};
+  return ton::validator::create_block(block_id, std::move(data)).move_as_ok();
+}
+
+}  // namespace
+
+TEST(TxIndexDb, account_transactions) {
+  ton::StdSmcAddress a, b;
+  a.set_zero();
+  a.bits().store_uint(1, 8);
+  b.set_zero();
+  b.bits().store_uint(2, 8);
+
+  std::map<ton::LogicalTime, ton::Bits256> hashes;
+  auto block1 = make_block(1, {{a, {10, 20, 30}}, {b, {15}}}, hashes);
+  auto block2 = make_block(2, {{a, {40, 50}}, {b, {25}}}, hashes);
+
+  ton::validator::TxIndexDb db{{}, std::make_shared<TestKeyValue>()};
+  db.start_up();
+  db.index_block_data(block1);
+  db.index_block_data(block2);
+
+  auto get = [&](ton::WorkchainId workchain, const ton::StdSmcAddress &addr, ton::LogicalTime lt, td::uint32 count) {
+    std::vector<ton::validator::AccountTransactionId> res;
+    db.get_account_transactions(
+        workchain, addr, lt, count,
+        td::PromiseCreator::lambda([&](td::Result<std::vector<ton::validator::AccountTransactionId>> R) {
+          res = R.move_as_ok();
+        }));
+    return res;
+  };
+  auto check = [&](const std::vector<ton::validator::AccountTransactionId> &res,
+                   const std::vector<ton::LogicalTime> &expected) {
+    ASSERT_EQ(expected.size(), res.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+      ASSERT_EQ(expected[i], res[i].lt);
+      ASSERT_TRUE(hashes[expected[i]] == res[i].hash);
+      auto &block = expected[i] > 30 || expected[i] == 25 ? block2 : block1;
+      ASSERT_TRUE(block->block_id() == res[i].block_id);
+    }
+  };
+
+  auto max_lt = std::numeric_limits<ton::LogicalTime>::max();
+  // latest first, across blocks
+  check(get(ton::basechainId, a, max_lt, 10), {50, 40, 30, 20, 10});
+  check(get(ton::basechainId, b, max_lt, 10), {25, 15});
+  // pages
+  check(get(ton::basechainId, a, max_lt, 2), {50, 40});
+  check(get(ton::basechainId, a, 39, 2), {30, 20});
+  check(get(ton::basechainId, a, 19, 2), {10});
+  // the lt bound is inclusive
+  check(get(ton::basechainId, a, 30, 10), {30, 20, 10});
+  check(get(ton::basechainId, a, 29, 10), {20, 10});
+  check(get(ton::basechainId, a, 9, 10), {});
+  // other accounts and workchains are not mixed in
+  check(get(ton::masterchainId, a, max_lt, 10), {});
+  ton::StdSmcAddress c;
+  c.set_zero();
+  c.bits().store_uint(3, 8);
+  check(get(ton::basechainId, c, max_lt, 10), {});
+}
@@ -0,0 +1,64 @@
+/*
+    This file is part of TON Blockchain Library.
+
+    TON Blockchain Library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    TON Blockchain Library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with TON Blockchain Library.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright 2017-2020 Telegram Systems LLP
+*/
+#include "td/utils/tests.h"
+
+#include "validator/impl/worker-pool.hpp"
+
+#include <atomic>
+
+TEST(WorkerPool, run) {
+  for (size_t pool_threads : {0, 1, 3}) {
+    ton::validator::WorkerPool pool(pool_threads);
+    for (size_t threads : {1, 2, 4, 8}) {
+      std::atomic<int> next{0}, done{0}, calls{0};
+      pool.run(threads, [&] {
+        calls++;
+        while (next++ < 1000) {
+          done++;
+        }
+      });
+      ASSERT_EQ(1000, done.load());
+      CHECK(calls.load() >= 1);
+      CHECK(static_cast<size_t>(calls.load()) <= td::min(threads, pool_threads + 1));
+    }
+  }
+}
+
+TEST(WorkerPool, busy) {
+  // the calling thread does all the work if the threads of the pool are taken by another run
+  ton::validator::WorkerPool pool(1);
+  std::atomic<bool> release{false};
+  std::atomic<int> blocked{0};
+  td::thread other([&] {
+    pool.run(2, [&] {
+      blocked++;
+      while (!release) {
+        td::this_thread::yield();
+      }
+    });
+  });
+  while (blocked.load() < 2) {
+    td::this_thread::yield();
+  }
+  std::atomic<int> done{0};
+  pool.run(2, [&] { done++; });
+  ASSERT_EQ(1, done.load());
+  release = true;
+  other.join();
+}
@@ -91,6 +91,12 @@ struct ValidatorManagerOptionsImpl : public ValidatorManagerOptions {
   td::uint32 get_filedb_depth() const override {
     return db_depth_;
   }
+  bool tx_index_enabled() const override {
+    return tx_index_enabled_;
+  }
+  bool persistent_state_deltas_enabled() const override {
+    return persistent_state_deltas_enabled_;
+  }
 
   void set_zero_block_id(BlockIdExt block_id) override {
     zero_block_id_ = block_id;
@@ -129,6 +135,12 @@ struct ValidatorManagerOptionsImpl : public ValidatorManagerOptions {
     CHECK(value <= 32);
     db_depth_ = value;
   }
+  void set_tx_index_enabled(bool value) override {
+    tx_index_enabled_ = value;
+  }
+  void set_persistent_state_deltas_enabled(bool value) override {
+    persistent_state_deltas_enabled_ = value;
+  }
 
   ValidatorManagerOptionsImpl *make_copy() const override {
     return new ValidatorManagerOptionsImpl(*this);
@@ -164,6 +176,8 @@ struct ValidatorManagerOptionsImpl : public ValidatorManagerOptions {
   bool initial_sync_disabled_;
   std::vector<BlockIdExt> hardforks_;
   td::uint32 db_depth_ = 2;
+  bool tx_index_enabled_ = false;
+  bool persistent_state_deltas_enabled_ = false;
 };
 
 }  // namespace validator
@@ -39,6 +39,13 @@ namespace ton {
 
 namespace validator {
 
+// a transaction of an account together with the block containing it, as kept in the transaction index
+struct AccountTransactionId {
+  LogicalTime lt;
+  Bits256 hash;
+  BlockIdExt block_id;
+};
+
 class DownloadToken {
  public:
   virtual ~DownloadToken() = default;
@@ -65,6 +72,8 @@ struct ValidatorManagerOptions : public td::CntObject {
   virtual td::uint32 get_last_fork_masterchain_seqno() const = 0;
   virtual std::vector<BlockIdExt> get_hardforks() const = 0;
   virtual td::uint32 get_filedb_depth() const = 0;
+  virtual bool tx_index_enabled() const = 0;
+  virtual bool persistent_state_deltas_enabled() const = 0;
   virtual td::uint32 key_block_utime_step() const {
     return 86400;
   }
@@ -81,6 +90,8 @@ struct ValidatorManagerOptions : public td::CntObject {
   virtual void set_initial_sync_disabled(bool value) = 0;
   virtual void set_hardforks(std::vector<BlockIdExt> hardforks) = 0;
   virtual void set_filedb_depth(td::uint32 value) = 0;
+  virtual void set_tx_index_enabled(bool value) = 0;
+  virtual void set_persistent_state_deltas_enabled(bool value) = 0;
 
   static td::Ref<ValidatorManagerOptions> create(
       BlockIdExt zero_block_id, BlockIdExt init_block_id,
@@ -193,6 +204,10 @@ class ValidatorManagerInterface : public td::actor::Actor {
                                               td::Promise<ConstBlockHandle> promise) = 0;
   virtual void get_block_by_seqno_from_db(AccountIdPrefixFull account, BlockSeqno seqno,
                                           td::Promise<ConstBlockHandle> promise) = 0;
+  // fails if the transaction index is disabled
+  virtual void get_account_transactions_from_db(WorkchainId workchain, StdSmcAddress addr, LogicalTime lt,
+                                                td::uint32 count,
+                                                td::Promise<std::vector<AccountTransactionId>> promise) = 0;
 
   virtual void get_archive_id(BlockSeqno masterchain_seqno, td::Promise<td::uint64> promise) = 0;
   virtual void get_archive_slice(td::uint64 archive_id, td::uint64 offset, td::uint32 limit,